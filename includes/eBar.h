@@ -13,6 +13,56 @@
 #define __EBAR_H__
 
 #include "eFile.h"
+#include <stdint.h>
+#include <sys/types.h>
+
+
+/**
+ * @struct bar_use structure of an open file, linked to the files used
+ *         before and after it.
+ */
+typedef struct bar_use {
+
+    /** File */
+    eFile const * file;
+
+    /** Index of the file in the bar */
+    unsigned int index;
+
+    /** File used just after, NULL for the last used one */
+    struct bar_use * previous;
+
+    /** File used just before, NULL for the least recently used one */
+    struct bar_use * next;
+
+} bar_use;
+
+
+/**
+ * @struct bar_slot structure of the table of the open files. A file is
+ *         found by the device and inode of its realpath, so that a hard
+ *         link or a symbolic link gives the same file, or by its realpath
+ *         when it has no status.
+ */
+typedef struct {
+
+    /** Hash of the key, 0 for a free slot and 1 for a removed one */
+    uint64_t hash;
+
+    /** The key is the realpath of the file, not its inode */
+    bool by_path;
+
+    /** Device of the file */
+    dev_t dev;
+
+    /** Inode of the file, 0 if it has none. A slot by path holds the inode
+        the file is also found by */
+    ino_t ino;
+
+    /** Open file */
+    bar_use * use;
+
+} bar_slot;
 
 
 /**
@@ -23,12 +73,24 @@ typedef struct {
     /** List allocation size */
     size_t alloc_size;
 
-    /** List of eFile */
-    eFile const ** files;
+    /** List of the open files, in the order of the bar */
+    bar_use ** files;
 
     /** File count */
     unsigned int n_files;
 
+    /** Table of the files, open addressing */
+    bar_slot * slots;
+
+    /** Number of slots, a power of two */
+    size_t n_slots;
+
+    /** Number of slots used or removed */
+    size_t n_used;
+
+    /** Last used file, first of the files from the most recently used */
+    bar_use * last_used;
+
 } eBar;
 
 
@@ -64,7 +126,8 @@ int add_file_eBar(eBar * bar,
 
 
 /**
- * @brief The remove_file_eBar() function remove a file from the bar.
+ * @brief The remove_file_eBar() function remove a file from the bar. The
+ *        next files are shifted, they keep the order of the tabs.
  *
  * @param bar: eBar pointer
  * @param index: index of eFile to remove
@@ -111,4 +174,71 @@ unsigned int count_eBar(eBar const * bar);
 bool is_file_in_eBar(eBar const * bar,
                      eFile const * file);
 
+
+/**
+ * @brief The find_file_eBar() function return the file of the bar which is
+ *        the same file on disk, by its inode, or by its realpath if it has
+ *        no status.
+ *
+ * @param bar: eBar pointer
+ * @param file: eFile pointer, in the bar or not
+ *
+ * @return eFile pointer of the bar or NULL if the file is not open.
+ */
+eFile const * find_file_eBar(eBar const * bar,
+                             eFile const * file);
+
+
+/**
+ * @brief The get_index_eBar() function return the index of a file of the
+ *        bar, without looking through the bar.
+ *
+ * @param bar: eBar pointer
+ * @param file: eFile pointer
+ *
+ * @return Index of the file or -1 if it is not in the bar.
+ */
+int get_index_eBar(eBar const * bar,
+                   eFile const * file);
+
+
+/**
+ * @brief The update_file_eBar() function find a file of the bar by its new
+ *        inode, after it was replaced on disk.
+ *
+ * @param bar: eBar pointer
+ * @param file: eFile pointer
+ *
+ * @return 0 on success or -1 in failure.
+ */
+int update_file_eBar(eBar * bar,
+                     eFile const * file);
+
+
+/**
+ * @brief The use_file_eBar() function set a file of the bar as the last
+ *        used one.
+ *
+ * @param bar: eBar pointer
+ * @param file: eFile pointer
+ *
+ * @return 0 on success or -1 if the file is not in the bar.
+ */
+int use_file_eBar(eBar * bar,
+                  eFile const * file);
+
+
+/**
+ * @brief The get_used_file_eBar() function return the file used just
+ *        before a file of the bar.
+ *
+ * @param bar: eBar pointer
+ * @param file: eFile pointer or NULL
+ *
+ * @return eFile pointer, the last used file if file is NULL, not in the bar
+ *         or the least recently used one, or NULL if the bar is empty.
+ */
+eFile const * get_used_file_eBar(eBar const * bar,
+                                 eFile const * file);
+
 #endif
@@ -97,4 +97,21 @@ int get_item_at_index_eDirectory(eDirectory const * directory,
                                  eDirectory ** out_directory,
                                  eFile ** out_file);
 
+
+/**
+ * @brief The find_path_eDirectory() function returns either the directory
+ *        or the file at a path.
+ *
+ * @param directory: eDirectory pointer
+ * @param path: Path from the directory, names separated by '/'
+ * @param out_directory: eDirectory pointer returned
+ * @param out_file: eFile pointer returned
+ *
+ * @return 0 on success or -1 if there is nothing at the path.
+ */
+int find_path_eDirectory(eDirectory const * directory,
+                         char const * path,
+                         eDirectory ** out_directory,
+                         eFile ** out_file);
+
 #endif
@@ -12,8 +12,18 @@
 #define __EFILE_H__
 
 #include "eLine.h"
+#include "eJournal.h"
+#include "eUndo.h"
+#include "eView.h"
+#include "eFollow.h"
+#include "eFilter.h"
+#include "eHex.h"
+#include "ePack.h"
 #include "util.h"
 #include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+#include <sys/stat.h>
 
 
 /**
@@ -33,6 +43,12 @@ typedef struct efile_s
     /** First line of eLine linked list */
     eLine * first_file_line;
 
+    /** Lines indexed by line number - 1 */
+    eLine ** lines;
+
+    /** Lines allocation size */
+    unsigned int alloc_lines;
+
     /** First line of screen */
     eLine * first_screen_line;
 
@@ -48,6 +64,44 @@ typedef struct efile_s
     /** boolean to track status of file */
     bool is_saved;
 
+    /** Descriptor of the opened file, source of the unchanged lines, or -1 */
+    int fd;
+
+    /** Status of the file when it was opened */
+    struct stat file_stat;
+
+    /** Status of the file on disk when it was last read or saved */
+    struct stat disk_stat;
+
+    /** Hash of the file on disk when it was last read, 0 if unknown */
+    uint64_t disk_hash;
+
+    /** Journal of the unsaved modifications or NULL */
+    eJournal * journal;
+
+    /** Undo and redo stacks or NULL */
+    eUndo * undo;
+
+    /** Paged view of a huge file or NULL, the file has no line then */
+    eView * view;
+
+    /** Reader of the bytes appended to the file or NULL */
+    eFollow * follow;
+
+    /** Lines shown by the filter or NULL, every line is shown */
+    eFilter * filter;
+
+    /** Hexadecimal view of a binary file or NULL, the file has no line
+        then */
+    eHex * hex;
+
+    /** Compressed lines of an unused file or NULL, the file has no line
+        then */
+    ePack * pack;
+
+    /** Time the file was last shown, an unused file is packed */
+    struct timespec last_use;
+
 } eFile;
 
 
@@ -85,6 +139,73 @@ void delete_eFile(eFile ** efile);
 int open_eFile(eFile * efile);
 
 
+/**
+ * @brief The begin_open_eFile() function open the file without reading its
+ *        lines, they are added by append_lines_eFile(), see eLoad. The file
+ *        can be modified while the lines are added.
+ *
+ * @param efile: eFile pointer
+ *
+ * @return 0 on success or -1 in failure.
+ *
+ * @note end_open_eFile() must be called once every line is added. If the
+ *       file did not exist when calling create_eFile(), a new file is
+ *       written and the fd attribute stays -1: there is nothing to read.
+ */
+int begin_open_eFile(eFile * efile);
+
+
+/**
+ * @brief The append_lines_eFile() function add lines read from the file
+ *        after the last line. The added lines are not a modification.
+ *
+ * @param efile: eFile pointer
+ * @param first_line: First line, linked to the next ones
+ * @param last_line: Last line
+ * @param n_lines: Number of lines
+ *
+ * @return 0 on success or -1 in failure.
+ */
+int append_lines_eFile(eFile * efile,
+                       eLine * first_line,
+                       eLine * last_line,
+                       unsigned int n_lines);
+
+
+/**
+ * @brief The end_open_eFile() function finish the opening once every line
+ *        is added. An empty file gets an empty line.
+ *
+ * @param efile: eFile pointer
+ */
+void end_open_eFile(eFile * efile);
+
+
+/**
+ * @brief The view_eFile() function show the file opened by
+ *        begin_open_eFile() through an eView instead of reading its lines.
+ *        The file gets an empty line, it must not be modified.
+ *
+ * @param efile: eFile pointer
+ *
+ * @return 0 on success or -1 in failure, the lines can still be read.
+ */
+int view_eFile(eFile * efile);
+
+
+/**
+ * @brief The hex_eFile() function show the binary file opened by
+ *        begin_open_eFile() in hexadecimal, through an eHex, instead of
+ *        reading its lines. The file gets an empty line, it must not be
+ *        modified.
+ *
+ * @param efile: eFile pointer
+ *
+ * @return 0 on success or -1 in failure, the lines can still be read.
+ */
+int hex_eFile(eFile * efile);
+
+
 /**
  * @brief The close_eFile() function close the file and deallocate eLines.
  *
@@ -94,7 +215,9 @@ void close_eFile(eFile *efile);
 
 /**
  * @brief The write_eFile() function write the content of eFile on the
- *        file designed by filename stored in the filename attribute.
+ *        file designed by filename stored in the filename attribute. The
+ *        content is written in a temporary file renamed over the file, see
+ *        eSave.
  *
  * @param efile eFile pointer
  *
@@ -129,6 +252,19 @@ int delete_line_eFile(eFile * efile,
                       unsigned int line_number);
 
 
+/**
+ * @brief The get_line_eFile() function return the line designed by its
+ *        line number in O(1).
+ *
+ * @param efile: eFile pointer
+ * @param line_number: Line number, clamped between 1 and n_elines
+ *
+ * @return eLine pointer or NULL if the file has no line.
+ */
+eLine * get_line_eFile(eFile const * efile,
+                       unsigned int line_number);
+
+
 /**
  * @brief The insert_char_eFile() insert a character to the current
  *        position in the current_line.
@@ -180,4 +316,147 @@ int insert_string_eFile(eFile * efile,
 int remove_string_eFile(eFile *efile,
                         size_t length);
 
+
+/**
+ * @brief The replace_all_eFile() function replace every occurrence of
+ *        pattern in the file by replacement in a single pass.
+ *
+ * @param efile: eFile pointer
+ * @param pattern: String to replace
+ * @param pattern_length: Length of pattern
+ * @param replacement: String replacing pattern
+ * @param replacement_length: Length of replacement
+ *
+ * @return Number of replaced occurrences or -1 in failure.
+ */
+long replace_all_eFile(eFile * efile,
+                       char const * pattern,
+                       size_t pattern_length,
+                       char const * replacement,
+                       size_t replacement_length);
+
+
+/**
+ * @brief The scan_filter_eFile() function extend the index of the filter
+ *        with the next lines of the file, until it has n_matches matches.
+ *
+ * @param efile: eFile pointer
+ * @param n_matches: Number of matches to reach
+ * @param n_lines: Number of lines scanned at most
+ *
+ * @return 0 on success or -1 in failure.
+ */
+int scan_filter_eFile(eFile * efile,
+                      unsigned int n_matches,
+                      unsigned int n_lines);
+
+
+/**
+ * @brief The is_changed_eFile() function tell if the file on disk is not
+ *        the one last read or saved: its status changed and, if its hash
+ *        is known, its content. A file only touched gets its new status.
+ *
+ * @param efile: eFile pointer
+ *
+ * @return true if the file was changed by another program, false
+ *         otherwise or if it can not be read.
+ */
+bool is_changed_eFile(eFile * efile);
+
+
+/**
+ * @brief The reload_eFile() function read again the file changed on disk
+ *        and replace only the lines which differ, so that the cursor and
+ *        the first line of screen stay on their line. The file is read in
+ *        memory rather than mapped, another program may still truncate
+ *        it. The modifications are lost and the undo history is cleared.
+ *
+ * @param efile: eFile pointer
+ * @param n_changed: Number of lines modified, added or deleted
+ *
+ * @return 0 on success or -1 in failure, the buffer is then unchanged.
+ */
+int reload_eFile(eFile * efile,
+                 unsigned int * n_changed);
+
+
+/**
+ * @brief The pack_eFile() function compress the lines of an unused file
+ *        and free them, the position of the cursor is kept.
+ *
+ * @param efile: eFile pointer
+ *
+ * @return 0 on success or -1 in failure, the lines are then kept.
+ */
+int pack_eFile(eFile * efile);
+
+
+/**
+ * @brief The unpack_eFile() function create again the lines of a packed
+ *        file, or read again a dropped file, and put the cursor back where
+ *        it was. A restored file is opened by the caller first, only its
+ *        cursor is put back.
+ *
+ * @param efile: eFile pointer
+ *
+ * @return 0 on success or if the file is not packed, -1 in failure, the
+ *         file stays packed then.
+ */
+int unpack_eFile(eFile * efile);
+
+
+/**
+ * @brief The restore_eFile() function keep the cursor of a file of a
+ *        previous session without opening it. The file is handled like a
+ *        dropped file until it is opened, then unpack_eFile() puts the
+ *        cursor back.
+ *
+ * @param efile: eFile pointer, not open
+ * @param current_line: Line number of the current line
+ * @param current_pos: Current pos in current line
+ * @param first_screen_line: Line number of the first line of screen
+ *
+ * @return 0 on success or -1 in failure.
+ */
+int restore_eFile(eFile * efile,
+                  unsigned int current_line,
+                  unsigned int current_pos,
+                  unsigned int first_screen_line);
+
+
+/**
+ * @brief The is_restored_eFile() function return true if a file of a
+ *        previous session was not opened yet.
+ *
+ * @param efile: eFile pointer
+ *
+ * @return true if the file must be opened before it is shown, false
+ *         otherwise.
+ */
+bool is_restored_eFile(eFile const * efile);
+
+
+/**
+ * @brief The can_drop_eFile() function return true if the lines of a file
+ *        can be dropped and read again from the file.
+ *
+ * @param efile: eFile pointer
+ *
+ * @return true if the file was read from disk and not modified, false
+ *         otherwise.
+ */
+bool can_drop_eFile(eFile const * efile);
+
+
+/**
+ * @brief The drop_eFile() function free the lines of an unused file which
+ *        was not modified, packed or not, and close it. Only the position
+ *        of the cursor is kept, the lines are read again from the file.
+ *
+ * @param efile: eFile pointer
+ *
+ * @return 0 on success or -1 if the file can not be read again.
+ */
+int drop_eFile(eFile * efile);
+
 #endif
@@ -0,0 +1,158 @@
+/**
+ * @file eFilter.h
+ * @brief eFilter Header
+ * @author ALARY Dorian
+ * @version 1.0
+ * @date 21/07/2024
+ * @copyright GNU Public License.
+ *
+ */
+
+#ifndef __EFILTER_H__
+#define __EFILTER_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <regex.h>
+
+
+#define FILTER_STEP 65536 /* Lines scanned by a tick */
+#define FILTER_BUDGET (1024*1024) /* Lines scanned at most to move the
+                                     cursor */
+
+
+/**
+ * @struct eFilter structure to show only the lines of a file matching a
+ *         pattern. The lines are scanned from the first one as they are
+ *         needed, the index of the matching lines grows with them.
+ */
+typedef struct {
+
+    /** Extended regular expression */
+    regex_t regex;
+
+    /** Line numbers of the matching lines, sorted */
+    unsigned int * matches;
+
+    /** Number of matching lines */
+    unsigned int n_matches;
+
+    /** Matches allocation size */
+    unsigned int alloc_matches;
+
+    /** Number of lines scanned, from the first one */
+    unsigned int n_scanned;
+
+    /** Every line of the file was scanned */
+    bool finished;
+
+    /** Index of the first match of screen */
+    unsigned int first_screen_match;
+
+} eFilter;
+
+
+/**
+ * @brief The create_eFilter() function compile a pattern and allocate an
+ *        eFilter with an empty index.
+ *
+ * @param pattern: Extended regular expression, ex "ERROR|timeout"
+ *
+ * @return eFilter pointer or NULL if it was an error or the pattern is
+ *         invalid.
+ *
+ * @note delete_eFilter() must be called before exiting.
+ */
+eFilter * create_eFilter(char const * pattern);
+
+
+/**
+ * @brief The delete_eFilter() function deallocate eFilter and set the
+ *        pointer to NULL.
+ *
+ * @param filter: eFilter pointer pointer
+ */
+void delete_eFilter(eFilter ** filter);
+
+
+/**
+ * @brief The add_line_eFilter() function scan the line following the
+ *        scanned lines.
+ *
+ * @param filter: eFilter pointer
+ * @param string: Content of the line, not necessarily terminated by 0
+ * @param length: Length of the line
+ *
+ * @return 0 on success or -1 in failure.
+ */
+int add_line_eFilter(eFilter * filter,
+                     char const * string,
+                     size_t length);
+
+
+/**
+ * @brief The update_line_eFilter() function scan again a modified line.
+ *
+ * @param filter: eFilter pointer
+ * @param line_number: Line number
+ * @param string: Content of the line, not necessarily terminated by 0
+ * @param length: Length of the line
+ *
+ * @return 0 on success or -1 in failure.
+ */
+int update_line_eFilter(eFilter * filter,
+                        unsigned int line_number,
+                        char const * string,
+                        size_t length);
+
+
+/**
+ * @brief The insert_line_eFilter() function shift the index after a line
+ *        was inserted, and scan the new line.
+ *
+ * @param filter: eFilter pointer
+ * @param line_number: Line number of the new line
+ * @param string: Content of the line, not necessarily terminated by 0
+ * @param length: Length of the line
+ *
+ * @return 0 on success or -1 in failure.
+ */
+int insert_line_eFilter(eFilter * filter,
+                        unsigned int line_number,
+                        char const * string,
+                        size_t length);
+
+
+/**
+ * @brief The delete_line_eFilter() function shift the index after a line
+ *        was deleted.
+ *
+ * @param filter: eFilter pointer
+ * @param line_number: Line number of the deleted line
+ */
+void delete_line_eFilter(eFilter * filter,
+                         unsigned int line_number);
+
+
+/**
+ * @brief The reset_eFilter() function empty the index, every line is
+ *        scanned again.
+ *
+ * @param filter: eFilter pointer
+ */
+void reset_eFilter(eFilter * filter);
+
+
+/**
+ * @brief The find_eFilter() function find the first matching line from a
+ *        line number, among the scanned lines.
+ *
+ * @param filter: eFilter pointer
+ * @param line_number: Line number
+ *
+ * @return Index of the match or n_matches if there is none.
+ */
+unsigned int find_eFilter(eFilter const * filter,
+                          unsigned int line_number);
+
+#endif
@@ -0,0 +1,155 @@
+/**
+ * @file eFinder.h
+ * @brief eFinder Header
+ * @author ALARY Dorian
+ * @version 1.0
+ * @date 21/07/2024
+ * @copyright GNU Public License.
+ *
+ */
+
+#ifndef __EFINDER_H__
+#define __EFINDER_H__
+
+#include "eDirectory.h"
+#include "eFile.h"
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define FINDER_MAX_RESULTS 64 /* Maximum number of results kept (top-K) */
+
+
+/**
+ * @struct eFinderResult structure to store a scored path.
+ */
+typedef struct {
+
+    /** Score of the path, higher is better */
+    int score;
+
+    /** Index of the path in the path table */
+    unsigned int index;
+
+} eFinderResult;
+
+
+/**
+ * @struct eFinder structure to fuzzy match a pattern against every file
+ *         path of an eDirectory. Paths are stored in a flat table.
+ */
+typedef struct {
+
+    /** Files of the table, one per path */
+    eFile ** files;
+
+    /** Arena of paths relative to the root directory, '\0' separated */
+    char * paths;
+
+    /** Lowercase copy of paths, same layout */
+    char * lower_paths;
+
+    /** Bonus of each character of paths (word boundary, basename) */
+    unsigned char * bonus;
+
+    /** Offset of each path in the arenas, n_paths+1 elements */
+    size_t * offsets;
+
+    /** Offset of the basename in each path */
+    uint32_t * basenames;
+
+    /** Bitset of the characters contained in each path */
+    uint64_t * masks;
+
+    /** Number of path */
+    unsigned int n_paths;
+
+    /** Path table allocation size */
+    unsigned int alloc_paths;
+
+    /** Arenas size */
+    size_t arena_size;
+
+    /** Arenas allocation size */
+    size_t alloc_arena;
+
+    /** Paths matching last_query, the next query extending last_query
+        only scores them */
+    unsigned int * candidates;
+
+    /** Number of candidates */
+    unsigned int n_candidates;
+
+    /** Last searched pattern (lowercase) */
+    char * last_query;
+
+    /** Best results of the last search, sorted by score */
+    eFinderResult results[FINDER_MAX_RESULTS];
+
+    /** Number of results */
+    unsigned int n_results;
+
+} eFinder;
+
+
+/**
+ * @brief The create_eFinder() function allocate an eFinder and build the
+ *        path table of every file under directory.
+ *
+ * @param directory: Root eDirectory
+ *
+ * @return eFinder pointer or NULL if it was an error.
+ *
+ * @note delete_eFinder() must be called before exiting.
+ */
+eFinder * create_eFinder(eDirectory const * directory);
+
+
+/**
+ * @brief The delete_eFinder() function deallocate eFinder and set the
+ *        pointer to NULL.
+ *
+ * @param finder: eFinder pointer pointer
+ */
+void delete_eFinder(eFinder ** finder);
+
+
+/**
+ * @brief The search_eFinder() function score every path against pattern
+ *        and keep the best results in finder->results.
+ *
+ * @param finder: eFinder pointer
+ * @param pattern: Characters to match, in order, case insensitive
+ *
+ * @return Number of results or -1 in failure.
+ */
+int search_eFinder(eFinder * finder,
+                   char const * pattern);
+
+
+/**
+ * @brief The get_path_eFinder() function return the path of the ith
+ *        result of the last search.
+ *
+ * @param finder: eFinder pointer
+ * @param index: Result index
+ *
+ * @return Path or NULL if index is out of results.
+ */
+char const * get_path_eFinder(eFinder const * finder,
+                              unsigned int index);
+
+
+/**
+ * @brief The get_file_eFinder() function return the eFile of the ith
+ *        result of the last search.
+ *
+ * @param finder: eFinder pointer
+ * @param index: Result index
+ *
+ * @return eFile pointer or NULL if index is out of results.
+ */
+eFile * get_file_eFinder(eFinder const * finder,
+                         unsigned int index);
+
+#endif
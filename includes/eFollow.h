@@ -0,0 +1,117 @@
+/**
+ * @file eFollow.h
+ * @brief eFollow Header
+ * @author ALARY Dorian
+ * @version 1.0
+ * @date 21/07/2024
+ * @copyright GNU Public License.
+ *
+ */
+
+#ifndef __EFOLLOW_H__
+#define __EFOLLOW_H__
+
+#include "eLine.h"
+
+#include <stdbool.h>
+#include <sys/types.h>
+
+
+#define FOLLOW_BUDGET (16*1024*1024) /* Bytes read at most by read_eFollow() */
+
+
+/**
+ * @struct eFollow structure to read the bytes appended to a file, like
+ *         tail -f, or the bytes written in a pipe. The file is watched with
+ *         inotify.
+ */
+typedef struct {
+
+    /** inotify descriptor or -1, the file is then checked every time */
+    int inotify_fd;
+
+    /** Descriptor of the file or of the pipe */
+    int fd;
+
+    /** The descriptor is a pipe, read without waiting until its end */
+    bool stream;
+
+    /** The end of the pipe was read */
+    bool finished;
+
+    /** Process writing the pipe or -1, it is waited for at the end */
+    pid_t pid;
+
+    /** Offset of the first byte not read */
+    off_t offset;
+
+    /** The last byte read is not a '\n', the last line continues */
+    bool open_line;
+
+    /** Bytes were left to read by the last read */
+    bool pending;
+
+} eFollow;
+
+
+/**
+ * @brief The create_eFollow() function allocate an eFollow reading a file
+ *        from an offset, or a pipe.
+ *
+ * @param realpath: Path of the file, NULL for a pipe
+ * @param fd: Descriptor of the file or of the pipe, it is duplicated
+ * @param offset: Offset of the first byte to read, 0 for a pipe
+ *
+ * @return eFollow pointer or NULL if it was an error.
+ *
+ * @note delete_eFollow() must be called before exiting.
+ */
+eFollow * create_eFollow(char const * realpath,
+                         int fd,
+                         off_t offset);
+
+
+/**
+ * @brief The delete_eFollow() function stop watching the file, stop the
+ *        process writing the pipe, deallocate eFollow and set the pointer
+ *        to NULL.
+ *
+ * @param follow: eFollow pointer pointer
+ */
+void delete_eFollow(eFollow ** follow);
+
+
+/**
+ * @brief The is_changed_eFollow() function return true if the file was
+ *        modified since the last call, without waiting.
+ *
+ * @param follow: eFollow pointer
+ *
+ * @return true if the file may have grown or bytes are left to read,
+ *         false otherwise.
+ */
+bool is_changed_eFollow(eFollow * follow);
+
+
+/**
+ * @brief The read_eFollow() function read the bytes appended to the file,
+ *        up to FOLLOW_BUDGET. The bytes until the first '\n' continue
+ *        last_line if the previous read did not end with '\n', the other
+ *        ones are returned as new lines, linked together.
+ *
+ * @param follow: eFollow pointer
+ * @param last_line: Last line of the file
+ * @param first_line: First new line or NULL
+ * @param new_last_line: Last new line or NULL
+ * @param n_lines: Number of new lines
+ *
+ * @return 0 on success or -1 in failure, or if the process writing the
+ *         pipe failed. A truncated file is read again from its start.
+ */
+int read_eFollow(eFollow * follow,
+                 eLine * last_line,
+                 eLine ** first_line,
+                 eLine ** new_last_line,
+                 unsigned int * n_lines);
+
+#endif
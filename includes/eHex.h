@@ -0,0 +1,85 @@
+/**
+ * @file eHex.h
+ * @brief eHex Header
+ * @author ALARY Dorian
+ * @version 1.0
+ * @date 21/07/2024
+ * @copyright GNU Public License.
+ *
+ */
+
+#ifndef __EHEX_H__
+#define __EHEX_H__
+
+#include <stddef.h>
+
+
+#define HEX_ROW_BYTES 16 /* Bytes shown by a row */
+#define HEX_ROW_LENGTH 96 /* Length of a formatted row, with its 0 */
+
+
+/**
+ * @struct eHex structure to show a binary file in hexadecimal without
+ *         reading it. A row shows HEX_ROW_BYTES bytes and only the rows of
+ *         the screen are read, with pread(2) so that a file truncated by
+ *         another program shows blank rows instead of stopping edito.
+ */
+typedef struct {
+
+    /** Descriptor of the file */
+    int fd;
+
+    /** Size of the file when it was opened */
+    size_t size;
+
+    /** Number of rows */
+    unsigned int n_rows;
+
+    /** First row of screen */
+    unsigned int first_screen_row;
+
+    /** Current row */
+    unsigned int current_row;
+
+} eHex;
+
+
+/**
+ * @brief The create_eHex() function allocate an eHex reading a file.
+ *
+ * @param fd: Descriptor of the file, it can be closed afterwards
+ * @param size: Size of the file, not 0
+ *
+ * @return eHex pointer or NULL if it was an error.
+ *
+ * @note delete_eHex() must be called before exiting.
+ */
+eHex * create_eHex(int fd,
+                   size_t size);
+
+
+/**
+ * @brief The delete_eHex() function close the file, deallocate eHex and
+ *        set the pointer to NULL.
+ *
+ * @param hex: eHex pointer pointer
+ */
+void delete_eHex(eHex ** hex);
+
+
+/**
+ * @brief The get_row_eHex() function format a row: the offset of its
+ *        first byte, its bytes in hexadecimal and its printable bytes.
+ *
+ * @param hex: eHex pointer
+ * @param row: Row number, from 1
+ * @param buffer: Buffer of HEX_ROW_LENGTH characters
+ *
+ * @return Length of the row or 0 if the row does not exist. The bytes
+ *         which can not be read anymore are left blank.
+ */
+size_t get_row_eHex(eHex const * hex,
+                    unsigned int row,
+                    char * buffer);
+
+#endif
@@ -0,0 +1,184 @@
+/**
+ * @file eIndex.h
+ * @brief eIndex Header
+ * @author ALARY Dorian
+ * @version 1.0
+ * @date 21/07/2024
+ * @copyright GNU Public License.
+ *
+ */
+
+#ifndef __EINDEX_H__
+#define __EINDEX_H__
+
+#include "eDirectory.h"
+#include "eFile.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+
+/**
+ * @enum Symbol type enumeration
+ */
+typedef enum {
+
+    s_FUNCTION,
+    s_STRUCT,
+    s_TYPEDEF,
+    s_MACRO
+
+} SYMBOL_TYPE;
+
+
+/**
+ * @struct eSymbol structure to store the definition of a symbol.
+ */
+typedef struct {
+
+    /** Symbol name or NULL if the slot is empty */
+    char * name;
+
+    /** Hash of the name */
+    uint32_t hash;
+
+    /** File of the definition */
+    eFile * file;
+
+    /** Line number of the definition */
+    unsigned int line_number;
+
+    /** Symbol type */
+    SYMBOL_TYPE type;
+
+    /** The slot was used by a removed symbol */
+    bool removed;
+
+} eSymbol;
+
+
+/**
+ * @struct indexed_file structure to store the hashes of the symbols of a
+ *         parsed file, so that they are removed without scanning the whole
+ *         table.
+ */
+typedef struct {
+
+    /** Parsed file or NULL if the slot is empty */
+    eFile const * file;
+
+    /** Hashes of the symbols of the file */
+    uint32_t * hashes;
+
+    /** Number of hashes */
+    size_t n_hashes;
+
+    /** Hashes allocation size */
+    size_t alloc_hashes;
+
+} indexed_file;
+
+
+/**
+ * @struct eIndex structure to store the definitions of the C/C++ symbols
+ *         of a directory. A background thread parses the files.
+ */
+typedef struct {
+
+    /** Hash table of symbols (open addressing) */
+    eSymbol * symbols;
+
+    /** Hash table allocation size, power of two */
+    size_t alloc_size;
+
+    /** Number of symbols */
+    size_t n_symbols;
+
+    /** Number of used slots (symbols and removed symbols) */
+    size_t n_used;
+
+    /** Hash table of parsed files (open addressing) */
+    indexed_file * files;
+
+    /** Files hash table allocation size, power of two */
+    size_t alloc_files;
+
+    /** Number of parsed files */
+    size_t n_files;
+
+    /** Files waiting to be parsed */
+    eFile ** queue;
+
+    /** Number of files in the queue */
+    unsigned int n_queue;
+
+    /** Queue allocation size */
+    unsigned int alloc_queue;
+
+    /** Protect symbols and queue */
+    pthread_mutex_t mutex;
+
+    /** Signal a new file in the queue */
+    pthread_cond_t cond;
+
+    /** Parsing thread */
+    pthread_t thread;
+
+    /** Ask the thread to stop */
+    bool stop;
+
+} eIndex;
+
+
+/**
+ * @brief The create_eIndex() function allocate an eIndex and start the
+ *        thread parsing the C/C++ files of directory.
+ *
+ * @param directory: Root eDirectory
+ *
+ * @return eIndex pointer or NULL if it was an error.
+ *
+ * @note delete_eIndex() must be called before exiting.
+ */
+eIndex * create_eIndex(eDirectory const * directory);
+
+
+/**
+ * @brief The delete_eIndex() function stop the thread, deallocate eIndex
+ *        and set the pointer to NULL.
+ *
+ * @param index: eIndex pointer pointer
+ */
+void delete_eIndex(eIndex ** index);
+
+
+/**
+ * @brief The update_file_eIndex() function ask the thread to parse the
+ *        file again. Files which are not C/C++ sources are ignored.
+ *
+ * @param index: eIndex pointer
+ * @param file: eFile pointer
+ *
+ * @return 0 on success or -1 in failure.
+ */
+int update_file_eIndex(eIndex * index,
+                       eFile * file);
+
+
+/**
+ * @brief The find_eIndex() function return the definition of a symbol.
+ *
+ * @param index: eIndex pointer
+ * @param name: Symbol name
+ * @param length: Symbol name length
+ * @param line_number: Line number of the definition returned
+ *
+ * @return eFile of the definition or NULL if the symbol is unknown.
+ */
+eFile * find_eIndex(eIndex * index,
+                    char const * name,
+                    size_t length,
+                    unsigned int * line_number);
+
+#endif
@@ -0,0 +1,190 @@
+/**
+ * @file eJournal.h
+ * @brief eJournal Header
+ * @author ALARY Dorian
+ * @version 1.0
+ * @date 21/07/2024
+ * @copyright GNU Public License.
+ *
+ */
+
+#ifndef __EJOURNAL_H__
+#define __EJOURNAL_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+struct efile_s;
+
+
+/**
+ * @enum Journal record type enumeration, one per eFile modification
+ */
+typedef enum {
+
+    j_INSERT_CHAR,
+    j_REMOVE_CHAR,
+    j_INSERT_STRING,
+    j_REMOVE_STRING,
+    j_ADD_LINE,
+    j_DELETE_LINE,
+    j_REPLACE_ALL
+
+} JOURNAL_RECORD;
+
+
+/**
+ * @struct eJournal structure to store the modifications of an eFile in a
+ *         journal next to the file, until the file is saved.
+ */
+typedef struct {
+
+    /** Path of the journal */
+    char * path;
+
+    /** Descriptor of the journal or -1 if it is not created yet */
+    int fd;
+
+    /** Records not written yet */
+    char * buffer;
+
+    /** Number of bytes in buffer */
+    size_t length;
+
+    /** Buffer allocation size */
+    size_t alloc_size;
+
+    /** Size of the journal file */
+    off_t size;
+
+    /** Size of the journal file when the last save started */
+    off_t mark;
+
+    /** Status of the file the records apply to */
+    struct stat base;
+
+} eJournal;
+
+
+/**
+ * @brief The create_eJournal() function allocate the eJournal of a file.
+ *        The journal file is created by the first flush.
+ *
+ * @param realpath: Path of the file
+ * @param base: Status of the file the records will apply to
+ *
+ * @return eJournal pointer or NULL if it was an error.
+ *
+ * @note delete_eJournal() must be called before exiting.
+ */
+eJournal * create_eJournal(char const * realpath,
+                           struct stat const * base);
+
+
+/**
+ * @brief The delete_eJournal() function flush the records, deallocate
+ *        eJournal and set the pointer to NULL.
+ *
+ * @param journal: eJournal pointer pointer
+ * @param remove: The journal file is removed, the file is saved
+ */
+void delete_eJournal(eJournal ** journal,
+                     bool remove);
+
+
+/**
+ * @brief The add_record_eJournal() function add a record to the journal.
+ *        It is only copied in memory, see flush_eJournal().
+ *
+ * @param journal: eJournal pointer
+ * @param type: Record type
+ * @param line_number: Line number of the cursor
+ * @param pos: Position of the cursor
+ * @param arg: Line number argument of j_ADD_LINE and j_DELETE_LINE,
+ *             character of j_INSERT_CHAR, length of j_REMOVE_STRING
+ * @param data: Inserted string or pattern, may be NULL
+ * @param length: Length of data
+ * @param data2: Replacement, may be NULL
+ * @param length2: Length of data2
+ *
+ * @return 0 on success or -1 in failure.
+ */
+int add_record_eJournal(eJournal * journal,
+                        JOURNAL_RECORD type,
+                        unsigned int line_number,
+                        unsigned int pos,
+                        unsigned int arg,
+                        char const * data,
+                        size_t length,
+                        char const * data2,
+                        size_t length2);
+
+
+/**
+ * @brief The flush_eJournal() function write the records in the journal
+ *        file and sync it.
+ *
+ * @param journal: eJournal pointer
+ *
+ * @return 0 on success or -1 in failure.
+ */
+int flush_eJournal(eJournal * journal);
+
+
+/**
+ * @brief The mark_eJournal() function remember the records written before
+ *        a save starts.
+ *
+ * @param journal: eJournal pointer
+ */
+void mark_eJournal(eJournal * journal);
+
+
+/**
+ * @brief The rebase_eJournal() function remove the records written before
+ *        the last mark_eJournal(), after the save succeeded. The remaining
+ *        records apply to the saved file.
+ *
+ * @param journal: eJournal pointer
+ * @param base: Status of the saved file
+ *
+ * @return 0 on success or -1 in failure.
+ */
+int rebase_eJournal(eJournal * journal,
+                    struct stat const * base);
+
+
+/**
+ * @brief The exists_eJournal() function return true if a file has a
+ *        journal, left by an edito which did not save it.
+ *
+ * @param realpath: Path of the file
+ *
+ * @return true if the journal exists, false otherwise.
+ */
+bool exists_eJournal(char const * realpath);
+
+
+/**
+ * @brief The remove_eJournal() function remove the journal of a file.
+ *
+ * @param realpath: Path of the file
+ */
+void remove_eJournal(char const * realpath);
+
+
+/**
+ * @brief The replay_eJournal() function apply the records of the journal
+ *        left for a file on the opened eFile. The records are journaled
+ *        again by the eFile.
+ *
+ * @param file: Opened eFile pointer
+ *
+ * @return Number of replayed records or -1 if the journal can not be read
+ *         or does not apply to the file.
+ */
+long replay_eJournal(struct efile_s * file);
+
+#endif
@@ -13,6 +13,7 @@
 #define __ELINE_H__
 
 #include <stddef.h> /* size_t */
+#include <sys/types.h> /* off_t */
 
 
 /**
@@ -39,6 +40,10 @@ typedef struct eLine
     /** Characters of the line, including \n character */
     char *string;
 
+    /** Offset of the line and its \n in the opened file, -1 if the line
+        was modified or is not in the file */
+    off_t file_offset;
+
 } eLine;
 
 
@@ -131,6 +136,26 @@ int remove_char_eLine(eLine * eline,
                       unsigned int pos);
 
 
+/**
+ * @brief The replace_all_eLine() function replace every occurrence of
+ *        pattern in the line by replacement. The line is reallocated at
+ *        most once.
+ *
+ * @param eline: eLine
+ * @param pattern: String to replace
+ * @param pattern_length: Length of pattern
+ * @param replacement: String replacing pattern
+ * @param replacement_length: Length of replacement
+ *
+ * @return Number of replaced occurrences or -1 in failure.
+ */
+long replace_all_eLine(eLine * eline,
+                       char const * pattern,
+                       size_t pattern_length,
+                       char const * replacement,
+                       size_t replacement_length);
+
+
 /**
  * @brief The get_string_eLine() function get a string in the line at position
  *        pos and return how many character actually got.
@@ -0,0 +1,232 @@
+/**
+ * @file eLoad.h
+ * @brief eLoad Header
+ * @author ALARY Dorian
+ * @version 1.0
+ * @date 21/07/2024
+ * @copyright GNU Public License.
+ *
+ */
+
+#ifndef __ELOAD_H__
+#define __ELOAD_H__
+
+#include "eLine.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include <pthread.h>
+
+
+#define SNIFF_LENGTH (64*1024) /* Bytes read to tell if a file is binary */
+
+struct efile_s;
+
+
+/**
+ * @struct eLoad structure to read the lines of a file, synchronously or
+ *        with a background thread handing them by blocks.
+ */
+typedef struct {
+
+    /** Loaded file, only used by the caller */
+    struct efile_s * file;
+
+    /** Descriptor of the file */
+    int fd;
+
+    /** Size of the file when it was opened */
+    off_t size;
+
+    /** Reading thread */
+    pthread_t thread;
+
+    /** The thread was started */
+    bool started;
+
+    /** Protect the following attributes */
+    pthread_mutex_t mutex;
+
+    /** Signaled when lines are read or the load is finished */
+    pthread_cond_t cond;
+
+    /** First line read and not taken yet */
+    eLine * first_line;
+
+    /** Last line read and not taken yet */
+    eLine * last_line;
+
+    /** Number of lines read and not taken yet */
+    unsigned int n_lines;
+
+    /** Number of bytes read */
+    off_t read_size;
+
+    /** Hash of the bytes read, see hash_bytes() */
+    uint64_t hash;
+
+    /** The load must stop */
+    bool cancel;
+
+    /** Every line was read */
+    bool finished;
+
+    /** Result of the load, 0 on success or -1 in failure */
+    int result;
+
+} eLoad;
+
+
+/**
+ * @brief The create_eLoad() function allocate an eLoad reading the file
+ *        opened by begin_open_eFile().
+ *
+ * @param file: eFile pointer
+ *
+ * @return eLoad pointer or NULL if it was an error.
+ *
+ * @note delete_eLoad() must be called before exiting.
+ */
+eLoad * create_eLoad(struct efile_s * file);
+
+
+/**
+ * @brief The delete_eLoad() function cancel the load, wait for the thread,
+ *        deallocate eLoad and the lines not taken, and set the pointer to
+ *        NULL.
+ *
+ * @param load: eLoad pointer pointer
+ */
+void delete_eLoad(eLoad ** load);
+
+
+/**
+ * @brief The start_eLoad() function start a thread reading the file.
+ *
+ * @param load: eLoad pointer
+ *
+ * @return 0 on success or -1 in failure.
+ */
+int start_eLoad(eLoad * load);
+
+
+/**
+ * @brief The read_eLoad() function read every line of the file. The lines
+ *        are handed by blocks, see take_lines_eLoad().
+ *
+ * @param load: eLoad pointer
+ *
+ * @return 0 on success or -1 in failure.
+ */
+int read_eLoad(eLoad * load);
+
+
+/**
+ * @brief The cancel_eLoad() function ask the thread to stop reading.
+ *
+ * @param load: eLoad pointer
+ */
+void cancel_eLoad(eLoad * load);
+
+
+/**
+ * @brief The wait_lines_eLoad() function wait until lines are read or the
+ *        load is finished.
+ *
+ * @param load: eLoad pointer
+ */
+void wait_lines_eLoad(eLoad * load);
+
+
+/**
+ * @brief The take_lines_eLoad() function take the lines read since the
+ *        last call. They are linked together, line numbers are not set.
+ *
+ * @param load: eLoad pointer
+ * @param first_line: First line or NULL
+ * @param last_line: Last line or NULL
+ *
+ * @return Number of taken lines.
+ */
+unsigned int take_lines_eLoad(eLoad * load,
+                              eLine ** first_line,
+                              eLine ** last_line);
+
+
+/**
+ * @brief The is_finished_eLoad() function return true if every line was
+ *        read, the result is then in the result attribute.
+ *
+ * @param load: eLoad pointer
+ *
+ * @return true if the load is finished, false otherwise.
+ */
+bool is_finished_eLoad(eLoad * load);
+
+
+/**
+ * @brief The prefetch_eLoad() function ask the kernel to read the
+ *        beginning of a file in the page cache, without waiting for it.
+ *
+ * @param realpath: Path of the file
+ * @param length: Number of bytes to read, 0 for the whole file
+ *
+ * @return 0 on success or -1 in failure.
+ */
+int prefetch_eLoad(char const * realpath,
+                   off_t length);
+
+
+/**
+ * @brief The is_binary_eLoad() function read the first block of a file
+ *        and tell if it is binary: it contains a 0 or is not valid UTF-8.
+ *
+ * @param fd: Descriptor of the file
+ *
+ * @return true if the file is binary, false otherwise or if it can not be
+ *         read.
+ */
+bool is_binary_eLoad(int fd);
+
+
+/**
+ * @brief The get_decompressor_eLoad() function read the magic bytes of a
+ *        file and return the program decompressing it.
+ *
+ * @param fd: Descriptor of the file
+ *
+ * @return Name of the program, ex "gzip", or NULL if the file is not
+ *         compressed.
+ */
+char const * get_decompressor_eLoad(int fd);
+
+
+/**
+ * @brief The decompress_eLoad() function start a program decompressing a
+ *        file to a pipe.
+ *
+ * @param fd: Descriptor of the file, read from its start
+ * @param program: Program decompressing the file, called with -dc
+ * @param pid: Process of the program
+ *
+ * @return Descriptor of the pipe to read, or -1 if it was an error.
+ *
+ * @note The process must be waited for.
+ */
+int decompress_eLoad(int fd,
+                     char const * program,
+                     pid_t * pid);
+
+
+/**
+ * @brief The get_progress_eLoad() function return the percentage of the
+ *        file already read.
+ *
+ * @param load: eLoad pointer
+ *
+ * @return Percentage between 0 and 100.
+ */
+unsigned int get_progress_eLoad(eLoad * load);
+
+#endif
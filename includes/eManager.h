@@ -15,6 +15,13 @@
 #include "eScreen.h"
 #include "eBar.h"
 #include "eDirectory.h"
+#include "eFinder.h"
+#include "eIndex.h"
+#include "eSave.h"
+#include "eLoad.h"
+#include "eWatch.h"
+
+#include <time.h>
 
 /**
  * @enum Program mode enumeration
@@ -43,6 +50,63 @@ typedef struct {
     /** Directory */
     eDirectory * directory;
 
+    /** File finder, built on first use */
+    eFinder * finder;
+
+    /** Symbol index */
+    eIndex * index;
+
+    /** Saves written in background */
+    eSave ** saves;
+
+    /** Number of saves written in background */
+    unsigned int n_saves;
+
+    /** Files read in background */
+    eLoad ** loads;
+
+    /** Number of files read in background */
+    unsigned int n_loads;
+
+    /** fsync policy of the saves */
+    FSYNC_POLICY fsync_policy;
+
+    /** Time of the last flush of the journals */
+    struct timespec journal_flush;
+
+    /** Memory cap of the undo history of a file (bytes) */
+    size_t undo_limit;
+
+    /** File under the cursor of the directory */
+    eFile * dwell_file;
+
+    /** Time the cursor of the directory reached dwell_file */
+    struct timespec dwell_time;
+
+    /** dwell_file was prefetched, or can not be */
+    bool dwell_done;
+
+    /** Lines of dwell_file read before it is opened */
+    eLoad * prefetch;
+
+    /** Size (bytes) from which a file is viewed, see eView */
+    off_t view_threshold;
+
+    /** Memory cap (bytes) of the modified pages of a viewed file */
+    size_t view_budget;
+
+    /** Time (seconds) an unused file is kept unpacked */
+    time_t pack_delay;
+
+    /** Memory cap (bytes) of the unpacked lines of the bar files */
+    size_t pack_budget;
+
+    /** The open files are kept for the next run */
+    bool session;
+
+    /** Watch of the directories of the open files or NULL */
+    eWatch * watch;
+
     /** Current mode */
     MODE mode;
 
@@ -107,7 +171,98 @@ void set_eDirectory_eManager(eManager * manager,
 
 
 /**
- * @brief The set_eFile_eManager() function set an eFile to eManager.
+ * @brief The set_eIndex_eManager() function set an eIndex to eManager.
+ *
+ * @param manager: eManager pointer
+ * @param index: eIndex pointer
+ */
+void set_eIndex_eManager(eManager * manager,
+                         eIndex * index);
+
+
+/**
+ * @brief The set_fsync_policy_eManager() function set the fsync policy of
+ *        the saves.
+ *
+ * @param manager: eManager pointer
+ * @param policy: fsync policy
+ */
+void set_fsync_policy_eManager(eManager * manager,
+                               FSYNC_POLICY policy);
+
+
+/**
+ * @brief The set_undo_limit_eManager() function set the memory cap of the
+ *        undo history of the files.
+ *
+ * @param manager: eManager pointer
+ * @param limit: Memory cap (bytes)
+ */
+void set_undo_limit_eManager(eManager * manager,
+                             size_t limit);
+
+
+/**
+ * @brief The set_view_threshold_eManager() function set the size from which
+ *        a file is shown by a paged view instead of being read.
+ *
+ * @param manager: eManager pointer
+ * @param threshold: Size of the file (bytes)
+ */
+void set_view_threshold_eManager(eManager * manager,
+                                 off_t threshold);
+
+
+/**
+ * @brief The set_view_budget_eManager() function set the memory cap of the
+ *        modified pages of each viewed file, the other ones are spilled in
+ *        a swap file.
+ *
+ * @param manager: eManager pointer
+ * @param budget: Memory cap (bytes)
+ */
+void set_view_budget_eManager(eManager * manager,
+                              size_t budget);
+
+
+/**
+ * @brief The set_pack_delay_eManager() function set the time after which
+ *        a file of the bar which is not shown is packed.
+ *
+ * @param manager: eManager pointer
+ * @param delay: Time (seconds)
+ */
+void set_pack_delay_eManager(eManager * manager,
+                             time_t delay);
+
+
+/**
+ * @brief The set_pack_budget_eManager() function set the memory cap of the
+ *        lines of the bar files, the least recently shown ones are packed
+ *        beyond it.
+ *
+ * @param manager: eManager pointer
+ * @param budget: Memory cap (bytes)
+ */
+void set_pack_budget_eManager(eManager * manager,
+                              size_t budget);
+
+
+/**
+ * @brief The set_session_eManager() function set if the open files and
+ *        directories are kept in the directory for the next run.
+ *
+ * @param manager: eManager pointer
+ * @param session: true to keep the session
+ */
+void set_session_eManager(eManager * manager,
+                          bool session);
+
+
+/**
+ * @brief The set_eFile_eManager() function set an eFile to eManager. A
+ *        packed file is unpacked first, the current file stays if it can
+ *        not be.
  *
  * @param manager: eManager pointer
  * @param file: eFile pointer
@@ -116,6 +271,42 @@ void set_eFile_eManager(eManager * manager,
                         eFile * file);
 
 
+/**
+ * @brief The recover_journals_eManager() function look for the journals
+ *        left in the directory by an edito which did not exit, and ask the
+ *        user to replay them on their files.
+ *
+ * @param manager: eManager pointer
+ */
+void recover_journals_eManager(eManager * manager);
+
+
+/**
+ * @brief The restore_session_eManager() function open again the files and
+ *        directories of the last edito which exited in the directory. Only
+ *        the current file is read, the others are read when they are shown.
+ *
+ * @param manager: eManager pointer
+ */
+void restore_session_eManager(eManager * manager);
+
+
+/**
+ * @brief The open_stream_eManager() function open a buffer filled with the
+ *        bytes written in a pipe, like the output of a command piped to
+ *        edito. The pipe is read between two inputs until its end.
+ *
+ * @param manager: eManager pointer
+ * @param file: eFile pointer of the buffer, not opened
+ * @param fd: Descriptor of the pipe
+ *
+ * @return 0 on success or -1 in failure.
+ */
+int open_stream_eManager(eManager * manager,
+                         eFile * file,
+                         int fd);
+
+
 /**
  * @brief The run_eManager() function is the main function of eManager,
  *        this function call screen to get an input and process the input.
@@ -14,7 +14,7 @@
 #include <ncurses.h>
 #include <menu.h>
 
-#define MENU_NUMBER 2
+#define MENU_NUMBER 1
 
 
 /**
@@ -22,8 +22,7 @@
  */
 typedef enum {
 
-    MDIR=0,
-    MBAR
+    MDIR=0
 
 } MENU_TYPE;
 
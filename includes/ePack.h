@@ -0,0 +1,155 @@
+/**
+ * @file ePack.h
+ * @brief ePack Header
+ * @author ALARY Dorian
+ * @version 1.0
+ * @date 21/07/2024
+ * @copyright GNU Public License.
+ *
+ */
+
+#ifndef __EPACK_H__
+#define __EPACK_H__
+
+#include "eLine.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <sys/types.h>
+
+
+#define PACK_BLOCK_LENGTH (256*1024) /* Bytes of lines compressed together */
+#define PACK_DEFAULT_DELAY 600 /* Seconds a file is left unused before it is
+                                  packed */
+#define PACK_DEFAULT_BUDGET (512*1024*1024) /* Bytes of lines kept unpacked
+                                               at most */
+
+
+/**
+ * @struct pack_block structure to keep the lines of a block compressed.
+ */
+typedef struct {
+
+    /** Compressed bytes */
+    unsigned char * data;
+
+    /** Number of compressed bytes */
+    size_t size;
+
+    /** Number of bytes once inflated */
+    size_t length;
+
+} pack_block;
+
+
+/**
+ * @struct ePack structure to keep the lines of an unused file compressed
+ *         in memory. The lines are written one after the other with their
+ *         offset in the file, and compressed by blocks of about
+ *         PACK_BLOCK_LENGTH bytes. A dropped file keeps only its cursor, as
+ *         does a file of a previous session which was not opened yet.
+ */
+typedef struct {
+
+    /** Compressed blocks */
+    pack_block * blocks;
+
+    /** Number of blocks */
+    unsigned int n_blocks;
+
+    /** Blocks allocation size */
+    unsigned int alloc_blocks;
+
+    /** Number of lines */
+    unsigned int n_lines;
+
+    /** Bytes of the block being written or NULL */
+    unsigned char * buffer;
+
+    /** Number of bytes of the block being written */
+    size_t length;
+
+    /** Buffer allocation size */
+    size_t alloc_length;
+
+    /** Offset following the previous line in the file */
+    off_t next_offset;
+
+    /** Number of compressed bytes of every block */
+    size_t size;
+
+    /** Line number of the current line */
+    unsigned int current_line;
+
+    /** Current pos in current line */
+    unsigned int current_pos;
+
+    /** Line number of the first line of screen */
+    unsigned int first_screen_line;
+
+    /** The lines were dropped, they are read again from the file */
+    bool dropped;
+
+    /** The file was not opened yet, the cursor is put back once it is */
+    bool restored;
+
+} ePack;
+
+
+/**
+ * @brief The create_ePack() function allocate an empty ePack.
+ *
+ * @return ePack pointer or NULL if it was an error.
+ *
+ * @note delete_ePack() must be called before exiting.
+ */
+ePack * create_ePack(void);
+
+
+/**
+ * @brief The delete_ePack() function deallocate ePack and set the pointer
+ *        to NULL.
+ *
+ * @param pack: ePack pointer pointer
+ */
+void delete_ePack(ePack ** pack);
+
+
+/**
+ * @brief The add_line_ePack() function write a line after the previous
+ *        ones, the block is compressed when it is full.
+ *
+ * @param pack: ePack pointer
+ * @param line: Line written
+ *
+ * @return 0 on success or -1 in failure.
+ */
+int add_line_ePack(ePack * pack,
+                   eLine const * line);
+
+
+/**
+ * @brief The end_ePack() function compress the last block, no line can be
+ *        added afterwards.
+ *
+ * @param pack: ePack pointer
+ *
+ * @return 0 on success or -1 in failure.
+ */
+int end_ePack(ePack * pack);
+
+
+/**
+ * @brief The unpack_ePack() function inflate every block and create the
+ *        lines again, linked together.
+ *
+ * @param pack: ePack pointer
+ * @param first_line: First line or NULL
+ * @param last_line: Last line or NULL
+ *
+ * @return 0 on success or -1 in failure, no line is created then.
+ */
+int unpack_ePack(ePack const * pack,
+                 eLine ** first_line,
+                 eLine ** last_line);
+
+#endif
@@ -0,0 +1,154 @@
+/**
+ * @file eReplace.h
+ * @brief eReplace Header
+ * @author ALARY Dorian
+ * @version 1.0
+ * @date 21/07/2024
+ * @copyright GNU Public License.
+ *
+ */
+
+#ifndef __EREPLACE_H__
+#define __EREPLACE_H__
+
+#include "eDirectory.h"
+#include "eBar.h"
+#include "eFile.h"
+#include "eSave.h"
+
+#include <stdbool.h>
+#include <pthread.h>
+
+#define REPLACE_MAX_THREADS 8 /* Maximum number of worker threads */
+
+
+/**
+ * @struct eReplace structure to replace a string in every file of a
+ *         directory with worker threads.
+ */
+typedef struct {
+
+    /** Files to process */
+    eFile ** files;
+
+    /** true for each file which was rewritten */
+    bool * changed;
+
+    /** Number of files */
+    unsigned int n_files;
+
+    /** Index of the next file to process */
+    unsigned int next;
+
+    /** Number of processed files */
+    unsigned int n_done;
+
+    /** Number of rewritten files */
+    unsigned int n_changed;
+
+    /** Number of files which could not be processed */
+    unsigned int n_errors;
+
+    /** Last processed file */
+    eFile const * last_file;
+
+    /** String to replace */
+    char * pattern;
+
+    /** Length of pattern */
+    size_t pattern_length;
+
+    /** String replacing pattern */
+    char * replacement;
+
+    /** Length of replacement */
+    size_t replacement_length;
+
+    /** fsync policy of the rewritten files */
+    FSYNC_POLICY policy;
+
+    /** Worker threads */
+    pthread_t threads[REPLACE_MAX_THREADS];
+
+    /** Number of started threads */
+    unsigned int n_threads;
+
+    /** Number of threads still running */
+    unsigned int n_running;
+
+    /** Protect counters */
+    pthread_mutex_t mutex;
+
+    /** Ask the workers to stop */
+    bool cancel;
+
+} eReplace;
+
+
+/**
+ * @brief The create_eReplace() function allocate an eReplace with every
+ *        file of directory which is not open in the bar. A dropped file
+ *        of the bar is read again from disk when it is shown, so it is
+ *        rewritten too. A file reached by several symbolic links is
+ *        processed once, each name of a hard link is rewritten.
+ *
+ * @param directory: Root eDirectory
+ * @param bar: eBar of the open files, processed in memory by the caller
+ * @param pattern: String to replace
+ * @param replacement: String replacing pattern
+ * @param policy: fsync policy, as for the saves
+ *
+ * @return eReplace pointer or NULL if it was an error.
+ *
+ * @note delete_eReplace() must be called before exiting.
+ */
+eReplace * create_eReplace(eDirectory const * directory,
+                           eBar const * bar,
+                           char const * pattern,
+                           char const * replacement,
+                           FSYNC_POLICY policy);
+
+
+/**
+ * @brief The delete_eReplace() function wait for the workers, deallocate
+ *        eReplace and set the pointer to NULL.
+ *
+ * @param replace: eReplace pointer pointer
+ */
+void delete_eReplace(eReplace ** replace);
+
+
+/**
+ * @brief The start_eReplace() function start the worker threads.
+ *
+ * @param replace: eReplace pointer
+ *
+ * @return 0 on success or -1 in failure.
+ */
+int start_eReplace(eReplace * replace);
+
+
+/**
+ * @brief The cancel_eReplace() function ask the workers to stop. Files
+ *        being processed are left unchanged.
+ *
+ * @param replace: eReplace pointer
+ */
+void cancel_eReplace(eReplace * replace);
+
+
+/**
+ * @brief The get_progress_eReplace() function return the progress of the
+ *        replacement.
+ *
+ * @param replace: eReplace pointer
+ * @param n_done: Number of processed files returned
+ * @param last_file: Last processed file returned, may be NULL
+ *
+ * @return true if every worker has finished, false otherwise.
+ */
+bool get_progress_eReplace(eReplace * replace,
+                           unsigned int * n_done,
+                           eFile const ** last_file);
+
+#endif
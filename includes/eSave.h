@@ -0,0 +1,197 @@
+/**
+ * @file eSave.h
+ * @brief eSave Header
+ * @author ALARY Dorian
+ * @version 1.0
+ * @date 21/07/2024
+ * @copyright GNU Public License.
+ *
+ */
+
+#ifndef __ESAVE_H__
+#define __ESAVE_H__
+
+#include "eFile.h"
+
+#include <stdbool.h>
+#include <sys/types.h>
+#include <pthread.h>
+
+
+/**
+ * @enum fsync policy enumeration
+ */
+typedef enum {
+
+    f_NONE, /* The kernel writes the file when it wants */
+    f_FILE, /* The file is synced before the rename */
+    f_FULL  /* The file and its directory are synced */
+
+} FSYNC_POLICY;
+
+
+/**
+ * @struct save_segment structure to describe a part of the snapshot.
+ */
+typedef struct {
+
+    /** Bytes in memory, or NULL for a range of the opened file */
+    char * data;
+
+    /** The range is in the swap file of the view instead */
+    bool swap;
+
+    /** Offset of the range in the opened file */
+    off_t offset;
+
+    /** Number of bytes */
+    size_t length;
+
+} save_segment;
+
+
+/**
+ * @struct eSave structure to write a snapshot of an eFile on the disk,
+ *         synchronously or with a background thread.
+ */
+typedef struct {
+
+    /** Saved file, only used by the caller */
+    eFile * file;
+
+    /** Path of the file */
+    char * realpath;
+
+    /** Snapshot of the file, modified lines in memory and unchanged lines
+        as ranges of the opened file */
+    save_segment * segments;
+
+    /** Number of segments */
+    unsigned int n_segments;
+
+    /** Segments allocation size */
+    unsigned int alloc_segments;
+
+    /** Memory of the modified lines */
+    char ** chunks;
+
+    /** Number of chunks */
+    unsigned int n_chunks;
+
+    /** Bytes used in the last chunk */
+    size_t chunk_length;
+
+    /** Size of the last chunk */
+    size_t chunk_size;
+
+    /** Descriptor of the opened file or -1 */
+    int source_fd;
+
+    /** Descriptor of the swap file of the view or -1 */
+    int swap_fd;
+
+    /** Mode of the file */
+    mode_t mode;
+
+    /** fsync policy */
+    FSYNC_POLICY policy;
+
+    /** Writing thread */
+    pthread_t thread;
+
+    /** The thread was started */
+    bool started;
+
+    /** Protect finished */
+    pthread_mutex_t mutex;
+
+    /** The file was written */
+    bool finished;
+
+    /** Result of the save, 0 on success or -1 in failure */
+    int result;
+
+} eSave;
+
+
+/**
+ * @brief The create_eSave() function allocate an eSave and take a
+ *        snapshot of the lines of file. The file can be modified as soon as
+ *        the function returns.
+ *
+ * @param file: eFile pointer
+ * @param policy: fsync policy
+ *
+ * @return eSave pointer or NULL if it was an error.
+ *
+ * @note delete_eSave() must be called before exiting. The swap file of a
+ *       view is held, release_swap_eView() must be called once the save
+ *       is finished.
+ */
+eSave * create_eSave(eFile * file,
+                     FSYNC_POLICY policy);
+
+
+/**
+ * @brief The delete_eSave() function wait for the thread, deallocate eSave
+ *        and set the pointer to NULL.
+ *
+ * @param save: eSave pointer pointer
+ */
+void delete_eSave(eSave ** save);
+
+
+/**
+ * @brief The start_eSave() function start a thread writing the snapshot.
+ *
+ * @param save: eSave pointer
+ *
+ * @return 0 on success or -1 in failure.
+ */
+int start_eSave(eSave * save);
+
+
+/**
+ * @brief The write_eSave() function write the snapshot in a temporary file
+ *        of the same directory and rename it over the file, so that the
+ *        file is never half written.
+ *
+ * @param save: eSave pointer
+ *
+ * @return 0 on success or -1 in failure.
+ */
+int write_eSave(eSave * save);
+
+
+/**
+ * @brief The is_finished_eSave() function return true if the snapshot was
+ *        written, the result is then in the result attribute.
+ *
+ * @param save: eSave pointer
+ *
+ * @return true if the save is finished, false otherwise.
+ */
+bool is_finished_eSave(eSave * save);
+
+
+/**
+ * @brief The wait_eSave() function wait until the snapshot is written.
+ *
+ * @param save: eSave pointer
+ *
+ * @return 0 if the file was saved or -1 in failure.
+ */
+int wait_eSave(eSave * save);
+
+
+/**
+ * @brief The sync_directory_eSave() function sync the directory of a file,
+ *        so that a rename in it is durable.
+ *
+ * @param path: Path of the file
+ *
+ * @return 0 on success or -1 in failure.
+ */
+int sync_directory_eSave(char const * path);
+
+#endif
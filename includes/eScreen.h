@@ -14,6 +14,7 @@
 #include "eLine.h"
 #include "eWindow.h"
 #include "eMenu.h"
+#include "eTabs.h"
 
 
 typedef struct {
@@ -30,6 +31,9 @@ typedef struct {
     /** Array of every menu */
     eMenu * menus[MENU_NUMBER];
 
+    /** Tabs of the bar */
+    eTabs * tabs;
+
 } eScreen;
 
 
@@ -66,7 +70,8 @@ void update_directory_eScreen(eScreen * screen);
 
 
 /*
- * @brief The update_bar_eScreen() function refresh the bar window.
+ * @brief The update_bar_eScreen() function print the tabs and refresh the
+ *        bar window.
  *
  * @param screen: eScreen pointer
  */
@@ -154,6 +159,22 @@ int get_input_eScreen(eScreen * screen,
                       WINDOW_TYPE type);
 
 
+/**
+ * @brief The set_input_timeout_eScreen() function set how long
+ *        get_input_eScreen() waits for an input on the window designed by
+ *        type.
+ *
+ * @param screen: eScreen pointer
+ * @param type: Window type
+ * @param delay: Delay in milliseconds, negative to wait forever
+ *
+ * @note get_input_eScreen() returns ERR when the delay expires.
+ */
+void set_input_timeout_eScreen(eScreen * screen,
+                               WINDOW_TYPE type,
+                               int delay);
+
+
 /**
  * @brief The create_file_window_eScreen() function allocate and initialize
  *        file windows.
@@ -191,6 +212,42 @@ void print_line_eScreen(eScreen *screen,
                         char const * line);
 
 
+/**
+ * @brief The print_string_eScreen() print the first bytes of a string,
+ *        which may not be terminated by 0, on the screen.
+ *
+ * @param screen: eScreen pointer
+ * @param type: Window type
+ * @param y: y position of the string
+ * @param x: x position of the string
+ * @param string: string to print
+ * @param length: number of bytes to print
+ */
+void print_string_eScreen(eScreen *screen,
+                          WINDOW_TYPE type,
+                          int y,
+                          int x,
+                          char const * string,
+                          size_t length);
+
+
+/**
+ * @brief The print_selected_line_eScreen() print a highlighted line on the
+ *        screen.
+ *
+ * @param screen: eScreen pointer
+ * @param type: Window type
+ * @param y: y position of the line
+ * @param x: x position of the line
+ * @param line: line to print
+ */
+void print_selected_line_eScreen(eScreen *screen,
+                                 WINDOW_TYPE type,
+                                 int y,
+                                 int x,
+                                 char const * line);
+
+
 /**
  * @brief The erase_window_eScreen() function erase the window designed by type.
  *
@@ -214,6 +271,36 @@ void print_help_eScreen(eScreen * screen,
                         char const * const * string_array);
 
 
+/**
+ * @brief The create_popup_eScreen() function allocate the popup window in
+ *        the middle of the file box.
+ *
+ * @param screen: eScreen pointer
+ *
+ * @return 0 on success or -1 in failure.
+ *
+ * @note delete_popup_eScreen() must be called to close the popup.
+ */
+int create_popup_eScreen(eScreen * screen);
+
+
+/**
+ * @brief The delete_popup_eScreen() function deallocate the popup window
+ *        and redraw the windows under it.
+ *
+ * @param screen: eScreen pointer
+ */
+void delete_popup_eScreen(eScreen * screen);
+
+
+/**
+ * @brief The update_popup_eScreen() function refresh the popup window.
+ *
+ * @param screen: eScreen pointer
+ */
+void update_popup_eScreen(eScreen * screen);
+
+
 /* ============================================================================
  * eMenu functions
  * ========================================================================= */
@@ -326,4 +413,70 @@ int get_current_item_index_menu_eScreen(eScreen const * screen,
                                         MENU_TYPE type);
 
 
+/* ============================================================================
+ * eTabs functions
+ * ========================================================================= */
+
+/**
+ * @brief The add_tab_eScreen() function add a tab after the last one.
+ *
+ * @param screen: eScreen pointer
+ * @param title: Tab title
+ *
+ * @return 0 in success or -1 in failure.
+ */
+int add_tab_eScreen(eScreen * screen,
+                    char const * title);
+
+
+/**
+ * @brief The remove_tab_eScreen() function remove a tab.
+ *
+ * @param screen: eScreen pointer
+ * @param index: Index of the tab
+ *
+ * @return 0 in success or -1 in failure.
+ */
+int remove_tab_eScreen(eScreen * screen,
+                       int index);
+
+
+/**
+ * @brief The set_current_tab_eScreen() function set the current tab.
+ *
+ * @param screen: eScreen pointer
+ * @param index: Index of the tab
+ */
+void set_current_tab_eScreen(eScreen * screen,
+                             int index);
+
+
+/**
+ * @brief The get_current_tab_eScreen() function return the index of the
+ *        current tab.
+ *
+ * @param screen: eScreen pointer
+ *
+ * @return Index of the current tab or -1 if there is no tab.
+ */
+int get_current_tab_eScreen(eScreen const * screen);
+
+
+/**
+ * @brief The move_next_tab_eScreen() function move to the next tab.
+ *
+ * @param screen: eScreen pointer
+ */
+void move_next_tab_eScreen(eScreen * screen);
+
+
+/**
+ * @brief The move_previous_tab_eScreen() function move to the previous
+ *        tab.
+ *
+ * @param screen: eScreen pointer
+ */
+void move_previous_tab_eScreen(eScreen * screen);
+
+
 #endif
@@ -0,0 +1,159 @@
+/**
+ * @file eSession.h
+ * @brief eSession Header
+ * @author ALARY Dorian
+ * @version 1.0
+ * @date 21/07/2024
+ * @copyright GNU Public License.
+ *
+ */
+
+#ifndef __ESESSION_H__
+#define __ESESSION_H__
+
+#include <stdbool.h>
+
+
+/**
+ * @struct session_file structure to keep an open file and its cursor.
+ */
+typedef struct {
+
+    /** Path of the file, from the directory of the session */
+    char * path;
+
+    /** Line number of the current line */
+    unsigned int current_line;
+
+    /** Current pos in current line */
+    unsigned int current_pos;
+
+    /** Line number of the first line of screen */
+    unsigned int first_screen_line;
+
+} session_file;
+
+
+/**
+ * @struct eSession structure to keep the state of edito in a directory
+ *         between two runs: the open files with their cursor, the open
+ *         directories and the mode. It is written when edito exits in
+ *         the state directory of the user, out of the tree of the
+ *         directory, in a file named after the absolute path of the
+ *         directory.
+ */
+typedef struct {
+
+    /** Path of the session file */
+    char * path;
+
+    /** Absolute path of the directory */
+    char * root;
+
+    /** Open files, in the order of the bar */
+    session_file * files;
+
+    /** Number of files */
+    unsigned int n_files;
+
+    /** Files allocation size */
+    unsigned int alloc_files;
+
+    /** Open directories, from the directory of the session */
+    char ** directories;
+
+    /** Number of directories */
+    unsigned int n_directories;
+
+    /** Directories allocation size */
+    unsigned int alloc_directories;
+
+    /** Index of the current file or -1 */
+    int current;
+
+    /** Mode of edito */
+    int mode;
+
+} eSession;
+
+
+/**
+ * @brief The create_eSession() function allocate an empty eSession of a
+ *        directory. Its file is in $XDG_STATE_HOME/edito, or in
+ *        $HOME/.local/state/edito, named after the directory and the hash
+ *        of its absolute path.
+ *
+ * @param directory: Path of the directory, "" for the root
+ *
+ * @return eSession pointer or NULL if it was an error or if the user has
+ *         no state directory.
+ *
+ * @note delete_eSession() must be called before exiting.
+ */
+eSession * create_eSession(char const * directory);
+
+
+/**
+ * @brief The delete_eSession() function deallocate eSession and set the
+ *        pointer to NULL.
+ *
+ * @param session: eSession pointer pointer
+ */
+void delete_eSession(eSession ** session);
+
+
+/**
+ * @brief The add_file_eSession() function add an open file after the
+ *        previous ones.
+ *
+ * @param session: eSession pointer
+ * @param path: Path of the file, from the directory of the session
+ * @param current_line: Line number of the current line
+ * @param current_pos: Current pos in current line
+ * @param first_screen_line: Line number of the first line of screen
+ *
+ * @return 0 on success or -1 in failure.
+ */
+int add_file_eSession(eSession * session,
+                      char const * path,
+                      unsigned int current_line,
+                      unsigned int current_pos,
+                      unsigned int first_screen_line);
+
+
+/**
+ * @brief The add_directory_eSession() function add an open directory.
+ *
+ * @param session: eSession pointer
+ * @param path: Path of the directory, from the directory of the session
+ *
+ * @return 0 on success or -1 in failure.
+ */
+int add_directory_eSession(eSession * session,
+                           char const * path);
+
+
+/**
+ * @brief The write_eSession() function write the session in its file,
+ *        creating the state directory. The session is written in a
+ *        temporary file renamed over it.
+ *
+ * @param session: eSession pointer
+ *
+ * @return 0 on success or -1 in failure.
+ */
+int write_eSession(eSession * session);
+
+
+/**
+ * @brief The read_eSession() function read the session written by the
+ *        last edito which exited in the directory.
+ *
+ * @param session: eSession pointer, empty
+ *
+ * @return 0 on success or -1 if there is no session, it can not be read
+ *         or it is the session of another directory.
+ */
+int read_eSession(eSession * session);
+
+#endif
@@ -0,0 +1,142 @@
+/**
+ * @file eTabs.h
+ * @brief eTabs Header
+ * @author ALARY Dorian
+ * @version 1.0
+ * @date 21/07/2024
+ * @copyright GNU Public License.
+ *
+ */
+
+#ifndef __ETABS_H__
+#define __ETABS_H__
+
+#include <ncurses.h>
+
+#define TABS_MARGIN 2 /* Columns kept on each side for the scroll marks */
+
+
+/**
+ * @struct eTabs structure to show the titles of the open files on one row.
+ *         Only the tabs which fit in the window are printed, the row
+ *         scrolls to show the current tab.
+ */
+typedef struct {
+
+    /** Tabs window */
+    WINDOW * win;
+
+    /** Tabs titles */
+    char ** titles;
+
+    /** Number of tabs, int because the indexes of the menus are int */
+    int n_tabs;
+
+    /** Titles allocation size */
+    int alloc_size;
+
+    /** Current tab, -1 if there is no tab */
+    int current;
+
+    /** First tab printed */
+    int first;
+
+} eTabs;
+
+
+/**
+ * @brief The create_eTabs() function allocate and initialize an eTabs
+ *        structure.
+ *
+ * @param win: Tabs window
+ *
+ * @return eTabs pointer or NULL if it was an error.
+ *
+ * @note delete_eTabs() must be called before exiting.
+ */
+eTabs * create_eTabs(WINDOW * win);
+
+
+/**
+ * @brief The delete_eTabs() function deallocate the eTabs structure and
+ *        set the pointer to the structure to NULL.
+ *
+ * @param tabs: eTabs pointer pointer
+ */
+void delete_eTabs(eTabs ** tabs);
+
+
+/**
+ * @brief The add_tab_eTabs() function add a tab after the last one, the
+ *        other tabs are kept as they are.
+ *
+ * @param tabs: eTabs pointer
+ * @param title: Tab title
+ *
+ * @return 0 on success, -1 in failure.
+ */
+int add_tab_eTabs(eTabs * tabs,
+                  char const * title);
+
+
+/**
+ * @brief The remove_tab_eTabs() function remove a tab, the current tab
+ *        stays the same or becomes the previous one if it is removed.
+ *
+ * @param tabs: eTabs pointer
+ * @param index: Index of the tab
+ *
+ * @return 0 on success, -1 in failure.
+ */
+int remove_tab_eTabs(eTabs * tabs,
+                     int index);
+
+
+/**
+ * @brief The set_current_tab_eTabs() function set the current tab.
+ *
+ * @param tabs: eTabs pointer
+ * @param index: Index of the tab
+ */
+void set_current_tab_eTabs(eTabs * tabs,
+                           int index);
+
+
+/**
+ * @brief The get_current_tab_eTabs() function return the current tab.
+ *
+ * @param tabs: eTabs pointer
+ *
+ * @return Index of the current tab or -1 if there is no tab.
+ */
+int get_current_tab_eTabs(eTabs const * tabs);
+
+
+/**
+ * @brief The move_next_tab_eTabs() function move to the next tab, the
+ *        first one after the last one.
+ *
+ * @param tabs: eTabs pointer
+ */
+void move_next_tab_eTabs(eTabs * tabs);
+
+
+/**
+ * @brief The move_previous_tab_eTabs() function move to the previous tab,
+ *        the last one before the first one.
+ *
+ * @param tabs: eTabs pointer
+ */
+void move_previous_tab_eTabs(eTabs * tabs);
+
+
+/**
+ * @brief The print_eTabs() function print the tabs which fit in the
+ *        window around the current one, and move the cursor of the window
+ *        to the current tab.
+ *
+ * @param tabs: eTabs pointer
+ */
+void print_eTabs(eTabs * tabs);
+
+#endif
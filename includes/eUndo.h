@@ -0,0 +1,219 @@
+/**
+ * @file eUndo.h
+ * @brief eUndo Header
+ * @author ALARY Dorian
+ * @version 1.0
+ * @date 21/07/2024
+ * @copyright GNU Public License.
+ *
+ */
+
+#ifndef __EUNDO_H__
+#define __EUNDO_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+
+struct efile_s;
+
+
+#define UNDO_DEFAULT_LIMIT (64*1024*1024) /* Default memory cap (bytes) */
+
+
+/**
+ * @enum Undo record type enumeration, the operation undoing a modification
+ */
+typedef enum {
+
+    u_INSERT_STRING,
+    u_REMOVE_STRING,
+    u_ADD_LINE,
+    u_DELETE_LINE
+
+} UNDO_RECORD;
+
+
+/**
+ * @enum Undo state enumeration, where the records of the modifications go
+ */
+typedef enum {
+
+    u_DO,   /* Undo stack, the redo stack is cleared */
+    u_UNDO, /* Redo stack */
+    u_REDO  /* Undo stack */
+
+} UNDO_STATE;
+
+
+/**
+ * @struct undo_record structure to describe an operation of a stack.
+ */
+typedef struct {
+
+    /** Group of the record, a group is undone at once */
+    unsigned int group;
+
+    /** Line number of the operation */
+    unsigned int line_number;
+
+    /** Position in the line */
+    unsigned int pos;
+
+    /** Operation type */
+    UNDO_RECORD type;
+
+    /** The record is a run of typed characters, it can grow */
+    bool typing;
+
+    /** Offset of the bytes in the arena */
+    size_t offset;
+
+    /** Number of bytes, or removed length of u_REMOVE_STRING */
+    size_t length;
+
+} undo_record;
+
+
+/**
+ * @struct undo_stack structure to store records and their bytes.
+ */
+typedef struct {
+
+    /** Records, the last one is undone first */
+    undo_record * records;
+
+    /** Number of records */
+    unsigned int n_records;
+
+    /** Records allocation size */
+    unsigned int alloc_records;
+
+    /** Bytes of the records */
+    char * arena;
+
+    /** Number of bytes used in the arena */
+    size_t arena_length;
+
+    /** Arena allocation size */
+    size_t arena_size;
+
+} undo_stack;
+
+
+/**
+ * @struct eUndo structure to undo and redo the modifications of an eFile.
+ */
+typedef struct {
+
+    /** Operations undoing the modifications */
+    undo_stack undo;
+
+    /** Operations redoing the undone modifications */
+    undo_stack redo;
+
+    /** Memory cap of both stacks (bytes) */
+    size_t limit;
+
+    /** Current group */
+    unsigned int group;
+
+    /** Where the records go */
+    UNDO_STATE state;
+
+    /** The current group did not fit in the memory cap, it is ignored */
+    bool overflow;
+
+} eUndo;
+
+
+/**
+ * @brief The create_eUndo() function allocate an empty eUndo.
+ *
+ * @param limit: Memory cap of the records (bytes)
+ *
+ * @return eUndo pointer or NULL if it was an error.
+ *
+ * @note delete_eUndo() must be called before exiting.
+ */
+eUndo * create_eUndo(size_t limit);
+
+
+/**
+ * @brief The delete_eUndo() function deallocate eUndo and set the pointer
+ *        to NULL.
+ *
+ * @param undo: eUndo pointer pointer
+ */
+void delete_eUndo(eUndo ** undo);
+
+
+/**
+ * @brief The set_limit_eUndo() function set the memory cap of the records.
+ *        The oldest records are dropped to fit in it.
+ *
+ * @param undo: eUndo pointer
+ * @param limit: Memory cap (bytes)
+ */
+void set_limit_eUndo(eUndo * undo,
+                     size_t limit);
+
+
+/**
+ * @brief The next_group_eUndo() function start a new group, the next
+ *        modifications are undone together.
+ *
+ * @param undo: eUndo pointer
+ */
+void next_group_eUndo(eUndo * undo);
+
+
+/**
+ * @brief The add_record_eUndo() function add the operation undoing a
+ *        modification to the current group.
+ *
+ * @param undo: eUndo pointer
+ * @param type: Operation type
+ * @param line_number: Line number of the operation
+ * @param pos: Position in the line
+ * @param data: Bytes of u_INSERT_STRING or NULL
+ * @param length: Number of bytes, or removed length of u_REMOVE_STRING
+ * @param typing: The modification is a typed character
+ *
+ * @return 0 on success or -1 in failure.
+ */
+int add_record_eUndo(eUndo * undo,
+                     UNDO_RECORD type,
+                     unsigned int line_number,
+                     unsigned int pos,
+                     char const * data,
+                     size_t length,
+                     bool typing);
+
+
+/**
+ * @brief The undo_eUndo() function undo the last group of modifications
+ *        of the file. The cursor is moved to the last modification.
+ *
+ * @param undo: eUndo pointer
+ * @param file: eFile pointer
+ *
+ * @return 0 on success or -1 if there is nothing to undo.
+ */
+int undo_eUndo(eUndo * undo,
+               struct efile_s * file);
+
+
+/**
+ * @brief The redo_eUndo() function redo the last undone group of
+ *        modifications of the file. The cursor is moved to the last
+ *        modification.
+ *
+ * @param undo: eUndo pointer
+ * @param file: eFile pointer
+ *
+ * @return 0 on success or -1 if there is nothing to redo.
+ */
+int redo_eUndo(eUndo * undo,
+               struct efile_s * file);
+
+#endif
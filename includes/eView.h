@@ -0,0 +1,308 @@
+/**
+ * @file eView.h
+ * @brief eView Header
+ * @author ALARY Dorian
+ * @version 1.0
+ * @date 21/07/2024
+ * @copyright GNU Public License.
+ *
+ */
+
+#ifndef __EVIEW_H__
+#define __EVIEW_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <signal.h>
+#include <sys/types.h>
+
+
+#define VIEW_STEP 4096 /* Lines of a page when the file is indexed */
+#define VIEW_DEFAULT_THRESHOLD (256*1024*1024) /* Size (bytes) from which a
+                                                  file is viewed */
+#define VIEW_DEFAULT_BUDGET (64*1024*1024) /* Default memory (bytes) of the
+                                              modified pages */
+
+
+/**
+ * @struct view_page structure to describe a page: consecutive lines of the
+ *         file. A page is in the mapping until it is modified, its bytes
+ *         are then in memory, or in the swap file once spilled.
+ */
+typedef struct {
+
+    /** Line number of its first line */
+    unsigned int first_line;
+
+    /** Number of lines */
+    unsigned int n_lines;
+
+    /** Offset of the bytes in the mapping, or in the swap file */
+    off_t offset;
+
+    /** Number of bytes, every line of a modified page ends with '\n' */
+    size_t length;
+
+    /** Bytes of a modified page in memory or NULL */
+    char * data;
+
+    /** Allocation size of data */
+    size_t size;
+
+    /** The page was modified */
+    bool dirty;
+
+    /** The bytes at offset in the swap file are the bytes of the page */
+    bool swapped;
+
+    /** Size of the range of the swap file at offset kept by the page, 0
+        if none */
+    size_t extent;
+
+    /** Last use of the page, the least recently used one is spilled */
+    unsigned long use;
+
+} view_page;
+
+
+/**
+ * @struct swap_extent structure to describe a free range of the swap file.
+ */
+typedef struct {
+
+    /** Offset in the swap file */
+    off_t offset;
+
+    /** Number of bytes */
+    size_t length;
+
+} swap_extent;
+
+
+/**
+ * @struct eView structure to show and modify a huge file without reading
+ *         its lines. The file is mapped in memory and divided in pages as
+ *         its lines are reached. Modified pages are kept in memory up to a
+ *         budget, the least recently used ones are spilled in a swap file.
+ *         A page of the mapping past the end of a truncated file reads as
+ *         zeros instead of stopping edito.
+ */
+typedef struct eView {
+
+    /** Mapping of the file */
+    char const * data;
+
+    /** Size of the mapping */
+    size_t size;
+
+    /** Pages sorted by line number */
+    view_page * pages;
+
+    /** Number of pages */
+    unsigned int n_pages;
+
+    /** Pages allocation size */
+    unsigned int alloc_pages;
+
+    /** Offset in the mapping of the first line not indexed */
+    size_t indexed;
+
+    /** Number of lines indexed */
+    unsigned int n_lines;
+
+    /** Line number of the last line found */
+    unsigned int last_line;
+
+    /** Page of the last line found */
+    unsigned int last_page;
+
+    /** Offset in its page of the last line found */
+    size_t last_offset;
+
+    /** Path of the swap file, created on the first spill */
+    char * swap_path;
+
+    /** Descriptor of the swap file or -1 */
+    int swap_fd;
+
+    /** Size of the swap file */
+    off_t swap_size;
+
+    /** Free ranges of the swap file, sorted by length */
+    swap_extent * extents;
+
+    /** Number of free ranges */
+    unsigned int n_extents;
+
+    /** Free ranges allocation size */
+    unsigned int alloc_extents;
+
+    /** Number of snapshots reading the swap file, the free ranges are not
+        reused meanwhile */
+    unsigned int n_holds;
+
+    /** Memory of the modified pages (bytes) */
+    size_t resident;
+
+    /** Memory cap of the modified pages (bytes) */
+    size_t budget;
+
+    /** Use counter of the pages */
+    unsigned long use;
+
+    /** First line of screen */
+    unsigned int first_screen_line;
+
+    /** Current line */
+    unsigned int current_line;
+
+    /** Current pos in current line */
+    unsigned int current_pos;
+
+    /** A page was read past the end of the truncated file */
+    volatile sig_atomic_t truncated;
+
+    /** The truncation was reported */
+    bool reported;
+
+    /** Next view of edito, for the SIGBUS handler */
+    struct eView * next;
+
+} eView;
+
+
+/**
+ * @brief The create_eView() function map a file and allocate an eView with
+ *        an empty index.
+ *
+ * @param fd: Descriptor of the file, it can be closed afterwards
+ * @param size: Size of the file
+ * @param realpath: Path of the file, the swap file is created next to it
+ *
+ * @return eView pointer or NULL if it was an error.
+ *
+ * @note delete_eView() must be called before exiting.
+ */
+eView * create_eView(int fd,
+                     size_t size,
+                     char const * realpath);
+
+
+/**
+ * @brief The delete_eView() function unmap the file, remove the swap file,
+ *        deallocate eView and set the pointer to NULL.
+ *
+ * @param view: eView pointer pointer
+ */
+void delete_eView(eView ** view);
+
+
+/**
+ * @brief The set_budget_eView() function set the memory cap of the
+ *        modified pages. The least recently used ones are spilled to fit
+ *        in it.
+ *
+ * @param view: eView pointer
+ * @param budget: Memory cap (bytes)
+ */
+void set_budget_eView(eView * view,
+                      size_t budget);
+
+
+/**
+ * @brief The extend_eView() function index the lines of the file until a
+ *        line number, or until the end of the file.
+ *
+ * @param view: eView pointer
+ * @param line_number: Line number to reach
+ *
+ * @return Number of lines indexed.
+ */
+unsigned int extend_eView(eView * view,
+                          unsigned int line_number);
+
+
+/**
+ * @brief The get_line_eView() function find a line. The line is not
+ *        terminated by 0, and is valid until the next call on the eView.
+ *
+ * @param view: eView pointer
+ * @param line_number: Line number
+ * @param length: Length of the line, without '\n'
+ *
+ * @return Beginning of the line or NULL if the line does not exist.
+ */
+char const * get_line_eView(eView * view,
+                            unsigned int line_number,
+                            size_t * length);
+
+
+/**
+ * @brief The insert_eView() function insert a string in a line. Each '\n'
+ *        of the string splits the line.
+ *
+ * @param view: eView pointer
+ * @param line_number: Line number
+ * @param pos: Position in the line
+ * @param string: String to insert
+ * @param length: Length of the string
+ *
+ * @return 0 on success or -1 in failure.
+ */
+int insert_eView(eView * view,
+                 unsigned int line_number,
+                 unsigned int pos,
+                 char const * string,
+                 size_t length);
+
+
+/**
+ * @brief The remove_eView() function remove bytes of a line. Removing the
+ *        '\n' at the end of the line joins the next line.
+ *
+ * @param view: eView pointer
+ * @param line_number: Line number
+ * @param pos: Position in the line
+ * @param length: Number of bytes, up to the end of the line and its '\n'
+ *
+ * @return 0 on success or -1 in failure.
+ */
+int remove_eView(eView * view,
+                 unsigned int line_number,
+                 unsigned int pos,
+                 size_t length);
+
+
+/**
+ * @brief The check_truncated_eView() function return true the first time
+ *        a page was read past the end of the file, truncated by another
+ *        program. The lines are not right anymore.
+ *
+ * @param view: eView pointer
+ *
+ * @return true if the truncation was not reported yet, false otherwise.
+ */
+bool check_truncated_eView(eView * view);
+
+
+/**
+ * @brief The hold_swap_eView() function keep the spilled pages where they
+ *        are while a snapshot reads the swap file: spilled pages are then
+ *        appended and no free range is reused.
+ *
+ * @param view: eView pointer
+ *
+ * @note release_swap_eView() must be called once the snapshot is written.
+ */
+void hold_swap_eView(eView * view);
+
+
+/**
+ * @brief The release_swap_eView() function let the free ranges of the swap
+ *        file be reused once a snapshot was written.
+ *
+ * @param view: eView pointer
+ */
+void release_swap_eView(eView * view);
+
+#endif
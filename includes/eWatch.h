@@ -0,0 +1,85 @@
+/**
+ * @file eWatch.h
+ * @brief eWatch Header
+ * @author ALARY Dorian
+ * @version 1.0
+ * @date 21/07/2024
+ * @copyright GNU Public License.
+ *
+ */
+
+#ifndef __EWATCH_H__
+#define __EWATCH_H__
+
+#include <stdbool.h>
+#include <time.h>
+
+
+#define WATCH_DELAY 1000 /* Delay (ms) between two checks of the files */
+
+
+/**
+ * @struct eWatch structure to tell when the open files may have been
+ *         changed by another program. The directories of the files are
+ *         watched with inotify, a file replaced by rename(2) is seen too.
+ */
+typedef struct {
+
+    /** inotify descriptor or -1, the files are then checked every
+        WATCH_DELAY */
+    int inotify_fd;
+
+    /** A check was put off, it is done next time */
+    bool pending;
+
+    /** Time of the last check */
+    struct timespec last_check;
+
+} eWatch;
+
+
+/**
+ * @brief The create_eWatch() function allocate an eWatch without watched
+ *        directory.
+ *
+ * @return eWatch pointer or NULL if it was an error.
+ *
+ * @note delete_eWatch() must be called before exiting.
+ */
+eWatch * create_eWatch(void);
+
+
+/**
+ * @brief The delete_eWatch() function stop watching the directories,
+ *        deallocate eWatch and set the pointer to NULL.
+ *
+ * @param watch: eWatch pointer pointer
+ */
+void delete_eWatch(eWatch ** watch);
+
+
+/**
+ * @brief The add_eWatch() function watch the directory of a file. A
+ *        directory is watched once, until the eWatch is deleted.
+ *
+ * @param watch: eWatch pointer
+ * @param realpath: Path of the file
+ *
+ * @return 0 on success or -1 in failure.
+ */
+int add_eWatch(eWatch * watch,
+               char const * realpath);
+
+
+/**
+ * @brief The is_changed_eWatch() function return true if a file of the
+ *        watched directories was written, renamed or deleted since the last
+ *        call, without waiting.
+ *
+ * @param watch: eWatch pointer
+ *
+ * @return true if the files must be checked, false otherwise.
+ */
+bool is_changed_eWatch(eWatch * watch);
+
+#endif
@@ -11,7 +11,7 @@
 #ifndef __EWINDOW_H__
 #define __EWINDOW_H__
 
-#define WINDOWS_NUMBER 8
+#define WINDOWS_NUMBER 9
 
 #include <ncurses.h>
 
@@ -28,7 +28,8 @@ typedef enum {
     WFILE_BOX,
     WFILE_LNUM,
     WFILE_CNT,
-    WHELP
+    WHELP,
+    WPOPUP
 
 } WINDOW_TYPE;
 
@@ -12,6 +12,13 @@
 #ifndef __UTIL_H__
 #define __UTIL_H__
 
+#include <stddef.h>
+#include <stdint.h>
+
+
+#define HASH_INIT 0xcbf29ce484222325ULL /* First hash given to hash_bytes() */
+
+
 /**
  * @enum File and eRepository permissions enumeration
  */
@@ -40,4 +47,17 @@ unsigned int get_next_power_of_two(unsigned int n);
  */
 int digit_number(unsigned int n);
 
+
+/*
+ * @brief The hash_bytes() function continue the hash of a content with
+ *        the following bytes. The bytes are hashed by words of 8, a
+ *        content hashed in blocks of a multiple of 8 bytes gets the same
+ *        hash as in one block.
+ *
+ * @example hash_bytes(HASH_INIT, "abc", 3)
+ */
+uint64_t hash_bytes(uint64_t hash,
+                    void const * data,
+                    size_t length);
+
 #endif
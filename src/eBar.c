@@ -8,7 +8,9 @@
  *
  * @details This file contains all the structures, variables and functions
  *          used to manage the bar structure. eBar is used to store open efile.
- *          This structure do not manage any screen function.
+ *          This structure do not manage any screen function. The open files
+ *          are also linked from the most recently used, so that the file
+ *          used before the current one is found at once.
  */
 
 #include "eBar.h"
@@ -17,6 +19,33 @@
 
 #include <stdlib.h>
 #include <string.h>
+#include <sys/stat.h>
+
+
+#define BAR_FREE_SLOT 0 /* Hash of a slot never used */
+#define BAR_REMOVED_SLOT 1 /* Hash of a slot whose file was removed */
+
+
+static uint64_t hash_key_eBar(bool by_path,
+                              dev_t dev,
+                              ino_t ino,
+                              char const * realpath);
+static bar_slot * find_slot_eBar(eBar const * bar,
+                                 bool by_path,
+                                 dev_t dev,
+                                 ino_t ino,
+                                 char const * realpath);
+static int insert_slot_eBar(eBar * bar,
+                            bar_slot const * slot);
+static int grow_eBar(eBar * bar);
+static int add_inode_eBar(eBar * bar,
+                          bar_use * use);
+static void remove_inode_eBar(eBar * bar,
+                              eFile const * file);
+static bar_use * find_use_eBar(eBar const * bar,
+                               eFile const * file);
+static void unlink_use_eBar(eBar * bar,
+                            bar_use * use);
 
 
 /**
@@ -35,6 +64,10 @@ eBar * create_eBar(void)
     bar->files = NULL;
     bar->n_files = 0;
     bar->alloc_size = 0;
+    bar->slots = NULL;
+    bar->n_slots = 0;
+    bar->n_used = 0;
+    bar->last_used = NULL;
 
     return bar;
 }
@@ -51,9 +84,13 @@ void delete_eBar(eBar ** bar)
     if(*bar == NULL)
         return;
 
+    for(unsigned int i=0; i<(*bar)->n_files; i++)
+        free((*bar)->files[i]);
+
     if((*bar)->files)
         free((*bar)->files);
 
+    free((*bar)->slots);
     free(*bar);
     *bar = NULL;
 }
@@ -69,6 +106,9 @@ void delete_eBar(eBar ** bar)
 int add_file_eBar(eBar * bar,
                   eFile const * file)
 {
+    bar_slot slot = {0, true, 0, 0, NULL};
+    bar_use *use = NULL;
+
     if(bar == NULL || file == NULL)
         return -1;
 
@@ -76,15 +116,38 @@ int add_file_eBar(eBar * bar,
     if(bar->n_files >= bar->alloc_size)
     {
         bar->alloc_size = get_next_power_of_two(bar->n_files);
-        bar->files = (eFile const **) realloc(bar->files,
-                                              bar->alloc_size*sizeof(eFile));
+        bar->files = (bar_use **) realloc(bar->files,
+                                          bar->alloc_size*sizeof(bar_use *));
         if(bar->files == NULL)
         {
             return -1;
         }
     }
 
-    bar->files[bar->n_files] = file;
+    use = (bar_use *) malloc(sizeof(bar_use));
+    if(use == NULL)
+        return -1;
+    use->file = file;
+    use->index = bar->n_files;
+
+    /* The file is found by its realpath, and by its inode if it has one */
+    slot.hash = hash_key_eBar(true, 0, 0, file->realpath);
+    slot.use = use;
+    if(insert_slot_eBar(bar, &slot) == -1)
+    {
+        free(use);
+        return -1;
+    }
+    add_inode_eBar(bar, use);
+
+    /* A file is opened to be shown */
+    use->previous = NULL;
+    use->next = bar->last_used;
+    if(bar->last_used != NULL)
+        bar->last_used->previous = use;
+    bar->last_used = use;
+
+    bar->files[bar->n_files] = use;
     bar->n_files++;
 
     return 0;
@@ -92,7 +155,8 @@ int add_file_eBar(eBar * bar,
 
 
 /**
- * @brief The remove_file_eBar() function remove a file from the bar.
+ * @brief The remove_file_eBar() function remove a file from the bar. The
+ *        next files are shifted, they keep the order of the tabs.
  *
  * @param bar: eBar pointer
  * @param index: index of eFile to remove
@@ -102,12 +166,27 @@ int add_file_eBar(eBar * bar,
 int remove_file_eBar(eBar * bar,
                      unsigned int index)
 {
+    bar_slot *slot = NULL;
+    bar_use *use = NULL;
+
     if(bar == NULL || index >= bar->n_files)
         return -1;
 
+    use = bar->files[index];
+    remove_inode_eBar(bar, use->file);
+    slot = find_slot_eBar(bar, true, 0, 0, use->file->realpath);
+    if(slot != NULL && slot->use == use)
+        slot->hash = BAR_REMOVED_SLOT;
+    unlink_use_eBar(bar, use);
+    free(use);
+
+    /* The files keep the order of their tabs, which eTabs shifts the same
+       way: a swap with the last file would move its tab. A close moves a
+       pointer by open file, once by user action */
     for(unsigned int i = index; i+1 < bar->n_files; i++)
     {
         bar->files[i] = bar->files[i+1];
+        bar->files[i]->index = i;
     }
     bar->n_files--;
     bar->files[bar->n_files] = NULL;
@@ -130,7 +209,7 @@ eFile const * get_file_eBar(eBar const * bar,
     if(bar == NULL || index >= bar->n_files)
         return NULL;
 
-    return bar->files[index];
+    return bar->files[index]->file;
 }
 
 
@@ -160,13 +239,400 @@ unsigned int count_eBar(eBar const * bar)
 bool is_file_in_eBar(eBar const * bar,
                      eFile const * file)
 {
-    if(bar == NULL ||file == NULL)
-        return false;
+    return find_file_eBar(bar, file) != NULL;
+}
+
+
+/**
+ * @brief The find_file_eBar() function return the file of the bar which is
+ *        the same file on disk, by its inode, or by its realpath if it has
+ *        no status.
+ *
+ * @param bar: eBar pointer
+ * @param file: eFile pointer, in the bar or not
+ *
+ * @return eFile pointer of the bar or NULL if the file is not open.
+ */
+eFile const * find_file_eBar(eBar const * bar,
+                             eFile const * file)
+{
+    struct stat info;
+    bar_slot *slot = NULL;
+
+    if(bar == NULL || file == NULL || bar->n_files == 0)
+        return NULL;
+
+    if(stat(file->realpath, &info) == 0)
+        slot = find_slot_eBar(bar, false, info.st_dev, info.st_ino, NULL);
+
+    /* A file replaced on disk is still found by its realpath */
+    if(slot == NULL)
+        slot = find_slot_eBar(bar, true, 0, 0, file->realpath);
+
+    return (slot != NULL) ? slot->use->file : NULL;
+}
+
+
+/**
+ * @brief The get_index_eBar() function return the index of a file of the
+ *        bar, without looking through the bar.
+ *
+ * @param bar: eBar pointer
+ * @param file: eFile pointer
+ *
+ * @return Index of the file or -1 if it is not in the bar.
+ */
+int get_index_eBar(eBar const * bar,
+                   eFile const * file)
+{
+    bar_use *use = find_use_eBar(bar, file);
+
+    return (use != NULL) ? (int) use->index : -1;
+}
+
+
+/**
+ * @brief The update_file_eBar() function find a file of the bar by its new
+ *        inode, after it was replaced on disk.
+ *
+ * @param bar: eBar pointer
+ * @param file: eFile pointer
+ *
+ * @return 0 on success or -1 in failure.
+ */
+int update_file_eBar(eBar * bar,
+                     eFile const * file)
+{
+    if(bar == NULL || file == NULL)
+        return -1;
+
+    bar_use *use = find_use_eBar(bar, file);
+
+    if(use == NULL)
+        return -1;
+
+    remove_inode_eBar(bar, file);
+
+    return add_inode_eBar(bar, use);
+}
+
+
+/**
+ * @brief The use_file_eBar() function set a file of the bar as the last
+ *        used one.
+ *
+ * @param bar: eBar pointer
+ * @param file: eFile pointer
+ *
+ * @return 0 on success or -1 if the file is not in the bar.
+ */
+int use_file_eBar(eBar * bar,
+                  eFile const * file)
+{
+    bar_use *use = find_use_eBar(bar, file);
+
+    if(use == NULL)
+        return -1;
+
+    if(use == bar->last_used)
+        return 0;
+
+    unlink_use_eBar(bar, use);
+    use->previous = NULL;
+    use->next = bar->last_used;
+    if(bar->last_used != NULL)
+        bar->last_used->previous = use;
+    bar->last_used = use;
+
+    return 0;
+}
+
+
+/**
+ * @brief The get_used_file_eBar() function return the file used just
+ *        before a file of the bar.
+ *
+ * @param bar: eBar pointer
+ * @param file: eFile pointer or NULL
+ *
+ * @return eFile pointer, the last used file if file is NULL, not in the bar
+ *         or the least recently used one, or NULL if the bar is empty.
+ */
+eFile const * get_used_file_eBar(eBar const * bar,
+                                 eFile const * file)
+{
+    bar_use *use = find_use_eBar(bar, file);
+
+    if(bar == NULL || bar->last_used == NULL)
+        return NULL;
+
+    /* After the least recently used file comes the last used one again */
+    if(use == NULL || use->next == NULL)
+        return bar->last_used->file;
+
+    return use->next->file;
+}
+
+
+/**
+ * @brief The hash_key_eBar() function hash the key of a slot.
+ *
+ * @param by_path: The key is the realpath, not the inode
+ * @param dev: Device of the file
+ * @param ino: Inode of the file
+ * @param realpath: Realpath of the file
+ *
+ * @return Hash of the key, never BAR_FREE_SLOT or BAR_REMOVED_SLOT.
+ */
+static uint64_t hash_key_eBar(bool by_path,
+                              dev_t dev,
+                              ino_t ino,
+                              char const * realpath)
+{
+    uint64_t hash = HASH_INIT;
+
+    if(by_path)
+        hash = hash_bytes(hash, realpath, strlen(realpath));
+    else
+    {
+        hash = hash_bytes(hash, &dev, sizeof(dev_t));
+        hash = hash_bytes(hash, &ino, sizeof(ino_t));
+    }
+
+    return (hash > BAR_REMOVED_SLOT) ? hash : hash+BAR_REMOVED_SLOT+1;
+}
+
+
+/**
+ * @brief The find_slot_eBar() function find the slot of a key.
+ *
+ * @param bar: eBar pointer
+ * @param by_path: The key is the realpath, not the inode
+ * @param dev: Device of the file
+ * @param ino: Inode of the file
+ * @param realpath: Realpath of the file
+ *
+ * @return bar_slot pointer or NULL if the key is not in the table.
+ */
+static bar_slot * find_slot_eBar(eBar const * bar,
+                                 bool by_path,
+                                 dev_t dev,
+                                 ino_t ino,
+                                 char const * realpath)
+{
+    uint64_t hash = 0;
+    size_t mask = bar->n_slots-1;
+    bar_slot *slot = NULL;
+
+    if(bar->n_slots == 0)
+        return NULL;
+
+    hash = hash_key_eBar(by_path, dev, ino, realpath);
+
+    /* The table is never more than half used, a free slot ends the search */
+    for(size_t i=hash & mask; bar->slots[i].hash != BAR_FREE_SLOT;
+        i = (i+1) & mask)
+    {
+        slot = &bar->slots[i];
+        if(slot->hash != hash || slot->by_path != by_path)
+            continue;
+
+        if(by_path ? strcmp(slot->use->file->realpath, realpath) == 0
+                   : slot->dev == dev && slot->ino == ino)
+            return slot;
+    }
+
+    return NULL;
+}
+
+
+/**
+ * @brief The insert_slot_eBar() function insert a key which is not in the
+ *        table.
+ *
+ * @param bar: eBar pointer
+ * @param slot: Slot copied in the table
+ *
+ * @return 0 on success or -1 in failure.
+ */
+static int insert_slot_eBar(eBar * bar,
+                            bar_slot const * slot)
+{
+    size_t i = 0;
+
+    if((bar->n_used+1)*2 > bar->n_slots && grow_eBar(bar) == -1)
+        return -1;
+
+    /* A removed slot is used again */
+    i = slot->hash & (bar->n_slots-1);
+    while(bar->slots[i].hash > BAR_REMOVED_SLOT)
+        i = (i+1) & (bar->n_slots-1);
+
+    if(bar->slots[i].hash == BAR_FREE_SLOT)
+        bar->n_used++;
+    bar->slots[i] = *slot;
+
+    return 0;
+}
+
+
+/**
+ * @brief The grow_eBar() function allocate a bigger table and insert the
+ *        keys again, without the removed slots.
+ *
+ * @param bar: eBar pointer
+ *
+ * @return 0 on success or -1 in failure.
+ */
+static int grow_eBar(eBar * bar)
+{
+    bar_slot *slots = NULL;
+    size_t n_slots = 16, n_keys = 0, j = 0;
+
+    for(size_t i=0; i<bar->n_slots; i++)
+    {
+        if(bar->slots[i].hash > BAR_REMOVED_SLOT)
+            n_keys++;
+    }
+
+    while(n_slots < (n_keys+1)*4)
+        n_slots *= 2;
+
+    slots = (bar_slot *) calloc(n_slots, sizeof(bar_slot));
+    if(slots == NULL)
+        return -1;
+
+    for(size_t i=0; i<bar->n_slots; i++)
+    {
+        if(bar->slots[i].hash <= BAR_REMOVED_SLOT)
+            continue;
+
+        j = bar->slots[i].hash & (n_slots-1);
+        while(slots[j].hash != BAR_FREE_SLOT)
+            j = (j+1) & (n_slots-1);
+        slots[j] = bar->slots[i];
+    }
+
+    free(bar->slots);
+    bar->slots = slots;
+    bar->n_slots = n_slots;
+    bar->n_used = n_keys;
+
+    return 0;
+}
+
+
+/**
+ * @brief The add_inode_eBar() function find a file by the inode of its
+ *        realpath too. The slot by path of the file keeps the inode, so
+ *        that the slot by inode is found to be removed.
+ *
+ * @param bar: eBar pointer
+ * @param use: Open file, in the table by its realpath
+ *
+ * @return 0 on success or if the file has no status, -1 in failure.
+ */
+static int add_inode_eBar(eBar * bar,
+                          bar_use * use)
+{
+    struct stat info;
+    bar_slot slot = {0, false, 0, 0, use};
+    bar_slot *path_slot = NULL;
+    eFile const *file = use->file;
+
+    /* A file without status, like the standard input, has no inode. An
+       inode already open keeps its file */
+    if(stat(file->realpath, &info) == -1
+       ||
+       find_slot_eBar(bar, false, info.st_dev, info.st_ino, NULL) != NULL)
+        return 0;
+
+    slot.hash = hash_key_eBar(false, info.st_dev, info.st_ino, NULL);
+    slot.dev = info.st_dev;
+    slot.ino = info.st_ino;
+    if(insert_slot_eBar(bar, &slot) == -1)
+        return -1;
 
-    for(unsigned int i=0; i<bar->n_files; i++)
+    /* Found after the insertion, which may move the slots */
+    path_slot = find_slot_eBar(bar, true, 0, 0, file->realpath);
+    if(path_slot != NULL)
     {
-        if(!strcmp(bar->files[i]->filename, file->filename))
-            return true;
+        path_slot->dev = info.st_dev;
+        path_slot->ino = info.st_ino;
     }
-    return false;
+
+    return 0;
+}
+
+
+/**
+ * @brief The remove_inode_eBar() function remove the slot by inode of a
+ *        file.
+ *
+ * @param bar: eBar pointer
+ * @param file: eFile pointer, in the table by its realpath
+ */
+static void remove_inode_eBar(eBar * bar,
+                              eFile const * file)
+{
+    bar_slot *path_slot = NULL, *slot = NULL;
+
+    path_slot = find_slot_eBar(bar, true, 0, 0, file->realpath);
+    if(path_slot == NULL
+       ||
+       path_slot->use->file != file
+       ||
+       path_slot->ino == 0)
+        return;
+
+    slot = find_slot_eBar(bar, false, path_slot->dev, path_slot->ino, NULL);
+    if(slot != NULL && slot->use == path_slot->use)
+        slot->hash = BAR_REMOVED_SLOT;
+
+    path_slot->dev = 0;
+    path_slot->ino = 0;
+}
+
+
+/**
+ * @brief The find_use_eBar() function find an open file by its realpath.
+ *
+ * @param bar: eBar pointer
+ * @param file: eFile pointer
+ *
+ * @return bar_use pointer or NULL if the file is not in the bar.
+ */
+static bar_use * find_use_eBar(eBar const * bar,
+                               eFile const * file)
+{
+    bar_slot *slot = NULL;
+
+    if(bar == NULL || file == NULL)
+        return NULL;
+
+    slot = find_slot_eBar(bar, true, 0, 0, file->realpath);
+
+    return (slot != NULL && slot->use->file == file) ? slot->use : NULL;
+}
+
+
+/**
+ * @brief The unlink_use_eBar() function remove an open file from the files
+ *        linked from the most recently used.
+ *
+ * @param bar: eBar pointer
+ * @param use: Open file
+ */
+static void unlink_use_eBar(eBar * bar,
+                            bar_use * use)
+{
+    if(use->previous != NULL)
+        use->previous->next = use->next;
+    else
+        bar->last_used = use->next;
+
+    if(use->next != NULL)
+        use->next->previous = use->previous;
+
+    use->previous = use->next = NULL;
 }
@@ -290,3 +290,71 @@ int get_item_at_index_eDirectory(eDirectory const * directory,
     return item_index;
 }
 
+
+
+/**
+ * @brief The find_path_eDirectory() function returns either the directory
+ *        or the file at a path.
+ *
+ * @param directory: eDirectory pointer
+ * @param path: Path from the directory, names separated by '/'
+ * @param out_directory: eDirectory pointer returned
+ * @param out_file: eFile pointer returned
+ *
+ * @return 0 on success or -1 if there is nothing at the path.
+ */
+int find_path_eDirectory(eDirectory const * directory,
+                         char const * path,
+                         eDirectory ** out_directory,
+                         eFile ** out_file)
+{
+    char const *end = NULL;
+    size_t length = 0;
+    eDirectory const *next = NULL;
+
+    while(directory != NULL)
+    {
+        end = strchr(path, '/');
+        length = (end != NULL) ? (size_t) (end-path) : strlen(path);
+
+        /* The last name is a file or a directory */
+        if(end == NULL)
+        {
+            for(unsigned int i=0; i<directory->n_files; i++)
+            {
+                if(strlen(directory->files[i]->filename) == length
+                   &&
+                   strncmp(directory->files[i]->filename, path, length) == 0)
+                {
+                    *out_file = directory->files[i];
+                    return 0;
+                }
+            }
+        }
+
+        next = NULL;
+        for(unsigned int i=0; i<directory->n_dirs && next == NULL; i++)
+        {
+            if(directory->dirs[i] != NULL
+               &&
+               strlen(directory->dirs[i]->dirname) == length
+               &&
+               strncmp(directory->dirs[i]->dirname, path, length) == 0)
+                next = directory->dirs[i];
+        }
+
+        if(end == NULL)
+        {
+            if(next == NULL)
+                return -1;
+
+            *out_directory = (eDirectory *) next;
+            return 0;
+        }
+
+        directory = next;
+        path = end+1;
+    }
+
+    return -1;
+}
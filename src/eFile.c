@@ -10,19 +10,103 @@
  *          used to manage the file and its content.
  */
 
+#define _GNU_SOURCE /* memmem */
+
 #include "eFile.h"
 #include "eLine.h"
+#include "eSave.h"
+#include "eLoad.h"
 #include "util.h"
 
 #include <stdio.h> /* printf, FILE */
 #include <stdlib.h> /* malloc */
-#include <string.h> /* strlen, strncpy, strncat */
+#include <string.h> /* strlen, strncpy, strncat, memmem */
 #include <errno.h> /* errno code */
 #include <unistd.h> /* access */
+#include <fcntl.h> /* open */
 #include <stdbool.h>
 
 
-#define BUFFER_LENGTH 256 /* Buffer length of the buffer used to read lines */
+#define DISK_BLOCK_LENGTH (1024*1024) /* Length of the blocks hashed */
+
+
+/**
+ * @struct disk_line structure to locate a line of a file read again.
+ */
+typedef struct {
+
+    /** Offset of the line in the file */
+    off_t offset;
+
+    /** Length of the line, without its \n */
+    size_t length;
+
+} disk_line;
+
+
+/**
+ * @struct line_hash structure to find the next occurrence of a line, the
+ *         hashes are sorted by hash then by position.
+ */
+typedef struct {
+
+    /** Hash of the line */
+    uint64_t hash;
+
+    /** Line number */
+    unsigned int position;
+
+} line_hash;
+
+
+/* Internal functions */
+static int add_first_line_eFile(eFile * efile);
+static int insert_index_eFile(eFile * efile,
+                              unsigned int index,
+                              eLine * line);
+static void remove_index_eFile(eFile * efile,
+                               unsigned int index);
+static void journal_eFile(eFile * efile,
+                          JOURNAL_RECORD type,
+                          unsigned int arg,
+                          char const * data,
+                          size_t length,
+                          char const * data2,
+                          size_t length2);
+static void undo_eFile(eFile * efile,
+                       UNDO_RECORD type,
+                       unsigned int line_number,
+                       unsigned int pos,
+                       char const * data,
+                       size_t length,
+                       bool typing);
+static void filter_eFile(eFile * efile,
+                         unsigned int line_number);
+static bool is_same_status_eFile(struct stat const * first,
+                                 struct stat const * second);
+static disk_line * split_disk_eFile(char const * data,
+                                    off_t size,
+                                    unsigned int * n_lines);
+static bool is_same_line_eFile(eLine const * line,
+                               char const * data,
+                               disk_line const * disk);
+static line_hash * hash_lines_eFile(eFile const * efile,
+                                    char const * data,
+                                    disk_line const * disk,
+                                    unsigned int n_disk);
+static int compare_line_hash(void const * first,
+                             void const * second);
+static unsigned int find_line_hash(line_hash const * hashes,
+                                   unsigned int n_hashes,
+                                   uint64_t hash,
+                                   unsigned int position);
+static void free_lines_eFile(eFile * efile);
+static int read_dropped_eFile(eFile * efile);
+static int hash_disk_eFile(int fd,
+                           uint64_t * hash);
+static char * read_disk_eFile(int fd,
+                              off_t size,
+                              size_t * length);
 
 
 /**
@@ -95,10 +179,24 @@ eFile * create_eFile(char const * realpath)
 
     efile->n_elines = 0;
     efile->first_file_line = NULL;
+    efile->lines = NULL;
+    efile->alloc_lines = 0;
     efile->first_screen_line = NULL;
     efile->current_line = NULL;
     efile->current_pos = 0;
     efile->is_saved = true;
+    efile->fd = -1;
+    memset(&efile->file_stat, 0, sizeof(struct stat));
+    memset(&efile->disk_stat, 0, sizeof(struct stat));
+    efile->disk_hash = 0;
+    efile->journal = NULL;
+    efile->undo = NULL;
+    efile->view = NULL;
+    efile->follow = NULL;
+    efile->filter = NULL;
+    efile->hex = NULL;
+    efile->pack = NULL;
+    clock_gettime(CLOCK_MONOTONIC, &efile->last_use);
 
     return efile;
 }
@@ -133,10 +231,58 @@ void delete_eFile(eFile ** efile)
  */
 int open_eFile(eFile * efile)
 {
-    eLine *current = NULL, *previous = NULL;
+    eLoad *load = NULL;
+    eLine *first_line = NULL, *last_line = NULL;
+    unsigned int n_lines = 0;
+    int result = 0;
+
+    if(begin_open_eFile(efile) == -1)
+        return -1;
+
+    /* The lines are read by the caller */
+    if(efile->fd != -1)
+    {
+        if((load = create_eLoad(efile)) == NULL)
+        {
+            close_eFile(efile);
+            return -1;
+        }
+
+        result = read_eLoad(load);
+        n_lines = take_lines_eLoad(load, &first_line, &last_line);
+        append_lines_eFile(efile, first_line, last_line, n_lines);
+        delete_eLoad(&load);
+
+        if(result == -1)
+        {
+            close_eFile(efile);
+            return -1;
+        }
+    }
+
+    end_open_eFile(efile);
+
+    return 0;
+}
+
+
+/**
+ * @brief The begin_open_eFile() function open the file without reading its
+ *        lines, they are added by append_lines_eFile(), see eLoad. The file
+ *        can be modified while the lines are added.
+ *
+ * @param efile: eFile pointer
+ *
+ * @return 0 on success or -1 in failure.
+ *
+ * @note end_open_eFile() must be called once every line is added. If the
+ *       file did not exist when calling create_eFile(), a new file is
+ *       written and the fd attribute stays -1: there is nothing to read.
+ */
+int begin_open_eFile(eFile * efile)
+{
     FILE *fp = NULL;
-    char buffer[BUFFER_LENGTH];
-    memset(buffer, 0, BUFFER_LENGTH);
+    int fd = -1;
 
     if(efile == NULL || efile->permissions == p_NOPERM)
         return -1;
@@ -149,61 +295,172 @@ int open_eFile(eFile * efile)
             return -1;
         }
 
-        add_empty_line_eFile(efile, 1);
+        add_first_line_eFile(efile);
         efile->permissions = p_READWRITE;
+        efile->undo = create_eUndo(UNDO_DEFAULT_LIMIT);
+
+        if(fstat(fileno(fp), &efile->file_stat) == 0)
+            efile->journal = create_eJournal(efile->realpath,
+                                             &efile->file_stat);
+        efile->disk_stat = efile->file_stat;
+        efile->disk_hash = HASH_INIT;
+        fclose(fp);
         return 0;
     }
 
-    /* Open file to read it */
-    else if(efile->permissions != p_CREATE)
+    /* Kept open, the file is still readable after being replaced */
+    if((fd = open(efile->realpath, O_RDONLY)) == -1)
+        return -1;
+
+    if(fstat(fd, &efile->file_stat) == -1)
     {
-        if((fp = fopen(efile->realpath, "r")) == NULL)
-            return -1;
+        close(fd);
+        return -1;
     }
 
+    efile->fd = fd;
+    efile->disk_stat = efile->file_stat;
+    efile->is_saved = true;
+    efile->undo = create_eUndo(UNDO_DEFAULT_LIMIT);
+
+    /* Unsaved modifications are journaled, see eJournal */
+    if(efile->permissions == p_READWRITE)
+        efile->journal = create_eJournal(efile->realpath,
+                                         &efile->file_stat);
 
-    /* Loop to read lines of the file*/
-    while(fgets(buffer, BUFFER_LENGTH, fp) != NULL)
+    return 0;
+}
+
+
+/**
+ * @brief The append_lines_eFile() function add lines read from the file
+ *        after the last line. The added lines are not a modification.
+ *
+ * @param efile: eFile pointer
+ * @param first_line: First line, linked to the next ones
+ * @param last_line: Last line
+ * @param n_lines: Number of lines
+ *
+ * @return 0 on success or -1 in failure.
+ */
+int append_lines_eFile(eFile * efile,
+                       eLine * first_line,
+                       eLine * last_line,
+                       unsigned int n_lines)
+{
+    eLine **lines = NULL;
+    eLine *current = NULL;
+    unsigned int alloc_lines = 0;
+
+    if(efile == NULL || n_lines == 0)
+        return -1;
+
+    if(efile->n_elines+n_lines > efile->alloc_lines)
     {
-        if((current = create_eLine(buffer, BUFFER_LENGTH, efile->n_elines+1, previous, NULL)) == NULL)
-        {
-            close_eFile(efile);
-            fclose(fp);
+        alloc_lines = get_next_power_of_two(efile->n_elines+n_lines);
+        lines = (eLine **) realloc(efile->lines,
+                                   alloc_lines*sizeof(eLine *));
+        if(lines == NULL)
             return -1;
-        }
 
-        /* If it is not the end of line */
-        while(buffer[strlen(buffer)-1] != '\n' && fgets(buffer, BUFFER_LENGTH, fp) != NULL)
-        {
-            if(insert_string_eLine(current, buffer, BUFFER_LENGTH, current->length))
-            {
-                close_eFile(efile);
-                fclose(fp);
-                return -1;
-            }
-        }
+        efile->lines = lines;
+        efile->alloc_lines = alloc_lines;
+    }
 
-        if(efile->n_elines==0)
-            efile->first_file_line = current;
+    if(efile->n_elines > 0)
+    {
+        current = efile->lines[efile->n_elines-1];
+        current->next = first_line;
+        first_line->previous = current;
+    }
+    else
+        efile->first_file_line = first_line;
 
-        /* Reinit for future lines */
-        efile->n_elines++;
-        previous = current;
-        current = NULL;
+    for(current = first_line; current; current = current->next)
+    {
+        current->line_number = efile->n_elines+1;
+        efile->lines[efile->n_elines++] = current;
+        if(current == last_line)
+            break;
     }
 
-    if(efile->n_elines == 0)
+    /* The cursor is put on the first line */
+    if(efile->current_line == NULL)
     {
-        add_empty_line_eFile(efile, 0);
-        efile->n_elines = 1;
+        efile->current_line = efile->first_file_line;
+        efile->current_pos = 0;
+        efile->first_screen_line = efile->first_file_line;
     }
 
+    return 0;
+}
+
+
+/**
+ * @brief The end_open_eFile() function finish the opening once every line
+ *        is added. An empty file gets an empty line.
+ *
+ * @param efile: eFile pointer
+ */
+void end_open_eFile(eFile * efile)
+{
+    if(efile == NULL || efile->n_elines > 0)
+        return;
+
+    add_first_line_eFile(efile);
     efile->current_line = efile->first_file_line;
     efile->current_pos = 0;
     efile->first_screen_line = efile->first_file_line;
     efile->is_saved = true;
+}
+
+
+/**
+ * @brief The view_eFile() function show the file opened by
+ *        begin_open_eFile() through an eView instead of reading its lines.
+ *        The file gets an empty line, it must not be modified.
+ *
+ * @param efile: eFile pointer
+ *
+ * @return 0 on success or -1 in failure, the lines can still be read.
+ */
+int view_eFile(eFile * efile)
+{
+    if(efile == NULL || efile->n_elines > 0)
+        return -1;
+
+    efile->view = create_eView(efile->fd, efile->file_stat.st_size,
+                               efile->realpath);
+    if(efile->view == NULL)
+        return -1;
+
+    end_open_eFile(efile);
+
+    return 0;
+}
+
+
+/**
+ * @brief The hex_eFile() function show the binary file opened by
+ *        begin_open_eFile() in hexadecimal, through an eHex, instead of
+ *        reading its lines. The file gets an empty line, it must not be
+ *        modified.
+ *
+ * @param efile: eFile pointer
+ *
+ * @return 0 on success or -1 in failure, the lines can still be read.
+ */
+int hex_eFile(eFile * efile)
+{
+    if(efile == NULL || efile->n_elines > 0)
+        return -1;
+
+    efile->hex = create_eHex(efile->fd, efile->file_stat.st_size);
+    if(efile->hex == NULL)
+        return -1;
+
+    end_open_eFile(efile);
 
-    fclose(fp);
     return 0;
 }
 
@@ -219,6 +476,15 @@ void close_eFile(eFile *efile)
 
     eLine *current = efile->first_file_line, *temp=NULL;
 
+    /* The journal of a saved file is not needed anymore */
+    delete_eJournal(&efile->journal, efile->is_saved);
+    delete_eUndo(&efile->undo);
+    delete_eView(&efile->view);
+    delete_eFollow(&efile->follow);
+    delete_eFilter(&efile->filter);
+    delete_eHex(&efile->hex);
+    delete_ePack(&efile->pack);
+
     while(current)
     {
         temp = current->next;
@@ -226,18 +492,29 @@ void close_eFile(eFile *efile)
         current = temp;
     }
 
+    if(efile->fd != -1)
+        close(efile->fd);
+    efile->fd = -1;
+
+    free(efile->lines);
+    efile->lines = NULL;
+    efile->alloc_lines = 0;
     efile->n_elines = 0;
     efile->first_file_line = NULL;
     efile->first_screen_line = NULL;
     efile->current_line = NULL;
     efile->current_pos = 0;
     efile->is_saved = true;
+    memset(&efile->disk_stat, 0, sizeof(struct stat));
+    efile->disk_hash = 0;
 }
 
 
 /**
  * @brief The write_eFile() function write the content of eFile on the
- *        file designed by filename stored in the filename attribute.
+ *        file designed by filename stored in the filename attribute. The
+ *        content is written in a temporary file renamed over the file, see
+ *        eSave.
  *
  * @param efile eFile pointer
  *
@@ -245,10 +522,8 @@ void close_eFile(eFile *efile)
  */
 int write_eFile(eFile *efile)
 {
-    FILE *fp = NULL;
-    eLine *current = NULL;
-    char *buffer = NULL;
-    size_t buffer_length = 0;
+    eSave *save = NULL;
+    int result = 0;
 
     if(efile == NULL)
         return -1;
@@ -259,35 +534,16 @@ int write_eFile(eFile *efile)
     if(efile->permissions != p_READWRITE)
         return -1;
 
-    if((fp = fopen(efile->realpath, "w")) == NULL)
+    if((save = create_eSave(efile, f_FULL)) == NULL)
         return -1;
 
-    current = efile->first_file_line;
-
-    while(current)
-    {
-        /* Realloc buffer if necessary, first time realloc is equal
-           to malloc */
-        if(buffer_length < current->length+2)
-        {
-            buffer_length = sizeof(char)*(current->length+2);
-            buffer = (char *) realloc(buffer, buffer_length);
-        }
-
-        memset(buffer, 0, buffer_length);
-        memcpy(buffer, current->string, current->length);
-        buffer[current->length] = '\n';
-
-        if(fputs(buffer, fp) == EOF)
-        {
-            fclose(fp);
-            return -1;
-        }
-        current=current->next;
-    }
+    result = write_eSave(save);
+    delete_eSave(&save);
+    if(efile->view != NULL)
+        release_swap_eView(efile->view);
 
-    free(buffer);
-    fclose(fp);
+    if(result == -1)
+        return -1;
 
     efile->is_saved = true;
 
@@ -309,40 +565,46 @@ int add_empty_line_eFile(eFile * efile,
 {
     eLine *current = NULL;
     eLine *new = NULL;
-    unsigned int i = 1;
 
     if(efile == NULL)
         return -1;
 
-    current = efile->first_file_line;
-
     if(efile->first_file_line == NULL)
-    {
-        efile->first_file_line = create_eLine("", 0, 1, NULL, NULL);
-        if(efile->first_file_line == NULL)
-        {
-            return -1;
-        }
+        return add_first_line_eFile(efile);
 
-        efile->n_elines = 1;
-        efile->is_saved = false;
-        return 0;
+    journal_eFile(efile, j_ADD_LINE, line_number, NULL, 0, NULL, 0);
 
-    }
+    /* Current is previous, line 1 is added before the first line */
+    current = (line_number > 1) ? get_line_eFile(efile, line_number-1)
+                                : NULL;
 
-    while(i < line_number-1 && current->next)
+    new = create_eLine("", 0, (current) ? current->line_number+1 : 1,
+                       current,
+                       (current) ? current->next : efile->first_file_line);
+    if(new == NULL)
     {
-        current=current->next;
-        i++;
+        return -1;
     }
 
-    /* Current is previous*/
-    if((new = create_eLine("", 0, line_number, current, current->next)) == NULL)
+    if(insert_index_eFile(efile, new->line_number-1, new) == -1)
     {
+        if(current != NULL)
+            current->next = new->next;
+        if(new->next != NULL)
+            new->next->previous = current;
+        delete_eLine(&new);
         return -1;
     }
     efile->n_elines++;
 
+    if(current == NULL)
+        efile->first_file_line = new;
+
+    undo_eFile(efile, u_DELETE_LINE, new->line_number, 0, NULL, 0, false);
+
+    if(efile->filter != NULL)
+        insert_line_eFilter(efile->filter, new->line_number, "", 0);
+
     /* Increment line number */
     current = new->next;
     while(current)
@@ -370,13 +632,22 @@ int delete_line_eFile(eFile * efile,
 {
     eLine *current = NULL;
     eLine *tmp = NULL;
-    unsigned int i = 1;
+    eJournal *journal = NULL;
+    eUndo *undo = NULL;
     bool last_line=false;
 
-    if(efile == NULL)
+    if(efile == NULL || line_number == 0 || line_number > efile->n_elines)
         return -1;
 
-    current = efile->first_file_line;
+    journal_eFile(efile, j_DELETE_LINE, line_number, NULL, 0, NULL, 0);
+
+    /* The content is inserted back in the added line, or in the new empty
+       line if it is the last one */
+    current = efile->lines[line_number-1];
+    undo_eFile(efile, u_INSERT_STRING, (efile->n_elines > 1) ? line_number : 1,
+               0, current->string, current->length, false);
+    if(efile->n_elines > 1)
+        undo_eFile(efile, u_ADD_LINE, line_number, 0, NULL, 0, false);
 
     if(line_number == efile->current_line->line_number)
     {
@@ -400,21 +671,27 @@ int delete_line_eFile(eFile * efile,
             last_line = true;
     }
 
+    /* The new line is replayed by the deletion, it is not recorded */
     if(last_line)
+    {
+        journal = efile->journal;
+        undo = efile->undo;
+        efile->journal = NULL;
+        efile->undo = NULL;
         add_empty_line_eFile(efile, line_number+1);
+        efile->journal = journal;
+        efile->undo = undo;
+    }
 
 
     if(line_number == efile->first_file_line->line_number)
         efile->first_file_line = efile->first_file_line->next;
 
-    while(current && i < line_number)
-    {
-        current = current->next;
-        i++;
-    }
+    current = efile->lines[line_number-1];
+    remove_index_eFile(efile, line_number-1);
 
-    if(current == NULL)
-        return -1;
+    if(efile->filter != NULL)
+        delete_line_eFilter(efile->filter, line_number);
 
     if(current->next != NULL)
         current->next->previous = current->previous;
@@ -439,6 +716,30 @@ int delete_line_eFile(eFile * efile,
 }
 
 
+/**
+ * @brief The get_line_eFile() function return the line designed by its
+ *        line number in O(1).
+ *
+ * @param efile: eFile pointer
+ * @param line_number: Line number, clamped between 1 and n_elines
+ *
+ * @return eLine pointer or NULL if the file has no line.
+ */
+eLine * get_line_eFile(eFile const * efile,
+                       unsigned int line_number)
+{
+    if(efile == NULL || efile->n_elines == 0)
+        return NULL;
+
+    if(line_number == 0)
+        line_number = 1;
+    else if(line_number > efile->n_elines)
+        line_number = efile->n_elines;
+
+    return efile->lines[line_number-1];
+}
+
+
 /**
  * @brief The insert_char_eFile() insert a character to the current
  *        position in the current_line.
@@ -454,9 +755,16 @@ int insert_char_eFile(eFile * efile,
     if(efile == NULL)
         return -1;
 
+    journal_eFile(efile, j_INSERT_CHAR, (unsigned char) ch, NULL, 0, NULL, 0);
+
     if(insert_char_eLine(efile->current_line, ch, efile->current_pos))
         return -1;
 
+    filter_eFile(efile, efile->current_line->line_number);
+
+    undo_eFile(efile, u_REMOVE_STRING, efile->current_line->line_number,
+               efile->current_pos, NULL, 1, true);
+
     efile->is_saved = false;
     return 0;
 }
@@ -475,9 +783,20 @@ int remove_char_eFile(eFile * efile)
     if(efile == NULL)
         return -1;
 
+    journal_eFile(efile, j_REMOVE_CHAR, 0, NULL, 0, NULL, 0);
+
+    if(efile->current_line != NULL
+       &&
+       efile->current_pos < efile->current_line->length)
+        undo_eFile(efile, u_INSERT_STRING, efile->current_line->line_number,
+                   efile->current_pos,
+                   efile->current_line->string+efile->current_pos, 1, false);
+
     if(remove_char_eLine(efile->current_line, efile->current_pos))
         return -1;
 
+    filter_eFile(efile, efile->current_line->line_number);
+
     efile->is_saved = false;
     return 0;
 }
@@ -498,9 +817,15 @@ int insert_string_eFile(eFile * efile,
                         size_t length)
 {
     int result = 0;
+    size_t old_length = 0;
     if(efile == NULL)
         return -1;
 
+    journal_eFile(efile, j_INSERT_STRING, 0, string, length, NULL, 0);
+
+    if(efile->current_line != NULL)
+        old_length = efile->current_line->length;
+
     result = insert_string_eLine(efile->current_line,
                                  string,
                                  length,
@@ -510,6 +835,13 @@ int insert_string_eFile(eFile * efile,
         return -1;
     }
 
+    filter_eFile(efile, efile->current_line->line_number);
+
+    if(efile->current_line->length > old_length)
+        undo_eFile(efile, u_REMOVE_STRING, efile->current_line->line_number,
+                   efile->current_pos, NULL,
+                   efile->current_line->length-old_length, false);
+
     efile->is_saved = false;
     return 0;
 }
@@ -532,6 +864,18 @@ int remove_string_eFile(eFile *efile,
     if(efile == NULL)
         return -1;
 
+    journal_eFile(efile, j_REMOVE_STRING, length, NULL, 0, NULL, 0);
+
+    if(efile->current_line != NULL
+       &&
+       efile->current_pos < efile->current_line->length)
+        undo_eFile(efile, u_INSERT_STRING, efile->current_line->line_number,
+                   efile->current_pos,
+                   efile->current_line->string+efile->current_pos,
+                   strnlen(efile->current_line->string+efile->current_pos,
+                           length),
+                   false);
+
     result = remove_string_eLine(efile->current_line,
                                  length,
                                  efile->current_pos);
@@ -540,6 +884,1222 @@ int remove_string_eFile(eFile *efile,
         return -1;
     }
 
+    filter_eFile(efile, efile->current_line->line_number);
+
     efile->is_saved = false;
     return 0;
 }
+
+
+/**
+ * @brief The replace_all_eFile() function replace every occurrence of
+ *        pattern in the file by replacement in a single pass.
+ *
+ * @param efile: eFile pointer
+ * @param pattern: String to replace
+ * @param pattern_length: Length of pattern
+ * @param replacement: String replacing pattern
+ * @param replacement_length: Length of replacement
+ *
+ * @return Number of replaced occurrences or -1 in failure.
+ */
+long replace_all_eFile(eFile * efile,
+                       char const * pattern,
+                       size_t pattern_length,
+                       char const * replacement,
+                       size_t replacement_length)
+{
+    eLine *current = NULL;
+    long count = 0;
+    long result = 0;
+    bool matched = false;
+
+    if(efile == NULL || pattern_length == 0)
+        return -1;
+
+    journal_eFile(efile, j_REPLACE_ALL, 0, pattern, pattern_length,
+                  replacement, replacement_length);
+
+    /* Lines are not added or deleted, line numbers do not change */
+    for(current = efile->first_file_line; current; current = current->next)
+    {
+        /* A modified line is undone by restoring its content */
+        matched = efile->undo != NULL
+                  &&
+                  memmem(current->string, current->length,
+                         pattern, pattern_length) != NULL;
+        if(matched)
+            undo_eFile(efile, u_INSERT_STRING, current->line_number, 0,
+                       current->string, current->length, false);
+
+        result = replace_all_eLine(current,
+                                   pattern,
+                                   pattern_length,
+                                   replacement,
+                                   replacement_length);
+        if(matched)
+            undo_eFile(efile, u_REMOVE_STRING, current->line_number, 0,
+                       NULL, current->length, false);
+
+        if(result == -1)
+            break;
+
+        count += result;
+    }
+
+    if(efile->current_line != NULL
+       &&
+       efile->current_pos > efile->current_line->length)
+    {
+        efile->current_pos = efile->current_line->length;
+    }
+
+    /* Any line may have changed, they are scanned again */
+    if(count > 0 && efile->filter != NULL)
+        reset_eFilter(efile->filter);
+
+    if(count > 0)
+        efile->is_saved = false;
+
+    return (result == -1) ? -1 : count;
+}
+
+
+/**
+ * @brief The scan_filter_eFile() function extend the index of the filter
+ *        with the next lines of the file, until it has n_matches matches.
+ *
+ * @param efile: eFile pointer
+ * @param n_matches: Number of matches to reach
+ * @param n_lines: Number of lines scanned at most
+ *
+ * @return 0 on success or -1 in failure.
+ */
+int scan_filter_eFile(eFile * efile,
+                      unsigned int n_matches,
+                      unsigned int n_lines)
+{
+    eFilter *filter = NULL;
+    eLine *line = NULL;
+    char const *string = NULL;
+    size_t length = 0;
+
+    if(efile == NULL || efile->filter == NULL)
+        return -1;
+
+    filter = efile->filter;
+    filter->finished = false;
+
+    while(filter->n_matches < n_matches && n_lines > 0)
+    {
+        /* The lines of a viewed file are indexed as they are scanned */
+        if(efile->view != NULL)
+            string = get_line_eView(efile->view, filter->n_scanned+1,
+                                    &length);
+        else if(filter->n_scanned < efile->n_elines)
+        {
+            line = efile->lines[filter->n_scanned];
+            string = line->string;
+            length = line->length;
+        }
+        else
+            string = NULL;
+
+        if(string == NULL)
+        {
+            filter->finished = true;
+            break;
+        }
+
+        if(add_line_eFilter(filter, string, length) == -1)
+            return -1;
+
+        n_lines--;
+    }
+
+    return 0;
+}
+
+
+/**
+ * @brief The is_changed_eFile() function tell if the file on disk is not
+ *        the one last read or saved: its status changed and, if its hash
+ *        is known, its content. A file only touched gets its new status.
+ *
+ * @param efile: eFile pointer
+ *
+ * @return true if the file was changed by another program, false
+ *         otherwise or if it can not be read.
+ */
+bool is_changed_eFile(eFile * efile)
+{
+    struct stat info;
+    uint64_t hash = HASH_INIT;
+    int fd = -1;
+
+    if(efile == NULL || stat(efile->realpath, &info) == -1)
+        return false;
+
+    if(is_same_status_eFile(&info, &efile->disk_stat))
+        return false;
+
+    if(efile->disk_hash == 0)
+        return true;
+
+    if((fd = open(efile->realpath, O_RDONLY)) == -1)
+        return false;
+
+    if(fstat(fd, &info) == -1 || hash_disk_eFile(fd, &hash) == -1)
+    {
+        close(fd);
+        return false;
+    }
+    close(fd);
+
+    if(hash != efile->disk_hash)
+        return true;
+
+    efile->disk_stat = info;
+
+    return false;
+}
+
+
+/**
+ * @brief The reload_eFile() function read again the file changed on disk
+ *        and replace only the lines which differ, so that the cursor and
+ *        the first line of screen stay on their line. The file is read in
+ *        memory rather than mapped, another program may still truncate
+ *        it. The modifications are lost and the undo history is cleared.
+ *
+ * @param efile: eFile pointer
+ * @param n_changed: Number of lines modified, added or deleted
+ *
+ * @return 0 on success or -1 in failure, the buffer is then unchanged.
+ */
+int reload_eFile(eFile * efile,
+                 unsigned int * n_changed)
+{
+    struct stat info;
+    disk_line *disk = NULL;
+    line_hash *old_hashes = NULL, *disk_hashes = NULL;
+    char *data = NULL;
+    eLine **lines = NULL, **dropped = NULL;
+    eLine *old = NULL, *current = NULL, *screen = NULL;
+    unsigned int n_old = 0, n_disk = 0, n_lines = 0, n_dropped = 0, j = 0;
+    unsigned int alloc_lines = 0;
+    unsigned int deleted = 0, inserted = 0, position = 0;
+    unsigned int current_number = 0, screen_number = 0;
+    uint64_t hash = HASH_INIT;
+    size_t size = 0, limit = UNDO_DEFAULT_LIMIT;
+    int fd = -1, result = 0;
+
+    *n_changed = 0;
+    if(efile == NULL || efile->n_elines == 0
+       ||
+       efile->view != NULL || efile->hex != NULL)
+        return -1;
+
+    if((fd = open(efile->realpath, O_RDONLY)) == -1)
+        return -1;
+
+    if(fstat(fd, &info) == -1
+       ||
+       (data = read_disk_eFile(fd, info.st_size, &size)) == NULL)
+    {
+        close(fd);
+        return -1;
+    }
+
+    /* An empty file gets an empty line */
+    n_old = efile->n_elines;
+    disk = split_disk_eFile(data, size, &n_disk);
+    alloc_lines = get_next_power_of_two((n_disk > 0) ? n_disk : 1);
+    if(disk != NULL)
+    {
+        old_hashes = hash_lines_eFile(efile, NULL, NULL, 0);
+        disk_hashes = hash_lines_eFile(NULL, data, disk, n_disk);
+        lines = (eLine **) malloc(alloc_lines*sizeof(eLine *));
+        dropped = (eLine **) malloc(n_old*sizeof(eLine *));
+    }
+
+    if(disk == NULL || old_hashes == NULL || disk_hashes == NULL
+       ||
+       lines == NULL || dropped == NULL)
+        result = -1;
+
+    current = efile->current_line;
+    screen = efile->first_screen_line;
+    current_number = current->line_number;
+    screen_number = screen->line_number;
+
+    /* The lines are compared in order. On a difference, the next
+       occurrences of both lines tell a block of added or deleted lines
+       from a modified line. The new lines are gathered first, the buffer
+       is only changed once they are all read */
+    old = efile->first_file_line;
+    while(result == 0 && (old != NULL || j < n_disk))
+    {
+        if(old != NULL && j < n_disk
+           &&
+           is_same_line_eFile(old, data, &disk[j]))
+        {
+            lines[n_lines++] = old;
+            old = old->next;
+            j++;
+            continue;
+        }
+
+        deleted = inserted = 0;
+        if(old != NULL && j < n_disk)
+        {
+            hash = hash_bytes(HASH_INIT, data+disk[j].offset,
+                              strnlen(data+disk[j].offset, disk[j].length));
+            position = find_line_hash(old_hashes, n_old, hash,
+                                      old->line_number);
+            if(position != 0
+               &&
+               is_same_line_eFile(efile->lines[position-1], data, &disk[j]))
+                deleted = position-old->line_number;
+
+            hash = hash_bytes(HASH_INIT, old->string, old->length);
+            position = find_line_hash(disk_hashes, n_disk, hash, j+1);
+            if(position != 0
+               &&
+               is_same_line_eFile(old, data, &disk[position-1]))
+                inserted = position-1-j;
+        }
+
+        (*n_changed)++;
+
+        /* Added line, numbered 0 until the lines are linked */
+        if(old == NULL
+           ||
+           (inserted > 0 && (deleted == 0 || inserted <= deleted)))
+        {
+            lines[n_lines] = create_eLine(data+disk[j].offset, disk[j].length,
+                                          0, NULL, NULL);
+            if(lines[n_lines] == NULL)
+            {
+                result = -1;
+                break;
+            }
+            n_lines++;
+            j++;
+        }
+        /* Deleted line, the cursor goes to the line of the same number */
+        else if(j == n_disk || deleted > 0)
+        {
+            if(old == current)
+                current = NULL;
+            if(old == screen)
+                screen = NULL;
+            dropped[n_dropped++] = old;
+            old = old->next;
+        }
+        /* Modified line, the cursor stays on it */
+        else
+        {
+            lines[n_lines] = create_eLine(data+disk[j].offset, disk[j].length,
+                                          0, NULL, NULL);
+            if(lines[n_lines] == NULL)
+            {
+                result = -1;
+                break;
+            }
+            if(old == current)
+                current = lines[n_lines];
+            if(old == screen)
+                screen = lines[n_lines];
+            dropped[n_dropped++] = old;
+            n_lines++;
+            old = old->next;
+            j++;
+        }
+    }
+
+    if(result == 0 && n_lines == 0)
+    {
+        lines[0] = create_eLine("", 0, 0, NULL, NULL);
+        if(lines[0] == NULL)
+            result = -1;
+        else
+            n_lines = 1;
+    }
+
+    free(old_hashes);
+    free(disk_hashes);
+
+    /* The buffer is left as it was */
+    if(result == -1)
+    {
+        for(unsigned int i=0; i<n_lines; i++)
+        {
+            if(lines[i]->line_number == 0)
+                delete_eLine(&lines[i]);
+        }
+        free(lines);
+        free(dropped);
+        free(disk);
+        free(data);
+        close(fd);
+        return -1;
+    }
+
+    for(unsigned int i=0; i<n_dropped; i++)
+        delete_eLine(&dropped[i]);
+    free(dropped);
+
+    /* The lines are in the new file, they can be copied when saving */
+    for(unsigned int i=0; i<n_lines; i++)
+    {
+        lines[i]->line_number = i+1;
+        lines[i]->previous = (i > 0) ? lines[i-1] : NULL;
+        lines[i]->next = (i+1 < n_lines) ? lines[i+1] : NULL;
+        lines[i]->file_offset = (i < n_disk
+                                 &&
+                                 lines[i]->length == disk[i].length
+                                 &&
+                                 disk[i].offset+disk[i].length < size)
+                                ? disk[i].offset : -1;
+    }
+    free(disk);
+
+    free(efile->lines);
+    efile->lines = lines;
+    efile->alloc_lines = alloc_lines;
+    efile->n_elines = n_lines;
+    efile->first_file_line = lines[0];
+
+    if(current == NULL)
+    {
+        current_number = (current_number < n_lines) ? current_number
+                                                    : n_lines;
+        current = lines[current_number-1];
+    }
+    efile->current_line = current;
+    if(efile->current_pos > current->length)
+        efile->current_pos = current->length;
+
+    if(screen == NULL)
+    {
+        screen_number = (screen_number < n_lines) ? screen_number : n_lines;
+        screen = lines[screen_number-1];
+    }
+    efile->first_screen_line = screen;
+
+    hash = (size > 0) ? hash_bytes(HASH_INIT, data, size) : HASH_INIT;
+    free(data);
+
+    /* The file read may be shorter than its status, it is checked again */
+    info.st_size = (off_t) size;
+
+    if(efile->fd != -1)
+        close(efile->fd);
+    efile->fd = fd;
+    efile->file_stat = info;
+    efile->disk_stat = info;
+    efile->disk_hash = hash;
+    efile->is_saved = true;
+
+    /* The records of the journal and of the undo history apply to the
+       previous content */
+    if(efile->journal != NULL)
+    {
+        delete_eJournal(&efile->journal, true);
+        efile->journal = create_eJournal(efile->realpath, &info);
+    }
+
+    if(efile->undo != NULL)
+    {
+        limit = efile->undo->limit;
+        delete_eUndo(&efile->undo);
+        efile->undo = create_eUndo(limit);
+    }
+
+    if(efile->filter != NULL)
+        reset_eFilter(efile->filter);
+
+    return 0;
+}
+
+
+/**
+ * @brief The pack_eFile() function compress the lines of an unused file
+ *        and free them, the position of the cursor is kept.
+ *
+ * @param efile: eFile pointer
+ *
+ * @return 0 on success or -1 in failure, the lines are then kept.
+ */
+int pack_eFile(eFile * efile)
+{
+    ePack *pack = NULL;
+    eLine *current = NULL;
+
+    if(efile == NULL || efile->pack != NULL || efile->n_elines == 0
+       ||
+       efile->view != NULL || efile->hex != NULL || efile->follow != NULL)
+        return -1;
+
+    pack = create_ePack();
+    if(pack == NULL)
+        return -1;
+
+    for(current = efile->first_file_line; current; current = current->next)
+    {
+        if(add_line_ePack(pack, current) == -1)
+        {
+            delete_ePack(&pack);
+            return -1;
+        }
+    }
+
+    if(end_ePack(pack) == -1)
+    {
+        delete_ePack(&pack);
+        return -1;
+    }
+
+    efile->pack = pack;
+    free_lines_eFile(efile);
+
+    return 0;
+}
+
+
+/**
+ * @brief The can_drop_eFile() function return true if the lines of a file
+ *        can be dropped and read again from the file.
+ *
+ * @param efile: eFile pointer
+ *
+ * @return true if the file was read from disk and not modified, false
+ *         otherwise.
+ */
+bool can_drop_eFile(eFile const * efile)
+{
+    /* The lines of a decompressed file are not the bytes of the file */
+    return efile != NULL && efile->is_saved && efile->fd != -1
+           &&
+           efile->view == NULL && efile->hex == NULL && efile->follow == NULL
+           &&
+           (efile->pack != NULL ? !efile->pack->dropped
+                                : efile->n_elines > 0)
+           &&
+           get_decompressor_eLoad(efile->fd) == NULL;
+}
+
+
+/**
+ * @brief The drop_eFile() function free the lines of an unused file which
+ *        was not modified, packed or not, and close it. Only the position
+ *        of the cursor is kept, the lines are read again from the file.
+ *
+ * @param efile: eFile pointer
+ *
+ * @return 0 on success or -1 if the file can not be read again.
+ */
+int drop_eFile(eFile * efile)
+{
+    ePack *pack = NULL;
+    size_t limit = 0;
+
+    if(!can_drop_eFile(efile))
+        return -1;
+
+    pack = create_ePack();
+    if(pack == NULL)
+        return -1;
+
+    pack->dropped = true;
+    if(efile->pack != NULL)
+    {
+        pack->current_line = efile->pack->current_line;
+        pack->current_pos = efile->pack->current_pos;
+        pack->first_screen_line = efile->pack->first_screen_line;
+        delete_ePack(&efile->pack);
+    }
+    efile->pack = pack;
+    free_lines_eFile(efile);
+
+    close(efile->fd);
+    efile->fd = -1;
+    efile->disk_hash = 0;
+
+    /* The file read again may differ, the records would not apply to it */
+    delete_eJournal(&efile->journal, true);
+    if(efile->undo != NULL)
+    {
+        limit = efile->undo->limit;
+        delete_eUndo(&efile->undo);
+        efile->undo = create_eUndo(limit);
+    }
+
+    if(efile->filter != NULL)
+        reset_eFilter(efile->filter);
+
+    return 0;
+}
+
+
+/**
+ * @brief The unpack_eFile() function create again the lines of a packed
+ *        file, or read again a dropped file, and put the cursor back where
+ *        it was. A restored file is opened by the caller first, only its
+ *        cursor is put back.
+ *
+ * @param efile: eFile pointer
+ *
+ * @return 0 on success or if the file is not packed, -1 in failure, the
+ *         file stays packed then.
+ */
+int unpack_eFile(eFile * efile)
+{
+    eLine *first_line = NULL, *last_line = NULL, *current = NULL;
+    ePack *pack = NULL;
+
+    if(efile == NULL || efile->pack == NULL)
+        return 0;
+
+    pack = efile->pack;
+    if(pack->restored)
+    {
+        if(efile->n_elines == 0)
+            return -1;
+    }
+    else if(pack->dropped)
+    {
+        if(read_dropped_eFile(efile) == -1)
+            return -1;
+    }
+    else
+    {
+        if(unpack_ePack(pack, &first_line, &last_line) == -1)
+            return -1;
+
+        if(append_lines_eFile(efile, first_line, last_line,
+                              pack->n_lines) == -1)
+        {
+            for(current = first_line; current; current = last_line)
+            {
+                last_line = current->next;
+                delete_eLine(&current);
+            }
+            return -1;
+        }
+    }
+
+    efile->current_line = get_line_eFile(efile, pack->current_line);
+    efile->first_screen_line = get_line_eFile(efile,
+                                              pack->first_screen_line);
+    if(efile->first_screen_line->line_number
+       >
+       efile->current_line->line_number)
+        efile->first_screen_line = efile->current_line;
+    efile->current_pos = (pack->current_pos <= efile->current_line->length)
+                         ? pack->current_pos
+                         : (unsigned int) efile->current_line->length;
+    delete_ePack(&efile->pack);
+
+    return 0;
+}
+
+
+/**
+ * @brief The restore_eFile() function keep the cursor of a file of a
+ *        previous session without opening it. The file is handled like a
+ *        dropped file until it is opened, then unpack_eFile() puts the
+ *        cursor back.
+ *
+ * @param efile: eFile pointer, not open
+ * @param current_line: Line number of the current line
+ * @param current_pos: Current pos in current line
+ * @param first_screen_line: Line number of the first line of screen
+ *
+ * @return 0 on success or -1 in failure.
+ */
+int restore_eFile(eFile * efile,
+                  unsigned int current_line,
+                  unsigned int current_pos,
+                  unsigned int first_screen_line)
+{
+    if(efile == NULL || efile->pack != NULL || efile->n_elines > 0
+       ||
+       efile->fd != -1)
+        return -1;
+
+    efile->pack = create_ePack();
+    if(efile->pack == NULL)
+        return -1;
+
+    /* It is not read by the watch of the files changed on disk */
+    efile->pack->dropped = true;
+    efile->pack->restored = true;
+    efile->pack->current_line = current_line;
+    efile->pack->current_pos = current_pos;
+    efile->pack->first_screen_line = first_screen_line;
+
+    return 0;
+}
+
+
+/**
+ * @brief The is_restored_eFile() function return true if a file of a
+ *        previous session was not opened yet.
+ *
+ * @param efile: eFile pointer
+ *
+ * @return true if the file must be opened before it is shown, false
+ *         otherwise.
+ */
+bool is_restored_eFile(eFile const * efile)
+{
+    return efile != NULL && efile->pack != NULL && efile->pack->restored;
+}
+
+
+/**
+ * @brief The add_first_line_eFile() function add an empty line to a file
+ *        without line.
+ *
+ * @param efile: eFile pointer
+ *
+ * @return 0 on success or -1 in failure.
+ */
+static int add_first_line_eFile(eFile * efile)
+{
+    efile->first_file_line = create_eLine("", 0, 1, NULL, NULL);
+    if(efile->first_file_line == NULL)
+    {
+        return -1;
+    }
+
+    if(insert_index_eFile(efile, 0, efile->first_file_line) == -1)
+    {
+        delete_eLine(&efile->first_file_line);
+        return -1;
+    }
+
+    efile->n_elines = 1;
+    efile->is_saved = false;
+    return 0;
+}
+
+
+/**
+ * @brief The insert_index_eFile() function insert a line in the line index
+ *        at position index, the following lines are shifted.
+ *
+ * @param efile: eFile pointer
+ * @param index: Position of the line in the index (line number - 1)
+ * @param line: eLine pointer
+ *
+ * @return 0 on success or -1 in failure.
+ */
+static int insert_index_eFile(eFile * efile,
+                              unsigned int index,
+                              eLine * line)
+{
+    eLine **lines = NULL;
+    unsigned int alloc_lines = 0;
+
+    if(efile->n_elines+1 > efile->alloc_lines)
+    {
+        alloc_lines = (efile->alloc_lines != 0) ? efile->alloc_lines*2 : 64;
+        lines = (eLine **) realloc(efile->lines, alloc_lines*sizeof(eLine *));
+        if(lines == NULL)
+            return -1;
+
+        efile->lines = lines;
+        efile->alloc_lines = alloc_lines;
+    }
+
+    memmove(efile->lines+index+1,
+            efile->lines+index,
+            (efile->n_elines-index)*sizeof(eLine *));
+    efile->lines[index] = line;
+
+    return 0;
+}
+
+
+/**
+ * @brief The remove_index_eFile() function remove the line at position
+ *        index from the line index, the following lines are shifted.
+ *
+ * @param efile: eFile pointer
+ * @param index: Position of the line in the index (line number - 1)
+ *
+ * @note n_elines is still the number of lines before the removal.
+ */
+static void remove_index_eFile(eFile * efile,
+                               unsigned int index)
+{
+    memmove(efile->lines+index,
+            efile->lines+index+1,
+            (efile->n_elines-index-1)*sizeof(eLine *));
+}
+
+
+/**
+ * @brief The journal_eFile() function add a record of a modification to
+ *        the journal, with the cursor as it is before the modification.
+ *
+ * @param efile: eFile pointer
+ * @param type: Record type
+ * @param arg: Argument of the record, see add_record_eJournal()
+ * @param data: Data of the record or NULL
+ * @param length: Length of data
+ * @param data2: Second data of the record or NULL
+ * @param length2: Length of data2
+ */
+static void journal_eFile(eFile * efile,
+                          JOURNAL_RECORD type,
+                          unsigned int arg,
+                          char const * data,
+                          size_t length,
+                          char const * data2,
+                          size_t length2)
+{
+    if(efile->journal == NULL)
+        return;
+
+    add_record_eJournal(efile->journal,
+                        type,
+                        (efile->current_line) ? efile->current_line->line_number
+                                              : 1,
+                        efile->current_pos,
+                        arg,
+                        data, length,
+                        data2, length2);
+}
+
+
+/**
+ * @brief The undo_eFile() function add the operation undoing a
+ *        modification to the undo stacks.
+ *
+ * @param efile: eFile pointer
+ * @param type: Operation type
+ * @param line_number: Line number of the operation
+ * @param pos: Position in the line
+ * @param data: Bytes of u_INSERT_STRING or NULL
+ * @param length: Number of bytes, or removed length of u_REMOVE_STRING
+ * @param typing: The modification is a typed character
+ */
+static void undo_eFile(eFile * efile,
+                       UNDO_RECORD type,
+                       unsigned int line_number,
+                       unsigned int pos,
+                       char const * data,
+                       size_t length,
+                       bool typing)
+{
+    if(efile->undo == NULL)
+        return;
+
+    add_record_eUndo(efile->undo, type, line_number, pos, data, length,
+                     typing);
+}
+
+
+/**
+ * @brief The filter_eFile() function scan again a modified line for the
+ *        filter of the file.
+ *
+ * @param efile: eFile pointer
+ * @param line_number: Line number of the modified line
+ */
+static void filter_eFile(eFile * efile,
+                         unsigned int line_number)
+{
+    eLine *line = NULL;
+
+    if(efile->filter == NULL)
+        return;
+
+    line = efile->lines[line_number-1];
+    update_line_eFilter(efile->filter, line_number, line->string,
+                        line->length);
+}
+
+
+/**
+ * @brief The is_same_status_eFile() function tell if two status are of the
+ *        same file with the same size and modification time.
+ *
+ * @param first: First status
+ * @param second: Second status
+ *
+ * @return true if the status are the same, false otherwise.
+ */
+static bool is_same_status_eFile(struct stat const * first,
+                                 struct stat const * second)
+{
+    return first->st_ino == second->st_ino
+           &&
+           first->st_dev == second->st_dev
+           &&
+           first->st_size == second->st_size
+           &&
+           first->st_mtim.tv_sec == second->st_mtim.tv_sec
+           &&
+           first->st_mtim.tv_nsec == second->st_mtim.tv_nsec;
+}
+
+
+/**
+ * @brief The split_disk_eFile() function cut the content of a file in
+ *        lines.
+ *
+ * @param data: Content of the file
+ * @param size: Size of the content
+ * @param n_lines: Number of lines
+ *
+ * @return Array of the lines, to free, or NULL if it was an error.
+ */
+static disk_line * split_disk_eFile(char const * data,
+                                    off_t size,
+                                    unsigned int * n_lines)
+{
+    disk_line *lines = NULL, *new_lines = NULL;
+    char const *start = data, *end = data+size, *newline = NULL;
+    unsigned int alloc_lines = 64;
+
+    *n_lines = 0;
+    lines = (disk_line *) malloc(alloc_lines*sizeof(disk_line));
+    if(lines == NULL)
+        return NULL;
+
+    while(start < end)
+    {
+        if(*n_lines == alloc_lines)
+        {
+            alloc_lines *= 2;
+            new_lines = (disk_line *) realloc(lines,
+                                              alloc_lines*sizeof(disk_line));
+            if(new_lines == NULL)
+            {
+                free(lines);
+                return NULL;
+            }
+            lines = new_lines;
+        }
+
+        newline = memchr(start, '\n', end-start);
+        lines[*n_lines].offset = start-data;
+        lines[*n_lines].length = (newline != NULL) ? (size_t) (newline-start)
+                                                   : (size_t) (end-start);
+        (*n_lines)++;
+        start = (newline != NULL) ? newline+1 : end;
+    }
+
+    return lines;
+}
+
+
+/**
+ * @brief The is_same_line_eFile() function compare a line with a line of
+ *        the file read again, as create_eLine() would read it.
+ *
+ * @param line: eLine pointer
+ * @param data: Content of the file
+ * @param disk: Line of the file
+ *
+ * @return true if the lines are the same, false otherwise.
+ */
+static bool is_same_line_eFile(eLine const * line,
+                               char const * data,
+                               disk_line const * disk)
+{
+    size_t length = strnlen(data+disk->offset, disk->length);
+
+    return line->length == length
+           &&
+           memcmp(line->string, data+disk->offset, length) == 0;
+}
+
+
+/**
+ * @brief The hash_lines_eFile() function hash the lines of a file, or the
+ *        lines of a file read again, and sort them.
+ *
+ * @param efile: eFile pointer, NULL for the lines read again
+ * @param data: Content of the file read again
+ * @param disk: Lines of the file read again
+ * @param n_disk: Number of lines read again
+ *
+ * @return Array of the hashes, to free, or NULL if it was an error.
+ */
+static line_hash * hash_lines_eFile(eFile const * efile,
+                                    char const * data,
+                                    disk_line const * disk,
+                                    unsigned int n_disk)
+{
+    line_hash *hashes = NULL;
+    unsigned int n_hashes = (efile != NULL) ? efile->n_elines : n_disk;
+    eLine const *line = NULL;
+
+    hashes = (line_hash *) malloc((n_hashes+1)*sizeof(line_hash));
+    if(hashes == NULL)
+        return NULL;
+
+    for(unsigned int i=0; i<n_hashes; i++)
+    {
+        if(efile != NULL)
+        {
+            line = efile->lines[i];
+            hashes[i].hash = hash_bytes(HASH_INIT, line->string,
+                                        line->length);
+        }
+        else
+            hashes[i].hash = hash_bytes(HASH_INIT, data+disk[i].offset,
+                                        strnlen(data+disk[i].offset,
+                                                disk[i].length));
+        hashes[i].position = i+1;
+    }
+
+    qsort(hashes, n_hashes, sizeof(line_hash), compare_line_hash);
+
+    return hashes;
+}
+
+
+/**
+ * @brief The compare_line_hash() function compare two line hashes by hash
+ *        then by position, for qsort().
+ *
+ * @param first: First line_hash
+ * @param second: Second line_hash
+ *
+ * @return Negative, 0 or positive as first is before, equal or after
+ *         second.
+ */
+static int compare_line_hash(void const * first,
+                             void const * second)
+{
+    line_hash const *a = (line_hash const *) first;
+    line_hash const *b = (line_hash const *) second;
+
+    if(a->hash != b->hash)
+        return (a->hash < b->hash) ? -1 : 1;
+
+    return (a->position > b->position) - (a->position < b->position);
+}
+
+
+/**
+ * @brief The find_line_hash() function find the first line with a hash
+ *        after a position.
+ *
+ * @param hashes: Sorted hashes
+ * @param n_hashes: Number of hashes
+ * @param hash: Hash of the line
+ * @param position: Position the line must follow
+ *
+ * @return Position of the line or 0 if there is none.
+ */
+static unsigned int find_line_hash(line_hash const * hashes,
+                                   unsigned int n_hashes,
+                                   uint64_t hash,
+                                   unsigned int position)
+{
+    unsigned int low = 0, high = n_hashes, middle = 0;
+
+    while(low < high)
+    {
+        middle = low+(high-low)/2;
+        if(hashes[middle].hash < hash
+           ||
+           (hashes[middle].hash == hash
+            &&
+            hashes[middle].position <= position))
+            low = middle+1;
+        else
+            high = middle;
+    }
+
+    return (low < n_hashes && hashes[low].hash == hash)
+           ? hashes[low].position : 0;
+}
+
+
+/**
+ * @brief The free_lines_eFile() function keep the position of the cursor
+ *        in the pack of the file and free its lines.
+ *
+ * @param efile: eFile pointer, with its pack
+ */
+static void free_lines_eFile(eFile * efile)
+{
+    eLine *current = efile->first_file_line, *next = NULL;
+
+    if(efile->current_line != NULL)
+    {
+        efile->pack->current_line = efile->current_line->line_number;
+        efile->pack->current_pos = efile->current_pos;
+        efile->pack->first_screen_line =
+            efile->first_screen_line->line_number;
+    }
+
+    while(current)
+    {
+        next = current->next;
+        delete_eLine(&current);
+        current = next;
+    }
+
+    free(efile->lines);
+    efile->lines = NULL;
+    efile->alloc_lines = 0;
+    efile->n_elines = 0;
+    efile->first_file_line = NULL;
+    efile->first_screen_line = NULL;
+    efile->current_line = NULL;
+    efile->current_pos = 0;
+}
+
+
+/**
+ * @brief The read_dropped_eFile() function open again a dropped file and
+ *        read its lines, as they are now on disk.
+ *
+ * @param efile: eFile pointer
+ *
+ * @return 0 on success or -1 in failure, the file stays dropped then.
+ */
+static int read_dropped_eFile(eFile * efile)
+{
+    eLoad *load = NULL;
+    eLine *first_line = NULL, *last_line = NULL, *current = NULL;
+    unsigned int n_lines = 0;
+    struct stat info;
+    int result = 0;
+
+    efile->fd = open(efile->realpath, O_RDONLY);
+    if(efile->fd == -1)
+        return -1;
+
+    if(fstat(efile->fd, &info) == 0)
+    {
+        efile->file_stat = info;
+        load = create_eLoad(efile);
+    }
+
+    if(load == NULL)
+    {
+        close(efile->fd);
+        efile->fd = -1;
+        return -1;
+    }
+
+    result = read_eLoad(load);
+    n_lines = take_lines_eLoad(load, &first_line, &last_line);
+    if(result == 0 && n_lines > 0)
+        result = append_lines_eFile(efile, first_line, last_line, n_lines);
+    efile->disk_hash = load->hash;
+    delete_eLoad(&load);
+
+    if(result == -1)
+    {
+        for(current = first_line; current; current = first_line)
+        {
+            first_line = current->next;
+            delete_eLine(&current);
+        }
+        close(efile->fd);
+        efile->fd = -1;
+        efile->disk_hash = 0;
+        return -1;
+    }
+
+    end_open_eFile(efile);
+    efile->disk_stat = info;
+
+    /* Unsaved modifications are journaled, see eJournal */
+    if(efile->permissions == p_READWRITE)
+        efile->journal = create_eJournal(efile->realpath, &info);
+
+    return 0;
+}
+
+
+/**
+ * @brief The hash_disk_eFile() function hash the content of a file, read
+ *        by blocks.
+ *
+ * @param fd: Descriptor of the file
+ * @param hash: Hash of the content
+ *
+ * @return 0 on success or -1 in failure.
+ */
+static int hash_disk_eFile(int fd,
+                           uint64_t * hash)
+{
+    char *buffer = NULL;
+    off_t offset = 0;
+    ssize_t n_read = 0;
+
+    buffer = (char *) malloc(DISK_BLOCK_LENGTH);
+    if(buffer == NULL)
+        return -1;
+
+    *hash = HASH_INIT;
+    while((n_read = pread(fd, buffer, DISK_BLOCK_LENGTH, offset)) != 0)
+    {
+        if(n_read == -1 && errno == EINTR)
+            continue;
+        if(n_read == -1)
+            break;
+
+        *hash = hash_bytes(*hash, buffer, n_read);
+        offset += n_read;
+    }
+    free(buffer);
+
+    return (n_read == -1) ? -1 : 0;
+}
+
+
+/**
+ * @brief The read_disk_eFile() function read a file in memory. A file
+ *        truncated meanwhile is read up to its new end.
+ *
+ * @param fd: Descriptor of the file
+ * @param size: Size of the file
+ * @param length: Number of bytes read
+ *
+ * @return Content of the file, to free, or NULL if it was an error.
+ */
+static char * read_disk_eFile(int fd,
+                              off_t size,
+                              size_t * length)
+{
+    char *data = NULL;
+    ssize_t n_read = 0;
+
+    /* An empty file gets a buffer too */
+    data = (char *) malloc((size_t) size+1);
+    if(data == NULL)
+        return NULL;
+
+    *length = 0;
+    while(*length < (size_t) size)
+    {
+        n_read = pread(fd, data+*length, (size_t) size-*length,
+                       (off_t) *length);
+        if(n_read == -1 && errno == EINTR)
+            continue;
+        if(n_read == -1)
+        {
+            free(data);
+            return NULL;
+        }
+        if(n_read == 0)
+            break;
+        *length += n_read;
+    }
+
+    return data;
+}
@@ -0,0 +1,314 @@
+/**
+ * @file eFilter.c
+ * @brief Contain eFilter structure and functions
+ * @author ALARY Dorian
+ * @version 1.0
+ * @date 21/07/2024
+ * @copyright GNU Public License.
+ *
+ * @details This file contains the functions used to index the lines of a
+ *          file matching a regular expression. The index only covers the
+ *          first lines of the file, it is extended as the lines are needed
+ *          and shifted when lines are added or deleted.
+ */
+
+#include "eFilter.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+
+static bool match_eFilter(eFilter const * filter,
+                          char const * string,
+                          size_t length);
+static int insert_match_eFilter(eFilter * filter,
+                                unsigned int index,
+                                unsigned int line_number);
+
+
+/**
+ * @brief The create_eFilter() function compile a pattern and allocate an
+ *        eFilter with an empty index.
+ *
+ * @param pattern: Extended regular expression, ex "ERROR|timeout"
+ *
+ * @return eFilter pointer or NULL if it was an error or the pattern is
+ *         invalid.
+ *
+ * @note delete_eFilter() must be called before exiting.
+ */
+eFilter * create_eFilter(char const * pattern)
+{
+    eFilter *filter = NULL;
+
+    if(pattern == NULL)
+        return NULL;
+
+    filter = (eFilter *) malloc(sizeof(eFilter));
+    if(filter == NULL)
+        return NULL;
+
+    if(regcomp(&filter->regex, pattern, REG_EXTENDED | REG_NOSUB) != 0)
+    {
+        free(filter);
+        return NULL;
+    }
+
+    filter->matches = NULL;
+    filter->n_matches = 0;
+    filter->alloc_matches = 0;
+    filter->n_scanned = 0;
+    filter->finished = false;
+    filter->first_screen_match = 0;
+
+    return filter;
+}
+
+
+/**
+ * @brief The delete_eFilter() function deallocate eFilter and set the
+ *        pointer to NULL.
+ *
+ * @param filter: eFilter pointer pointer
+ */
+void delete_eFilter(eFilter ** filter)
+{
+    if(*filter == NULL)
+        return;
+
+    regfree(&(*filter)->regex);
+    free((*filter)->matches);
+    free(*filter);
+    *filter = NULL;
+}
+
+
+/**
+ * @brief The add_line_eFilter() function scan the line following the
+ *        scanned lines.
+ *
+ * @param filter: eFilter pointer
+ * @param string: Content of the line, not necessarily terminated by 0
+ * @param length: Length of the line
+ *
+ * @return 0 on success or -1 in failure.
+ */
+int add_line_eFilter(eFilter * filter,
+                     char const * string,
+                     size_t length)
+{
+    if(match_eFilter(filter, string, length)
+       &&
+       insert_match_eFilter(filter, filter->n_matches,
+                            filter->n_scanned+1) == -1)
+        return -1;
+
+    filter->n_scanned++;
+
+    return 0;
+}
+
+
+/**
+ * @brief The update_line_eFilter() function scan again a modified line.
+ *
+ * @param filter: eFilter pointer
+ * @param line_number: Line number
+ * @param string: Content of the line, not necessarily terminated by 0
+ * @param length: Length of the line
+ *
+ * @return 0 on success or -1 in failure.
+ */
+int update_line_eFilter(eFilter * filter,
+                        unsigned int line_number,
+                        char const * string,
+                        size_t length)
+{
+    unsigned int index = 0;
+    bool indexed = false, matched = false;
+
+    /* The line will be scanned with the next ones */
+    if(line_number > filter->n_scanned)
+        return 0;
+
+    index = find_eFilter(filter, line_number);
+    indexed = (index < filter->n_matches
+               &&
+               filter->matches[index] == line_number);
+    matched = match_eFilter(filter, string, length);
+
+    if(matched && !indexed)
+        return insert_match_eFilter(filter, index, line_number);
+
+    if(!matched && indexed)
+    {
+        memmove(filter->matches+index, filter->matches+index+1,
+                (filter->n_matches-index-1)*sizeof(unsigned int));
+        filter->n_matches--;
+    }
+
+    return 0;
+}
+
+
+/**
+ * @brief The insert_line_eFilter() function shift the index after a line
+ *        was inserted, and scan the new line.
+ *
+ * @param filter: eFilter pointer
+ * @param line_number: Line number of the new line
+ * @param string: Content of the line, not necessarily terminated by 0
+ * @param length: Length of the line
+ *
+ * @return 0 on success or -1 in failure.
+ */
+int insert_line_eFilter(eFilter * filter,
+                        unsigned int line_number,
+                        char const * string,
+                        size_t length)
+{
+    unsigned int index = 0;
+
+    if(line_number > filter->n_scanned)
+        return 0;
+
+    index = find_eFilter(filter, line_number);
+    for(unsigned int i=index; i<filter->n_matches; i++)
+        filter->matches[i]++;
+    filter->n_scanned++;
+
+    if(match_eFilter(filter, string, length))
+        return insert_match_eFilter(filter, index, line_number);
+
+    return 0;
+}
+
+
+/**
+ * @brief The delete_line_eFilter() function shift the index after a line
+ *        was deleted.
+ *
+ * @param filter: eFilter pointer
+ * @param line_number: Line number of the deleted line
+ */
+void delete_line_eFilter(eFilter * filter,
+                         unsigned int line_number)
+{
+    unsigned int index = 0;
+
+    if(line_number > filter->n_scanned)
+        return;
+
+    index = find_eFilter(filter, line_number);
+    if(index < filter->n_matches && filter->matches[index] == line_number)
+    {
+        memmove(filter->matches+index, filter->matches+index+1,
+                (filter->n_matches-index-1)*sizeof(unsigned int));
+        filter->n_matches--;
+    }
+
+    for(unsigned int i=index; i<filter->n_matches; i++)
+        filter->matches[i]--;
+    filter->n_scanned--;
+}
+
+
+/**
+ * @brief The reset_eFilter() function empty the index, every line is
+ *        scanned again.
+ *
+ * @param filter: eFilter pointer
+ */
+void reset_eFilter(eFilter * filter)
+{
+    filter->n_matches = 0;
+    filter->n_scanned = 0;
+    filter->finished = false;
+    filter->first_screen_match = 0;
+}
+
+
+/**
+ * @brief The find_eFilter() function find the first matching line from a
+ *        line number, among the scanned lines.
+ *
+ * @param filter: eFilter pointer
+ * @param line_number: Line number
+ *
+ * @return Index of the match or n_matches if there is none.
+ */
+unsigned int find_eFilter(eFilter const * filter,
+                          unsigned int line_number)
+{
+    unsigned int low = 0, high = filter->n_matches, middle = 0;
+
+    while(low < high)
+    {
+        middle = low+(high-low)/2;
+        if(filter->matches[middle] < line_number)
+            low = middle+1;
+        else
+            high = middle;
+    }
+
+    return low;
+}
+
+
+/**
+ * @brief The match_eFilter() function test a line against the pattern.
+ *
+ * @param filter: eFilter pointer
+ * @param string: Content of the line, not necessarily terminated by 0
+ * @param length: Length of the line
+ *
+ * @return true if the line matches, false otherwise.
+ */
+static bool match_eFilter(eFilter const * filter,
+                          char const * string,
+                          size_t length)
+{
+    /* The bounds of the line are given, it does not need a 0 */
+    regmatch_t bounds = {0, (regoff_t) length};
+
+    return regexec(&filter->regex, string, 1, &bounds, REG_STARTEND) == 0;
+}
+
+
+/**
+ * @brief The insert_match_eFilter() function insert a line number in the
+ *        index.
+ *
+ * @param filter: eFilter pointer
+ * @param index: Position of the line number in the index
+ * @param line_number: Line number
+ *
+ * @return 0 on success or -1 in failure.
+ */
+static int insert_match_eFilter(eFilter * filter,
+                                unsigned int index,
+                                unsigned int line_number)
+{
+    unsigned int *matches = NULL;
+    unsigned int alloc_matches = 0;
+
+    if(filter->n_matches+1 > filter->alloc_matches)
+    {
+        alloc_matches = (filter->alloc_matches != 0)
+                        ? filter->alloc_matches*2 : 64;
+        matches = (unsigned int *) realloc(filter->matches,
+                                           alloc_matches*sizeof(unsigned int));
+        if(matches == NULL)
+            return -1;
+
+        filter->matches = matches;
+        filter->alloc_matches = alloc_matches;
+    }
+
+    memmove(filter->matches+index+1, filter->matches+index,
+            (filter->n_matches-index)*sizeof(unsigned int));
+    filter->matches[index] = line_number;
+    filter->n_matches++;
+
+    return 0;
+}
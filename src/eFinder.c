@@ -0,0 +1,707 @@
+/**
+ * @file eFinder.c
+ * @brief Contain eFinder structure and functions
+ * @author ALARY Dorian
+ * @version 1.0
+ * @date 21/07/2024
+ * @copyright GNU Public License.
+ *
+ * @details This file contains all the structures, variables and functions
+ *          used to fuzzy find a file in the directory tree. Paths are copied
+ *          once in flat arenas with their lowercase version and the bonus of
+ *          each character, so a search only reads contiguous memory. The
+ *          scoring is split between several threads, each thread keeps its
+ *          own top-K heap and the heaps are merged at the end.
+ */
+
+#include "eFinder.h"
+#include "eDirectory.h"
+#include "eFile.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h> /* tolower */
+#include <limits.h> /* INT_MIN */
+#include <unistd.h> /* sysconf */
+#include <pthread.h>
+
+
+#define FINDER_MAX_THREADS 8 /* Maximum number of scoring threads */
+#define FINDER_MIN_PER_THREAD 16384 /* Minimum paths scored by a thread */
+
+/* Scoring constants */
+#define SCORE_MATCH 16
+#define SCORE_GAP_START -3
+#define SCORE_GAP_EXTENSION -1
+#define BONUS_CONSECUTIVE 8
+#define BONUS_BOUNDARY 8
+#define BONUS_CAMEL 6
+#define BONUS_BASENAME_START 12
+#define BONUS_IN_BASENAME 2
+
+
+/**
+ * @struct finder_job structure given to a scoring thread.
+ */
+typedef struct {
+
+    /** eFinder to read */
+    eFinder const * finder;
+
+    /** Paths to score or NULL to score every path */
+    unsigned int const * candidates;
+
+    /** First element of candidates to score */
+    unsigned int begin;
+
+    /** Last element (excluded) of candidates to score */
+    unsigned int end;
+
+    /** Lowercase pattern */
+    char const * query;
+
+    /** Pattern length */
+    size_t query_length;
+
+    /** Bitset of the characters of the pattern */
+    uint64_t query_mask;
+
+    /** Matching paths, written from matches[begin] */
+    unsigned int * matches;
+
+    /** Number of matching paths */
+    unsigned int n_matches;
+
+    /** Min-heap of the best results */
+    eFinderResult top[FINDER_MAX_RESULTS];
+
+    /** Number of elements in top */
+    unsigned int n_top;
+
+} finder_job;
+
+
+static int fill_eFinder(eFinder * finder,
+                        eDirectory const * directory,
+                        size_t root_length);
+static int add_path_eFinder(eFinder * finder,
+                            eFile * file,
+                            char const * path);
+static int score_path(eFinder const * finder,
+                      unsigned int index,
+                      char const * query,
+                      size_t query_length);
+static void push_result(eFinderResult * heap,
+                        unsigned int * n_heap,
+                        int score,
+                        unsigned int index);
+static void * run_finder_job(void * arg);
+static int compare_results(void const * a,
+                           void const * b);
+
+
+/**
+ * @brief The char_mask() function return the bit of a lowercase character
+ *        in a path bitset. Several characters can share a bit, the mask is
+ *        only used to reject paths quickly.
+ *
+ * @param ch: Lowercase character
+ *
+ * @return Bit of the character.
+ */
+static inline uint64_t char_mask(unsigned char ch)
+{
+    return (uint64_t) 1 << (ch & 63);
+}
+
+
+/**
+ * @brief The create_eFinder() function allocate an eFinder and build the
+ *        path table of every file under directory.
+ *
+ * @param directory: Root eDirectory
+ *
+ * @return eFinder pointer or NULL if it was an error.
+ *
+ * @note delete_eFinder() must be called before exiting.
+ */
+eFinder * create_eFinder(eDirectory const * directory)
+{
+    eFinder *finder = NULL;
+    size_t root_length = 0;
+
+    if(directory == NULL)
+        return NULL;
+
+    finder = (eFinder *) malloc(sizeof(eFinder));
+    if(finder == NULL)
+        return NULL;
+
+    memset(finder, 0, sizeof(eFinder));
+
+    finder->offsets = (size_t *) malloc(sizeof(size_t));
+    if(finder->offsets == NULL)
+    {
+        free(finder);
+        return NULL;
+    }
+    finder->offsets[0] = 0;
+
+    /* Paths are displayed relative to the root directory */
+    root_length = strlen(directory->realpath)+1;
+
+    if(fill_eFinder(finder, directory, root_length) == -1)
+    {
+        delete_eFinder(&finder);
+        return NULL;
+    }
+
+    return finder;
+}
+
+
+/**
+ * @brief The delete_eFinder() function deallocate eFinder and set the
+ *        pointer to NULL.
+ *
+ * @param finder: eFinder pointer pointer
+ */
+void delete_eFinder(eFinder ** finder)
+{
+    if(*finder == NULL)
+        return;
+
+    free((*finder)->files);
+    free((*finder)->paths);
+    free((*finder)->lower_paths);
+    free((*finder)->bonus);
+    free((*finder)->offsets);
+    free((*finder)->basenames);
+    free((*finder)->masks);
+    free((*finder)->candidates);
+    free((*finder)->last_query);
+    free(*finder);
+    *finder = NULL;
+}
+
+
+/**
+ * @brief The search_eFinder() function score every path against pattern
+ *        and keep the best results in finder->results.
+ *
+ * @param finder: eFinder pointer
+ * @param pattern: Characters to match, in order, case insensitive
+ *
+ * @return Number of results or -1 in failure.
+ */
+int search_eFinder(eFinder * finder,
+                   char const * pattern)
+{
+    finder_job jobs[FINDER_MAX_THREADS];
+    pthread_t threads[FINDER_MAX_THREADS];
+    bool started[FINDER_MAX_THREADS];
+    eFinderResult merged[FINDER_MAX_THREADS*FINDER_MAX_RESULTS];
+    unsigned int n_merged = 0;
+    unsigned int *matches = NULL;
+    unsigned int const *source = NULL;
+    unsigned int n_source = 0;
+    unsigned int n_matches = 0;
+    unsigned int n_threads = 1;
+    unsigned int slice = 0;
+    long n_cpu = 0;
+    char *query = NULL;
+    size_t query_length = 0;
+    uint64_t query_mask = 0;
+
+    if(finder == NULL || pattern == NULL)
+        return -1;
+
+    query_length = strlen(pattern);
+    query = strdup(pattern);
+    if(query == NULL)
+        return -1;
+
+    for(size_t i=0; i<query_length; i++)
+    {
+        query[i] = tolower((unsigned char) query[i]);
+        query_mask |= char_mask(query[i]);
+    }
+
+    /* Empty pattern: the first paths of the tree */
+    if(query_length == 0)
+    {
+        finder->n_results = 0;
+        for(unsigned int i=0; i<finder->n_paths &&
+                              i<FINDER_MAX_RESULTS; i++)
+        {
+            finder->results[i].score = 0;
+            finder->results[i].index = i;
+            finder->n_results++;
+        }
+        free(finder->candidates);
+        finder->candidates = NULL;
+        free(finder->last_query);
+        finder->last_query = query;
+        return finder->n_results;
+    }
+
+    /* A pattern extending the last one can only match its candidates */
+    if(finder->candidates != NULL
+       &&
+       finder->last_query != NULL
+       &&
+       !strncmp(query, finder->last_query, strlen(finder->last_query)))
+    {
+        source = finder->candidates;
+        n_source = finder->n_candidates;
+    }
+    else
+    {
+        source = NULL;
+        n_source = finder->n_paths;
+    }
+
+    matches = (unsigned int *) malloc((n_source+1)*sizeof(unsigned int));
+    if(matches == NULL)
+    {
+        free(query);
+        return -1;
+    }
+
+    n_cpu = sysconf(_SC_NPROCESSORS_ONLN);
+    n_threads = n_source/FINDER_MIN_PER_THREAD + 1;
+    if(n_cpu > 0 && n_threads > (unsigned int) n_cpu)
+        n_threads = n_cpu;
+    if(n_threads > FINDER_MAX_THREADS)
+        n_threads = FINDER_MAX_THREADS;
+
+    slice = n_source/n_threads + 1;
+
+    for(unsigned int i=0; i<n_threads; i++)
+    {
+        jobs[i].finder = finder;
+        jobs[i].candidates = source;
+        jobs[i].begin = (i*slice < n_source) ? i*slice : n_source;
+        jobs[i].end = (jobs[i].begin+slice < n_source) ? jobs[i].begin+slice
+                                                       : n_source;
+        jobs[i].query = query;
+        jobs[i].query_length = query_length;
+        jobs[i].query_mask = query_mask;
+        jobs[i].matches = matches;
+        jobs[i].n_matches = 0;
+        jobs[i].n_top = 0;
+        started[i] = false;
+    }
+
+    /* The calling thread scores the first slice */
+    for(unsigned int i=1; i<n_threads; i++)
+    {
+        started[i] = !pthread_create(&threads[i], NULL,
+                                     run_finder_job, &jobs[i]);
+    }
+    run_finder_job(&jobs[0]);
+
+    for(unsigned int i=1; i<n_threads; i++)
+    {
+        if(started[i])
+            pthread_join(threads[i], NULL);
+        else
+            run_finder_job(&jobs[i]);
+    }
+
+    /* Compact the matches of every slice and merge the heaps */
+    for(unsigned int i=0; i<n_threads; i++)
+    {
+        memmove(matches+n_matches,
+                matches+jobs[i].begin,
+                jobs[i].n_matches*sizeof(unsigned int));
+        n_matches += jobs[i].n_matches;
+
+        memcpy(merged+n_merged,
+               jobs[i].top,
+               jobs[i].n_top*sizeof(eFinderResult));
+        n_merged += jobs[i].n_top;
+    }
+
+    qsort(merged, n_merged, sizeof(eFinderResult), compare_results);
+
+    finder->n_results = (n_merged < FINDER_MAX_RESULTS) ? n_merged
+                                                        : FINDER_MAX_RESULTS;
+    memcpy(finder->results, merged, finder->n_results*sizeof(eFinderResult));
+
+    free(finder->candidates);
+    finder->candidates = matches;
+    finder->n_candidates = n_matches;
+
+    free(finder->last_query);
+    finder->last_query = query;
+
+    return finder->n_results;
+}
+
+
+/**
+ * @brief The get_path_eFinder() function return the path of the ith
+ *        result of the last search.
+ *
+ * @param finder: eFinder pointer
+ * @param index: Result index
+ *
+ * @return Path or NULL if index is out of results.
+ */
+char const * get_path_eFinder(eFinder const * finder,
+                              unsigned int index)
+{
+    if(finder == NULL || index >= finder->n_results)
+        return NULL;
+
+    return finder->paths + finder->offsets[finder->results[index].index];
+}
+
+
+/**
+ * @brief The get_file_eFinder() function return the eFile of the ith
+ *        result of the last search.
+ *
+ * @param finder: eFinder pointer
+ * @param index: Result index
+ *
+ * @return eFile pointer or NULL if index is out of results.
+ */
+eFile * get_file_eFinder(eFinder const * finder,
+                         unsigned int index)
+{
+    if(finder == NULL || index >= finder->n_results)
+        return NULL;
+
+    return finder->files[finder->results[index].index];
+}
+
+
+/**
+ * @brief The fill_eFinder() function add every file of directory and its
+ *        children to the path table.
+ *
+ * @param finder: eFinder pointer
+ * @param directory: eDirectory pointer
+ * @param root_length: Length of the root path prefix to skip
+ *
+ * @return 0 on success or -1 in failure.
+ * @note This is a recursive function.
+ */
+static int fill_eFinder(eFinder * finder,
+                        eDirectory const * directory,
+                        size_t root_length)
+{
+    char const *path = NULL;
+
+    for(unsigned int i=0; i<directory->n_dirs; i++)
+    {
+        if(directory->dirs[i] == NULL)
+            continue;
+
+        if(fill_eFinder(finder, directory->dirs[i], root_length) == -1)
+            return -1;
+    }
+
+    for(unsigned int i=0; i<directory->n_files; i++)
+    {
+        if(directory->files[i] == NULL)
+            continue;
+
+        path = directory->files[i]->realpath;
+        path += (strlen(path) > root_length) ? root_length : 0;
+
+        if(add_path_eFinder(finder, directory->files[i], path) == -1)
+            return -1;
+    }
+
+    return 0;
+}
+
+
+/**
+ * @brief The add_path_eFinder() function append a path to the table and
+ *        precompute its lowercase version, bonus and character mask.
+ *
+ * @param finder: eFinder pointer
+ * @param file: eFile of the path
+ * @param path: Path to add
+ *
+ * @return 0 on success or -1 in failure.
+ */
+static int add_path_eFinder(eFinder * finder,
+                            eFile * file,
+                            char const * path)
+{
+    size_t length = strlen(path);
+    size_t offset = finder->arena_size;
+    char const *basename = NULL;
+    unsigned char previous = 0, current = 0;
+    uint64_t mask = 0;
+
+    /* Reallocate the path table */
+    if(finder->n_paths+1 > finder->alloc_paths)
+    {
+        unsigned int alloc = (finder->alloc_paths) ? finder->alloc_paths*2
+                                                   : 64;
+        eFile **files = realloc(finder->files, alloc*sizeof(eFile *));
+        if(files == NULL)
+            return -1;
+        finder->files = files;
+
+        size_t *offsets = realloc(finder->offsets, (alloc+1)*sizeof(size_t));
+        if(offsets == NULL)
+            return -1;
+        finder->offsets = offsets;
+
+        uint32_t *basenames = realloc(finder->basenames,
+                                      alloc*sizeof(uint32_t));
+        if(basenames == NULL)
+            return -1;
+        finder->basenames = basenames;
+
+        uint64_t *masks = realloc(finder->masks, alloc*sizeof(uint64_t));
+        if(masks == NULL)
+            return -1;
+        finder->masks = masks;
+
+        finder->alloc_paths = alloc;
+    }
+
+    /* Reallocate the arenas */
+    if(finder->arena_size+length+1 > finder->alloc_arena)
+    {
+        size_t alloc = (finder->alloc_arena) ? finder->alloc_arena*2 : 4096;
+        while(alloc < finder->arena_size+length+1)
+            alloc *= 2;
+
+        char *paths = realloc(finder->paths, alloc);
+        if(paths == NULL)
+            return -1;
+        finder->paths = paths;
+
+        char *lower_paths = realloc(finder->lower_paths, alloc);
+        if(lower_paths == NULL)
+            return -1;
+        finder->lower_paths = lower_paths;
+
+        unsigned char *bonus = realloc(finder->bonus, alloc);
+        if(bonus == NULL)
+            return -1;
+        finder->bonus = bonus;
+
+        finder->alloc_arena = alloc;
+    }
+
+    basename = strrchr(path, '/');
+    basename = (basename != NULL) ? basename+1 : path;
+
+    memcpy(finder->paths+offset, path, length+1);
+
+    for(size_t i=0; i<=length; i++)
+    {
+        current = (unsigned char) path[i];
+        finder->lower_paths[offset+i] = tolower(current);
+        mask |= char_mask(tolower(current));
+
+        if(path+i == basename)
+            finder->bonus[offset+i] = BONUS_BASENAME_START;
+        else if(i == 0 || strchr("/_-. ", previous) != NULL)
+            finder->bonus[offset+i] = BONUS_BOUNDARY;
+        else if(islower(previous) && isupper(current))
+            finder->bonus[offset+i] = BONUS_CAMEL;
+        else
+            finder->bonus[offset+i] = 0;
+
+        previous = current;
+    }
+
+    finder->files[finder->n_paths] = file;
+    finder->basenames[finder->n_paths] = basename - path;
+    finder->masks[finder->n_paths] = mask;
+    finder->n_paths++;
+    finder->arena_size += length+1;
+    finder->offsets[finder->n_paths] = finder->arena_size;
+
+    return 0;
+}
+
+
+/**
+ * @brief The score_path() function score a path against the pattern. The
+ *        first match is searched forward, then the match window is shrunk
+ *        backward and the characters of the window are scored.
+ *
+ * @param finder: eFinder pointer
+ * @param index: Index of the path
+ * @param query: Lowercase pattern
+ * @param query_length: Pattern length
+ *
+ * @return Score of the path or INT_MIN if the path does not match.
+ */
+static int score_path(eFinder const * finder,
+                      unsigned int index,
+                      char const * query,
+                      size_t query_length)
+{
+    char const *path = finder->lower_paths + finder->offsets[index];
+    unsigned char const *bonus = finder->bonus + finder->offsets[index];
+    size_t length = finder->offsets[index+1] - finder->offsets[index] - 1;
+    size_t basename = finder->basenames[index];
+    size_t start = 0, end = 0, q = 0;
+    long previous = -2;
+    int score = 0;
+
+    /* Forward: end of the first match */
+    for(end=0; end<length; end++)
+    {
+        if(path[end] == query[q] && ++q == query_length)
+            break;
+    }
+    if(q < query_length)
+        return INT_MIN;
+
+    /* Backward: shortest window ending at end */
+    q = query_length-1;
+    for(start=end; ; start--)
+    {
+        if(path[start] == query[q])
+        {
+            if(q == 0)
+                break;
+            q--;
+        }
+    }
+
+    /* Score the window */
+    q = 0;
+    for(size_t i=start; i<=end; i++)
+    {
+        if(q < query_length && path[i] == query[q])
+        {
+            score += SCORE_MATCH + bonus[i];
+            if(previous == (long) i-1)
+                score += BONUS_CONSECUTIVE;
+            if(i >= basename)
+                score += BONUS_IN_BASENAME;
+            previous = i;
+            q++;
+        }
+        else
+        {
+            score += (previous == (long) i-1) ? SCORE_GAP_START
+                                              : SCORE_GAP_EXTENSION;
+        }
+    }
+
+    /* Prefer short paths */
+    score -= length/16;
+
+    return score;
+}
+
+
+/**
+ * @brief The push_result() function push a result in a min-heap of
+ *        FINDER_MAX_RESULTS elements. If the heap is full, the result
+ *        replaces the worst one if it is better.
+ *
+ * @param heap: Min-heap
+ * @param n_heap: Number of elements in the heap
+ * @param score: Score of the result
+ * @param index: Index of the path
+ */
+static void push_result(eFinderResult * heap,
+                        unsigned int * n_heap,
+                        int score,
+                        unsigned int index)
+{
+    unsigned int i = 0, child = 0;
+    eFinderResult tmp;
+
+    if(*n_heap < FINDER_MAX_RESULTS)
+    {
+        /* Sift up */
+        i = (*n_heap)++;
+        while(i > 0 && heap[(i-1)/2].score > score)
+        {
+            heap[i] = heap[(i-1)/2];
+            i = (i-1)/2;
+        }
+        heap[i].score = score;
+        heap[i].index = index;
+        return;
+    }
+
+    if(score <= heap[0].score)
+        return;
+
+    /* Replace the root and sift down */
+    heap[0].score = score;
+    heap[0].index = index;
+    i = 0;
+    while((child = 2*i+1) < *n_heap)
+    {
+        if(child+1 < *n_heap && heap[child+1].score < heap[child].score)
+            child++;
+        if(heap[i].score <= heap[child].score)
+            break;
+        tmp = heap[i];
+        heap[i] = heap[child];
+        heap[child] = tmp;
+        i = child;
+    }
+}
+
+
+/**
+ * @brief The run_finder_job() function score a slice of paths. Thread
+ *        routine.
+ *
+ * @param arg: finder_job pointer
+ *
+ * @return NULL.
+ */
+static void * run_finder_job(void * arg)
+{
+    finder_job *job = (finder_job *) arg;
+    eFinder const *finder = job->finder;
+    unsigned int index = 0;
+    int score = 0;
+
+    for(unsigned int i=job->begin; i<job->end; i++)
+    {
+        index = (job->candidates) ? job->candidates[i] : i;
+
+        if((finder->masks[index] & job->query_mask) != job->query_mask)
+            continue;
+
+        score = score_path(finder, index, job->query, job->query_length);
+        if(score == INT_MIN)
+            continue;
+
+        job->matches[job->begin + job->n_matches] = index;
+        job->n_matches++;
+        push_result(job->top, &job->n_top, score, index);
+    }
+
+    return NULL;
+}
+
+
+/**
+ * @brief The compare_results() function compare two results for qsort,
+ *        best score first then path order.
+ */
+static int compare_results(void const * a,
+                           void const * b)
+{
+    eFinderResult const *ra = (eFinderResult const *) a;
+    eFinderResult const *rb = (eFinderResult const *) b;
+
+    if(ra->score != rb->score)
+        return (ra->score < rb->score) ? 1 : -1;
+
+    return (ra->index > rb->index) - (ra->index < rb->index);
+}
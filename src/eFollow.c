@@ -0,0 +1,377 @@
+/**
+ * @file eFollow.c
+ * @brief Contain eFollow structure and functions
+ * @author ALARY Dorian
+ * @version 1.0
+ * @date 21/07/2024
+ * @copyright GNU Public License.
+ *
+ * @details This file contains the functions used to follow a growing file,
+ *          like tail -f. inotify tells when the file is modified, then only
+ *          the bytes appended since the last read are read and cut in
+ *          lines. A pipe is read the same way, without waiting, until its
+ *          end.
+ */
+
+#include "eFollow.h"
+#include "eLine.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <sys/stat.h>
+#include <sys/inotify.h>
+
+
+#define FOLLOW_BUFFER_LENGTH (1024*1024) /* Length of the blocks read */
+
+
+static int wait_eFollow(eFollow * follow);
+static int add_bytes_eFollow(eFollow * follow,
+                             eLine * last_line,
+                             eLine ** first_line,
+                             eLine ** new_last_line,
+                             unsigned int * n_lines,
+                             char const * data,
+                             size_t length,
+                             off_t offset);
+
+
+/**
+ * @brief The create_eFollow() function allocate an eFollow reading a file
+ *        from an offset, or a pipe.
+ *
+ * @param realpath: Path of the file, NULL for a pipe
+ * @param fd: Descriptor of the file or of the pipe, it is duplicated
+ * @param offset: Offset of the first byte to read, 0 for a pipe
+ *
+ * @return eFollow pointer or NULL if it was an error.
+ *
+ * @note delete_eFollow() must be called before exiting.
+ */
+eFollow * create_eFollow(char const * realpath,
+                         int fd,
+                         off_t offset)
+{
+    eFollow *follow = NULL;
+    char last = '\n';
+
+    if(fd == -1)
+        return NULL;
+
+    follow = (eFollow *) malloc(sizeof(eFollow));
+    if(follow == NULL)
+        return NULL;
+
+    follow->offset = offset;
+    follow->stream = (realpath == NULL);
+    follow->finished = false;
+    follow->pending = false;
+    follow->pid = -1;
+    follow->inotify_fd = -1;
+    /* The descriptor is not left open in the programs decompressing the
+       next files */
+    follow->fd = fcntl(fd, F_DUPFD_CLOEXEC, 0);
+    if(follow->fd == -1)
+    {
+        delete_eFollow(&follow);
+        return NULL;
+    }
+
+    /* The pipe is read without blocking the interface */
+    if(follow->stream)
+    {
+        follow->open_line = true;
+        if(fcntl(follow->fd, F_SETFL,
+                 fcntl(follow->fd, F_GETFL) | O_NONBLOCK) == -1)
+            delete_eFollow(&follow);
+        return follow;
+    }
+
+    /* The bytes read continue the last line until a '\n' */
+    if(offset > 0 && pread(follow->fd, &last, 1, offset-1) != 1)
+    {
+        delete_eFollow(&follow);
+        return NULL;
+    }
+    follow->open_line = (last != '\n' || offset == 0);
+
+    /* Without inotify, the size of the file is checked every time */
+    follow->inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if(follow->inotify_fd != -1
+       &&
+       inotify_add_watch(follow->inotify_fd, realpath, IN_MODIFY) == -1)
+    {
+        close(follow->inotify_fd);
+        follow->inotify_fd = -1;
+    }
+
+    return follow;
+}
+
+
+/**
+ * @brief The delete_eFollow() function stop watching the file, stop the
+ *        process writing the pipe, deallocate eFollow and set the pointer
+ *        to NULL.
+ *
+ * @param follow: eFollow pointer pointer
+ */
+void delete_eFollow(eFollow ** follow)
+{
+    if(*follow == NULL)
+        return;
+
+    if((*follow)->inotify_fd != -1)
+        close((*follow)->inotify_fd);
+
+    if((*follow)->fd != -1)
+        close((*follow)->fd);
+
+    /* A process still writing the pipe is not needed anymore */
+    if((*follow)->pid != -1)
+    {
+        kill((*follow)->pid, SIGTERM);
+        wait_eFollow(*follow);
+    }
+
+    free(*follow);
+    *follow = NULL;
+}
+
+
+/**
+ * @brief The is_changed_eFollow() function return true if the file was
+ *        modified since the last call, without waiting.
+ *
+ * @param follow: eFollow pointer
+ *
+ * @return true if the file may have grown or bytes are left to read,
+ *         false otherwise.
+ */
+bool is_changed_eFollow(eFollow * follow)
+{
+    char events[4096];
+    struct pollfd input = {follow->fd, POLLIN, 0};
+    bool changed = false;
+    ssize_t n = 0;
+
+    if(follow->stream)
+        return !follow->finished && poll(&input, 1, 0) > 0;
+
+    if(follow->inotify_fd == -1 || follow->pending)
+        return true;
+
+    /* Every pending event is read, one read follows them all */
+    while((n = read(follow->inotify_fd, events, sizeof(events))) > 0
+          ||
+          (n == -1 && errno == EINTR))
+    {
+        if(n > 0)
+            changed = true;
+    }
+
+    return changed;
+}
+
+
+/**
+ * @brief The read_eFollow() function read the bytes appended to the file,
+ *        up to FOLLOW_BUDGET. The bytes until the first '\n' continue
+ *        last_line if the previous read did not end with '\n', the other
+ *        ones are returned as new lines, linked together.
+ *
+ * @param follow: eFollow pointer
+ * @param last_line: Last line of the file
+ * @param first_line: First new line or NULL
+ * @param new_last_line: Last new line or NULL
+ * @param n_lines: Number of new lines
+ *
+ * @return 0 on success or -1 in failure, or if the process writing the
+ *         pipe failed. A truncated file is read again from its start.
+ */
+int read_eFollow(eFollow * follow,
+                 eLine * last_line,
+                 eLine ** first_line,
+                 eLine ** new_last_line,
+                 unsigned int * n_lines)
+{
+    struct stat info;
+    char *buffer = NULL;
+    off_t size = 0, end = 0;
+    size_t length = 0;
+    ssize_t n_read = 0;
+    int result = 0;
+
+    *first_line = *new_last_line = NULL;
+    *n_lines = 0;
+    follow->pending = false;
+
+    if(!follow->stream)
+    {
+        if(fstat(follow->fd, &info) == -1)
+            return -1;
+        size = info.st_size;
+
+        /* Truncated (log rotation by copy), it is read again from the start
+           as new lines */
+        if(size < follow->offset)
+        {
+            follow->offset = 0;
+            follow->open_line = false;
+        }
+
+        if(size == follow->offset)
+            return 0;
+    }
+
+    /* The size of a pipe is unknown, it is read until it is empty */
+    end = (follow->stream || size-follow->offset > FOLLOW_BUDGET)
+          ? follow->offset+FOLLOW_BUDGET : size;
+
+    buffer = (char *) malloc(FOLLOW_BUFFER_LENGTH);
+    if(buffer == NULL)
+        return -1;
+
+    while(follow->offset < end)
+    {
+        length = (end-follow->offset < FOLLOW_BUFFER_LENGTH)
+                 ? (size_t) (end-follow->offset) : FOLLOW_BUFFER_LENGTH;
+        n_read = follow->stream ? read(follow->fd, buffer, length)
+                                : pread(follow->fd, buffer, length,
+                                        follow->offset);
+        if(n_read == -1 && errno == EINTR)
+            continue;
+
+        /* The pipe is empty for now, or closed */
+        if(follow->stream && n_read == -1 && errno == EAGAIN)
+            break;
+        if(follow->stream && n_read == 0)
+        {
+            follow->finished = true;
+            if(follow->pid != -1 && wait_eFollow(follow) != 0)
+                result = -1;
+            break;
+        }
+
+        if(n_read <= 0
+           ||
+           add_bytes_eFollow(follow, last_line, first_line, new_last_line,
+                             n_lines, buffer, n_read, follow->offset) == -1)
+        {
+            result = -1;
+            break;
+        }
+
+        follow->offset += n_read;
+    }
+
+    free(buffer);
+
+    /* The rest is read next time, even without a new event */
+    follow->pending = (result == 0
+                       &&
+                       follow->offset == end
+                       &&
+                       (follow->stream || end < size));
+
+    return result;
+}
+
+
+/**
+ * @brief The wait_eFollow() function wait for the end of the process
+ *        writing the pipe.
+ *
+ * @param follow: eFollow pointer
+ *
+ * @return Exit status of the process, or -1 if it did not exit normally.
+ */
+static int wait_eFollow(eFollow * follow)
+{
+    int status = 0;
+
+    while(waitpid(follow->pid, &status, 0) == -1)
+    {
+        if(errno != EINTR)
+        {
+            status = -1;
+            break;
+        }
+    }
+    follow->pid = -1;
+
+    return (status != -1 && WIFEXITED(status)) ? WEXITSTATUS(status) : -1;
+}
+
+
+/**
+ * @brief The add_bytes_eFollow() function cut a block of bytes in lines.
+ *
+ * @param follow: eFollow pointer
+ * @param last_line: Last line of the file
+ * @param first_line: First new line or NULL
+ * @param new_last_line: Last new line or NULL
+ * @param n_lines: Number of new lines
+ * @param data: Bytes read
+ * @param length: Number of bytes
+ * @param offset: Offset of the bytes in the file
+ *
+ * @return 0 on success or -1 in failure.
+ */
+static int add_bytes_eFollow(eFollow * follow,
+                             eLine * last_line,
+                             eLine ** first_line,
+                             eLine ** new_last_line,
+                             unsigned int * n_lines,
+                             char const * data,
+                             size_t length,
+                             off_t offset)
+{
+    char const *start = data, *end = data+length, *newline = NULL;
+    eLine *line = NULL;
+    size_t line_length = 0;
+
+    while(start < end)
+    {
+        newline = memchr(start, '\n', end-start);
+        line_length = (newline != NULL) ? (size_t) (newline-start)
+                                        : (size_t) (end-start);
+
+        /* The last line continues */
+        if(follow->open_line)
+        {
+            line = (*new_last_line != NULL) ? *new_last_line : last_line;
+            if(insert_string_eLine(line, start, line_length,
+                                   line->length) == -1)
+                return -1;
+        }
+        else
+        {
+            line = create_eLine(start, line_length, 0, *new_last_line, NULL);
+            if(line == NULL)
+                return -1;
+
+            /* A line read as is can be copied from the file when saving */
+            if(!follow->stream && newline != NULL
+               &&
+               line->length == line_length)
+                line->file_offset = offset+(start-data);
+
+            if(*first_line == NULL)
+                *first_line = line;
+            *new_last_line = line;
+            (*n_lines)++;
+        }
+
+        follow->open_line = (newline == NULL);
+        start = (newline != NULL) ? newline+1 : end;
+    }
+
+    return 0;
+}
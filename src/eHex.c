@@ -0,0 +1,143 @@
+/**
+ * @file eHex.c
+ * @brief Contain eHex structure and functions
+ * @author ALARY Dorian
+ * @version 1.0
+ * @date 21/07/2024
+ * @copyright GNU Public License.
+ *
+ * @details This file contains the functions used to show a binary file in
+ *          hexadecimal. A row is read and formatted only when it is
+ *          printed, so that the memory used does not depend on the size of
+ *          the file. The file is not mapped: a page of a mapping past the
+ *          end of a file truncated meanwhile would stop edito with SIGBUS.
+ */
+
+#include "eHex.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <unistd.h>
+
+
+/**
+ * @brief The create_eHex() function allocate an eHex reading a file.
+ *
+ * @param fd: Descriptor of the file, it can be closed afterwards
+ * @param size: Size of the file, not 0
+ *
+ * @return eHex pointer or NULL if it was an error.
+ *
+ * @note delete_eHex() must be called before exiting.
+ */
+eHex * create_eHex(int fd,
+                   size_t size)
+{
+    eHex *hex = NULL;
+    size_t n_rows = (size+HEX_ROW_BYTES-1)/HEX_ROW_BYTES;
+
+    if(fd == -1 || size == 0)
+        return NULL;
+
+    hex = (eHex *) malloc(sizeof(eHex));
+    if(hex == NULL)
+        return NULL;
+
+    /* The descriptor of the caller may be closed */
+    hex->fd = dup(fd);
+    if(hex->fd == -1)
+    {
+        free(hex);
+        return NULL;
+    }
+
+
+    hex->size = size;
+    hex->n_rows = (n_rows < UINT_MAX) ? (unsigned int) n_rows : UINT_MAX;
+    hex->first_screen_row = 1;
+    hex->current_row = 1;
+
+    return hex;
+}
+
+
+/**
+ * @brief The delete_eHex() function close the file, deallocate eHex and
+ *        set the pointer to NULL.
+ *
+ * @param hex: eHex pointer pointer
+ */
+void delete_eHex(eHex ** hex)
+{
+    if(*hex == NULL)
+        return;
+
+    close((*hex)->fd);
+    free(*hex);
+    *hex = NULL;
+}
+
+
+/**
+ * @brief The get_row_eHex() function format a row: the offset of its
+ *        first byte, its bytes in hexadecimal and its printable bytes.
+ *
+ * @param hex: eHex pointer
+ * @param row: Row number, from 1
+ * @param buffer: Buffer of HEX_ROW_LENGTH characters
+ *
+ * @return Length of the row or 0 if the row does not exist. The bytes
+ *         which can not be read anymore are left blank.
+ */
+size_t get_row_eHex(eHex const * hex,
+                    unsigned int row,
+                    char * buffer)
+{
+    static char const digits[] = "0123456789abcdef";
+    unsigned char bytes[HEX_ROW_BYTES];
+    size_t offset = 0, n_bytes = 0, length = 0;
+    ssize_t n = 0;
+
+    if(row == 0 || row > hex->n_rows)
+        return 0;
+
+    offset = (size_t) (row-1)*HEX_ROW_BYTES;
+    length = (hex->size-offset < HEX_ROW_BYTES) ? hex->size-offset
+                                                : HEX_ROW_BYTES;
+
+    /* The file may be shorter now */
+    while(n_bytes < length)
+    {
+        n = pread(hex->fd, bytes+n_bytes, length-n_bytes, offset+n_bytes);
+        if(n == -1 && errno == EINTR)
+            continue;
+        if(n <= 0)
+            break;
+        n_bytes += n;
+    }
+
+    length = snprintf(buffer, HEX_ROW_LENGTH, "%08zx ", offset);
+
+    /* A missing byte of the last row is left blank */
+    for(size_t i=0; i<HEX_ROW_BYTES; i++)
+    {
+        if(i%8 == 0)
+            buffer[length++] = ' ';
+        buffer[length++] = (i < n_bytes) ? digits[bytes[i] >> 4] : ' ';
+        buffer[length++] = (i < n_bytes) ? digits[bytes[i] & 0xf] : ' ';
+        buffer[length++] = ' ';
+    }
+
+    buffer[length++] = ' ';
+    buffer[length++] = '|';
+    for(size_t i=0; i<n_bytes; i++)
+        buffer[length++] = (bytes[i] >= 0x20 && bytes[i] < 0x7f) ? bytes[i]
+                                                                 : '.';
+    buffer[length++] = '|';
+    buffer[length] = 0;
+
+    return length;
+}
@@ -0,0 +1,1069 @@
+/**
+ * @file eIndex.c
+ * @brief Contain eIndex structure and functions
+ * @author ALARY Dorian
+ * @version 1.0
+ * @date 21/07/2024
+ * @copyright GNU Public License.
+ *
+ * @details This file contains all the structures, variables and functions
+ *          used to index the definitions of the C/C++ symbols of the
+ *          directory. A thread reads the files from a queue and parses them
+ *          with a small tokenizer recording function, struct, typedef and
+ *          macro definitions. Symbols are stored in a hash table so a
+ *          lookup is O(1).
+ */
+
+#include "eIndex.h"
+#include "eDirectory.h"
+#include "eFile.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <sys/stat.h>
+
+
+#define INDEX_MAX_FILE_SIZE (8*1024*1024) /* Bigger files are not parsed */
+#define INDEX_MIN_ALLOC 1024 /* First allocation of the hash table */
+
+
+/**
+ * @struct symbol_list structure to store the symbols of a parsed file
+ *         before inserting them in the hash table.
+ */
+typedef struct {
+
+    /** Symbols */
+    eSymbol * symbols;
+
+    /** Number of symbols */
+    size_t n_symbols;
+
+    /** Allocation size */
+    size_t alloc_size;
+
+} symbol_list;
+
+
+static void fill_queue_eIndex(eIndex * index,
+                              eDirectory const * directory);
+static int push_queue_eIndex(eIndex * index,
+                             eFile * file);
+static void * run_eIndex(void * arg);
+static int parse_file(eFile * file,
+                      symbol_list * list);
+static void parse_source(char const * data,
+                         size_t size,
+                         eFile * file,
+                         symbol_list * list);
+static int add_symbol(symbol_list * list,
+                      char const * name,
+                      size_t length,
+                      eFile * file,
+                      unsigned int line_number,
+                      SYMBOL_TYPE type);
+static int insert_symbol_eIndex(eIndex * index,
+                                eSymbol const * symbol);
+static void remove_file_symbols_eIndex(eIndex * index,
+                                       eFile const * file);
+static void keep_file_symbols_eIndex(eIndex * index,
+                                     eFile const * file,
+                                     symbol_list const * list);
+static indexed_file * get_file_eIndex(eIndex * index,
+                                      eFile const * file,
+                                      bool add);
+static int resize_files_eIndex(eIndex * index,
+                               size_t alloc_files);
+static int resize_eIndex(eIndex * index,
+                         size_t alloc_size);
+static uint32_t hash_name(char const * name,
+                          size_t length);
+static bool is_source_file(char const * filename);
+
+
+/**
+ * @brief The create_eIndex() function allocate an eIndex and start the
+ *        thread parsing the C/C++ files of directory.
+ *
+ * @param directory: Root eDirectory
+ *
+ * @return eIndex pointer or NULL if it was an error.
+ *
+ * @note delete_eIndex() must be called before exiting.
+ */
+eIndex * create_eIndex(eDirectory const * directory)
+{
+    eIndex *index = NULL;
+
+    if(directory == NULL)
+        return NULL;
+
+    index = (eIndex *) malloc(sizeof(eIndex));
+    if(index == NULL)
+        return NULL;
+
+    index->symbols = NULL;
+    index->alloc_size = 0;
+    index->n_symbols = 0;
+    index->n_used = 0;
+    index->files = NULL;
+    index->alloc_files = 0;
+    index->n_files = 0;
+    index->queue = NULL;
+    index->n_queue = 0;
+    index->alloc_queue = 0;
+    index->stop = false;
+
+    if(resize_eIndex(index, INDEX_MIN_ALLOC) == -1
+       ||
+       resize_files_eIndex(index, INDEX_MIN_ALLOC) == -1)
+    {
+        free(index->symbols);
+        free(index);
+        return NULL;
+    }
+
+    /* The tree does not change after its creation, the queue is filled
+       before starting the thread */
+    fill_queue_eIndex(index, directory);
+
+    pthread_mutex_init(&index->mutex, NULL);
+    pthread_cond_init(&index->cond, NULL);
+
+    if(pthread_create(&index->thread, NULL, run_eIndex, index) != 0)
+    {
+        pthread_mutex_destroy(&index->mutex);
+        pthread_cond_destroy(&index->cond);
+        free(index->queue);
+        free(index->files);
+        free(index->symbols);
+        free(index);
+        return NULL;
+    }
+
+    return index;
+}
+
+
+/**
+ * @brief The delete_eIndex() function stop the thread, deallocate eIndex
+ *        and set the pointer to NULL.
+ *
+ * @param index: eIndex pointer pointer
+ */
+void delete_eIndex(eIndex ** index)
+{
+    if(*index == NULL)
+        return;
+
+    pthread_mutex_lock(&(*index)->mutex);
+    (*index)->stop = true;
+    pthread_cond_signal(&(*index)->cond);
+    pthread_mutex_unlock(&(*index)->mutex);
+
+    pthread_join((*index)->thread, NULL);
+
+    for(size_t i=0; i<(*index)->alloc_size; i++)
+        free((*index)->symbols[i].name);
+
+    for(size_t i=0; i<(*index)->alloc_files; i++)
+        free((*index)->files[i].hashes);
+
+    pthread_mutex_destroy(&(*index)->mutex);
+    pthread_cond_destroy(&(*index)->cond);
+    free((*index)->symbols);
+    free((*index)->files);
+    free((*index)->queue);
+    free(*index);
+    *index = NULL;
+}
+
+
+/**
+ * @brief The update_file_eIndex() function ask the thread to parse the
+ *        file again. Files which are not C/C++ sources are ignored.
+ *
+ * @param index: eIndex pointer
+ * @param file: eFile pointer
+ *
+ * @return 0 on success or -1 in failure.
+ */
+int update_file_eIndex(eIndex * index,
+                       eFile * file)
+{
+    int result = 0;
+
+    if(index == NULL || file == NULL)
+        return -1;
+
+    if(!is_source_file(file->filename))
+        return 0;
+
+    pthread_mutex_lock(&index->mutex);
+    result = push_queue_eIndex(index, file);
+    pthread_cond_signal(&index->cond);
+    pthread_mutex_unlock(&index->mutex);
+
+    return result;
+}
+
+
+/**
+ * @brief The find_eIndex() function return the definition of a symbol.
+ *
+ * @param index: eIndex pointer
+ * @param name: Symbol name
+ * @param length: Symbol name length
+ * @param line_number: Line number of the definition returned
+ *
+ * @return eFile of the definition or NULL if the symbol is unknown.
+ */
+eFile * find_eIndex(eIndex * index,
+                    char const * name,
+                    size_t length,
+                    unsigned int * line_number)
+{
+    eFile *file = NULL;
+    uint32_t hash = 0;
+    size_t slot = 0;
+    eSymbol const *symbol = NULL;
+
+    if(index == NULL || name == NULL || length == 0)
+        return NULL;
+
+    hash = hash_name(name, length);
+
+    pthread_mutex_lock(&index->mutex);
+
+    slot = hash & (index->alloc_size-1);
+    while(index->symbols[slot].name != NULL || index->symbols[slot].removed)
+    {
+        symbol = &index->symbols[slot];
+        if(symbol->name != NULL
+           &&
+           symbol->hash == hash
+           &&
+           !strncmp(symbol->name, name, length)
+           &&
+           symbol->name[length] == 0)
+        {
+            file = symbol->file;
+            *line_number = symbol->line_number;
+            break;
+        }
+        slot = (slot+1) & (index->alloc_size-1);
+    }
+
+    pthread_mutex_unlock(&index->mutex);
+
+    return file;
+}
+
+
+/**
+ * @brief The fill_queue_eIndex() function add every source file of the
+ *        directory and its children to the queue.
+ *
+ * @param index: eIndex pointer
+ * @param directory: eDirectory pointer
+ *
+ * @note This is a recursive function.
+ */
+static void fill_queue_eIndex(eIndex * index,
+                              eDirectory const * directory)
+{
+    for(unsigned int i=0; i<directory->n_dirs; i++)
+    {
+        if(directory->dirs[i] != NULL)
+            fill_queue_eIndex(index, directory->dirs[i]);
+    }
+
+    for(unsigned int i=0; i<directory->n_files; i++)
+    {
+        if(directory->files[i] != NULL
+           &&
+           is_source_file(directory->files[i]->filename))
+        {
+            push_queue_eIndex(index, directory->files[i]);
+        }
+    }
+}
+
+
+/**
+ * @brief The push_queue_eIndex() function add a file at the end of the
+ *        queue.
+ *
+ * @param index: eIndex pointer
+ * @param file: eFile pointer
+ *
+ * @return 0 on success or -1 in failure.
+ *
+ * @note The mutex must be locked if the thread is running.
+ */
+static int push_queue_eIndex(eIndex * index,
+                             eFile * file)
+{
+    eFile **queue = NULL;
+
+    /* The file is already waiting */
+    for(unsigned int i=0; i<index->n_queue; i++)
+    {
+        if(index->queue[i] == file)
+            return 0;
+    }
+
+    if(index->n_queue+1 > index->alloc_queue)
+    {
+        queue = (eFile **) realloc(index->queue,
+                                   get_next_power_of_two(index->n_queue+1)
+                                   * sizeof(eFile *));
+        if(queue == NULL)
+            return -1;
+
+        index->queue = queue;
+        index->alloc_queue = get_next_power_of_two(index->n_queue+1);
+    }
+
+    index->queue[index->n_queue] = file;
+    index->n_queue++;
+
+    return 0;
+}
+
+
+/**
+ * @brief The run_eIndex() function parse the files of the queue until the
+ *        index is deleted. Thread routine.
+ *
+ * @param arg: eIndex pointer
+ *
+ * @return NULL.
+ */
+static void * run_eIndex(void * arg)
+{
+    eIndex *index = (eIndex *) arg;
+    eFile *file = NULL;
+    symbol_list list = {NULL, 0, 0};
+
+    pthread_mutex_lock(&index->mutex);
+
+    while(!index->stop)
+    {
+        if(index->n_queue == 0)
+        {
+            pthread_cond_wait(&index->cond, &index->mutex);
+            continue;
+        }
+
+        /* Pop the last file, order does not matter */
+        index->n_queue--;
+        file = index->queue[index->n_queue];
+
+        /* Parse without holding the lock */
+        pthread_mutex_unlock(&index->mutex);
+        list.n_symbols = 0;
+        parse_file(file, &list);
+        pthread_mutex_lock(&index->mutex);
+
+        remove_file_symbols_eIndex(index, file);
+        for(size_t i=0; i<list.n_symbols; i++)
+        {
+            if(insert_symbol_eIndex(index, &list.symbols[i]) == -1)
+                free(list.symbols[i].name);
+        }
+        keep_file_symbols_eIndex(index, file, &list);
+    }
+
+    pthread_mutex_unlock(&index->mutex);
+    free(list.symbols);
+
+    return NULL;
+}
+
+
+/**
+ * @brief The parse_file() function read a file from the disk and parse it.
+ *
+ * @param file: eFile pointer
+ * @param list: symbol_list where symbols are added
+ *
+ * @return 0 on success or -1 in failure.
+ */
+static int parse_file(eFile * file,
+                      symbol_list * list)
+{
+    FILE *fp = NULL;
+    struct stat info;
+    char *data = NULL;
+    size_t size = 0;
+
+    if(stat(file->realpath, &info) == -1 || !S_ISREG(info.st_mode))
+        return -1;
+
+    if(info.st_size > INDEX_MAX_FILE_SIZE)
+        return -1;
+
+    if((fp = fopen(file->realpath, "r")) == NULL)
+        return -1;
+
+    data = (char *) malloc(info.st_size+1);
+    if(data == NULL)
+    {
+        fclose(fp);
+        return -1;
+    }
+
+    size = fread(data, 1, info.st_size, fp);
+    data[size] = 0;
+    fclose(fp);
+
+    parse_source(data, size, file, list);
+
+    free(data);
+    return 0;
+}
+
+
+/**
+ * @brief The parse_source() function tokenize a C/C++ source and record
+ *        the definitions found at file scope. A function is an identifier
+ *        followed by parentheses and a '{', a struct is a struct, union,
+ *        enum or class name followed by a '{', a typedef is the name before
+ *        the ';' ending the typedef and a macro is the name after #define.
+ *
+ * @param data: Content of the file
+ * @param size: Size of data
+ * @param file: eFile pointer
+ * @param list: symbol_list where symbols are added
+ */
+static void parse_source(char const * data,
+                         size_t size,
+                         eFile * file,
+                         symbol_list * list)
+{
+    size_t i = 0, start = 0;
+    unsigned int line = 1;
+    int brace = 0, paren = 0, bracket = 0;
+    bool line_start = true;
+    bool previous_ident = false;
+    bool previous_star = false;
+
+    /* Last identifier at file scope */
+    char const *ident = NULL;
+    size_t ident_length = 0;
+    unsigned int ident_line = 0;
+
+    /* Function candidate: identifier followed by '(' */
+    char const *function = NULL;
+    size_t function_length = 0;
+    unsigned int function_line = 0;
+    bool function_closed = false;
+
+    /* struct/union/enum/class: 1 after the keyword, 2 after the name */
+    int aggregate = 0;
+    char const *aggregate_name = NULL;
+    size_t aggregate_length = 0;
+    unsigned int aggregate_line = 0;
+
+    /* typedef, the name of a function pointer is between parentheses */
+    bool in_typedef = false;
+    char const *typedef_name = NULL;
+    size_t typedef_length = 0;
+    unsigned int typedef_line = 0;
+
+    while(i < size)
+    {
+        char c = data[i];
+
+        if(c == '\n')
+        {
+            line++;
+            line_start = true;
+            i++;
+            continue;
+        }
+
+        if(isspace((unsigned char) c))
+        {
+            i++;
+            continue;
+        }
+
+        /* Comments */
+        if(c == '/' && i+1 < size && data[i+1] == '*')
+        {
+            i += 2;
+            while(i+1 < size && !(data[i] == '*' && data[i+1] == '/'))
+            {
+                if(data[i] == '\n')
+                    line++;
+                i++;
+            }
+            i += 2;
+            continue;
+        }
+        if(c == '/' && i+1 < size && data[i+1] == '/')
+        {
+            while(i < size && data[i] != '\n')
+                i++;
+            continue;
+        }
+
+        /* Preprocessor directive */
+        if(c == '#' && line_start)
+        {
+            i++;
+            while(i < size && (data[i] == ' ' || data[i] == '\t'))
+                i++;
+
+            if(i+6 < size && !strncmp(data+i, "define", 6)
+               &&
+               (data[i+6] == ' ' || data[i+6] == '\t'))
+            {
+                i += 6;
+                while(i < size && (data[i] == ' ' || data[i] == '\t'))
+                    i++;
+                start = i;
+                while(i < size && (isalnum((unsigned char) data[i])
+                                   || data[i] == '_'))
+                    i++;
+                if(i > start)
+                    add_symbol(list, data+start, i-start, file, line,
+                               s_MACRO);
+            }
+
+            /* Skip the rest of the directive and its continuations */
+            while(i < size && data[i] != '\n')
+            {
+                if(data[i] == '\\' && i+1 < size && data[i+1] == '\n')
+                {
+                    line++;
+                    i++;
+                }
+                i++;
+            }
+            continue;
+        }
+
+        line_start = false;
+
+        /* Strings and characters */
+        if(c == '"' || c == '\'')
+        {
+            i++;
+            while(i < size && data[i] != c && data[i] != '\n')
+            {
+                if(data[i] == '\\')
+                    i++;
+                i++;
+            }
+            i++;
+            previous_ident = false;
+            continue;
+        }
+
+        /* Identifiers and keywords */
+        if(isalpha((unsigned char) c) || c == '_')
+        {
+            start = i;
+            while(i < size && (isalnum((unsigned char) data[i])
+                               || data[i] == '_'))
+                i++;
+
+            size_t length = i-start;
+            char const *word = data+start;
+
+            if(brace == 0 && length == 7 && !strncmp(word, "typedef", 7))
+            {
+                in_typedef = true;
+                typedef_name = NULL;
+            }
+            else if((length == 6 && !strncmp(word, "struct", 6))
+                    ||
+                    (length == 5 && !strncmp(word, "union", 5))
+                    ||
+                    (length == 4 && !strncmp(word, "enum", 4))
+                    ||
+                    (length == 5 && !strncmp(word, "class", 5)))
+            {
+                aggregate = 1;
+            }
+            else
+            {
+                if(aggregate == 1)
+                {
+                    aggregate = 2;
+                    aggregate_name = word;
+                    aggregate_length = length;
+                    aggregate_line = line;
+                }
+                else
+                {
+                    aggregate = 0;
+                }
+
+                if(brace == 0 && paren == 0 && bracket == 0)
+                {
+                    ident = word;
+                    ident_length = length;
+                    ident_line = line;
+                }
+
+                /* typedef int (*name)(int); */
+                if(brace == 0 && in_typedef && paren == 1 && previous_star)
+                {
+                    typedef_name = word;
+                    typedef_length = length;
+                    typedef_line = line;
+                }
+            }
+
+            previous_ident = true;
+            previous_star = false;
+            continue;
+        }
+
+        /* Punctuation */
+        switch(c)
+        {
+            case '{':
+                if(aggregate == 2)
+                    add_symbol(list, aggregate_name, aggregate_length, file,
+                               aggregate_line, s_STRUCT);
+
+                if(brace == 0 && function != NULL && function_closed)
+                    add_symbol(list, function, function_length, file,
+                               function_line, s_FUNCTION);
+
+                function = NULL;
+                brace++;
+                break;
+
+            case '}':
+                if(brace > 0)
+                    brace--;
+                break;
+
+            case '(':
+                if(brace == 0 && paren == 0 && previous_ident && !in_typedef
+                   && ident != NULL)
+                {
+                    function = ident;
+                    function_length = ident_length;
+                    function_line = ident_line;
+                    function_closed = false;
+                }
+                paren++;
+                break;
+
+            case ')':
+                if(paren > 0)
+                    paren--;
+                if(paren == 0 && function != NULL)
+                    function_closed = true;
+                break;
+
+            case '[':
+                bracket++;
+                break;
+
+            case ']':
+                if(bracket > 0)
+                    bracket--;
+                break;
+
+            case ';':
+                if(brace == 0)
+                {
+                    if(in_typedef && typedef_name != NULL)
+                        add_symbol(list, typedef_name, typedef_length, file,
+                                   typedef_line, s_TYPEDEF);
+                    else if(in_typedef && ident != NULL)
+                        add_symbol(list, ident, ident_length, file,
+                                   ident_line, s_TYPEDEF);
+                    in_typedef = false;
+                    function = NULL;
+                    paren = 0;
+                }
+                break;
+
+            case ',':
+            case '=':
+                if(brace == 0 && paren == 0)
+                    function = NULL;
+                break;
+
+            default:
+                break;
+        }
+
+        if(c != '{')
+            aggregate = 0;
+
+        previous_star = (c == '*');
+        previous_ident = false;
+        i++;
+    }
+}
+
+
+/**
+ * @brief The add_symbol() function add a symbol to the list.
+ *
+ * @param list: symbol_list pointer
+ * @param name: Symbol name
+ * @param length: Symbol name length
+ * @param file: eFile of the definition
+ * @param line_number: Line number of the definition
+ * @param type: Symbol type
+ *
+ * @return 0 on success or -1 in failure.
+ */
+static int add_symbol(symbol_list * list,
+                      char const * name,
+                      size_t length,
+                      eFile * file,
+                      unsigned int line_number,
+                      SYMBOL_TYPE type)
+{
+    eSymbol *symbols = NULL;
+    eSymbol *symbol = NULL;
+
+    if(list->n_symbols+1 > list->alloc_size)
+    {
+        size_t alloc_size = (list->alloc_size) ? list->alloc_size*2 : 64;
+        symbols = (eSymbol *) realloc(list->symbols,
+                                      alloc_size*sizeof(eSymbol));
+        if(symbols == NULL)
+            return -1;
+
+        list->symbols = symbols;
+        list->alloc_size = alloc_size;
+    }
+
+    symbol = &list->symbols[list->n_symbols];
+    symbol->name = strndup(name, length);
+    if(symbol->name == NULL)
+        return -1;
+
+    symbol->hash = hash_name(name, length);
+    symbol->file = file;
+    symbol->line_number = line_number;
+    symbol->type = type;
+    symbol->removed = false;
+    list->n_symbols++;
+
+    return 0;
+}
+
+
+/**
+ * @brief The insert_symbol_eIndex() function insert a symbol in the hash
+ *        table. The table takes the ownership of the name.
+ *
+ * @param index: eIndex pointer
+ * @param symbol: Symbol to insert
+ *
+ * @return 0 on success or -1 in failure.
+ *
+ * @note The mutex must be locked.
+ */
+static int insert_symbol_eIndex(eIndex * index,
+                                eSymbol const * symbol)
+{
+    size_t slot = 0;
+
+    /* Keep the load factor under 3/4 */
+    if((index->n_used+1)*4 > index->alloc_size*3)
+    {
+        size_t alloc_size = index->alloc_size;
+        if((index->n_symbols+1)*2 > alloc_size)
+            alloc_size *= 2;
+
+        if(resize_eIndex(index, alloc_size) == -1)
+            return -1;
+    }
+
+    slot = symbol->hash & (index->alloc_size-1);
+    while(index->symbols[slot].name != NULL)
+        slot = (slot+1) & (index->alloc_size-1);
+
+    if(!index->symbols[slot].removed)
+        index->n_used++;
+
+    index->symbols[slot] = *symbol;
+    index->symbols[slot].removed = false;
+    index->n_symbols++;
+
+    return 0;
+}
+
+
+/**
+ * @brief The remove_file_symbols_eIndex() function remove every symbol
+ *        defined in file. Only the slots of its symbols are looked at, a
+ *        file parsed for the first time has none.
+ *
+ * @param index: eIndex pointer
+ * @param file: eFile pointer
+ *
+ * @note The mutex must be locked.
+ */
+static void remove_file_symbols_eIndex(eIndex * index,
+                                       eFile const * file)
+{
+    indexed_file *parsed = get_file_eIndex(index, file, false);
+    eSymbol *symbol = NULL;
+    size_t slot = 0;
+
+    if(parsed == NULL)
+        return;
+
+    for(size_t i=0; i<parsed->n_hashes; i++)
+    {
+        slot = parsed->hashes[i] & (index->alloc_size-1);
+        while(index->symbols[slot].name != NULL
+              ||
+              index->symbols[slot].removed)
+        {
+            symbol = &index->symbols[slot];
+            if(symbol->name != NULL
+               &&
+               symbol->hash == parsed->hashes[i]
+               &&
+               symbol->file == file)
+            {
+                free(symbol->name);
+                symbol->name = NULL;
+                symbol->removed = true;
+                index->n_symbols--;
+            }
+            slot = (slot+1) & (index->alloc_size-1);
+        }
+    }
+
+    parsed->n_hashes = 0;
+}
+
+
+/**
+ * @brief The keep_file_symbols_eIndex() function keep the hashes of the
+ *        symbols of a parsed file, to remove them when it is parsed again.
+ *
+ * @param index: eIndex pointer
+ * @param file: eFile pointer
+ * @param list: Symbols of the file
+ *
+ * @note The mutex must be locked.
+ */
+static void keep_file_symbols_eIndex(eIndex * index,
+                                     eFile const * file,
+                                     symbol_list const * list)
+{
+    indexed_file *parsed = NULL;
+    uint32_t *hashes = NULL;
+
+    if(list->n_symbols == 0)
+        return;
+
+    parsed = get_file_eIndex(index, file, true);
+    if(parsed == NULL)
+        return;
+
+    if(list->n_symbols > parsed->alloc_hashes)
+    {
+        hashes = (uint32_t *) realloc(parsed->hashes,
+                                      list->n_symbols*sizeof(uint32_t));
+        if(hashes == NULL)
+            return;
+
+        parsed->hashes = hashes;
+        parsed->alloc_hashes = list->n_symbols;
+    }
+
+    for(size_t i=0; i<list->n_symbols; i++)
+        parsed->hashes[i] = list->symbols[i].hash;
+    parsed->n_hashes = list->n_symbols;
+}
+
+
+/**
+ * @brief The get_file_eIndex() function return the parsed file entry of a
+ *        file.
+ *
+ * @param index: eIndex pointer
+ * @param file: eFile pointer
+ * @param add: Add the file if it was never parsed
+ *
+ * @return indexed_file pointer or NULL if the file was never parsed or
+ *         it was an error.
+ *
+ * @note The mutex must be locked.
+ */
+static indexed_file * get_file_eIndex(eIndex * index,
+                                      eFile const * file,
+                                      bool add)
+{
+    size_t slot = 0;
+
+    /* Keep the load factor under 1/2 */
+    if(add
+       &&
+       (index->n_files+1)*2 > index->alloc_files
+       &&
+       resize_files_eIndex(index, index->alloc_files*2) == -1)
+        return NULL;
+
+    slot = hash_name((char const *) &file, sizeof(file))
+           & (index->alloc_files-1);
+    while(index->files[slot].file != NULL)
+    {
+        if(index->files[slot].file == file)
+            return &index->files[slot];
+        slot = (slot+1) & (index->alloc_files-1);
+    }
+
+    if(!add)
+        return NULL;
+
+    index->files[slot].file = file;
+    index->n_files++;
+
+    return &index->files[slot];
+}
+
+
+/**
+ * @brief The resize_files_eIndex() function reallocate the hash table of
+ *        the parsed files and insert the files again.
+ *
+ * @param index: eIndex pointer
+ * @param alloc_files: New allocation size, power of two
+ *
+ * @return 0 on success or -1 in failure.
+ */
+static int resize_files_eIndex(eIndex * index,
+                               size_t alloc_files)
+{
+    indexed_file *old_files = index->files;
+    size_t old_alloc_files = index->alloc_files;
+    size_t slot = 0;
+
+    index->files = (indexed_file *) calloc(alloc_files,
+                                           sizeof(indexed_file));
+    if(index->files == NULL)
+    {
+        index->files = old_files;
+        return -1;
+    }
+
+    index->alloc_files = alloc_files;
+
+    for(size_t i=0; i<old_alloc_files; i++)
+    {
+        if(old_files[i].file == NULL)
+            continue;
+
+        slot = hash_name((char const *) &old_files[i].file,
+                         sizeof(old_files[i].file))
+               & (alloc_files-1);
+        while(index->files[slot].file != NULL)
+            slot = (slot+1) & (alloc_files-1);
+        index->files[slot] = old_files[i];
+    }
+
+    free(old_files);
+    return 0;
+}
+
+
+/**
+ * @brief The resize_eIndex() function reallocate the hash table and insert
+ *        the symbols again, removed slots are dropped.
+ *
+ * @param index: eIndex pointer
+ * @param alloc_size: New allocation size, power of two
+ *
+ * @return 0 on success or -1 in failure.
+ */
+static int resize_eIndex(eIndex * index,
+                         size_t alloc_size)
+{
+    eSymbol *old_symbols = index->symbols;
+    size_t old_alloc_size = index->alloc_size;
+
+    index->symbols = (eSymbol *) calloc(alloc_size, sizeof(eSymbol));
+    if(index->symbols == NULL)
+    {
+        index->symbols = old_symbols;
+        return -1;
+    }
+
+    index->alloc_size = alloc_size;
+    index->n_symbols = 0;
+    index->n_used = 0;
+
+    for(size_t i=0; i<old_alloc_size; i++)
+    {
+        if(old_symbols[i].name != NULL)
+            insert_symbol_eIndex(index, &old_symbols[i]);
+    }
+
+    free(old_symbols);
+    return 0;
+}
+
+
+/**
+ * @brief The hash_name() function return the FNV-1a hash of a name.
+ *
+ * @param name: Name
+ * @param length: Name length
+ *
+ * @return Hash of the name.
+ */
+static uint32_t hash_name(char const * name,
+                          size_t length)
+{
+    uint32_t hash = 2166136261u;
+
+    for(size_t i=0; i<length; i++)
+    {
+        hash ^= (unsigned char) name[i];
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+
+/**
+ * @brief The is_source_file() function return true if the filename has a
+ *        C/C++ extension.
+ *
+ * @param filename: Name of the file
+ *
+ * @return true if the file is a C/C++ source, false otherwise.
+ */
+static bool is_source_file(char const * filename)
+{
+    static char const * const extensions[] =
+    {
+        ".c", ".h", ".cc", ".cpp", ".cxx", ".hh", ".hpp", ".hxx", NULL
+    };
+    char const *extension = strrchr(filename, '.');
+
+    if(extension == NULL)
+        return false;
+
+    for(int i=0; extensions[i] != NULL; i++)
+    {
+        if(!strcmp(extension, extensions[i]))
+            return true;
+    }
+
+    return false;
+}
@@ -0,0 +1,591 @@
+/**
+ * @file eJournal.c
+ * @brief Contain eJournal structure and functions
+ * @author ALARY Dorian
+ * @version 1.0
+ * @date 21/07/2024
+ * @copyright GNU Public License.
+ *
+ * @details This file contains the functions used to journal the
+ *          modifications of an eFile. Every modification appends a small
+ *          record in memory, the records are written and synced by batch.
+ *          If edito dies, the journal is replayed on the file at the next
+ *          start.
+ */
+
+#include "eJournal.h"
+#include "eFile.h"
+#include "eLine.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <limits.h> /* PATH_MAX */
+#include <unistd.h>
+#include <fcntl.h>
+
+
+#define JOURNAL_MAGIC "EDJOURN1" /* First bytes of a journal */
+#define JOURNAL_SUFFIX ".edito-journal" /* Journal is .<name><suffix> */
+
+
+/**
+ * @struct journal_header structure written at the beginning of a journal.
+ */
+typedef struct {
+
+    /** JOURNAL_MAGIC */
+    char magic[8];
+
+    /** Inode of the file */
+    uint64_t ino;
+
+    /** Size of the file */
+    int64_t size;
+
+    /** Modification time of the file */
+    int64_t mtime_sec;
+    int64_t mtime_nsec;
+
+} journal_header;
+
+
+/**
+ * @struct journal_record structure written before the data of a record.
+ */
+typedef struct {
+
+    uint32_t type;
+    uint32_t line_number;
+    uint32_t pos;
+    uint32_t arg;
+    uint32_t length;
+    uint32_t length2;
+
+} journal_record;
+
+
+static int get_path_eJournal(char const * realpath,
+                             char * path,
+                             size_t length);
+static void fill_header_eJournal(journal_header * header,
+                                 struct stat const * base);
+static int write_all_eJournal(int fd,
+                              char const * data,
+                              size_t length);
+static int apply_record_eJournal(eFile * file,
+                                 journal_record const * record,
+                                 char const * data);
+
+
+/**
+ * @brief The create_eJournal() function allocate the eJournal of a file.
+ *        The journal file is created by the first flush.
+ *
+ * @param realpath: Path of the file
+ * @param base: Status of the file the records will apply to
+ *
+ * @return eJournal pointer or NULL if it was an error.
+ *
+ * @note delete_eJournal() must be called before exiting.
+ */
+eJournal * create_eJournal(char const * realpath,
+                           struct stat const * base)
+{
+    eJournal *journal = NULL;
+    char path[PATH_MAX];
+
+    if(get_path_eJournal(realpath, path, sizeof(path)) == -1)
+        return NULL;
+
+    journal = (eJournal *) malloc(sizeof(eJournal));
+    if(journal == NULL)
+        return NULL;
+
+    memset(journal, 0, sizeof(eJournal));
+    journal->fd = -1;
+    journal->base = *base;
+
+    journal->path = strdup(path);
+    if(journal->path == NULL)
+    {
+        free(journal);
+        return NULL;
+    }
+
+    return journal;
+}
+
+
+/**
+ * @brief The delete_eJournal() function flush the records, deallocate
+ *        eJournal and set the pointer to NULL.
+ *
+ * @param journal: eJournal pointer pointer
+ * @param remove: The journal file is removed, the file is saved
+ */
+void delete_eJournal(eJournal ** journal,
+                     bool remove)
+{
+    if(*journal == NULL)
+        return;
+
+    if(!remove)
+        flush_eJournal(*journal);
+
+    /* A journal left by another edito is not removed */
+    if((*journal)->fd != -1)
+    {
+        close((*journal)->fd);
+        if(remove)
+            unlink((*journal)->path);
+    }
+
+    free((*journal)->buffer);
+    free((*journal)->path);
+    free(*journal);
+    *journal = NULL;
+}
+
+
+/**
+ * @brief The add_record_eJournal() function add a record to the journal.
+ *        It is only copied in memory, see flush_eJournal().
+ *
+ * @param journal: eJournal pointer
+ * @param type: Record type
+ * @param line_number: Line number of the cursor
+ * @param pos: Position of the cursor
+ * @param arg: Line number argument of j_ADD_LINE and j_DELETE_LINE,
+ *             character of j_INSERT_CHAR, length of j_REMOVE_STRING
+ * @param data: Inserted string or pattern, may be NULL
+ * @param length: Length of data
+ * @param data2: Replacement, may be NULL
+ * @param length2: Length of data2
+ *
+ * @return 0 on success or -1 in failure.
+ */
+int add_record_eJournal(eJournal * journal,
+                        JOURNAL_RECORD type,
+                        unsigned int line_number,
+                        unsigned int pos,
+                        unsigned int arg,
+                        char const * data,
+                        size_t length,
+                        char const * data2,
+                        size_t length2)
+{
+    journal_record record = {type, line_number, pos, arg, length, length2};
+    size_t record_length = sizeof(journal_record)+length+length2;
+    size_t alloc_size = 0;
+    char *buffer = NULL;
+
+    if(journal == NULL)
+        return -1;
+
+    if(journal->length+record_length > journal->alloc_size)
+    {
+        alloc_size = get_next_power_of_two(journal->length+record_length);
+        buffer = (char *) realloc(journal->buffer, alloc_size);
+        if(buffer == NULL)
+            return -1;
+
+        journal->buffer = buffer;
+        journal->alloc_size = alloc_size;
+    }
+
+    memcpy(journal->buffer+journal->length, &record, sizeof(journal_record));
+    journal->length += sizeof(journal_record);
+
+    if(length > 0)
+        memcpy(journal->buffer+journal->length, data, length);
+    journal->length += length;
+
+    if(length2 > 0)
+        memcpy(journal->buffer+journal->length, data2, length2);
+    journal->length += length2;
+
+    return 0;
+}
+
+
+/**
+ * @brief The flush_eJournal() function write the records in the journal
+ *        file and sync it.
+ *
+ * @param journal: eJournal pointer
+ *
+ * @return 0 on success or -1 in failure.
+ */
+int flush_eJournal(eJournal * journal)
+{
+    journal_header header;
+
+    if(journal == NULL || journal->length == 0)
+        return 0;
+
+    /* The journal is created by the first modification */
+    if(journal->fd == -1)
+    {
+        journal->fd = open(journal->path, O_WRONLY | O_CREAT | O_TRUNC,
+                           0600);
+        if(journal->fd == -1)
+            return -1;
+
+        fill_header_eJournal(&header, &journal->base);
+        if(write_all_eJournal(journal->fd, (char const *) &header,
+                              sizeof(journal_header)) == -1)
+            return -1;
+
+        journal->size = sizeof(journal_header);
+        journal->mark = journal->size;
+    }
+
+    if(write_all_eJournal(journal->fd, journal->buffer,
+                          journal->length) == -1)
+        return -1;
+
+    journal->size += journal->length;
+    journal->length = 0;
+
+    return fdatasync(journal->fd);
+}
+
+
+/**
+ * @brief The mark_eJournal() function remember the records written before
+ *        a save starts.
+ *
+ * @param journal: eJournal pointer
+ */
+void mark_eJournal(eJournal * journal)
+{
+    if(journal == NULL)
+        return;
+
+    flush_eJournal(journal);
+    journal->mark = journal->size;
+}
+
+
+/**
+ * @brief The rebase_eJournal() function remove the records written before
+ *        the last mark_eJournal(), after the save succeeded. The remaining
+ *        records apply to the saved file.
+ *
+ * @param journal: eJournal pointer
+ * @param base: Status of the saved file
+ *
+ * @return 0 on success or -1 in failure.
+ */
+int rebase_eJournal(eJournal * journal,
+                    struct stat const * base)
+{
+    char tmp_path[PATH_MAX+8];
+    journal_header header;
+    char *tail = NULL;
+    size_t tail_length = 0;
+    ssize_t n = 0;
+    int fd = -1;
+
+    if(journal == NULL)
+        return -1;
+
+    journal->base = *base;
+
+    if(journal->fd == -1)
+        return 0;
+
+    /* Nothing was modified since the save, the journal is removed */
+    tail_length = journal->size - journal->mark;
+    if(tail_length == 0)
+    {
+        close(journal->fd);
+        unlink(journal->path);
+        journal->fd = -1;
+        journal->size = 0;
+        journal->mark = 0;
+        return 0;
+    }
+
+    /* The records written after the mark are kept in a new journal */
+    tail = (char *) malloc(tail_length);
+    if(tail == NULL)
+        return -1;
+
+    n = pread(journal->fd, tail, tail_length, journal->mark);
+    snprintf(tmp_path, sizeof(tmp_path), "%s.new", journal->path);
+    fill_header_eJournal(&header, base);
+
+    if(n != (ssize_t) tail_length
+       ||
+       (fd = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC, 0600)) == -1)
+    {
+        free(tail);
+        return -1;
+    }
+
+    if(write_all_eJournal(fd, (char const *) &header,
+                          sizeof(journal_header)) == -1
+       ||
+       write_all_eJournal(fd, tail, tail_length) == -1
+       ||
+       fdatasync(fd) == -1
+       ||
+       rename(tmp_path, journal->path) == -1)
+    {
+        close(fd);
+        unlink(tmp_path);
+        free(tail);
+        return -1;
+    }
+
+    free(tail);
+    close(journal->fd);
+    journal->fd = fd;
+    journal->size = sizeof(journal_header)+tail_length;
+    journal->mark = sizeof(journal_header);
+
+    return 0;
+}
+
+
+/**
+ * @brief The exists_eJournal() function return true if a file has a
+ *        journal, left by an edito which did not save it.
+ *
+ * @param realpath: Path of the file
+ *
+ * @return true if the journal exists, false otherwise.
+ */
+bool exists_eJournal(char const * realpath)
+{
+    char path[PATH_MAX];
+
+    if(get_path_eJournal(realpath, path, sizeof(path)) == -1)
+        return false;
+
+    return access(path, F_OK) == 0;
+}
+
+
+/**
+ * @brief The remove_eJournal() function remove the journal of a file.
+ *
+ * @param realpath: Path of the file
+ */
+void remove_eJournal(char const * realpath)
+{
+    char path[PATH_MAX];
+
+    if(get_path_eJournal(realpath, path, sizeof(path)) == 0)
+        unlink(path);
+}
+
+
+/**
+ * @brief The replay_eJournal() function apply the records of the journal
+ *        left for a file on the opened eFile. The records are journaled
+ *        again by the eFile.
+ *
+ * @param file: Opened eFile pointer
+ *
+ * @return Number of replayed records or -1 if the journal can not be read
+ *         or does not apply to the file.
+ */
+long replay_eJournal(eFile * file)
+{
+    char path[PATH_MAX];
+    journal_header header, expected;
+    journal_record record;
+    struct stat info;
+    char *content = NULL;
+    size_t pos = 0;
+    long count = 0;
+    int fd = -1;
+
+    if(get_path_eJournal(file->realpath, path, sizeof(path)) == -1)
+        return -1;
+
+    if((fd = open(path, O_RDONLY)) == -1)
+        return -1;
+
+    if(fstat(fd, &info) == -1
+       ||
+       (size_t) info.st_size < sizeof(journal_header)
+       ||
+       (content = (char *) malloc(info.st_size)) == NULL
+       ||
+       read(fd, content, info.st_size) != info.st_size)
+    {
+        close(fd);
+        free(content);
+        return -1;
+    }
+    close(fd);
+
+    /* The records only apply to the file they were written for */
+    memcpy(&header, content, sizeof(journal_header));
+    fill_header_eJournal(&expected, &file->file_stat);
+    if(memcmp(&header, &expected, sizeof(journal_header)) != 0)
+    {
+        free(content);
+        return -1;
+    }
+
+    /* The eFile writes a new journal while the records are applied */
+    unlink(path);
+
+    /* A record cut by a crash is ignored */
+    pos = sizeof(journal_header);
+    while(pos+sizeof(journal_record) <= (size_t) info.st_size)
+    {
+        memcpy(&record, content+pos, sizeof(journal_record));
+        pos += sizeof(journal_record);
+
+        if((size_t) record.length+record.length2 > info.st_size-pos)
+            break;
+
+        apply_record_eJournal(file, &record, content+pos);
+        pos += record.length+record.length2;
+        count++;
+    }
+
+    free(content);
+
+    return count;
+}
+
+
+/**
+ * @brief The get_path_eJournal() function write the path of the journal
+ *        of a file: .<name>.edito-journal in the same directory.
+ *
+ * @param realpath: Path of the file
+ * @param path: Buffer where the path is written
+ * @param length: Length of path
+ *
+ * @return 0 on success or -1 if the path is too long.
+ */
+static int get_path_eJournal(char const * realpath,
+                             char * path,
+                             size_t length)
+{
+    char const *name = strrchr(realpath, '/');
+    int n = 0;
+
+    if(name == NULL)
+        n = snprintf(path, length, ".%s%s", realpath, JOURNAL_SUFFIX);
+    else
+        n = snprintf(path, length, "%.*s/.%s%s", (int) (name-realpath),
+                     realpath, name+1, JOURNAL_SUFFIX);
+
+    return (n < 0 || (size_t) n >= length) ? -1 : 0;
+}
+
+
+/**
+ * @brief The fill_header_eJournal() function fill a journal header.
+ *
+ * @param header: journal_header pointer
+ * @param base: Status of the file the records apply to
+ */
+static void fill_header_eJournal(journal_header * header,
+                                 struct stat const * base)
+{
+    memset(header, 0, sizeof(journal_header));
+    memcpy(header->magic, JOURNAL_MAGIC, sizeof(header->magic));
+    header->ino = base->st_ino;
+    header->size = base->st_size;
+    header->mtime_sec = base->st_mtim.tv_sec;
+    header->mtime_nsec = base->st_mtim.tv_nsec;
+}
+
+
+/**
+ * @brief The write_all_eJournal() function write length bytes on the file
+ *        descriptor, even if write(2) is interrupted or partial.
+ *
+ * @param fd: File descriptor
+ * @param data: Bytes to write
+ * @param length: Number of bytes
+ *
+ * @return 0 on success or -1 in failure.
+ */
+static int write_all_eJournal(int fd,
+                              char const * data,
+                              size_t length)
+{
+    ssize_t n = 0;
+
+    while(length > 0)
+    {
+        n = write(fd, data, length);
+        if(n == -1)
+        {
+            if(errno == EINTR)
+                continue;
+            return -1;
+        }
+
+        data += n;
+        length -= n;
+    }
+
+    return 0;
+}
+
+
+/**
+ * @brief The apply_record_eJournal() function apply a record on the eFile
+ *        with the cursor where it was.
+ *
+ * @param file: eFile pointer
+ * @param record: journal_record pointer
+ * @param data: Data of the record
+ *
+ * @return 0 on success or -1 in failure.
+ */
+static int apply_record_eJournal(eFile * file,
+                                 journal_record const * record,
+                                 char const * data)
+{
+    file->current_line = get_line_eFile(file, record->line_number);
+    if(file->current_line == NULL)
+        return -1;
+
+    file->current_pos = record->pos;
+    if(file->current_pos > file->current_line->length)
+        file->current_pos = file->current_line->length;
+
+    switch(record->type)
+    {
+        case j_INSERT_CHAR:
+            return insert_char_eFile(file, (char) record->arg);
+
+        case j_REMOVE_CHAR:
+            return remove_char_eFile(file);
+
+        case j_INSERT_STRING:
+            return insert_string_eFile(file, data, record->length);
+
+        case j_REMOVE_STRING:
+            return remove_string_eFile(file, record->arg);
+
+        case j_ADD_LINE:
+            return add_empty_line_eFile(file, record->arg);
+
+        case j_DELETE_LINE:
+            return delete_line_eFile(file, record->arg);
+
+        case j_REPLACE_ALL:
+            return (replace_all_eFile(file, data, record->length,
+                                      data+record->length,
+                                      record->length2) == -1) ? -1 : 0;
+
+        default:
+            return -1;
+    }
+}
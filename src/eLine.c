@@ -10,10 +10,12 @@
  *          used to manage lines.
  */
 
+#define _GNU_SOURCE /* memmem */
+
 #include "eLine.h"
 #include "util.h"
 
-#include <string.h> /* strnlen */
+#include <string.h> /* strnlen, memmem */
 #include <stdlib.h> /* malloc */
 #include <stdio.h> /* EOF */
 
@@ -44,9 +46,10 @@ eLine * create_eLine(char const * string,
     }
 
     /* Remove '\n' */
-    if(string[strnlen(string, length)-1] == '\n')
+    length = strnlen(string, length);
+    if(length > 0 && string[length-1] == '\n')
     {
-        length = strnlen(string, length)-1;
+        length--;
     }
 
     eline->length = strnlen(string, length);
@@ -64,6 +67,7 @@ eLine * create_eLine(char const * string,
     memcpy(eline->string, string, eline->length);
 
     eline->line_number = line_number;
+    eline->file_offset = -1;
 
     eline->next = next;
     if(eline->next)
@@ -119,9 +123,10 @@ int insert_string_eLine(eLine * eline,
         return -1;
 
     /* del terminating \n character */
-    if(string[strnlen(string, length)-1] == '\n')
+    length = strnlen(string, length);
+    if(length > 0 && string[length-1] == '\n')
     {
-        length = strnlen(string, length)-1;
+        length--;
     }
 
     string_length = strnlen(string, length);
@@ -142,12 +147,14 @@ int insert_string_eLine(eLine * eline,
                eline->alloc_size - eline->length);
     }
 
+    /* This move final 0 */
     memmove(eline->string + pos + string_length,
             eline->string + pos,
-            eline->length - pos);
+            eline->length - pos + 1);
     memcpy(eline->string+pos, string, string_length);
 
     eline->length = new_length;
+    eline->file_offset = -1;
 
     return 0;
 }
@@ -183,6 +190,7 @@ int remove_string_eLine(eLine * eline,
             eline->string + pos + real_length,
             eline->length-real_length-pos+1);
     eline->length -= real_length;
+    eline->file_offset = -1;
     return 0;
 }
 
@@ -224,6 +232,7 @@ int insert_char_eLine(eLine * eline,
 
     memmove(eline->string + pos + 1, eline->string + pos, eline->length - pos);
     eline->string[pos] = ch;
+    eline->file_offset = -1;
     return 0;
 }
 
@@ -254,10 +263,109 @@ int remove_char_eLine(eLine * eline,
     /* This move final 0 */
     memmove(eline->string+pos, eline->string + pos + 1, eline->length - pos);
     eline->length--;
+    eline->file_offset = -1;
     return 0;
 }
 
 
+/**
+ * @brief The replace_all_eLine() function replace every occurrence of
+ *        pattern in the line by replacement. The line is reallocated at
+ *        most once.
+ *
+ * @param eline: eLine
+ * @param pattern: String to replace
+ * @param pattern_length: Length of pattern
+ * @param replacement: String replacing pattern
+ * @param replacement_length: Length of replacement
+ *
+ * @return Number of replaced occurrences or -1 in failure.
+ */
+long replace_all_eLine(eLine * eline,
+                       char const * pattern,
+                       size_t pattern_length,
+                       char const * replacement,
+                       size_t replacement_length)
+{
+    char const *match = NULL;
+    char const *end = NULL;
+    char *string = NULL;
+    size_t new_length = 0;
+    size_t alloc_size = 0;
+    size_t read = 0, write = 0;
+    long count = 0;
+
+    if(eline == NULL || pattern_length == 0)
+        return -1;
+
+    /* Count occurrences */
+    match = eline->string;
+    end = eline->string + eline->length;
+    while((match = memmem(match, end-match, pattern, pattern_length)) != NULL)
+    {
+        count++;
+        match += pattern_length;
+    }
+
+    if(count == 0)
+        return 0;
+
+    new_length = eline->length + count*replacement_length
+                               - count*pattern_length;
+
+    /* Growing line: copy into a new string */
+    if(replacement_length > pattern_length)
+    {
+        alloc_size = eline->alloc_size;
+        if(new_length+1 > alloc_size)
+            alloc_size = sizeof(char)*get_next_power_of_two(new_length);
+
+        string = (char *) malloc(alloc_size);
+        if(string == NULL)
+            return -1;
+
+        while((match = memmem(eline->string+read, eline->length-read,
+                              pattern, pattern_length)) != NULL)
+        {
+            memcpy(string+write, eline->string+read,
+                   match-(eline->string+read));
+            write += match-(eline->string+read);
+            memcpy(string+write, replacement, replacement_length);
+            write += replacement_length;
+            read = match-eline->string + pattern_length;
+        }
+        memcpy(string+write, eline->string+read, eline->length-read);
+        memset(string+new_length, 0, alloc_size-new_length);
+
+        free(eline->string);
+        eline->string = string;
+        eline->alloc_size = alloc_size;
+    }
+    /* Shrinking line: replace in place, write never overtakes read */
+    else
+    {
+        while((match = memmem(eline->string+read, eline->length-read,
+                              pattern, pattern_length)) != NULL)
+        {
+            memmove(eline->string+write, eline->string+read,
+                    match-(eline->string+read));
+            write += match-(eline->string+read);
+            memcpy(eline->string+write, replacement, replacement_length);
+            write += replacement_length;
+            read = match-eline->string + pattern_length;
+        }
+        memmove(eline->string+write, eline->string+read,
+                eline->length-read);
+        memset(eline->string+new_length, 0, eline->length-new_length);
+    }
+
+    eline->length = new_length;
+    eline->file_offset = -1;
+
+    return count;
+}
+
+
 /**
  * @brief The get_string_eLine() function get a string in the line at position
  *        pos and return how many character actually got.
@@ -0,0 +1,768 @@
+/**
+ * @file eLoad.c
+ * @brief Contain eLoad structure and functions
+ * @author ALARY Dorian
+ * @version 1.0
+ * @date 21/07/2024
+ * @copyright GNU Public License.
+ *
+ * @details This file contains the functions used to read the lines of a
+ *          file. The file is read by large blocks, the lines of a block are
+ *          handed to the caller at once, so that a big file is shown before
+ *          it is entirely read.
+ */
+
+#include "eLoad.h"
+#include "eFile.h"
+#include "eLine.h"
+#include "util.h"
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h> /* posix_fadvise */
+
+
+#define LOAD_BUFFER_LENGTH (1024*1024) /* Length of the blocks read */
+
+
+/**
+ * @struct decompressor structure to recognize a compressed file by its
+ *         first bytes.
+ */
+typedef struct {
+
+    /** Magic bytes, '?' matches any byte */
+    char const * magic;
+
+    /** Number of magic bytes */
+    size_t length;
+
+    /** Program decompressing the file */
+    char const * program;
+
+} decompressor;
+
+
+static decompressor const DECOMPRESSORS[] =
+{
+    {"\x1f\x8b\x08", 3, "gzip"},
+    {"\x28\xb5\x2f\xfd", 4, "zstd"},
+    {"\xfd" "7zXZ\x00", 6, "xz"},
+    /* The level and the magic of the first block, "BZh" alone could
+       start a text */
+    {"BZh?\x31\x41\x59\x26\x53\x59", 10, "bzip2"}
+};
+
+
+static bool is_canceled_eLoad(eLoad * load);
+static bool is_utf8_eLoad(unsigned char const * data,
+                          size_t length,
+                          bool truncated);
+static int append_partial_eLoad(char ** partial,
+                                size_t * partial_length,
+                                size_t * partial_size,
+                                char const * data,
+                                size_t length);
+static void hand_lines_eLoad(eLoad * load,
+                             eLine * first_line,
+                             eLine * last_line,
+                             unsigned int n_lines,
+                             off_t read_size);
+static void finish_eLoad(eLoad * load,
+                         int result);
+static void * run_eLoad(void * arg);
+
+
+/**
+ * @brief The create_eLoad() function allocate an eLoad reading the file
+ *        opened by begin_open_eFile().
+ *
+ * @param file: eFile pointer
+ *
+ * @return eLoad pointer or NULL if it was an error.
+ *
+ * @note delete_eLoad() must be called before exiting.
+ */
+eLoad * create_eLoad(eFile * file)
+{
+    eLoad *load = NULL;
+
+    if(file == NULL || file->fd == -1)
+        return NULL;
+
+    load = (eLoad *) malloc(sizeof(eLoad));
+    if(load == NULL)
+        return NULL;
+
+    memset(load, 0, sizeof(eLoad));
+    pthread_mutex_init(&load->mutex, NULL);
+    pthread_cond_init(&load->cond, NULL);
+    load->file = file;
+    load->size = file->file_stat.st_size;
+    load->result = -1;
+    load->hash = HASH_INIT;
+
+    /* The thread has its own descriptor, the file may be closed first */
+    load->fd = dup(file->fd);
+    if(load->fd == -1)
+    {
+        delete_eLoad(&load);
+        return NULL;
+    }
+
+    return load;
+}
+
+
+/**
+ * @brief The delete_eLoad() function cancel the load, wait for the thread,
+ *        deallocate eLoad and the lines not taken, and set the pointer to
+ *        NULL.
+ *
+ * @param load: eLoad pointer pointer
+ */
+void delete_eLoad(eLoad ** load)
+{
+    eLine *current = NULL, *next = NULL;
+
+    if(*load == NULL)
+        return;
+
+    if((*load)->started)
+    {
+        cancel_eLoad(*load);
+        pthread_join((*load)->thread, NULL);
+    }
+
+    current = (*load)->first_line;
+    while(current)
+    {
+        next = current->next;
+        delete_eLine(&current);
+        current = next;
+    }
+
+    if((*load)->fd != -1)
+        close((*load)->fd);
+
+    pthread_cond_destroy(&(*load)->cond);
+    pthread_mutex_destroy(&(*load)->mutex);
+    free(*load);
+    *load = NULL;
+}
+
+
+/**
+ * @brief The start_eLoad() function start a thread reading the file.
+ *
+ * @param load: eLoad pointer
+ *
+ * @return 0 on success or -1 in failure.
+ */
+int start_eLoad(eLoad * load)
+{
+    if(load == NULL || load->started)
+        return -1;
+
+    /* The kernel reads ahead more for a sequential read */
+    posix_fadvise(load->fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    if(pthread_create(&load->thread, NULL, run_eLoad, load) != 0)
+        return -1;
+
+    load->started = true;
+
+    return 0;
+}
+
+
+/**
+ * @brief The read_eLoad() function read every line of the file. The lines
+ *        are handed by blocks, see take_lines_eLoad().
+ *
+ * @param load: eLoad pointer
+ *
+ * @return 0 on success or -1 in failure.
+ */
+int read_eLoad(eLoad * load)
+{
+    eLine *first_line = NULL, *last_line = NULL, *line = NULL;
+    unsigned int n_lines = 0;
+    char *buffer = NULL, *start = NULL, *end = NULL, *newline = NULL;
+    char *partial = NULL;
+    size_t partial_length = 0, partial_size = 0, length = 0;
+    char const *data = NULL;
+    off_t offset = 0, line_offset = 0;
+    ssize_t n_read = 0;
+    int result = 0;
+
+    buffer = (char *) malloc(LOAD_BUFFER_LENGTH);
+    if(buffer == NULL)
+    {
+        finish_eLoad(load, -1);
+        return -1;
+    }
+
+    while(!is_canceled_eLoad(load) && result == 0)
+    {
+        n_read = pread(load->fd, buffer, LOAD_BUFFER_LENGTH, offset);
+        if(n_read == -1 && errno == EINTR)
+            continue;
+        if(n_read <= 0)
+        {
+            result = (n_read == -1) ? -1 : 0;
+            break;
+        }
+
+        /* The hash tells later if the file on disk was changed */
+        load->hash = hash_bytes(load->hash, buffer, n_read);
+
+        start = buffer;
+        end = buffer+n_read;
+        while(result == 0
+              &&
+              (newline = memchr(start, '\n', end-start)) != NULL)
+        {
+            /* A line spanning two blocks is gathered first */
+            if(partial_length > 0)
+            {
+                result = append_partial_eLoad(&partial, &partial_length,
+                                              &partial_size, start,
+                                              newline-start);
+                data = partial;
+                length = partial_length;
+            }
+            else
+            {
+                data = start;
+                length = newline-start;
+            }
+
+            line = (result == 0) ? create_eLine(data, length, 0, last_line,
+                                                NULL)
+                                 : NULL;
+            if(line == NULL)
+            {
+                result = -1;
+                break;
+            }
+
+            /* A line read as is can be copied from the file when saving */
+            if(line->length == length)
+                line->file_offset = line_offset;
+
+            if(first_line == NULL)
+                first_line = line;
+            last_line = line;
+            n_lines++;
+
+            line_offset += length+1;
+            partial_length = 0;
+            start = newline+1;
+        }
+
+        if(result == 0 && start < end)
+            result = append_partial_eLoad(&partial, &partial_length,
+                                          &partial_size, start, end-start);
+        offset += n_read;
+
+        /* The lines of the block are shown before the next one is read */
+        hand_lines_eLoad(load, first_line, last_line, n_lines, offset);
+        first_line = last_line = NULL;
+        n_lines = 0;
+    }
+
+    /* Last line without '\n' */
+    if(result == 0 && partial_length > 0 && !is_canceled_eLoad(load))
+    {
+        line = create_eLine(partial, partial_length, 0, NULL, NULL);
+        if(line == NULL)
+            result = -1;
+        else
+            hand_lines_eLoad(load, line, line, 1, offset);
+    }
+
+    /* Lines of a failed block */
+    while(first_line)
+    {
+        line = first_line->next;
+        delete_eLine(&first_line);
+        first_line = line;
+    }
+
+    free(partial);
+    free(buffer);
+    finish_eLoad(load, result);
+
+    return result;
+}
+
+
+/**
+ * @brief The cancel_eLoad() function ask the thread to stop reading.
+ *
+ * @param load: eLoad pointer
+ */
+void cancel_eLoad(eLoad * load)
+{
+    pthread_mutex_lock(&load->mutex);
+    load->cancel = true;
+    pthread_mutex_unlock(&load->mutex);
+}
+
+
+/**
+ * @brief The wait_lines_eLoad() function wait until lines are read or the
+ *        load is finished.
+ *
+ * @param load: eLoad pointer
+ */
+void wait_lines_eLoad(eLoad * load)
+{
+    pthread_mutex_lock(&load->mutex);
+    while(load->n_lines == 0 && !load->finished)
+        pthread_cond_wait(&load->cond, &load->mutex);
+    pthread_mutex_unlock(&load->mutex);
+}
+
+
+/**
+ * @brief The take_lines_eLoad() function take the lines read since the
+ *        last call. They are linked together, line numbers are not set.
+ *
+ * @param load: eLoad pointer
+ * @param first_line: First line or NULL
+ * @param last_line: Last line or NULL
+ *
+ * @return Number of taken lines.
+ */
+unsigned int take_lines_eLoad(eLoad * load,
+                              eLine ** first_line,
+                              eLine ** last_line)
+{
+    unsigned int n_lines = 0;
+
+    pthread_mutex_lock(&load->mutex);
+    *first_line = load->first_line;
+    *last_line = load->last_line;
+    n_lines = load->n_lines;
+    load->first_line = NULL;
+    load->last_line = NULL;
+    load->n_lines = 0;
+    pthread_mutex_unlock(&load->mutex);
+
+    return n_lines;
+}
+
+
+/**
+ * @brief The is_finished_eLoad() function return true if every line was
+ *        read, the result is then in the result attribute.
+ *
+ * @param load: eLoad pointer
+ *
+ * @return true if the load is finished, false otherwise.
+ */
+bool is_finished_eLoad(eLoad * load)
+{
+    bool finished = false;
+
+    pthread_mutex_lock(&load->mutex);
+    finished = load->finished;
+    pthread_mutex_unlock(&load->mutex);
+
+    return finished;
+}
+
+
+/**
+ * @brief The prefetch_eLoad() function ask the kernel to read the
+ *        beginning of a file in the page cache, without waiting for it.
+ *
+ * @param realpath: Path of the file
+ * @param length: Number of bytes to read, 0 for the whole file
+ *
+ * @return 0 on success or -1 in failure.
+ */
+int prefetch_eLoad(char const * realpath,
+                   off_t length)
+{
+    int fd = -1;
+    int result = 0;
+
+    if((fd = open(realpath, O_RDONLY)) == -1)
+        return -1;
+
+    result = posix_fadvise(fd, 0, length, POSIX_FADV_WILLNEED);
+    close(fd);
+
+    return (result == 0) ? 0 : -1;
+}
+
+
+/**
+ * @brief The is_binary_eLoad() function read the first block of a file
+ *        and tell if it is binary: it contains a 0 or is not valid UTF-8.
+ *
+ * @param fd: Descriptor of the file
+ *
+ * @return true if the file is binary, false otherwise or if it can not be
+ *         read.
+ */
+bool is_binary_eLoad(int fd)
+{
+    unsigned char *buffer = NULL;
+    ssize_t n_read = 0;
+    bool binary = false;
+
+    buffer = (unsigned char *) malloc(SNIFF_LENGTH);
+    if(buffer == NULL)
+        return false;
+
+    while((n_read = pread(fd, buffer, SNIFF_LENGTH, 0)) == -1
+          &&
+          errno == EINTR);
+
+    /* A character can be cut at the end of a full block */
+    if(n_read > 0)
+        binary = memchr(buffer, 0, n_read) != NULL
+                 ||
+                 !is_utf8_eLoad(buffer, n_read, n_read == SNIFF_LENGTH);
+
+    free(buffer);
+
+    return binary;
+}
+
+
+/**
+ * @brief The get_decompressor_eLoad() function read the magic bytes of a
+ *        file and return the program decompressing it.
+ *
+ * @param fd: Descriptor of the file
+ *
+ * @return Name of the program, ex "gzip", or NULL if the file is not
+ *         compressed.
+ */
+char const * get_decompressor_eLoad(int fd)
+{
+    char magic[16];
+    ssize_t n_read = 0;
+    size_t j = 0;
+
+    while((n_read = pread(fd, magic, sizeof(magic), 0)) == -1
+          &&
+          errno == EINTR);
+
+    for(size_t i=0; i<sizeof(DECOMPRESSORS)/sizeof(DECOMPRESSORS[0]); i++)
+    {
+        if(n_read < (ssize_t) DECOMPRESSORS[i].length)
+            continue;
+
+        for(j=0; j<DECOMPRESSORS[i].length; j++)
+        {
+            if(DECOMPRESSORS[i].magic[j] != '?'
+               &&
+               DECOMPRESSORS[i].magic[j] != magic[j])
+                break;
+        }
+
+        if(j == DECOMPRESSORS[i].length)
+            return DECOMPRESSORS[i].program;
+    }
+
+    return NULL;
+}
+
+
+/**
+ * @brief The decompress_eLoad() function start a program decompressing a
+ *        file to a pipe.
+ *
+ * @param fd: Descriptor of the file, read from its start
+ * @param program: Program decompressing the file, called with -dc
+ * @param pid: Process of the program
+ *
+ * @return Descriptor of the pipe to read, or -1 if it was an error.
+ *
+ * @note The process must be waited for.
+ */
+int decompress_eLoad(int fd,
+                     char const * program,
+                     pid_t * pid)
+{
+    int pipe_fds[2] = {-1, -1};
+    int null_fd = -1;
+
+    if(pipe(pipe_fds) == -1)
+        return -1;
+
+    *pid = fork();
+    if(*pid == -1)
+    {
+        close(pipe_fds[0]);
+        close(pipe_fds[1]);
+        return -1;
+    }
+
+    /* The program reads the file and writes the pipe, its errors would
+       be printed over the screen */
+    if(*pid == 0)
+    {
+        null_fd = open("/dev/null", O_WRONLY);
+        if(dup2(fd, STDIN_FILENO) == -1
+           ||
+           lseek(STDIN_FILENO, 0, SEEK_SET) == -1
+           ||
+           dup2(pipe_fds[1], STDOUT_FILENO) == -1
+           ||
+           null_fd == -1
+           ||
+           dup2(null_fd, STDERR_FILENO) == -1)
+            _exit(127);
+
+        close(pipe_fds[0]);
+        close(pipe_fds[1]);
+        close(null_fd);
+        execlp(program, program, "-dc", (char *) NULL);
+        _exit(127);
+    }
+
+    close(pipe_fds[1]);
+
+    return pipe_fds[0];
+}
+
+
+/**
+ * @brief The get_progress_eLoad() function return the percentage of the
+ *        file already read.
+ *
+ * @param load: eLoad pointer
+ *
+ * @return Percentage between 0 and 100.
+ */
+unsigned int get_progress_eLoad(eLoad * load)
+{
+    off_t read_size = 0;
+
+    pthread_mutex_lock(&load->mutex);
+    read_size = load->read_size;
+    pthread_mutex_unlock(&load->mutex);
+
+    if(load->size <= 0 || read_size >= load->size)
+        return 100;
+
+    return (unsigned int) (read_size*100/load->size);
+}
+
+
+/**
+ * @brief The is_canceled_eLoad() function return true if the load must
+ *        stop.
+ *
+ * @param load: eLoad pointer
+ *
+ * @return true if the load is canceled, false otherwise.
+ */
+static bool is_canceled_eLoad(eLoad * load)
+{
+    bool cancel = false;
+
+    pthread_mutex_lock(&load->mutex);
+    cancel = load->cancel;
+    pthread_mutex_unlock(&load->mutex);
+
+    return cancel;
+}
+
+
+/**
+ * @brief The is_utf8_eLoad() function tell if bytes are valid UTF-8. The
+ *        ASCII bytes are skipped by words of 8 bytes.
+ *
+ * @param data: Bytes
+ * @param length: Number of bytes
+ * @param truncated: The bytes were cut, the last character can be
+ *                   incomplete
+ *
+ * @return true if the bytes are valid UTF-8, false otherwise.
+ */
+static bool is_utf8_eLoad(unsigned char const * data,
+                          size_t length,
+                          bool truncated)
+{
+    uint64_t word = 0;
+    size_t i = 0, n = 0;
+    unsigned char low = 0x80, high = 0xbf;
+
+    while(i < length)
+    {
+        if(i+sizeof(word) <= length)
+        {
+            memcpy(&word, data+i, sizeof(word));
+            if((word & 0x8080808080808080ULL) == 0)
+            {
+                i += sizeof(word);
+                continue;
+            }
+        }
+
+        if(data[i] < 0x80)
+        {
+            i++;
+            continue;
+        }
+
+        /* Number of continuation bytes, the range of the first one
+           excludes the overlong forms, the surrogates and the code points
+           after U+10FFFF */
+        low = 0x80;
+        high = 0xbf;
+        if(data[i] >= 0xc2 && data[i] <= 0xdf)
+            n = 1;
+        else if(data[i] >= 0xe0 && data[i] <= 0xef)
+        {
+            n = 2;
+            low = (data[i] == 0xe0) ? 0xa0 : 0x80;
+            high = (data[i] == 0xed) ? 0x9f : 0xbf;
+        }
+        else if(data[i] >= 0xf0 && data[i] <= 0xf4)
+        {
+            n = 3;
+            low = (data[i] == 0xf0) ? 0x90 : 0x80;
+            high = (data[i] == 0xf4) ? 0x8f : 0xbf;
+        }
+        else
+            return false;
+
+        if(i+n >= length)
+            return truncated;
+
+        if(data[i+1] < low || data[i+1] > high)
+            return false;
+
+        for(size_t j=2; j<=n; j++)
+        {
+            if((data[i+j] & 0xc0) != 0x80)
+                return false;
+        }
+
+        i += n+1;
+    }
+
+    return true;
+}
+
+
+/**
+ * @brief The append_partial_eLoad() function append bytes to the line
+ *        spanning several blocks.
+ *
+ * @param partial: Partial line pointer
+ * @param partial_length: Length of the partial line
+ * @param partial_size: Allocation size of the partial line
+ * @param data: Bytes to append
+ * @param length: Number of bytes
+ *
+ * @return 0 on success or -1 in failure.
+ */
+static int append_partial_eLoad(char ** partial,
+                                size_t * partial_length,
+                                size_t * partial_size,
+                                char const * data,
+                                size_t length)
+{
+    char *memory = NULL;
+    size_t size = 0;
+
+    if(*partial_length+length > *partial_size)
+    {
+        size = get_next_power_of_two(*partial_length+length);
+        memory = (char *) realloc(*partial, size);
+        if(memory == NULL)
+            return -1;
+
+        *partial = memory;
+        *partial_size = size;
+    }
+
+    memcpy(*partial+*partial_length, data, length);
+    *partial_length += length;
+
+    return 0;
+}
+
+
+/**
+ * @brief The hand_lines_eLoad() function append lines to the lines not
+ *        taken yet and wake up the caller.
+ *
+ * @param load: eLoad pointer
+ * @param first_line: First line or NULL
+ * @param last_line: Last line or NULL
+ * @param n_lines: Number of lines
+ * @param read_size: Number of bytes read
+ */
+static void hand_lines_eLoad(eLoad * load,
+                             eLine * first_line,
+                             eLine * last_line,
+                             unsigned int n_lines,
+                             off_t read_size)
+{
+    pthread_mutex_lock(&load->mutex);
+
+    if(n_lines > 0)
+    {
+        if(load->last_line != NULL)
+        {
+            load->last_line->next = first_line;
+            first_line->previous = load->last_line;
+        }
+        else
+            load->first_line = first_line;
+
+        load->last_line = last_line;
+        load->n_lines += n_lines;
+    }
+    load->read_size = read_size;
+
+    pthread_cond_broadcast(&load->cond);
+    pthread_mutex_unlock(&load->mutex);
+}
+
+
+/**
+ * @brief The finish_eLoad() function set the result of the load and wake
+ *        up the caller.
+ *
+ * @param load: eLoad pointer
+ * @param result: 0 on success or -1 in failure
+ */
+static void finish_eLoad(eLoad * load,
+                         int result)
+{
+    pthread_mutex_lock(&load->mutex);
+    load->result = result;
+    load->finished = true;
+    pthread_cond_broadcast(&load->cond);
+    pthread_mutex_unlock(&load->mutex);
+}
+
+
+/**
+ * @brief The run_eLoad() function is the reading thread.
+ *
+ * @param arg: eLoad pointer
+ *
+ * @return NULL.
+ */
+static void * run_eLoad(void * arg)
+{
+    read_eLoad((eLoad *) arg);
+
+    return NULL;
+}
@@ -14,12 +14,24 @@
 #include "eManager.h"
 #include "eScreen.h"
 #include "eFile.h"
+#include "eReplace.h"
+#include "eSession.h"
 
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <limits.h>
+#include <malloc.h> /* malloc_trim */
+#include <signal.h>
+#include <unistd.h>
+#include <sys/wait.h>
 
 #define CTRL(x) (x & 0x1F)
+#define TICK_DELAY 100 /* Input delay (ms) while background jobs run */
+#define JOURNAL_DELAY 1000 /* Delay (ms) between two flushes of journals */
+#define PREFETCH_DELAY 200 /* Delay (ms) on a file before it is prefetched */
+#define PREFETCH_BUDGET (32*1024*1024) /* Biggest file (bytes) read before
+                                          it is opened */
 
 /* Internal functions */
 static bool process_input_eManager(eManager * manager,
@@ -32,6 +44,9 @@ static bool process_ctrls_eManager(eManager * manager);
 static bool process_ctrlf_eManager(eManager * manager);
 static bool process_ctrld_eManager(eManager * manager);
 static bool process_ctrlb_eManager(eManager * manager);
+static bool process_ctrlp_eManager(eManager * manager);
+static bool process_ctrlt_eManager(eManager * manager);
+static bool process_ctrlr_eManager(eManager * manager);
 static bool process_ENTER_eManager(eManager * manager);
 static bool process_ESCAPE_eManager(eManager * manager);
 static bool process_BACKSPACE_eManager(eManager * manager);
@@ -40,6 +55,18 @@ static bool process_KEY_RIGHT_eManager(eManager * manager);
 static bool process_KEY_LEFT_eManager(eManager *manager);
 static bool process_KEY_DOWN_eManager(eManager *manager);
 static bool process_KEY_UP_eManager(eManager *manager);
+static bool process_KEY_NPAGE_eManager(eManager *manager);
+static bool process_KEY_PPAGE_eManager(eManager *manager);
+static bool process_KEY_HOME_eManager(eManager *manager);
+static bool process_KEY_END_eManager(eManager *manager);
+static bool process_CTRL_HOME_eManager(eManager *manager);
+static bool process_CTRL_END_eManager(eManager *manager);
+static bool process_ctrlg_eManager(eManager * manager);
+static bool process_ctrlz_eManager(eManager * manager);
+static bool process_ctrly_eManager(eManager * manager);
+static bool process_ctrll_eManager(eManager * manager);
+static bool process_ctrle_eManager(eManager * manager);
+static bool process_ctrlw_eManager(eManager * manager);
 
 static void change_mode_eManager(eManager * manager,
                                  MODE mode);
@@ -47,15 +74,100 @@ static unsigned int screen_width_of_string(char const * s,
                                            size_t length);
 static void add_help_msg_eManager(eManager * manager,
                                   char const * message);
+static void add_open_msg_eManager(eManager * manager,
+                                  eFile const * file);
+static int unpack_file_eManager(eManager * manager,
+                                eFile * file);
+static int open_file_eManager(eManager * manager,
+                              eFile * file);
+static void print_finder_eManager(eManager const * manager,
+                                  char const * query,
+                                  unsigned int selected);
+static void goto_line_eManager(eManager * manager,
+                               unsigned int line_number);
+static void scroll_to_cursor_eManager(eManager * manager);
+static void show_cursor_eManager(eManager * manager);
+static unsigned int page_height_eManager(eManager const * manager);
+static int key_code_eManager(char const * capname);
+static bool prompt_eManager(eManager * manager,
+                            char const * message,
+                            char * buffer,
+                            size_t length);
+static void replace_project_eManager(eManager * manager,
+                                     char const * pattern,
+                                     char const * replacement);
+static void process_tick_eManager(eManager * manager);
+static bool flush_journals_eManager(eManager * manager);
+static bool follow_files_eManager(eManager * manager);
+static void watch_files_eManager(eManager * manager);
+static void check_file_eManager(eManager * manager,
+                                eFile * file);
+static void pack_files_eManager(eManager * manager);
+static bool is_older_eManager(eFile const * first,
+                              eFile const * second);
+static void follow_cursor_eManager(eManager * manager,
+                                   eFile * file);
+static void recover_directory_eManager(eManager * manager,
+                                       eDirectory const * directory);
+static void save_session_eManager(eManager * manager);
+static void save_directories_eManager(eManager const * manager,
+                                      eSession * session,
+                                      eDirectory const * directory);
+static char const * get_session_path_eManager(eManager const * manager,
+                                              char const * realpath);
+static void process_saves_eManager(eManager * manager,
+                                   eFile const * file);
+static void close_file_eManager(eManager * manager,
+                                unsigned int item_index);
+static int load_file_eManager(eManager * manager,
+                              eFile * file);
+static bool cancel_load_eManager(eManager * manager,
+                                 eFile const * file);
+static bool is_loading_eManager(eManager const * manager,
+                                eFile const * file);
+static bool is_saving_eManager(eManager const * manager,
+                               eFile const * file);
+static int decompress_file_eManager(eFile * file);
+static void process_loads_eManager(eManager * manager,
+                                   bool wait);
+static bool adopt_prefetch_eManager(eManager * manager,
+                                    eFile * file);
+static void process_prefetch_eManager(eManager * manager);
+static void prefetch_file_eManager(eManager * manager,
+                                   eFile * file);
+static void drop_prefetch_eManager(eManager * manager);
+static bool process_view_eManager(eManager * manager,
+                                  int input);
+static void edit_view_eManager(eManager * manager,
+                               int input);
+static void scroll_view_eManager(eManager * manager);
+static int print_view_eManager(eManager const * manager);
+static unsigned int get_n_lines_eManager(eManager const * manager);
+static bool process_filter_eManager(eManager * manager,
+                                    int input);
+static void filter_file_eManager(eManager * manager);
+static void filter_cursor_eManager(eManager * manager);
+static void move_filter_eManager(eManager * manager,
+                                 unsigned int index);
+static int print_filter_eManager(eManager const * manager);
+static char const * get_string_eManager(eFile * file,
+                                        unsigned int line_number,
+                                        size_t * length);
+static bool process_hex_eManager(eManager * manager,
+                                 int input);
+static void scroll_hex_eManager(eManager * manager);
+static int print_hex_eManager(eManager const * manager);
 
 /* CONSTANTS */
-char const * const DEFAULT_HELP_MESSAGE[sizeof(MODE)][7] =
+char const * const DEFAULT_HELP_MESSAGE[sizeof(MODE)][13] =
 {
     /* DIR */
     {
         "Ctrl+Q: Quit",
         "Ctrl+B: Bar",
         "Ctrl+F: File",
+        "Ctrl+P: Go to file",
+        "Ctrl+R: Replace in project",
         "^ / v : UP / DOWN",
         "Enter: Open file / dir",
         NULL
@@ -67,6 +179,14 @@ char const * const DEFAULT_HELP_MESSAGE[sizeof(MODE)][7] =
         "Ctrl+D: Directory",
         "Ctrl+B: Bar",
         "Ctrl+S: Save file",
+        "Ctrl+P: Go to file",
+        "Ctrl+T: Go to definition",
+        "Ctrl+R: Replace all",
+        "Ctrl+G: Go to line",
+        "Ctrl+Z/Y: Undo/Redo",
+        "Ctrl+L: Follow file",
+        "Ctrl+E: Filter lines",
+        "Ctrl+W: Last file",
         NULL
     },
 
@@ -75,9 +195,11 @@ char const * const DEFAULT_HELP_MESSAGE[sizeof(MODE)][7] =
         "Ctrl+Q: Quit",
         "Ctrl+D: Directory",
         "Ctrl+F: File",
+        "Ctrl+P: Go to file",
         "<- / -> : Left / Right",
         "Enter: Open file",
         "Delete: Close file",
+        "Ctrl+W: Last file",
         NULL
     }
 };
@@ -107,6 +229,25 @@ eManager * create_eManager(void)
     manager->file = NULL;
     manager->directory = NULL;
     manager->bar = NULL;
+    manager->finder = NULL;
+    manager->index = NULL;
+    manager->saves = NULL;
+    manager->n_saves = 0;
+    manager->loads = NULL;
+    manager->n_loads = 0;
+    manager->fsync_policy = f_FULL;
+    clock_gettime(CLOCK_MONOTONIC, &manager->journal_flush);
+    manager->undo_limit = UNDO_DEFAULT_LIMIT;
+    manager->dwell_file = NULL;
+    manager->dwell_time = manager->journal_flush;
+    manager->dwell_done = true;
+    manager->prefetch = NULL;
+    manager->view_threshold = VIEW_DEFAULT_THRESHOLD;
+    manager->view_budget = VIEW_DEFAULT_BUDGET;
+    manager->pack_delay = PACK_DEFAULT_DELAY;
+    manager->pack_budget = PACK_DEFAULT_BUDGET;
+    manager->session = true;
+    manager->watch = create_eWatch();
     manager->help_msg = NULL;
 
     return manager;
@@ -124,6 +265,19 @@ void delete_eManager(eManager ** manager)
     if(*manager == NULL)
         return;
 
+    delete_eFinder(&(*manager)->finder);
+
+    /* Files are not touched, they may be deallocated */
+    for(unsigned int i=0; i<(*manager)->n_saves; i++)
+        delete_eSave(&(*manager)->saves[i]);
+    free((*manager)->saves);
+
+    for(unsigned int i=0; i<(*manager)->n_loads; i++)
+        delete_eLoad(&(*manager)->loads[i]);
+    free((*manager)->loads);
+    delete_eLoad(&(*manager)->prefetch);
+    delete_eWatch(&(*manager)->watch);
+
     free(*manager);
     *manager = NULL;
 }
@@ -170,7 +324,130 @@ void set_eDirectory_eManager(eManager * manager,
 
 
 /**
- * @brief The set_eFile_eManager() function set an eFile to eManager.
+ * @brief The set_eIndex_eManager() function set an eIndex to eManager.
+ *
+ * @param manager: eManager pointer
+ * @param index: eIndex pointer
+ */
+void set_eIndex_eManager(eManager * manager,
+                         eIndex * index)
+{
+    manager->index = index;
+}
+
+
+/**
+ * @brief The set_fsync_policy_eManager() function set the fsync policy of
+ *        the saves.
+ *
+ * @param manager: eManager pointer
+ * @param policy: fsync policy
+ */
+void set_fsync_policy_eManager(eManager * manager,
+                               FSYNC_POLICY policy)
+{
+    manager->fsync_policy = policy;
+}
+
+
+/**
+ * @brief The set_undo_limit_eManager() function set the memory cap of the
+ *        undo history of the files.
+ *
+ * @param manager: eManager pointer
+ * @param limit: Memory cap (bytes)
+ */
+void set_undo_limit_eManager(eManager * manager,
+                             size_t limit)
+{
+    manager->undo_limit = limit;
+
+    for(unsigned int i=0; i<count_eBar(manager->bar); i++)
+        set_limit_eUndo(((eFile *) get_file_eBar(manager->bar, i))->undo,
+                        limit);
+}
+
+
+/**
+ * @brief The set_view_threshold_eManager() function set the size from which
+ *        a file is shown by a paged view instead of being read.
+ *
+ * @param manager: eManager pointer
+ * @param threshold: Size of the file (bytes)
+ */
+void set_view_threshold_eManager(eManager * manager,
+                                 off_t threshold)
+{
+    manager->view_threshold = threshold;
+}
+
+
+/**
+ * @brief The set_view_budget_eManager() function set the memory cap of the
+ *        modified pages of each viewed file, the other ones are spilled in
+ *        a swap file.
+ *
+ * @param manager: eManager pointer
+ * @param budget: Memory cap (bytes)
+ */
+void set_view_budget_eManager(eManager * manager,
+                              size_t budget)
+{
+    manager->view_budget = budget;
+
+    for(unsigned int i=0; i<count_eBar(manager->bar); i++)
+        set_budget_eView(((eFile *) get_file_eBar(manager->bar, i))->view,
+                         budget);
+}
+
+
+/**
+ * @brief The set_pack_delay_eManager() function set the time after which
+ *        a file of the bar which is not shown is packed.
+ *
+ * @param manager: eManager pointer
+ * @param delay: Time (seconds)
+ */
+void set_pack_delay_eManager(eManager * manager,
+                             time_t delay)
+{
+    manager->pack_delay = delay;
+}
+
+
+/**
+ * @brief The set_pack_budget_eManager() function set the memory cap of the
+ *        lines of the bar files, the least recently shown ones are packed
+ *        beyond it.
+ *
+ * @param manager: eManager pointer
+ * @param budget: Memory cap (bytes)
+ */
+void set_pack_budget_eManager(eManager * manager,
+                              size_t budget)
+{
+    manager->pack_budget = budget;
+}
+
+
+/**
+ * @brief The set_session_eManager() function set if the open files and
+ *        directories are kept in the directory for the next run.
+ *
+ * @param manager: eManager pointer
+ * @param session: true to keep the session
+ */
+void set_session_eManager(eManager * manager,
+                          bool session)
+{
+    manager->session = session;
+}
+
+
+/**
+ * @brief The set_eFile_eManager() function set an eFile to eManager. A
+ *        packed file is unpacked first, the current file stays if it can
+ *        not be.
  *
  * @param manager: eManager pointer
  * @param file: eFile pointer
@@ -178,6 +455,21 @@ void set_eDirectory_eManager(eManager * manager,
 void set_eFile_eManager(eManager * manager,
                         eFile * file)
 {
+    if(file != NULL && unpack_file_eManager(manager, file) == -1)
+    {
+        add_help_msg_eManager(manager, "Impossible to open file.");
+        return;
+    }
+
+    /* The file left and the file shown start their unused time */
+    if(manager->file != NULL)
+        clock_gettime(CLOCK_MONOTONIC, &manager->file->last_use);
+    if(file != NULL)
+    {
+        clock_gettime(CLOCK_MONOTONIC, &file->last_use);
+        use_file_eBar(manager->bar, file);
+    }
+
     manager->file = file;
 }
 
@@ -194,31 +486,64 @@ bool run_eManager(eManager * manager)
 {
     int input = 0;
     bool result = false;
+    WINDOW_TYPE type = WDIR_BOX;
+    int delay = -1;
 
-    /* Get input */
-    curs_set(1);
     if(manager->mode == WRITE)
-        input = get_input_eScreen(manager->screen, WFILE_BOX);
-    else if(manager->mode == DIR)
-        input = get_input_eScreen(manager->screen, WDIR_BOX);
+        type = WFILE_BOX;
     else if(manager->mode == BAR)
-        input = get_input_eScreen(manager->screen, WBAR_BOX);
+        type = WBAR_BOX;
+
+    /* Background jobs and journals are followed between two inputs */
+    if(manager->n_saves > 0
+       ||
+       manager->n_loads > 0
+       ||
+       (manager->mode == DIR && !manager->dwell_done)
+       ||
+       flush_journals_eManager(manager)
+       ||
+       follow_files_eManager(manager)
+       ||
+       (manager->file != NULL
+        &&
+        manager->file->filter != NULL
+        &&
+        !manager->file->filter->finished))
+        delay = TICK_DELAY;
+
+    /* Open files are checked for changes by other programs, and packed
+       when they are not used */
+    else if(count_eBar(manager->bar) > 0)
+        delay = WATCH_DELAY;
+
+    /* Get input */
+    curs_set(1);
+    set_input_timeout_eScreen(manager->screen, type, delay);
+    input = get_input_eScreen(manager->screen, type);
     curs_set(0);
 
     /* Process input */
-    result =  process_input_eManager(manager, input);
+    result = (input == ERR) ? true : process_input_eManager(manager, input);
 
     if(result == false)
         return false;
 
-    /* Update screen */
-    send_help_msg_to_screen_eManager(manager);
+    process_tick_eManager(manager);
+
+    /* Packing takes a moment, it waits for the user to stop typing */
+    if(input == ERR)
+        pack_files_eManager(manager);
+
+    /* Update screen, a wake up only to watch the files keeps the message */
+    if(input != ERR || delay != WATCH_DELAY || manager->help_msg != NULL)
+        send_help_msg_to_screen_eManager(manager);
     update_help_eScreen(manager->screen);
 
     if(manager->mode == WRITE)
     {
         resize_file_eScreen(manager->screen,
-                            digit_number(manager->file->n_elines));
+                            digit_number(get_n_lines_eManager(manager)));
         print_file_eManager(manager);
         move_cursor_eScreen(manager->screen,
                             gety_cursor_eManager(manager),
@@ -228,7 +553,6 @@ bool run_eManager(eManager * manager)
     }
     else if(manager->mode == BAR)
     {
-        move_current_item_menu_eScreen(manager->screen, MBAR);
         update_bar_eScreen(manager->screen);
     }
     else if(manager->mode == DIR)
@@ -253,6 +577,47 @@ bool run_eManager(eManager * manager)
 bool process_input_eManager(eManager * manager,
                             int input)
 {
+    /* The modifications of an input are undone at once */
+    if(manager->mode == WRITE && manager->file != NULL)
+        next_group_eUndo(manager->file->undo);
+
+    /* A binary file is only shown */
+    if(manager->mode == WRITE
+       &&
+       manager->file != NULL
+       &&
+       manager->file->hex != NULL
+       &&
+       process_hex_eManager(manager, input))
+        return true;
+
+    /* The cursor of a filtered file moves from a matching line to another */
+    if(manager->mode == WRITE
+       &&
+       manager->file != NULL
+       &&
+       manager->file->filter != NULL
+       &&
+       process_filter_eManager(manager, input))
+        return true;
+
+    /* A viewed file is modified by pages, without undo */
+    if(manager->mode == WRITE
+       &&
+       manager->file != NULL
+       &&
+       manager->file->view != NULL
+       &&
+       process_view_eManager(manager, input))
+        return true;
+
+    /* Ctrl+Home and Ctrl+End have no ncurses constant */
+    if(input > 0 && input == key_code_eManager("kHOM5"))
+        return process_CTRL_HOME_eManager(manager);
+
+    if(input > 0 && input == key_code_eManager("kEND5"))
+        return process_CTRL_END_eManager(manager);
+
     switch(input)
     {
         /* exit */
@@ -271,6 +636,42 @@ bool process_input_eManager(eManager * manager,
         case CTRL('d'):
             return process_ctrld_eManager(manager);
 
+        /* Go to file */
+        case CTRL('p'):
+            return process_ctrlp_eManager(manager);
+
+        /* Go to definition */
+        case CTRL('t'):
+            return process_ctrlt_eManager(manager);
+
+        /* Replace all */
+        case CTRL('r'):
+            return process_ctrlr_eManager(manager);
+
+        /* Go to line */
+        case CTRL('g'):
+            return process_ctrlg_eManager(manager);
+
+        /* Undo */
+        case CTRL('z'):
+            return process_ctrlz_eManager(manager);
+
+        /* Redo */
+        case CTRL('y'):
+            return process_ctrly_eManager(manager);
+
+        /* Follow file */
+        case CTRL('l'):
+            return process_ctrll_eManager(manager);
+
+        /* Filter lines */
+        case CTRL('e'):
+            return process_ctrle_eManager(manager);
+
+        /* Last used file */
+        case CTRL('w'):
+            return process_ctrlw_eManager(manager);
+
 
         case CTRL('s'):
             return process_ctrls_eManager(manager);
@@ -289,6 +690,22 @@ bool process_input_eManager(eManager * manager,
             return process_KEY_DOWN_eManager(manager);
 
 
+        case KEY_NPAGE:
+            return process_KEY_NPAGE_eManager(manager);
+
+
+        case KEY_PPAGE:
+            return process_KEY_PPAGE_eManager(manager);
+
+
+        case KEY_HOME:
+            return process_KEY_HOME_eManager(manager);
+
+
+        case KEY_END:
+            return process_KEY_END_eManager(manager);
+
+
         case KEY_LEFT:
             return process_KEY_LEFT_eManager(manager);
 
@@ -348,7 +765,25 @@ bool process_DEFAULT_eManager(eManager * manager,
  */
 bool process_ctrlq_eManager(eManager * manager)
 {
-    (void)manager;
+    eFile *file = NULL;
+
+    /* Wait for the saves written in background */
+    process_saves_eManager(manager, NULL);
+    save_session_eManager(manager);
+
+    /* The files being read are not needed anymore */
+    for(unsigned int i=0; i<manager->n_loads; i++)
+        delete_eLoad(&manager->loads[i]);
+    manager->n_loads = 0;
+    drop_prefetch_eManager(manager);
+
+    /* Edito exits normally, the journals are not needed */
+    for(unsigned int i=0; i<count_eBar(manager->bar); i++)
+    {
+        file = (eFile *) get_file_eBar(manager->bar, i);
+        delete_eJournal(&file->journal, true);
+    }
+
     return false;
 }
 
@@ -362,19 +797,72 @@ bool process_ctrlq_eManager(eManager * manager)
  */
 bool process_ctrls_eManager(eManager * manager)
 {
-    if(manager->file != NULL && manager->mode == WRITE)
+    eSave **saves = NULL;
+    eSave *save = NULL;
+
+    if(manager->file == NULL || manager->mode != WRITE)
+        return true;
+
+    if(manager->file->permissions != p_READWRITE)
+    {
+        add_help_msg_eManager(manager, "Readonly file.");
+        return true;
+    }
+
+    if(manager->file->is_saved)
     {
-        if(manager->file->permissions != p_READWRITE)
-        {
-            add_help_msg_eManager(manager, "Readonly file.");
-        }
-        else if(write_eFile(manager->file) == -1)
-        {
-            /* tmp file */
-        }
         add_help_msg_eManager(manager, "File saved.");
+        return true;
+    }
+
+    /* A file partially read must not be written */
+    if(is_loading_eManager(manager, manager->file))
+    {
+        add_help_msg_eManager(manager, "File is loading.");
+        return true;
+    }
+
+    /* An older save of the file must not be renamed after this one */
+    process_saves_eManager(manager, manager->file);
+
+    /* A change of another program is not overwritten silently, the file
+       is saved once reloaded */
+    check_file_eManager(manager, manager->file);
+    if(manager->file->is_saved)
+        return true;
+
+    saves = (eSave **) realloc(manager->saves,
+                               (manager->n_saves+1)*sizeof(eSave *));
+    if(saves == NULL)
+    {
+        add_help_msg_eManager(manager, "Impossible to save.");
+        return true;
+    }
+    manager->saves = saves;
+
+    /* The records written before the snapshot are removed once saved */
+    mark_eJournal(manager->file->journal);
+
+    /* The snapshot is written in background, the file can be modified */
+    save = create_eSave(manager->file, manager->fsync_policy);
+    if(save == NULL)
+    {
+        add_help_msg_eManager(manager, "Impossible to save.");
+        return true;
+    }
+
+    manager->file->is_saved = true;
+    manager->saves[manager->n_saves++] = save;
+
+    if(start_eSave(save) == -1)
+    {
+        /* Without thread, the snapshot is written now */
+        save->result = write_eSave(save);
+        save->finished = true;
     }
 
+    add_help_msg_eManager(manager, "Saving...");
+
     return true;
 }
 
@@ -430,6 +918,208 @@ bool process_ctrlf_eManager(eManager * manager)
 }
 
 
+/*
+ * @brief The process_ctrlp_input_eManager() function process a CTRLP input.
+ *        A popup fuzzy finds a file of the directory while the user types.
+ *
+ * @param manager: eManager pointer
+ *
+ * @return returns true if the program continues and false otherwise.
+ */
+bool process_ctrlp_eManager(eManager * manager)
+{
+    char query[256];
+    size_t query_length = 0;
+    unsigned int selected = 0;
+    int n_results = 0;
+    int input = 0;
+    bool run = true;
+    bool changed = true;
+    eFile *file = NULL;
+
+    if(manager->finder == NULL)
+        manager->finder = create_eFinder(manager->directory);
+
+    if(manager->finder == NULL)
+    {
+        add_help_msg_eManager(manager, "Impossible to list files.");
+        return true;
+    }
+
+    if(create_popup_eScreen(manager->screen) == -1)
+        return true;
+
+    memset(query, 0, sizeof(query));
+    curs_set(1);
+
+    while(run)
+    {
+        /* Only search again when the pattern changes */
+        if(changed)
+        {
+            n_results = search_eFinder(manager->finder, query);
+            if(n_results < 0)
+                n_results = 0;
+            selected = 0;
+            changed = false;
+        }
+
+        print_finder_eManager(manager, query, selected);
+
+        input = get_input_eScreen(manager->screen, WPOPUP);
+        switch(input)
+        {
+            /* ESCAPE */
+            case 27:
+                run = false;
+                break;
+
+            case '\n':
+                file = get_file_eFinder(manager->finder, selected);
+                run = false;
+                break;
+
+            case KEY_UP:
+                if(selected > 0)
+                    selected--;
+                break;
+
+            case KEY_DOWN:
+                if(selected+1 < (unsigned int) n_results)
+                    selected++;
+                break;
+
+            case KEY_BACKSPACE:
+                if(query_length > 0)
+                {
+                    query[--query_length] = 0;
+                    changed = true;
+                }
+                break;
+
+            default:
+                if(isprint(input) && query_length+1 < sizeof(query))
+                {
+                    query[query_length++] = input;
+                    changed = true;
+                }
+                break;
+        }
+    }
+
+    curs_set(0);
+    delete_popup_eScreen(manager->screen);
+
+    if(file != NULL)
+        open_file_eManager(manager, file);
+
+    return true;
+}
+
+
+/*
+ * @brief The process_ctrlt_input_eManager() function process a CTRLT input.
+ *        The definition of the word under the cursor is searched in the
+ *        symbol index and opened.
+ *
+ * @param manager: eManager pointer
+ *
+ * @return returns true if the program continues and false otherwise.
+ */
+bool process_ctrlt_eManager(eManager * manager)
+{
+    eLine const *line = NULL;
+    eFile *file = NULL;
+    size_t start = 0, end = 0;
+    unsigned int line_number = 0;
+
+    if(manager->mode != WRITE || manager->file == NULL)
+        return true;
+
+    /* Word under the cursor */
+    line = manager->file->current_line;
+    start = end = manager->file->current_pos;
+    while(start > 0 && (isalnum((unsigned char) line->string[start-1])
+                        || line->string[start-1] == '_'))
+        start--;
+    while(end < line->length && (isalnum((unsigned char) line->string[end])
+                                 || line->string[end] == '_'))
+        end++;
+
+    if(start == end)
+        return true;
+
+    file = find_eIndex(manager->index,
+                       line->string+start,
+                       end-start,
+                       &line_number);
+    if(file == NULL)
+    {
+        add_help_msg_eManager(manager, "Definition not found.");
+        return true;
+    }
+
+    if(open_file_eManager(manager, file) == 0)
+        goto_line_eManager(manager, line_number);
+
+    return true;
+}
+
+
+/*
+ * @brief The process_ctrlr_input_eManager() function process a CTRLR input.
+ *        Every occurrence of a string is replaced in the current file, or in
+ *        every file of the project in DIR mode.
+ *
+ * @param manager: eManager pointer
+ *
+ * @return returns true if the program continues and false otherwise.
+ */
+bool process_ctrlr_eManager(eManager * manager)
+{
+    char pattern[256];
+    char replacement[256];
+    char message[64];
+    long count = 0;
+
+    if(manager->mode == BAR
+       ||
+       (manager->mode == WRITE && manager->file == NULL))
+        return true;
+
+    if(!prompt_eManager(manager, "Replace: ", pattern, sizeof(pattern))
+       ||
+       pattern[0] == 0)
+        return true;
+
+    if(!prompt_eManager(manager, "With: ", replacement, sizeof(replacement)))
+        return true;
+
+    if(manager->mode == DIR)
+    {
+        replace_project_eManager(manager, pattern, replacement);
+        return true;
+    }
+
+    /* The screen is printed once by run_eManager() */
+    count = replace_all_eFile(manager->file,
+                              pattern,
+                              strlen(pattern),
+                              replacement,
+                              strlen(replacement));
+    if(count == -1)
+    {
+        add_help_msg_eManager(manager, "Impossible to replace.");
+        return true;
+    }
+
+    snprintf(message, sizeof(message), "%ld occurrences replaced.", count);
+    add_help_msg_eManager(manager, message);
+
+    return true;
+}
+
+
 /*
  * @brief The process_ESCAPE_input_eManager() function process an ESCAPE input.
  *
@@ -440,6 +1130,21 @@ bool process_ctrlf_eManager(eManager * manager)
 
 bool process_ESCAPE_eManager(eManager * manager)
 {
+    /* Escape cancels the load of the current file, which is closed */
+    if(manager->file != NULL && is_loading_eManager(manager, manager->file))
+    {
+        for(unsigned int i=0; i<count_eBar(manager->bar); i++)
+        {
+            if(get_file_eBar(manager->bar, i) == manager->file)
+            {
+                close_file_eManager(manager, i);
+                break;
+            }
+        }
+        add_help_msg_eManager(manager, "Loading canceled.");
+        return true;
+    }
+
     if(manager->lastmode == BAR)
         if(count_eBar(manager->bar) == 0)
             return true;
@@ -515,77 +1220,18 @@ bool process_ENTER_eManager(eManager * manager)
         }
         else if(file != NULL)
         {
-            /* If file isn't in the bar */
-            if(!is_file_in_eBar(manager->bar, file))
-            {
-                /* Try to open the file */
-                if(open_eFile(file) == -1)
-                {
-                    add_help_msg_eManager(manager, "Impossible to open file.");
-                    return true;
-                }
-                if(file->permissions == p_READONLY)
-                    add_help_msg_eManager(manager, "Readonly file.");
-
-
-                /* Add file to eBar or quit, adding file to eBar */
-                if(add_file_eBar(manager->bar, file) == -1)
-                    return true;
-
-                /* Add filename to the bar menu */
-                buffer_length = strlen(file->filename)+1;
-                buffer = (char *) malloc(buffer_length*sizeof(char));
-                memset(buffer, 0, buffer_length);
-                strcpy(buffer, file->filename);
-
-                /* Add item to the menu, and refresh the window */
-                add_item_menu_eScreen(manager->screen, MBAR, buffer);
-                refresh_menu_eScreen(manager->screen, MBAR);
-
-                /* Deplace cursor to the file in the menu bar */
-                move_pattern_item_menu_eScreen(manager->screen,
-                                               MBAR,
-                                               file->filename);
-                update_bar_eScreen(manager->screen);
-
-                /* Create or resize file Window for the file (resize for lines
-                   number) */
-                if(manager->screen->windows[WFILE_CNT] == NULL)
-                    create_file_window_eScreen(manager->screen,
-                                               digit_number(file->n_elines));
-                else
-                    resize_file_eScreen(manager->screen,
-                                        digit_number(file->n_elines));
-
-                /* Enter write mode */
-                set_eFile_eManager(manager, file);
-                change_mode_eManager(manager, WRITE);
-            }
-            /* The file is in the bar */
-            else
-            {
-                /* Deplace cursor to the file in the menu bar */
-                move_pattern_item_menu_eScreen(manager->screen,
-                                               MBAR,
-                                               file->filename);
-                update_bar_eScreen(manager->screen);
-                resize_file_eScreen(manager->screen, file->n_elines);
-
-                /* Enter write mode */
-                set_eFile_eManager(manager, file);
-                change_mode_eManager(manager, WRITE);
-            }
+            open_file_eManager(manager, file);
         }
     }
     else if(manager->mode == BAR)
     {
-        item_index = get_current_item_index_menu_eScreen(manager->screen,
-                                                         MBAR);
+        item_index = get_current_tab_eScreen(manager->screen);
         file = (eFile *) get_file_eBar(manager->bar, item_index);
 
         /* Enter write mode */
         set_eFile_eManager(manager, file);
-        change_mode_eManager(manager, WRITE);
+        if(manager->file == file)
+            change_mode_eManager(manager, WRITE);
     }
 
     return true;
@@ -687,45 +1333,11 @@ bool process_DELETE_eManager(eManager * manager)
     }
     if(manager->mode == BAR)
     {
-        eFile *file = NULL;
         unsigned int item_index = 0;
 
-        item_index = get_current_item_index_menu_eScreen(manager->screen,
-                                                         MBAR);
-
-        file = (eFile *) get_file_eBar(manager->bar, item_index);
-
-        if(file == manager->file)
-        {
-           set_eFile_eManager(manager, NULL);
-        }
-
-        // TODO: Si modifié, faire une popup qui demande à enregistrer
-        remove_file_eBar(manager->bar, item_index);
-        remove_item_menu_eScreen(manager->screen, MBAR, item_index);
-        refresh_menu_eScreen(manager->screen, MBAR);
-        close_eFile(file);
+        item_index = get_current_tab_eScreen(manager->screen);
 
-        if(count_eBar(manager->bar) != 0)
-        {
-            item_index = (item_index == 0) ? 0 : item_index-1;
-            file = (eFile *) get_file_eBar(manager->bar, item_index);
-            move_pattern_item_menu_eScreen(manager->screen,
-                                           MBAR,
-                                           file->filename);
-            set_eFile_eManager(manager, file);
-            resize_file_eScreen(manager->screen,
-                                digit_number(manager->file->n_elines));
-            print_file_eManager(manager);
-        }
-        else
-        {
-            change_mode_eManager(manager, DIR);
-            update_bar_eScreen(manager->screen);
-            erase_window_eScreen(manager->screen, WFILE_CNT);
-            erase_window_eScreen(manager->screen, WFILE_LNUM);
-        }
-        update_file_eScreen(manager->screen, manager->file != NULL);
+        close_file_eManager(manager, item_index);
     }
     return true;
 }
@@ -759,7 +1371,7 @@ bool process_KEY_RIGHT_eManager(eManager * manager)
     else if(manager->mode == DIR)
         move_next_item_menu_eScreen(manager->screen, MDIR);
     else if(manager->mode == BAR)
-        move_next_item_menu_eScreen(manager->screen, MBAR);
+        move_next_tab_eScreen(manager->screen);
 
     return true;
 }
@@ -794,7 +1406,7 @@ bool process_KEY_LEFT_eManager(eManager * manager)
     else if(manager->mode == DIR)
         move_previous_item_menu_eScreen(manager->screen, MDIR);
     else if(manager->mode == BAR)
-        move_previous_item_menu_eScreen(manager->screen, MBAR);
+        move_previous_tab_eScreen(manager->screen);
 
     return true;
 }
@@ -814,8 +1426,6 @@ bool process_KEY_DOWN_eManager(eManager * manager)
     if(manager->mode == WRITE)
     {
         eLine *next = manager->file->current_line->next;
-        unsigned int screen_height = get_height_eScreen(manager->screen,
-                                                        WFILE_CNT);
         if(next)
         {
             /* Do not get out of line with cursor  */
@@ -826,15 +1436,13 @@ bool process_KEY_DOWN_eManager(eManager * manager)
 
             /* While cursor is out of screen (line to big), pull down the
                screen */
-            while(gety_cursor_eManager(manager)+5 > screen_height-1)
-                manager->file->first_screen_line =
-                                     manager->file->first_screen_line->next;
+            scroll_to_cursor_eManager(manager);
         }
     }
     else if(manager->mode == DIR)
         move_next_item_menu_eScreen(manager->screen, MDIR);
     else if(manager->mode == BAR)
-        move_next_item_menu_eScreen(manager->screen, MBAR);
+        move_next_tab_eScreen(manager->screen);
     return true;
 }
 
@@ -872,24 +1480,489 @@ bool process_KEY_UP_eManager(eManager * manager)
     else if(manager->mode == DIR)
         move_previous_item_menu_eScreen(manager->screen, MDIR);
     else if(manager->mode == BAR)
-        move_previous_item_menu_eScreen(manager->screen, MBAR);
+        move_previous_tab_eScreen(manager->screen);
 
     return true;
 }
 
 
 /*
- * @brief The getx_cursor_eManager() return the position x of the cursor
- *        in the file window depending on the current file.
+ * @brief The process_KEY_NPAGE_input_eManager() function process a
+ *        KEY_NPAGE (Page Down) input. The cursor and the screen move one
+ *        page down.
  *
- * @param manager: eManager pointer
+ * @param manager eManager pointer
  *
- * @return returns x position.
+ * @return returns true if the program continues and false otherwise.
  */
-unsigned int getx_cursor_eManager(eManager const * manager)
+bool process_KEY_NPAGE_eManager(eManager * manager)
 {
-    unsigned int pos = 0;
+    eFile *f = manager->file;
+    unsigned int page = 0;
+    unsigned int last_screen_line = 1;
+
+    if(manager->mode != WRITE)
+        return true;
+
+    page = page_height_eManager(manager);
+
+    /* Do not scroll after the last page */
+    if(f->n_elines > page)
+        last_screen_line = f->n_elines-page+1;
+
+    f->current_line = get_line_eFile(f, f->current_line->line_number+page);
+    if(f->first_screen_line->line_number+page < last_screen_line)
+        last_screen_line = f->first_screen_line->line_number+page;
+    if(last_screen_line > f->current_line->line_number)
+        last_screen_line = f->current_line->line_number;
+    f->first_screen_line = get_line_eFile(f, last_screen_line);
+
+    if(f->current_pos > f->current_line->length)
+        f->current_pos = f->current_line->length;
+
+    scroll_to_cursor_eManager(manager);
+
+    return true;
+}
+
+
+/*
+ * @brief The process_KEY_PPAGE_input_eManager() function process a
+ *        KEY_PPAGE (Page Up) input. The cursor and the screen move one
+ *        page up.
+ *
+ * @param manager eManager pointer
+ *
+ * @return returns true if the program continues and false otherwise.
+ */
+bool process_KEY_PPAGE_eManager(eManager * manager)
+{
+    eFile *f = manager->file;
+    unsigned int page = 0;
+    unsigned int current = 0, first = 0;
+
+    if(manager->mode != WRITE)
+        return true;
+
+    page = page_height_eManager(manager);
+    current = f->current_line->line_number;
+    first = f->first_screen_line->line_number;
+
+    f->current_line = get_line_eFile(f, (current > page) ? current-page : 1);
+    f->first_screen_line = get_line_eFile(f, (first > page) ? first-page : 1);
+
+    if(f->current_pos > f->current_line->length)
+        f->current_pos = f->current_line->length;
+
+    scroll_to_cursor_eManager(manager);
+
+    return true;
+}
+
+
+/*
+ * @brief The process_KEY_HOME_input_eManager() function process a KEY_HOME
+ *        input. The cursor moves to the beginning of the line.
+ *
+ * @param manager eManager pointer
+ *
+ * @return returns true if the program continues and false otherwise.
+ */
+bool process_KEY_HOME_eManager(eManager * manager)
+{
+    if(manager->mode == WRITE)
+        manager->file->current_pos = 0;
+
+    return true;
+}
+
+
+/*
+ * @brief The process_KEY_END_input_eManager() function process a KEY_END
+ *        input. The cursor moves to the end of the line.
+ *
+ * @param manager eManager pointer
+ *
+ * @return returns true if the program continues and false otherwise.
+ */
+bool process_KEY_END_eManager(eManager * manager)
+{
+    if(manager->mode == WRITE)
+    {
+        manager->file->current_pos = manager->file->current_line->length;
+        scroll_to_cursor_eManager(manager);
+    }
+
+    return true;
+}
+
+
+/*
+ * @brief The process_CTRL_HOME_input_eManager() function process a
+ *        Ctrl+Home input. The cursor moves to the beginning of the file.
+ *
+ * @param manager eManager pointer
+ *
+ * @return returns true if the program continues and false otherwise.
+ */
+bool process_CTRL_HOME_eManager(eManager * manager)
+{
+    if(manager->mode == WRITE)
+    {
+        manager->file->current_line = manager->file->first_file_line;
+        manager->file->first_screen_line = manager->file->first_file_line;
+        manager->file->current_pos = 0;
+    }
+
+    return true;
+}
+
+
+/*
+ * @brief The process_CTRL_END_input_eManager() function process a
+ *        Ctrl+End input. The cursor moves to the end of the file.
+ *
+ * @param manager eManager pointer
+ *
+ * @return returns true if the program continues and false otherwise.
+ */
+bool process_CTRL_END_eManager(eManager * manager)
+{
+    eFile *f = manager->file;
+    unsigned int page = 0;
+
+    if(manager->mode != WRITE)
+        return true;
+
+    page = page_height_eManager(manager);
+
+    f->current_line = get_line_eFile(f, f->n_elines);
+    f->current_pos = f->current_line->length;
+    f->first_screen_line = get_line_eFile(f, (f->n_elines > page)
+                                             ? f->n_elines-page+1 : 1);
+
+    scroll_to_cursor_eManager(manager);
+
+    return true;
+}
+
+
+/*
+ * @brief The process_ctrlg_input_eManager() function process a CTRLG input.
+ *        The cursor moves to the line number typed by the user.
+ *
+ * @param manager: eManager pointer
+ *
+ * @return returns true if the program continues and false otherwise.
+ */
+bool process_ctrlg_eManager(eManager * manager)
+{
+    char buffer[16];
+    char *end = NULL;
+    unsigned long line_number = 0;
+
+    if(manager->mode != WRITE || manager->file == NULL)
+        return true;
+
+    if(!prompt_eManager(manager, "Go to line: ", buffer, sizeof(buffer))
+       ||
+       buffer[0] == 0)
+        return true;
+
+    line_number = strtoul(buffer, &end, 10);
+    if(*end != 0 || line_number == 0)
+    {
+        add_help_msg_eManager(manager, "Invalid line number.");
+        return true;
+    }
+
+    /* The lines of a viewed file are counted by goto_line_eManager() */
+    if(manager->file->view == NULL
+       &&
+       manager->file->hex == NULL
+       &&
+       line_number > manager->file->n_elines)
+        line_number = manager->file->n_elines;
+
+    goto_line_eManager(manager, line_number);
+
+    return true;
+}
+
+
+/*
+ * @brief The process_ctrlz_input_eManager() function process a CTRLZ input.
+ *        The last modifications of the file are undone.
+ *
+ * @param manager: eManager pointer
+ *
+ * @return returns true if the program continues and false otherwise.
+ */
+bool process_ctrlz_eManager(eManager * manager)
+{
+    if(manager->mode != WRITE || manager->file == NULL)
+        return true;
+
+    /* The screen is printed once by run_eManager() */
+    if(undo_eUndo(manager->file->undo, manager->file) == -1)
+    {
+        add_help_msg_eManager(manager, "Nothing to undo.");
+        return true;
+    }
+
+    show_cursor_eManager(manager);
+
+    return true;
+}
+
+
+/*
+ * @brief The process_ctrly_input_eManager() function process a CTRLY input.
+ *        The last undone modifications of the file are redone.
+ *
+ * @param manager: eManager pointer
+ *
+ * @return returns true if the program continues and false otherwise.
+ */
+bool process_ctrly_eManager(eManager * manager)
+{
+    if(manager->mode != WRITE || manager->file == NULL)
+        return true;
+
+    if(redo_eUndo(manager->file->undo, manager->file) == -1)
+    {
+        add_help_msg_eManager(manager, "Nothing to redo.");
+        return true;
+    }
+
+    show_cursor_eManager(manager);
+
+    return true;
+}
+
+
+/*
+ * @brief The process_ctrll_input_eManager() function process a CTRLL input.
+ *        The bytes appended to the file are added as lines, like tail -f,
+ *        until the next CTRLL.
+ *
+ * @param manager: eManager pointer
+ *
+ * @return returns true if the program continues and false otherwise.
+ */
+bool process_ctrll_eManager(eManager * manager)
+{
+    eFile *file = manager->file;
+
+    if(manager->mode != WRITE || file == NULL)
+        return true;
+
+    /* The input piped to edito is read until its end */
+    if(file->follow != NULL && file->follow->stream)
+    {
+        add_help_msg_eManager(manager, "The input is still read.");
+        return true;
+    }
+
+    if(file->follow != NULL)
+    {
+        delete_eFollow(&file->follow);
+        add_help_msg_eManager(manager, "Follow stopped.");
+        return true;
+    }
+
+    if(file->view != NULL)
+    {
+        add_help_msg_eManager(manager, "No follow in a huge file.");
+        return true;
+    }
+
+    /* The bytes appended to a compressed file are not lines */
+    if(file->fd != -1 && get_decompressor_eLoad(file->fd) != NULL)
+    {
+        add_help_msg_eManager(manager, "No follow in a compressed file.");
+        return true;
+    }
+
+    /* The lines of the file are read first */
+    if(is_loading_eManager(manager, file))
+    {
+        add_help_msg_eManager(manager, "File is loading.");
+        return true;
+    }
+
+    file->follow = create_eFollow(file->realpath, file->fd,
+                                  file->file_stat.st_size);
+    if(file->follow == NULL)
+    {
+        add_help_msg_eManager(manager, "Impossible to follow the file.");
+        return true;
+    }
+
+    /* The cursor waits for the new lines at the end */
+    file->current_line = file->lines[file->n_elines-1];
+    follow_cursor_eManager(manager, file);
+    add_help_msg_eManager(manager, "Following the file (Ctrl+L: stop).");
+
+    return true;
+}
+
+
+/*
+ * @brief The process_ctrle_input_eManager() function process a CTRLE input.
+ *        Only the lines matching the pattern typed by the user are shown,
+ *        until the next CTRLE.
+ *
+ * @param manager: eManager pointer
+ *
+ * @return returns true if the program continues and false otherwise.
+ */
+bool process_ctrle_eManager(eManager * manager)
+{
+    eFile *file = manager->file;
+    char buffer[128];
+    char message[192];
+
+    if(manager->mode != WRITE || file == NULL)
+        return true;
+
+    /* The cursor stays on the line it is on in the filter */
+    if(file->filter != NULL)
+    {
+        delete_eFilter(&file->filter);
+        if(file->view != NULL)
+            scroll_view_eManager(manager);
+        else
+            show_cursor_eManager(manager);
+        add_help_msg_eManager(manager, "Filter cleared.");
+        return true;
+    }
+
+    /* The lines of the file are read first */
+    if(is_loading_eManager(manager, file))
+    {
+        add_help_msg_eManager(manager, "File is loading.");
+        return true;
+    }
+
+    if(!prompt_eManager(manager, "Filter: ", buffer, sizeof(buffer))
+       ||
+       buffer[0] == 0)
+        return true;
+
+    file->filter = create_eFilter(buffer);
+    if(file->filter == NULL)
+    {
+        add_help_msg_eManager(manager, "Invalid pattern.");
+        return true;
+    }
+
+    /* The first screen is scanned now, the other lines in the background */
+    scan_filter_eFile(file, get_height_eScreen(manager->screen, WFILE_CNT),
+                      FILTER_BUDGET);
+    if(file->filter->n_matches == 0 && file->filter->finished)
+    {
+        delete_eFilter(&file->filter);
+        add_help_msg_eManager(manager, "No line matches.");
+        return true;
+    }
+
+    if(file->filter->n_matches > 0)
+        move_filter_eManager(manager, 0);
+
+    snprintf(message, sizeof(message), "Filter: %s (Ctrl+E: clear)", buffer);
+    add_help_msg_eManager(manager, message);
+
+    return true;
+}
+
+
+/*
+ * @brief The process_ctrlw_input_eManager() function process a CTRLW input.
+ *        The file used before the current one is shown, so that two files
+ *        are switched at once. In BAR mode, the cursor moves to the file
+ *        used before the file under it, the files are walked from the most
+ *        recently used.
+ *
+ * @param manager: eManager pointer
+ *
+ * @return returns true if the program continues and false otherwise.
+ */
+bool process_ctrlw_eManager(eManager * manager)
+{
+    eFile *file = NULL;
+    int tab = get_current_tab_eScreen(manager->screen);
+
+    if(count_eBar(manager->bar) == 0)
+    {
+        add_help_msg_eManager(manager, "No files open.");
+        return true;
+    }
+
+    if(manager->mode == BAR)
+    {
+        file = (eFile *) get_file_eBar(manager->bar, tab);
+        file = (eFile *) get_used_file_eBar(manager->bar, file);
+        set_current_tab_eScreen(manager->screen,
+                                get_index_eBar(manager->bar, file));
+        return true;
+    }
+
+    file = (eFile *) get_used_file_eBar(manager->bar, manager->file);
+    if(file == manager->file)
+    {
+        add_help_msg_eManager(manager, "No other file open.");
+        return true;
+    }
+
+    set_eFile_eManager(manager, file);
+    if(manager->file == file)
+    {
+        set_current_tab_eScreen(manager->screen,
+                                get_index_eBar(manager->bar, file));
+        update_bar_eScreen(manager->screen);
+        change_mode_eManager(manager, WRITE);
+    }
+
+    return true;
+}
+
+
+/*
+ * @brief The getx_cursor_eManager() return the position x of the cursor
+ *        in the file window depending on the current file.
+ *
+ * @param manager: eManager pointer
+ *
+ * @return returns x position.
+ */
+unsigned int getx_cursor_eManager(eManager const * manager)
+{
+    unsigned int pos = 0;
     size_t width = get_width_eScreen(manager->screen, WFILE_CNT);
+    eView *view = manager->file->view;
+    char const *string = NULL;
+    size_t length = 0, shift = 0;
+
+    /* The cursor of a binary file is at the beginning of its row */
+    if(manager->file->hex != NULL)
+        return 0;
+
+    /* The current line of a viewed or filtered file is shifted by whole
+       windows */
+    if(view != NULL || manager->file->filter != NULL)
+    {
+        pos = (view != NULL) ? view->current_pos : manager->file->current_pos;
+        string = get_string_eManager(manager->file,
+                                     (view != NULL)
+                                     ? view->current_line
+                                     : manager->file->current_line->line_number,
+                                     &length);
+        shift = pos/width*width;
+        return (string != NULL)
+               ? screen_width_of_string(string+shift, pos-shift)
+               : 0;
+    }
 
     pos = screen_width_of_string(manager->file->current_line->string,
                                  manager->file->current_pos) % width;
@@ -911,9 +1984,27 @@ unsigned int gety_cursor_eManager(eManager const * manager)
     size_t width = 0;
     unsigned int y = 0;
     eLine *current = NULL;
+    eFilter *filter = manager->file->filter;
 
     width = get_width_eScreen(manager->screen, WFILE_CNT);
 
+    if(manager->file->hex != NULL)
+        return manager->file->hex->current_row
+               - manager->file->hex->first_screen_row;
+
+    if(filter != NULL)
+    {
+        y = find_eFilter(filter, (manager->file->view != NULL)
+                                 ? manager->file->view->current_line
+                                 : manager->file->current_line->line_number);
+        return (y > filter->first_screen_match)
+               ? y-filter->first_screen_match : 0;
+    }
+
+    if(manager->file->view != NULL)
+        return manager->file->view->current_line
+               - manager->file->view->first_screen_line;
+
     y=0;
     current = manager->file->first_screen_line;
     while(current && current != manager->file->current_line)
@@ -1057,6 +2148,15 @@ int fill_directory_menu_eManager(eManager const * manager,
  */
 int print_file_eManager(eManager const * manager)
 {
+    if(manager->file->hex != NULL)
+        return print_hex_eManager(manager);
+
+    if(manager->file->filter != NULL)
+        return print_filter_eManager(manager);
+
+    if(manager->file->view != NULL)
+        return print_view_eManager(manager);
+
     /* y pos on the screen */
     int y_pos = 0;
 
@@ -1126,6 +2226,2578 @@ int print_file_eManager(eManager const * manager)
 }
 
 
+/**
+ * @brief The print_finder_eManager() function print the pattern and the
+ *        results of the file finder in the popup.
+ *
+ * @param manager: eManager pointer
+ * @param query: Pattern typed by the user
+ * @param selected: Index of the selected result
+ */
+static void print_finder_eManager(eManager const * manager,
+                                  char const * query,
+                                  unsigned int selected)
+{
+    int width = get_width_eScreen(manager->screen, WPOPUP) - 4;
+    int height = get_height_eScreen(manager->screen, WPOPUP) - 3;
+    char const *path = NULL;
+    char *line = NULL;
+    size_t length = 0;
+
+    line = (char *) malloc((width+1)*sizeof(char));
+    if(line == NULL)
+        return;
+
+    erase_window_eScreen(manager->screen, WPOPUP);
+
+    snprintf(line, width+1, "> %s", query);
+    print_line_eScreen(manager->screen, WPOPUP, 1, 2, line);
+
+    for(int i=0; i<height-1; i++)
+    {
+        path = get_path_eFinder(manager->finder, i);
+        if(path == NULL)
+            break;
+
+        /* Keep the end of long paths, the filename matters most */
+        length = strlen(path);
+        if(length > (size_t) width)
+            path += length - width;
+        snprintf(line, width+1, "%s", path);
+
+        if((unsigned int) i == selected)
+            print_selected_line_eScreen(manager->screen, WPOPUP,
+                                        i+2, 2, line);
+        else
+            print_line_eScreen(manager->screen, WPOPUP, i+2, 2, line);
+    }
+
+    update_popup_eScreen(manager->screen);
+    move_cursor_eScreen(manager->screen, 1, 4+strlen(query), WPOPUP);
+    free(line);
+}
+
+
+/**
+ * @brief The open_file_eManager() function open the file if it is not in
+ *        the bar, select it in the bar and enter WRITE mode.
+ *
+ * @param manager: eManager pointer
+ * @param file: eFile pointer
+ *
+ * @return 0 on success or -1 in failure.
+ */
+static int open_file_eManager(eManager * manager,
+                              eFile * file)
+{
+    eFile *open = NULL;
+    char *buffer = NULL;
+    int buffer_length = 0;
+
+    /* A link to an open file, or the same path, shows the open file */
+    open = (eFile *) find_file_eBar(manager->bar, file);
+    if(open != NULL)
+        file = open;
+
+    /* If file isn't in the bar */
+    if(open == NULL)
+    {
+        /* Try to open the file, the lines are read in background */
+        if(load_file_eManager(manager, file) == -1)
+        {
+            add_help_msg_eManager(manager, "Impossible to open file.");
+            return -1;
+        }
+        add_open_msg_eManager(manager, file);
+        set_limit_eUndo(file->undo, manager->undo_limit);
+
+
+        /* Add file to eBar or quit, adding file to eBar */
+        if(add_file_eBar(manager->bar, file) == -1)
+            return -1;
+
+        if(manager->watch != NULL)
+            add_eWatch(manager->watch, file->realpath);
+
+        /* Add filename to the bar menu */
+        buffer_length = strlen(file->filename)+1;
+        buffer = (char *) malloc(buffer_length*sizeof(char));
+        memset(buffer, 0, buffer_length);
+        strcpy(buffer, file->filename);
+
+        /* Add a tab after the others, and refresh the window */
+        add_tab_eScreen(manager->screen, buffer);
+        free(buffer);
+
+        /* Deplace cursor to the file in the tabs */
+        set_current_tab_eScreen(manager->screen,
+                                count_eBar(manager->bar)-1);
+        update_bar_eScreen(manager->screen);
+
+        /* Create or resize file Window for the file (resize for lines
+           number) */
+        if(manager->screen->windows[WFILE_CNT] == NULL)
+            create_file_window_eScreen(manager->screen,
+                                       digit_number(file->n_elines));
+        else
+            resize_file_eScreen(manager->screen,
+                                digit_number(file->n_elines));
+    }
+    /* The file is in the bar, its lines may be packed */
+    else
+    {
+        if(unpack_file_eManager(manager, file) == -1)
+        {
+            add_help_msg_eManager(manager, "Impossible to open file.");
+            return -1;
+        }
+
+        /* Deplace cursor to the file in the tabs, two files may have the
+           same name */
+        set_current_tab_eScreen(manager->screen,
+                                get_index_eBar(manager->bar, file));
+        update_bar_eScreen(manager->screen);
+        resize_file_eScreen(manager->screen,
+                            digit_number(file->n_elines));
+    }
+
+    /* Enter write mode */
+    set_eFile_eManager(manager, file);
+    change_mode_eManager(manager, WRITE);
+
+    return 0;
+}
+
+
+/**
+ * @brief The add_open_msg_eManager() function tell the user how a file
+ *        which was just opened is shown.
+ *
+ * @param manager: eManager pointer
+ * @param file: eFile pointer
+ */
+static void add_open_msg_eManager(eManager * manager,
+                                  eFile const * file)
+{
+    if(file->view != NULL)
+        add_help_msg_eManager(manager, "Huge file, paged without undo.");
+    else if(file->hex != NULL)
+        add_help_msg_eManager(manager, "Binary file, shown in hex.");
+    else if(file->follow != NULL)
+        add_help_msg_eManager(manager, "Decompressing, readonly file.");
+    else if(file->permissions == p_READONLY)
+        add_help_msg_eManager(manager, "Readonly file.");
+}
+
+
+/**
+ * @brief The unpack_file_eManager() function unpack a file of the bar. A
+ *        file of the previous session was never read, it is opened like a
+ *        new file and its cursor is put back once its line is read.
+ *
+ * @param manager: eManager pointer
+ * @param file: eFile pointer
+ *
+ * @return 0 on success or -1 in failure, the file stays packed then.
+ */
+static int unpack_file_eManager(eManager * manager,
+                                eFile * file)
+{
+    ePack *pack = NULL;
+
+    if(!is_restored_eFile(file))
+        return unpack_eFile(file);
+
+    /* The pack is kept aside, a failed open closes the file */
+    pack = file->pack;
+    file->pack = NULL;
+    if(load_file_eManager(manager, file) == -1)
+    {
+        file->pack = pack;
+        return -1;
+    }
+    file->pack = pack;
+    add_open_msg_eManager(manager, file);
+    set_limit_eUndo(file->undo, manager->undo_limit);
+
+    /* The lines before the cursor are read first */
+    if(file->n_elines < pack->current_line
+       &&
+       is_loading_eManager(manager, file))
+        process_loads_eManager(manager, true);
+
+    return unpack_eFile(file);
+}
+
+
+/**
+ * @brief The close_file_eManager() function close a file of the bar and
+ *        show the previous one.
+ *
+ * @param manager: eManager pointer
+ * @param item_index: Index of the file in the bar
+ */
+static void close_file_eManager(eManager * manager,
+                                unsigned int item_index)
+{
+    eFile *file = NULL;
+
+    file = (eFile *) get_file_eBar(manager->bar, item_index);
+
+    /* The lines not read yet are not needed anymore, a save reads the
+       view of the file */
+    cancel_load_eManager(manager, file);
+    process_saves_eManager(manager, file);
+
+    if(file == manager->file)
+    {
+       set_eFile_eManager(manager, NULL);
+    }
+
+    // TODO: Si modifié, faire une popup qui demande à enregistrer
+    remove_file_eBar(manager->bar, item_index);
+    remove_tab_eScreen(manager->screen, item_index);
+    close_eFile(file);
+
+    if(count_eBar(manager->bar) != 0)
+    {
+        item_index = (item_index == 0) ? 0 : item_index-1;
+        file = (eFile *) get_file_eBar(manager->bar, item_index);
+        set_current_tab_eScreen(manager->screen, item_index);
+        set_eFile_eManager(manager, file);
+    }
+    update_bar_eScreen(manager->screen);
+
+    if(manager->file != NULL)
+    {
+        resize_file_eScreen(manager->screen,
+                            digit_number(manager->file->n_elines));
+        print_file_eManager(manager);
+    }
+    else
+    {
+        change_mode_eManager(manager, DIR);
+        erase_window_eScreen(manager->screen, WFILE_CNT);
+        erase_window_eScreen(manager->screen, WFILE_LNUM);
+    }
+    update_file_eScreen(manager->screen, manager->file != NULL);
+}
+
+
+/**
+ * @brief The load_file_eManager() function open a file and start reading
+ *        its lines in background. The function returns once the first
+ *        lines are read, the next ones are added by
+ *        process_loads_eManager().
+ *
+ * @param manager: eManager pointer
+ * @param file: eFile pointer
+ *
+ * @return 0 on success or -1 in failure.
+ */
+static int load_file_eManager(eManager * manager,
+                              eFile * file)
+{
+    eLoad **loads = NULL;
+    eLoad *load = NULL;
+    bool adopted = false;
+
+    /* A buffer read from a pipe has no file to open */
+    if(file->follow != NULL && file->follow->stream)
+        return 0;
+
+    adopted = adopt_prefetch_eManager(manager, file);
+
+    if(!adopted && begin_open_eFile(file) == -1)
+        return -1;
+
+    /* A new file has nothing to read */
+    if(file->fd == -1)
+    {
+        end_open_eFile(file);
+        return 0;
+    }
+
+    /* A compressed file is decompressed by a process, its output is read
+       like a pipe */
+    if(!adopted && get_decompressor_eLoad(file->fd) != NULL)
+        return decompress_file_eManager(file);
+
+    /* A binary file is shown in hexadecimal, its lines are not read */
+    if(!adopted && is_binary_eLoad(file->fd) && hex_eFile(file) == 0)
+        return 0;
+
+    /* A huge file is shown from a mapping, its lines are not read */
+    if(!adopted
+       &&
+       file->file_stat.st_size >= manager->view_threshold
+       &&
+       view_eFile(file) == 0)
+    {
+        set_budget_eView(file->view, manager->view_budget);
+        return 0;
+    }
+
+    loads = (eLoad **) realloc(manager->loads,
+                               (manager->n_loads+1)*sizeof(eLoad *));
+    if(loads != NULL)
+        manager->loads = loads;
+
+    if(adopted)
+    {
+        load = manager->prefetch;
+        manager->prefetch = NULL;
+    }
+
+    if(loads == NULL || (load == NULL && (load = create_eLoad(file)) == NULL))
+    {
+        delete_eLoad(&load);
+        close_eFile(file);
+        return -1;
+    }
+    manager->loads[manager->n_loads++] = load;
+
+    /* Without thread, the file is read now */
+    if(!adopted && start_eLoad(load) == -1)
+        read_eLoad(load);
+
+    /* The first lines are shown as soon as they are read */
+    wait_lines_eLoad(load);
+    process_loads_eManager(manager, false);
+
+    return 0;
+}
+
+
+/**
+ * @brief The decompress_file_eManager() function start decompressing a
+ *        compressed file opened by begin_open_eFile(). The lines are
+ *        appended as they are decompressed, see follow_files_eManager().
+ *        The buffer can be modified but not saved over the compressed file.
+ *
+ * @param file: eFile pointer
+ *
+ * @return 0 on success or -1 in failure.
+ */
+static int decompress_file_eManager(eFile * file)
+{
+    pid_t pid = -1;
+    int fd = -1;
+
+    fd = decompress_eLoad(file->fd, get_decompressor_eLoad(file->fd), &pid);
+    if(fd == -1)
+    {
+        close_eFile(file);
+        return -1;
+    }
+
+    file->follow = create_eFollow(NULL, fd, 0);
+    close(fd);
+    if(file->follow == NULL)
+    {
+        kill(pid, SIGTERM);
+        waitpid(pid, NULL, 0);
+        close_eFile(file);
+        return -1;
+    }
+    file->follow->pid = pid;
+
+    /* The modifications of the buffer are not journaled, they can not be
+       replayed on the compressed file */
+    delete_eJournal(&file->journal, true);
+    file->permissions = p_READONLY;
+    end_open_eFile(file);
+
+    return 0;
+}
+
+
+/**
+ * @brief The cancel_load_eManager() function stop reading the lines of a
+ *        file. The lines already read stay in the file.
+ *
+ * @param manager: eManager pointer
+ * @param file: eFile pointer
+ *
+ * @return true if the file was loading, false otherwise.
+ */
+static bool cancel_load_eManager(eManager * manager,
+                                 eFile const * file)
+{
+    unsigned int n = 0;
+    bool found = false;
+
+    for(unsigned int i=0; i<manager->n_loads; i++)
+    {
+        if(manager->loads[i]->file != file)
+        {
+            manager->loads[n++] = manager->loads[i];
+            continue;
+        }
+
+        delete_eLoad(&manager->loads[i]);
+        found = true;
+    }
+    manager->n_loads = n;
+
+    return found;
+}
+
+
+/**
+ * @brief The is_loading_eManager() function return true if the lines of
+ *        a file are still read in background.
+ *
+ * @param manager: eManager pointer
+ * @param file: eFile pointer
+ *
+ * @return true if the file is loading, false otherwise.
+ */
+static bool is_loading_eManager(eManager const * manager,
+                                eFile const * file)
+{
+    for(unsigned int i=0; i<manager->n_loads; i++)
+    {
+        if(manager->loads[i]->file == file)
+            return true;
+    }
+
+    return false;
+}
+
+
+/**
+ * @brief The is_saving_eManager() function return true if a save of a file
+ *        was not reported yet.
+ *
+ * @param manager: eManager pointer
+ * @param file: eFile pointer
+ *
+ * @return true if the file has a save, false otherwise.
+ */
+static bool is_saving_eManager(eManager const * manager,
+                               eFile const * file)
+{
+    for(unsigned int i=0; i<manager->n_saves; i++)
+    {
+        if(manager->saves[i]->file == file)
+            return true;
+    }
+
+    return false;
+}
+
+
+/**
+ * @brief The process_loads_eManager() function add the lines read in
+ *        background to their file and finish the finished loads.
+ *
+ * @param manager: eManager pointer
+ * @param wait: Wait until every file is read
+ */
+static void process_loads_eManager(eManager * manager,
+                                   bool wait)
+{
+    eLoad *load = NULL;
+    eLine *first_line = NULL, *last_line = NULL;
+    char message[128];
+    unsigned int n_lines = 0;
+    unsigned int n = 0;
+    bool finished = false;
+
+    for(unsigned int i=0; i<manager->n_loads; i++)
+    {
+        load = manager->loads[i];
+
+        do
+        {
+            if(wait)
+                wait_lines_eLoad(load);
+
+            /* Lines handed before the end are all taken */
+            finished = is_finished_eLoad(load);
+            n_lines = take_lines_eLoad(load, &first_line, &last_line);
+            if(n_lines > 0)
+                append_lines_eFile(load->file, first_line, last_line,
+                                   n_lines);
+        } while(wait && !finished);
+
+        if(!finished)
+        {
+            manager->loads[n++] = load;
+            continue;
+        }
+
+        /* A file partially read must not be saved */
+        if(load->result == -1)
+        {
+            load->file->permissions = p_READONLY;
+            snprintf(message, sizeof(message),
+                     "Impossible to read %s, readonly file.",
+                     load->file->filename);
+            add_help_msg_eManager(manager, message);
+        }
+        else
+            load->file->disk_hash = load->hash;
+
+        end_open_eFile(load->file);
+        delete_eLoad(&load);
+    }
+
+    manager->n_loads = n;
+}
+
+
+/**
+ * @brief The adopt_prefetch_eManager() function keep the lines of a file
+ *        read while the cursor of the directory rested on it, if the file
+ *        did not change since. The prefetch is dropped otherwise.
+ *
+ * @param manager: eManager pointer
+ * @param file: eFile pointer
+ *
+ * @return true if the prefetch is kept in manager->prefetch, false
+ *         otherwise.
+ */
+static bool adopt_prefetch_eManager(eManager * manager,
+                                    eFile * file)
+{
+    struct stat info;
+
+    if(manager->prefetch == NULL || manager->prefetch->file != file)
+    {
+        drop_prefetch_eManager(manager);
+        return false;
+    }
+
+    if(stat(file->realpath, &info) == 0
+       &&
+       info.st_ino == file->file_stat.st_ino
+       &&
+       info.st_size == file->file_stat.st_size
+       &&
+       info.st_mtim.tv_sec == file->file_stat.st_mtim.tv_sec
+       &&
+       info.st_mtim.tv_nsec == file->file_stat.st_mtim.tv_nsec)
+        return true;
+
+    drop_prefetch_eManager(manager);
+    return false;
+}
+
+
+/**
+ * @brief The process_prefetch_eManager() function follow the cursor of
+ *        the directory. A file is prefetched once the cursor rested on it
+ *        PREFETCH_DELAY, the work is dropped when the cursor moves on.
+ *
+ * @param manager: eManager pointer
+ */
+static void process_prefetch_eManager(eManager * manager)
+{
+    eDirectory *directory = NULL;
+    eFile *file = NULL;
+    struct timespec now;
+    unsigned int item_index = 0;
+    long elapsed = 0;
+
+    if(manager->mode != DIR)
+        return;
+
+    item_index = get_current_item_index_menu_eScreen(manager->screen, MDIR);
+    get_item_at_index_eDirectory(manager->directory, item_index,
+                                 &directory, &file);
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    if(file != manager->dwell_file)
+    {
+        drop_prefetch_eManager(manager);
+        manager->dwell_file = file;
+        manager->dwell_time = now;
+        manager->dwell_done = (file == NULL);
+        return;
+    }
+
+    if(manager->dwell_done)
+        return;
+
+    elapsed = (now.tv_sec - manager->dwell_time.tv_sec)*1000
+              + (now.tv_nsec - manager->dwell_time.tv_nsec)/1000000;
+    if(elapsed < PREFETCH_DELAY)
+        return;
+
+    manager->dwell_done = true;
+    prefetch_file_eManager(manager, file);
+}
+
+
+/**
+ * @brief The prefetch_file_eManager() function start reading a file before
+ *        it is opened. A file bigger than PREFETCH_BUDGET is only read in
+ *        the page cache, up to PREFETCH_BUDGET bytes.
+ *
+ * @param manager: eManager pointer
+ * @param file: eFile pointer
+ */
+static void prefetch_file_eManager(eManager * manager,
+                                   eFile * file)
+{
+    struct stat info;
+    eLoad *load = NULL;
+
+    /* A new file would be created */
+    if(file->permissions == p_NOPERM || file->permissions == p_CREATE)
+        return;
+
+    if(is_file_in_eBar(manager->bar, file)
+       ||
+       stat(file->realpath, &info) == -1
+       ||
+       !S_ISREG(info.st_mode))
+        return;
+
+    if(info.st_size > PREFETCH_BUDGET
+       ||
+       info.st_size >= manager->view_threshold)
+    {
+        prefetch_eLoad(file->realpath, PREFETCH_BUDGET);
+        return;
+    }
+
+    if(begin_open_eFile(file) == -1)
+        return;
+
+    /* A binary file is not read, see hex_eFile(), and a compressed one is
+       read from its decompressor, see decompress_file_eManager() */
+    if(is_binary_eLoad(file->fd) || get_decompressor_eLoad(file->fd) != NULL)
+    {
+        close_eFile(file);
+        return;
+    }
+
+    if((load = create_eLoad(file)) == NULL || start_eLoad(load) == -1)
+    {
+        delete_eLoad(&load);
+        close_eFile(file);
+        return;
+    }
+
+    manager->prefetch = load;
+}
+
+
+/**
+ * @brief The drop_prefetch_eManager() function stop reading the prefetched
+ *        file and close it.
+ *
+ * @param manager: eManager pointer
+ */
+static void drop_prefetch_eManager(eManager * manager)
+{
+    eFile *file = NULL;
+
+    if(manager->prefetch == NULL)
+        return;
+
+    file = manager->prefetch->file;
+    delete_eLoad(&manager->prefetch);
+    close_eFile(file);
+}
+
+
+/**
+ * @brief The process_view_eManager() function process an input on a viewed
+ *        file. The pages of the file are modified, without undo history.
+ *
+ * @param manager: eManager pointer
+ * @param input: User input to process
+ *
+ * @return true if the input was processed, false if it is processed as
+ *         for another file.
+ */
+static bool process_view_eManager(eManager * manager,
+                                  int input)
+{
+    eView *view = manager->file->view;
+    unsigned int page = page_height_eManager(manager);
+    unsigned int last = 0;
+    size_t length = 0;
+    char character = (char) input;
+
+    get_line_eView(view, view->current_line, &length);
+
+    if(input > 0 && input == key_code_eManager("kHOM5"))
+        view->current_line = 1;
+
+    else if(input > 0 && input == key_code_eManager("kEND5"))
+        view->current_line = extend_eView(view, UINT_MAX);
+
+    else switch(input)
+    {
+        case KEY_UP:
+            if(view->current_line > 1)
+                view->current_line--;
+            break;
+
+        case KEY_DOWN:
+            if(extend_eView(view, view->current_line+1) > view->current_line)
+                view->current_line++;
+            break;
+
+        case KEY_NPAGE:
+            last = extend_eView(view, view->current_line+page);
+            view->current_line = (last < view->current_line+page)
+                                 ? last : view->current_line+page;
+            view->first_screen_line += page;
+            break;
+
+        case KEY_PPAGE:
+            view->current_line = (view->current_line > page)
+                                 ? view->current_line-page : 1;
+            view->first_screen_line = (view->first_screen_line > page)
+                                      ? view->first_screen_line-page : 1;
+            break;
+
+        case KEY_LEFT:
+            if(view->current_pos > 0)
+                view->current_pos--;
+            else if(view->current_line > 1)
+            {
+                view->current_line--;
+                view->current_pos = UINT_MAX;
+            }
+            break;
+
+        case KEY_RIGHT:
+            if(view->current_pos < length)
+                view->current_pos++;
+            else if(extend_eView(view, view->current_line+1)
+                    > view->current_line)
+            {
+                view->current_line++;
+                view->current_pos = 0;
+            }
+            break;
+
+        case KEY_HOME:
+            view->current_pos = 0;
+            break;
+
+        case KEY_END:
+            view->current_pos = length;
+            break;
+
+        case CTRL('s'):
+            return false;
+
+        case CTRL('z'):
+        case CTRL('y'):
+            add_help_msg_eManager(manager, "No undo in a huge file.");
+            break;
+
+        case '\n':
+        case KEY_BACKSPACE:
+        case KEY_DC:
+            edit_view_eManager(manager, input);
+            break;
+
+        default:
+            if(!isprint(input) && input != '\t')
+                return false;
+            edit_view_eManager(manager, character);
+            break;
+    }
+
+    /* The cursor stays in its line */
+    get_line_eView(view, view->current_line, &length);
+    if(view->current_pos > length)
+        view->current_pos = length;
+
+    scroll_view_eManager(manager);
+
+    return true;
+}
+
+
+/**
+ * @brief The edit_view_eManager() function insert a character or remove
+ *        one at the cursor of a viewed file.
+ *
+ * @param manager: eManager pointer
+ * @param input: Character to insert, KEY_BACKSPACE or KEY_DC
+ */
+static void edit_view_eManager(eManager * manager,
+                               int input)
+{
+    eView *view = manager->file->view;
+    eFilter *filter = manager->file->filter;
+    unsigned int n_lines = view->n_lines, line_number = 0;
+    char const *string = NULL;
+    size_t length = 0;
+    char character = (char) input;
+    int result = 0;
+
+    if(manager->file->permissions != p_READWRITE)
+    {
+        add_help_msg_eManager(manager, "Readonly file.");
+        return;
+    }
+
+    if(input == KEY_BACKSPACE && view->current_pos > 0)
+    {
+        result = remove_eView(view, view->current_line,
+                              --view->current_pos, 1);
+    }
+    else if(input == KEY_BACKSPACE)
+    {
+        /* The line is joined with the previous one */
+        if(view->current_line == 1)
+            return;
+
+        view->current_line--;
+        get_line_eView(view, view->current_line, &length);
+        view->current_pos = length;
+        result = remove_eView(view, view->current_line, length, 1);
+    }
+    else if(input == KEY_DC)
+        result = remove_eView(view, view->current_line, view->current_pos, 1);
+    else if((result = insert_eView(view, view->current_line,
+                                   view->current_pos, &character, 1)) == 0)
+    {
+        if(input == '\n')
+        {
+            view->current_line++;
+            view->current_pos = 0;
+        }
+        else
+            view->current_pos++;
+    }
+
+    if(result == -1)
+    {
+        add_help_msg_eManager(manager, "Impossible to modify the file.");
+        return;
+    }
+
+    /* The filter scans again the modified line, and shifts the lines after
+       a line split or joined */
+    if(filter != NULL)
+    {
+        line_number = (input == '\n') ? view->current_line-1
+                                      : view->current_line;
+        if(view->n_lines > n_lines)
+        {
+            string = get_line_eView(view, line_number+1, &length);
+            insert_line_eFilter(filter, line_number+1, string, length);
+        }
+        else if(view->n_lines < n_lines)
+            delete_line_eFilter(filter, line_number+1);
+
+        string = get_line_eView(view, line_number, &length);
+        update_line_eFilter(filter, line_number, string, length);
+    }
+
+    manager->file->is_saved = false;
+}
+
+
+/**
+ * @brief The scroll_view_eManager() function scroll the viewed file until
+ *        its cursor is visible, and index its lines until the bottom of
+ *        the screen.
+ *
+ * @param manager: eManager pointer
+ */
+static void scroll_view_eManager(eManager * manager)
+{
+    eView *view = manager->file->view;
+    unsigned int height = get_height_eScreen(manager->screen, WFILE_CNT);
+
+    if(extend_eView(view, view->current_line) < view->current_line)
+        view->current_line = view->n_lines;
+
+    if(view->first_screen_line > view->current_line)
+        view->first_screen_line = view->current_line;
+
+    if(view->current_line >= view->first_screen_line+height)
+        view->first_screen_line = view->current_line-height+1;
+
+    extend_eView(view, view->first_screen_line+height);
+}
+
+
+/**
+ * @brief The print_view_eManager() function print the lines of the screen
+ *        of a viewed file. A line longer than the window is cut, the
+ *        current line is shifted to show the cursor.
+ *
+ * @param manager: eManager pointer
+ *
+ * @return 0 on success or -1 in failure.
+ */
+static int print_view_eManager(eManager const * manager)
+{
+    eView *view = manager->file->view;
+    int height = get_height_eScreen(manager->screen, WFILE_CNT);
+    size_t width = get_width_eScreen(manager->screen, WFILE_CNT);
+    int line_number_width = digit_number(get_n_lines_eManager(manager));
+    char number[16];
+    char const *string = NULL;
+    size_t length = 0, shift = 0;
+
+    erase_window_eScreen(manager->screen, WFILE_CNT);
+    erase_window_eScreen(manager->screen, WFILE_LNUM);
+
+    for(int y=0; y<height; y++)
+    {
+        string = get_line_eView(view, view->first_screen_line+y, &length);
+        if(string == NULL)
+        {
+            snprintf(number, sizeof(number), "%*c", line_number_width, '~');
+            print_line_eScreen(manager->screen, WFILE_LNUM, y, 1, number);
+            continue;
+        }
+
+        shift = (view->first_screen_line+y == view->current_line)
+                ? view->current_pos/width*width : 0;
+        string += shift;
+        length -= shift;
+
+        snprintf(number, sizeof(number), "%*u", line_number_width,
+                 view->first_screen_line+y);
+        print_line_eScreen(manager->screen, WFILE_LNUM, y, 1, number);
+        print_string_eScreen(manager->screen, WFILE_CNT, y, 0, string,
+                             (length < width) ? length : width);
+    }
+
+    return 0;
+}
+
+
+/**
+ * @brief The get_n_lines_eManager() function return the number of lines
+ *        of the current file. The lines of a viewed file are counted until
+ *        the bottom of the screen.
+ *
+ * @param manager: eManager pointer
+ *
+ * @return Number of lines.
+ */
+static unsigned int get_n_lines_eManager(eManager const * manager)
+{
+    eView *view = manager->file->view;
+    unsigned int height = get_height_eScreen(manager->screen, WFILE_CNT);
+
+    if(manager->file->hex != NULL)
+        return manager->file->hex->n_rows;
+
+    if(view == NULL)
+        return manager->file->n_elines;
+
+    return extend_eView(view, view->first_screen_line+height);
+}
+
+
+/**
+ * @brief The process_filter_eManager() function process an input moving
+ *        the cursor of a filtered file. The cursor moves from a matching
+ *        line to another.
+ *
+ * @param manager: eManager pointer
+ * @param input: User input to process
+ *
+ * @return true if the input was processed, false if it is processed as
+ *         for another file.
+ */
+static bool process_filter_eManager(eManager * manager,
+                                    int input)
+{
+    eFile *file = manager->file;
+    eFilter *filter = file->filter;
+    unsigned int page = page_height_eManager(manager);
+    unsigned int index = 0, pos = 0;
+    size_t length = 0;
+
+    if(filter->n_matches == 0)
+    {
+        /* The cursor is on no shown line, it can not modify it */
+        if(isprint(input) || input == '\t' || input == '\n'
+           ||
+           input == KEY_BACKSPACE || input == KEY_DC)
+        {
+            add_help_msg_eManager(manager, "No line matches yet.");
+            return true;
+        }
+        return false;
+    }
+
+    if(file->view != NULL)
+    {
+        index = find_eFilter(filter, file->view->current_line);
+        pos = file->view->current_pos;
+    }
+    else
+    {
+        index = find_eFilter(filter, file->current_line->line_number);
+        pos = file->current_pos;
+    }
+    if(index >= filter->n_matches)
+        index = filter->n_matches-1;
+
+    get_string_eManager(file, filter->matches[index], &length);
+
+    if(input > 0 && input == key_code_eManager("kHOM5"))
+        index = 0;
+
+    else if(input > 0 && input == key_code_eManager("kEND5"))
+    {
+        scan_filter_eFile(file, UINT_MAX, FILTER_BUDGET);
+        index = filter->n_matches-1;
+    }
+
+    else switch(input)
+    {
+        case KEY_UP:
+            if(index > 0)
+                index--;
+            break;
+
+        case KEY_DOWN:
+            scan_filter_eFile(file, index+2, FILTER_BUDGET);
+            if(index+1 < filter->n_matches)
+                index++;
+            break;
+
+        case KEY_NPAGE:
+            scan_filter_eFile(file, index+page+1, FILTER_BUDGET);
+            index = (index+page < filter->n_matches)
+                    ? index+page : filter->n_matches-1;
+            filter->first_screen_match += page;
+            break;
+
+        case KEY_PPAGE:
+            index = (index > page) ? index-page : 0;
+            filter->first_screen_match = (filter->first_screen_match > page)
+                                         ? filter->first_screen_match-page
+                                         : 0;
+            break;
+
+        /* The cursor goes to the end of the previous matching line */
+        case KEY_LEFT:
+            if(pos > 0 || index == 0)
+                return false;
+            index--;
+            get_string_eManager(file, filter->matches[index], &length);
+            break;
+
+        /* The cursor goes to the beginning of the next matching line */
+        case KEY_RIGHT:
+            if(pos < length)
+                return false;
+            scan_filter_eFile(file, index+2, FILTER_BUDGET);
+            if(index+1 >= filter->n_matches)
+                return false;
+            index++;
+            length = 0;
+            break;
+
+        default:
+            return false;
+    }
+
+    /* The cursor keeps its position, or goes to the end of the line */
+    if(input == KEY_LEFT || input == KEY_RIGHT)
+    {
+        if(file->view != NULL)
+            file->view->current_pos = length;
+        else
+            file->current_pos = length;
+    }
+
+    move_filter_eManager(manager, index);
+
+    return true;
+}
+
+
+/**
+ * @brief The filter_file_eManager() function scan the next lines of the
+ *        filtered current file, and keep its cursor on a matching line.
+ *
+ * @param manager: eManager pointer
+ */
+static void filter_file_eManager(eManager * manager)
+{
+    eFilter *filter = NULL;
+    char message[64];
+    bool finished = false;
+
+    if(manager->file == NULL || manager->file->filter == NULL)
+        return;
+
+    filter = manager->file->filter;
+    finished = filter->finished;
+
+    if(scan_filter_eFile(manager->file, UINT_MAX, FILTER_STEP) == -1)
+    {
+        delete_eFilter(&manager->file->filter);
+        add_help_msg_eManager(manager, "Impossible to filter the file.");
+        return;
+    }
+
+    if(!finished && filter->finished && manager->help_msg == NULL)
+    {
+        snprintf(message, sizeof(message), "%u matching lines.",
+                 filter->n_matches);
+        add_help_msg_eManager(manager, message);
+    }
+
+    filter_cursor_eManager(manager);
+}
+
+
+/**
+ * @brief The filter_cursor_eManager() function move the cursor of the
+ *        filtered current file to the next matching line if its line does
+ *        not match anymore, or the last one, and scroll the screen to show
+ *        it.
+ *
+ * @param manager: eManager pointer
+ */
+static void filter_cursor_eManager(eManager * manager)
+{
+    eFile *file = manager->file;
+    eFilter *filter = file->filter;
+    unsigned int height = get_height_eScreen(manager->screen, WFILE_CNT);
+    unsigned int line_number = 0, index = 0;
+
+    line_number = (file->view != NULL) ? file->view->current_line
+                                       : file->current_line->line_number;
+
+    /* The lines are scanned until the cursor and its next matching line */
+    index = find_eFilter(filter, line_number);
+    if(index >= filter->n_matches && !filter->finished)
+    {
+        if(line_number > filter->n_scanned)
+            scan_filter_eFile(file, UINT_MAX,
+                              (line_number-filter->n_scanned < FILTER_BUDGET)
+                              ? line_number-filter->n_scanned
+                              : FILTER_BUDGET);
+        scan_filter_eFile(file, filter->n_matches+1, FILTER_BUDGET);
+        index = find_eFilter(filter, line_number);
+    }
+
+    if(filter->n_matches == 0)
+    {
+        filter->first_screen_match = 0;
+        return;
+    }
+
+    if(index >= filter->n_matches)
+        index = filter->n_matches-1;
+
+    if(filter->matches[index] != line_number)
+        move_filter_eManager(manager, index);
+
+    if(filter->first_screen_match > index)
+        filter->first_screen_match = index;
+
+    if(index >= filter->first_screen_match+height)
+        filter->first_screen_match = index-height+1;
+
+    /* The matching lines of the screen are found */
+    scan_filter_eFile(file, filter->first_screen_match+height,
+                      FILTER_BUDGET);
+}
+
+
+/**
+ * @brief The move_filter_eManager() function move the cursor of the
+ *        filtered current file to a matching line, and scroll the screen to
+ *        show it.
+ *
+ * @param manager: eManager pointer
+ * @param index: Index of the match
+ */
+static void move_filter_eManager(eManager * manager,
+                                 unsigned int index)
+{
+    eFile *file = manager->file;
+    eFilter *filter = file->filter;
+    unsigned int height = get_height_eScreen(manager->screen, WFILE_CNT);
+    size_t length = 0;
+
+    get_string_eManager(file, filter->matches[index], &length);
+
+    if(file->view != NULL)
+    {
+        file->view->current_line = filter->matches[index];
+        if(file->view->current_pos > length)
+            file->view->current_pos = length;
+    }
+    else
+    {
+        file->current_line = get_line_eFile(file, filter->matches[index]);
+        if(file->current_pos > length)
+            file->current_pos = length;
+    }
+
+    if(filter->first_screen_match > index)
+        filter->first_screen_match = index;
+
+    if(index >= filter->first_screen_match+height)
+        filter->first_screen_match = index-height+1;
+}
+
+
+/**
+ * @brief The print_filter_eManager() function print the matching lines of
+ *        the screen of a filtered file, with their line number. A line
+ *        longer than the window is cut, the current line is shifted to
+ *        show the cursor.
+ *
+ * @param manager: eManager pointer
+ *
+ * @return 0 on success or -1 in failure.
+ */
+static int print_filter_eManager(eManager const * manager)
+{
+    eFile *file = manager->file;
+    eFilter *filter = file->filter;
+    int height = get_height_eScreen(manager->screen, WFILE_CNT);
+    size_t width = get_width_eScreen(manager->screen, WFILE_CNT);
+    int line_number_width = digit_number(get_n_lines_eManager(manager));
+    unsigned int current = 0, pos = 0, index = 0;
+    char number[16];
+    char const *string = NULL;
+    size_t length = 0, shift = 0;
+
+    current = (file->view != NULL) ? file->view->current_line
+                                   : file->current_line->line_number;
+    pos = (file->view != NULL) ? file->view->current_pos : file->current_pos;
+
+    erase_window_eScreen(manager->screen, WFILE_CNT);
+    erase_window_eScreen(manager->screen, WFILE_LNUM);
+
+    for(int y=0; y<height; y++)
+    {
+        index = filter->first_screen_match+y;
+        string = (index < filter->n_matches)
+                 ? get_string_eManager(file, filter->matches[index], &length)
+                 : NULL;
+        if(string == NULL)
+        {
+            snprintf(number, sizeof(number), "%*c", line_number_width, '~');
+            print_line_eScreen(manager->screen, WFILE_LNUM, y, 1, number);
+            continue;
+        }
+
+        shift = (filter->matches[index] == current) ? pos/width*width : 0;
+        string += shift;
+        length -= shift;
+
+        snprintf(number, sizeof(number), "%*u", line_number_width,
+                 filter->matches[index]);
+        print_line_eScreen(manager->screen, WFILE_LNUM, y, 1, number);
+        print_string_eScreen(manager->screen, WFILE_CNT, y, 0, string,
+                             (length < width) ? length : width);
+    }
+
+    return 0;
+}
+
+
+/**
+ * @brief The get_string_eManager() function return the content of a line
+ *        of a file, read or viewed.
+ *
+ * @param file: eFile pointer
+ * @param line_number: Line number
+ * @param length: Length of the line
+ *
+ * @return Beginning of the line, not necessarily terminated by 0, or NULL
+ *         if the line does not exist.
+ */
+static char const * get_string_eManager(eFile * file,
+                                        unsigned int line_number,
+                                        size_t * length)
+{
+    eLine *line = NULL;
+
+    if(file->view != NULL)
+        return get_line_eView(file->view, line_number, length);
+
+    if(line_number == 0 || line_number > file->n_elines)
+        return NULL;
+
+    line = file->lines[line_number-1];
+    *length = line->length;
+
+    return line->string;
+}
+
+
+/**
+ * @brief The process_hex_eManager() function process an input on a binary
+ *        file. The cursor moves from a row to another, the file can not be
+ *        modified.
+ *
+ * @param manager: eManager pointer
+ * @param input: User input to process
+ *
+ * @return true if the input was processed, false if it is processed as
+ *         for another file.
+ */
+static bool process_hex_eManager(eManager * manager,
+                                 int input)
+{
+    eHex *hex = manager->file->hex;
+    unsigned int page = page_height_eManager(manager);
+
+    if(input > 0 && input == key_code_eManager("kHOM5"))
+        hex->current_row = 1;
+
+    else if(input > 0 && input == key_code_eManager("kEND5"))
+        hex->current_row = hex->n_rows;
+
+    else switch(input)
+    {
+        case KEY_UP:
+            if(hex->current_row > 1)
+                hex->current_row--;
+            break;
+
+        case KEY_DOWN:
+            if(hex->current_row < hex->n_rows)
+                hex->current_row++;
+            break;
+
+        case KEY_NPAGE:
+            hex->current_row = (hex->n_rows-hex->current_row > page)
+                               ? hex->current_row+page : hex->n_rows;
+            hex->first_screen_row = (hex->n_rows-hex->first_screen_row > page)
+                                    ? hex->first_screen_row+page
+                                    : hex->n_rows;
+            break;
+
+        case KEY_PPAGE:
+            hex->current_row = (hex->current_row > page)
+                               ? hex->current_row-page : 1;
+            hex->first_screen_row = (hex->first_screen_row > page)
+                                    ? hex->first_screen_row-page : 1;
+            break;
+
+        case CTRL('s'):
+        case CTRL('z'):
+        case CTRL('y'):
+        case CTRL('r'):
+        case CTRL('l'):
+        case CTRL('e'):
+        case '\n':
+        case KEY_BACKSPACE:
+        case KEY_DC:
+            add_help_msg_eManager(manager, "Binary file, readonly.");
+            break;
+
+        default:
+            if(!isprint(input) && input != '\t')
+                return false;
+            add_help_msg_eManager(manager, "Binary file, readonly.");
+            break;
+    }
+
+    scroll_hex_eManager(manager);
+
+    return true;
+}
+
+
+/**
+ * @brief The scroll_hex_eManager() function scroll the binary file until
+ *        its cursor is visible.
+ *
+ * @param manager: eManager pointer
+ */
+static void scroll_hex_eManager(eManager * manager)
+{
+    eHex *hex = manager->file->hex;
+    unsigned int height = get_height_eScreen(manager->screen, WFILE_CNT);
+
+    if(hex->first_screen_row > hex->current_row)
+        hex->first_screen_row = hex->current_row;
+
+    if(hex->current_row >= hex->first_screen_row+height)
+        hex->first_screen_row = hex->current_row-height+1;
+}
+
+
+/**
+ * @brief The print_hex_eManager() function print the rows of the screen of
+ *        a binary file. Only these rows are read from the file, with
+ *        pread(2).
+ *
+ * @param manager: eManager pointer
+ *
+ * @return 0 on success or -1 in failure.
+ */
+static int print_hex_eManager(eManager const * manager)
+{
+    eHex *hex = manager->file->hex;
+    int height = get_height_eScreen(manager->screen, WFILE_CNT);
+    size_t width = get_width_eScreen(manager->screen, WFILE_CNT);
+    int line_number_width = digit_number(hex->n_rows);
+    char number[16];
+    char row[HEX_ROW_LENGTH];
+    size_t length = 0;
+
+    erase_window_eScreen(manager->screen, WFILE_CNT);
+    erase_window_eScreen(manager->screen, WFILE_LNUM);
+
+    for(int y=0; y<height; y++)
+    {
+        length = get_row_eHex(hex, hex->first_screen_row+y, row);
+        if(length == 0)
+        {
+            snprintf(number, sizeof(number), "%*c", line_number_width, '~');
+            print_line_eScreen(manager->screen, WFILE_LNUM, y, 1, number);
+            continue;
+        }
+
+        snprintf(number, sizeof(number), "%*u", line_number_width,
+                 hex->first_screen_row+y);
+        print_line_eScreen(manager->screen, WFILE_LNUM, y, 1, number);
+        print_string_eScreen(manager->screen, WFILE_CNT, y, 0, row,
+                             (length < width) ? length : width);
+    }
+
+    return 0;
+}
+
+
+/**
+ * @brief The goto_line_eManager() function move the cursor at the
+ *        beginning of a line of the current file and scroll the screen to
+ *        show it.
+ *
+ * @param manager: eManager pointer
+ * @param line_number: Line number
+ */
+static void goto_line_eManager(eManager * manager,
+                               unsigned int line_number)
+{
+    eFile *file = manager->file;
+
+    if(file->hex != NULL)
+    {
+        file->hex->current_row = (line_number < file->hex->n_rows)
+                                 ? line_number : file->hex->n_rows;
+        file->hex->first_screen_row = (file->hex->current_row > 5)
+                                      ? file->hex->current_row-5 : 1;
+        scroll_hex_eManager(manager);
+        return;
+    }
+
+    if(file->view != NULL)
+    {
+        if(extend_eView(file->view, line_number) < line_number)
+            line_number = file->view->n_lines;
+
+        file->view->current_line = line_number;
+        file->view->first_screen_line = (line_number > 5) ? line_number-5 : 1;
+        scroll_view_eManager(manager);
+        return;
+    }
+
+    file->current_line = get_line_eFile(file, line_number);
+    file->current_pos = 0;
+
+    /* Let a few lines above the cursor */
+    line_number = file->current_line->line_number;
+    file->first_screen_line = get_line_eFile(file, (line_number > 5)
+                                                   ? line_number-5 : 1);
+}
+
+
+/**
+ * @brief The scroll_to_cursor_eManager() function pull down the screen
+ *        until the cursor of the current file is visible, with a few lines
+ *        under it.
+ *
+ * @param manager: eManager pointer
+ */
+static void scroll_to_cursor_eManager(eManager * manager)
+{
+    eFile *file = manager->file;
+    unsigned int screen_height = get_height_eScreen(manager->screen,
+                                                    WFILE_CNT);
+
+    if(file->first_screen_line->line_number > file->current_line->line_number)
+        file->first_screen_line = file->current_line;
+
+    while(file->first_screen_line != file->current_line
+          &&
+          gety_cursor_eManager(manager)+5 > screen_height-1)
+        file->first_screen_line = file->first_screen_line->next;
+}
+
+
+/**
+ * @brief The show_cursor_eManager() function scroll the screen to show the
+ *        cursor after it moved anywhere in the file. A line far from the
+ *        screen is shown like goto_line_eManager() does.
+ *
+ * @param manager: eManager pointer
+ */
+static void show_cursor_eManager(eManager * manager)
+{
+    eFile *file = manager->file;
+    unsigned int line_number = file->current_line->line_number;
+    unsigned int first = file->first_screen_line->line_number;
+
+    if(line_number < first
+       ||
+       line_number >= first+page_height_eManager(manager))
+        file->first_screen_line = get_line_eFile(file, (line_number > 5)
+                                                       ? line_number-5 : 1);
+
+    scroll_to_cursor_eManager(manager);
+}
+
+
+/**
+ * @brief The page_height_eManager() function return the number of lines
+ *        moved by Page Up and Page Down.
+ *
+ * @param manager: eManager pointer
+ *
+ * @return the number of lines of a page, at least 1.
+ */
+static unsigned int page_height_eManager(eManager const * manager)
+{
+    unsigned int height = get_height_eScreen(manager->screen, WFILE_CNT);
+
+    return (height > 1) ? height-1 : 1;
+}
+
+
+/**
+ * @brief The key_code_eManager() function return the code of a key which
+ *        is only described by the terminfo database (extended capability).
+ *
+ * @param capname: Capability name of the key, ex "kEND5" for Ctrl+End
+ *
+ * @return the key code or 0 if the terminal does not define the key.
+ */
+static int key_code_eManager(char const * capname)
+{
+    char *sequence = tigetstr(capname);
+
+    if(sequence == NULL || sequence == (char *) -1)
+        return 0;
+
+    return key_defined(sequence);
+}
+
+
+/**
+ * @brief The prompt_eManager() function read a string typed by the user in
+ *        the help window.
+ *
+ * @param manager: eManager pointer
+ * @param message: Message printed before the string
+ * @param buffer: Buffer where the string is written
+ * @param length: Length of buffer
+ *
+ * @return true if the user validated with Enter, false if it was canceled
+ *         with Escape.
+ */
+static bool prompt_eManager(eManager * manager,
+                            char const * message,
+                            char * buffer,
+                            size_t length)
+{
+    char const *string_array[2] = {NULL, NULL};
+    char *line = NULL;
+    size_t line_length = strlen(message)+length;
+    size_t n = 0;
+    int input = 0;
+
+    line = (char *) malloc(line_length*sizeof(char));
+    if(line == NULL)
+        return false;
+
+    memset(buffer, 0, length);
+    string_array[0] = line;
+    curs_set(1);
+
+    while(true)
+    {
+        snprintf(line, line_length, "%s%s", message, buffer);
+        print_help_eScreen(manager->screen, string_array);
+        move_cursor_eScreen(manager->screen, 1, 1+strlen(line), WHELP);
+        update_help_eScreen(manager->screen);
+
+        input = get_input_eScreen(manager->screen, WHELP);
+
+        if(input == '\n' || input == 27)
+            break;
+
+        if(input == KEY_BACKSPACE && n > 0)
+            buffer[--n] = 0;
+        else if((isprint(input) || input == '\t') && n+1 < length)
+            buffer[n++] = input;
+    }
+
+    curs_set(0);
+    free(line);
+
+    return input == '\n';
+}
+
+
+/**
+ * @brief The process_tick_eManager() function follow the background jobs.
+ *        It is called after every input and every TICK_DELAY while jobs
+ *        are running.
+ *
+ * @param manager: eManager pointer
+ */
+static void process_tick_eManager(eManager * manager)
+{
+    eLoad *load = NULL;
+    char message[128];
+    unsigned int i = 0;
+
+    /* Finished saves, they are not waited for */
+    for(i=0; i<manager->n_saves; i++)
+    {
+        if(is_finished_eSave(manager->saves[i]))
+            break;
+    }
+
+    if(i < manager->n_saves)
+        process_saves_eManager(manager, manager->saves[i]->file);
+
+    flush_journals_eManager(manager);
+
+    /* The lines read since the last tick are added to their file */
+    process_loads_eManager(manager, false);
+
+    follow_files_eManager(manager);
+
+    watch_files_eManager(manager);
+
+    filter_file_eManager(manager);
+
+    process_prefetch_eManager(manager);
+
+    /* The end of a viewed file truncated by another program reads as
+       zeros, it must be opened again */
+    if(manager->file != NULL && check_truncated_eView(manager->file->view))
+    {
+        snprintf(message, sizeof(message),
+                 "%s was truncated on disk, close and open it again.",
+                 manager->file->filename);
+        add_help_msg_eManager(manager, message);
+    }
+
+    /* Progress of the current file, or of the first one */
+    for(i=0; i<manager->n_loads; i++)
+    {
+        if(manager->loads[i]->file == manager->file)
+            break;
+    }
+
+    if(manager->n_loads > 0 && manager->help_msg == NULL)
+    {
+        load = manager->loads[(i < manager->n_loads) ? i : 0];
+        snprintf(message, sizeof(message),
+                 "Loading %s: %u%% (Escape: cancel)",
+                 load->file->filename, get_progress_eLoad(load));
+        add_help_msg_eManager(manager, message);
+    }
+}
+
+
+/**
+ * @brief The flush_journals_eManager() function write the journals of the
+ *        bar files when JOURNAL_DELAY elapsed since the last flush, so that
+ *        the records are synced by batch.
+ *
+ * @param manager: eManager pointer
+ *
+ * @return true if records are still waiting to be written, false otherwise.
+ */
+static bool flush_journals_eManager(eManager * manager)
+{
+    struct timespec now;
+    eFile *file = NULL;
+    long elapsed = 0;
+    bool waiting = false;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    elapsed = (now.tv_sec - manager->journal_flush.tv_sec)*1000
+              + (now.tv_nsec - manager->journal_flush.tv_nsec)/1000000;
+
+    for(unsigned int i=0; i<count_eBar(manager->bar); i++)
+    {
+        file = (eFile *) get_file_eBar(manager->bar, i);
+        if(file->journal == NULL || file->journal->length == 0)
+            continue;
+
+        if(elapsed >= JOURNAL_DELAY)
+            flush_eJournal(file->journal);
+        else
+            waiting = true;
+    }
+
+    if(elapsed >= JOURNAL_DELAY)
+        manager->journal_flush = now;
+
+    return waiting;
+}
+
+
+/**
+ * @brief The follow_files_eManager() function add the lines appended to
+ *        the followed files of the bar. A cursor on the last line follows
+ *        the new lines.
+ *
+ * @param manager: eManager pointer
+ *
+ * @return true if a file is followed, false otherwise.
+ */
+static bool follow_files_eManager(eManager * manager)
+{
+    eFile *file = NULL;
+    eLine *first_line = NULL, *last_line = NULL, *line = NULL;
+    unsigned int n_lines = 0;
+    char message[128];
+    bool at_end = false, following = false;
+    int result = 0;
+
+    for(unsigned int i=0; i<count_eBar(manager->bar); i++)
+    {
+        file = (eFile *) get_file_eBar(manager->bar, i);
+        if(file->follow == NULL)
+            continue;
+
+        following = true;
+        if(!is_changed_eFollow(file->follow))
+            continue;
+
+        /* The cursor stays at the top of a pipe until it is moved down */
+        at_end = (file->current_line == file->lines[file->n_elines-1]
+                  &&
+                  !(file->follow->stream && file->n_elines == 1));
+        result = read_eFollow(file->follow, file->lines[file->n_elines-1],
+                              &first_line, &last_line, &n_lines);
+
+        /* The last line may be continued by the bytes read */
+        line = file->lines[file->n_elines-1];
+        if(file->filter != NULL)
+            update_line_eFilter(file->filter, line->line_number,
+                                line->string, line->length);
+
+        if(n_lines > 0
+           &&
+           append_lines_eFile(file, first_line, last_line, n_lines) == -1)
+        {
+            while(first_line)
+            {
+                line = first_line->next;
+                delete_eLine(&first_line);
+                first_line = line;
+            }
+            result = -1;
+        }
+
+        if(result == -1)
+        {
+            snprintf(message, sizeof(message),
+                     (file->follow->stream) ? "Impossible to read %s."
+                                            : "Impossible to follow %s.",
+                     file->filename);
+            delete_eFollow(&file->follow);
+            add_help_msg_eManager(manager, message);
+        }
+        else if(file->follow->finished)
+        {
+            delete_eFollow(&file->follow);
+            snprintf(message, sizeof(message), "%s read.", file->filename);
+            add_help_msg_eManager(manager, message);
+        }
+
+        if(at_end)
+        {
+            file->current_line = file->lines[file->n_elines-1];
+            follow_cursor_eManager(manager, file);
+        }
+    }
+
+    return following;
+}
+
+
+/**
+ * @brief The watch_files_eManager() function check the open files when
+ *        eWatch tells that they may have been changed by another program.
+ *
+ * @param manager: eManager pointer
+ */
+static void watch_files_eManager(eManager * manager)
+{
+    if(manager->watch == NULL || !is_changed_eWatch(manager->watch))
+        return;
+
+    for(unsigned int i=0; i<count_eBar(manager->bar); i++)
+        check_file_eManager(manager,
+                            (eFile *) get_file_eBar(manager->bar, i));
+}
+
+
+/**
+ * @brief The check_file_eManager() function read again a file changed on
+ *        disk by another program. Only the lines which differ are patched.
+ *        If the file was modified, the user chooses between the edits and
+ *        the file on disk.
+ *
+ * @param manager: eManager pointer
+ * @param file: eFile pointer
+ */
+static void check_file_eManager(eManager * manager,
+                                eFile * file)
+{
+    struct stat info;
+    char message[256];
+    char answer[2];
+    unsigned int n_changed = 0;
+
+    /* The file has no line read from disk, or is read by a follow. A
+       dropped file is read as it is on disk when it is shown */
+    if(file->disk_stat.st_ino == 0
+       ||
+       (file->pack != NULL && file->pack->dropped)
+       ||
+       file->view != NULL || file->hex != NULL || file->follow != NULL
+       ||
+       (file->fd != -1 && get_decompressor_eLoad(file->fd) != NULL))
+        return;
+
+    /* A save or a load changes the file, it is checked after them */
+    if(is_loading_eManager(manager, file) || is_saving_eManager(manager, file))
+    {
+        if(manager->watch != NULL)
+            manager->watch->pending = true;
+        return;
+    }
+
+    if(!is_changed_eFile(file))
+        return;
+
+    /* The lines of a packed file are patched too */
+    if(unpack_eFile(file) == -1)
+    {
+        snprintf(message, sizeof(message), "Impossible to reload %s.",
+                 file->filename);
+        add_help_msg_eManager(manager, message);
+        return;
+    }
+
+    if(!file->is_saved)
+    {
+        snprintf(message, sizeof(message),
+                 "%s changed on disk, reload it and lose the edits? (y/n): ",
+                 file->filename);
+
+        /* The edits are kept, the user is not asked again for this change
+           and a save overwrites the file */
+        if(!prompt_eManager(manager, message, answer, sizeof(answer))
+           ||
+           (answer[0] != 'y' && answer[0] != 'Y'))
+        {
+            if(stat(file->realpath, &info) == 0)
+                file->disk_stat = info;
+            snprintf(message, sizeof(message),
+                     "Edits kept, Ctrl+S overwrites %s.", file->filename);
+            add_help_msg_eManager(manager, message);
+            return;
+        }
+    }
+
+    if(reload_eFile(file, &n_changed) == -1)
+        snprintf(message, sizeof(message), "Impossible to reload %s.",
+                 file->filename);
+    else
+    {
+        update_file_eBar(manager->bar, file);
+        snprintf(message, sizeof(message), "%s reloaded, %u lines changed.",
+                 file->filename, n_changed);
+    }
+    add_help_msg_eManager(manager, message);
+}
+
+
+/**
+ * @brief The pack_files_eManager() function free the lines of the least
+ *        recently shown file of the bar while the lines of the bar files
+ *        exceed pack_budget: a file which was not modified is dropped, as
+ *        the disk has its lines, another one is packed. A file which was
+ *        not shown for pack_delay is packed. A file is freed by call, while
+ *        the user does not type.
+ *
+ * @param manager: eManager pointer
+ */
+static void pack_files_eManager(eManager * manager)
+{
+    struct timespec now;
+    eFile *file = NULL, *oldest = NULL, *oldest_unpacked = NULL;
+    size_t resident = 0;
+    bool freed = false;
+
+    for(unsigned int i=0; i<count_eBar(manager->bar); i++)
+    {
+        file = (eFile *) get_file_eBar(manager->bar, i);
+
+        /* The lines take about the size of the file and their structure */
+        if(file->pack != NULL)
+            resident += file->pack->size;
+        else
+            resident += (size_t) file->file_stat.st_size
+                        + (size_t) file->n_elines*(sizeof(eLine)
+                                                   +sizeof(eLine *));
+
+        /* A shown file, or a file changed by a background job, is kept */
+        if(file == manager->file
+           ||
+           file->view != NULL || file->hex != NULL || file->follow != NULL
+           ||
+           is_loading_eManager(manager, file)
+           ||
+           is_saving_eManager(manager, file))
+            continue;
+
+        /* A packed file is still dropped if it was not modified */
+        if(file->pack != NULL && !can_drop_eFile(file))
+            continue;
+        if(file->pack == NULL && file->n_elines == 0)
+            continue;
+
+        if(oldest == NULL || is_older_eManager(file, oldest))
+            oldest = file;
+        if(file->pack == NULL
+           &&
+           (oldest_unpacked == NULL || is_older_eManager(file,
+                                                         oldest_unpacked)))
+            oldest_unpacked = file;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    if(resident > manager->pack_budget && oldest != NULL)
+        freed = (drop_eFile(oldest) == 0 || pack_eFile(oldest) == 0);
+    else if(oldest_unpacked != NULL
+            &&
+            now.tv_sec-oldest_unpacked->last_use.tv_sec >= manager->pack_delay)
+        freed = (pack_eFile(oldest_unpacked) == 0);
+
+    /* The lines were small blocks, their free pages are given back to the
+       system */
+    if(freed)
+        malloc_trim(0);
+}
+
+
+/**
+ * @brief The is_older_eManager() function return true if a file was shown
+ *        before another one.
+ *
+ * @param first: eFile pointer
+ * @param second: eFile pointer
+ *
+ * @return true if first was last shown before second, false otherwise.
+ */
+static bool is_older_eManager(eFile const * first,
+                              eFile const * second)
+{
+    if(first->last_use.tv_sec != second->last_use.tv_sec)
+        return first->last_use.tv_sec < second->last_use.tv_sec;
+
+    return first->last_use.tv_nsec < second->last_use.tv_nsec;
+}
+
+
+/**
+ * @brief The follow_cursor_eManager() function put the cursor at the
+ *        beginning of the current line of a followed file, and scroll the
+ *        file so that the screen ends with it.
+ *
+ * @param manager: eManager pointer
+ * @param file: eFile pointer
+ */
+static void follow_cursor_eManager(eManager * manager,
+                                   eFile * file)
+{
+    unsigned int height = get_height_eScreen(manager->screen, WFILE_CNT);
+    unsigned int line_number = file->current_line->line_number;
+
+    file->current_pos = 0;
+    file->first_screen_line = get_line_eFile(file, (line_number+6 > height)
+                                                   ? line_number+6-height
+                                                   : 1);
+
+    if(file == manager->file)
+        scroll_to_cursor_eManager(manager);
+}
+
+
+/**
+ * @brief The recover_journals_eManager() function look for the journals
+ *        left in the directory by an edito which did not exit, and ask the
+ *        user to replay them on their files.
+ *
+ * @param manager: eManager pointer
+ */
+void recover_journals_eManager(eManager * manager)
+{
+    recover_directory_eManager(manager, manager->directory);
+
+    send_help_msg_to_screen_eManager(manager);
+    update_help_eScreen(manager->screen);
+
+    /* The last recovered file is shown */
+    if(manager->mode == WRITE)
+    {
+        print_file_eManager(manager);
+        move_cursor_eScreen(manager->screen,
+                            gety_cursor_eManager(manager),
+                            getx_cursor_eManager(manager),
+                            WFILE_CNT);
+        update_file_eScreen(manager->screen, true);
+    }
+}
+
+
+/**
+ * @brief The restore_session_eManager() function open again the files and
+ *        directories of the last edito which exited in the directory. Only
+ *        the current file is read, the others are read when they are shown.
+ *
+ * @param manager: eManager pointer
+ */
+void restore_session_eManager(eManager * manager)
+{
+    eSession *session = NULL;
+    session_file const *entry = NULL;
+    eDirectory *directory = NULL;
+    eFile *file = NULL;
+    eFile *current = NULL;
+
+    if(!manager->session)
+        return;
+
+    session = create_eSession(manager->directory->realpath);
+    if(session == NULL)
+        return;
+
+    if(read_eSession(session) == -1)
+    {
+        delete_eSession(&session);
+        return;
+    }
+
+    for(unsigned int i=0; i<session->n_directories; i++)
+    {
+        directory = NULL;
+        file = NULL;
+        if(find_path_eDirectory(manager->directory, session->directories[i],
+                                &directory, &file) == 0
+           &&
+           directory != NULL)
+            directory->is_open = true;
+    }
+    fill_directory_menu_eManager(manager, manager->directory, 0);
+    refresh_menu_eScreen(manager->screen, MDIR);
+    update_directory_eScreen(manager->screen);
+
+    /* The files are added to the bar with their cursor, not read */
+    for(unsigned int i=0; i<session->n_files; i++)
+    {
+        entry = &session->files[i];
+        directory = NULL;
+        file = NULL;
+        if(find_path_eDirectory(manager->directory, entry->path,
+                                &directory, &file) == -1
+           ||
+           file == NULL)
+            continue;
+
+        /* A recovered file is already open */
+        if(find_file_eBar(manager->bar, file) != NULL)
+        {
+            if((int) i == session->current)
+                current = (eFile *) find_file_eBar(manager->bar, file);
+            continue;
+        }
+
+        if(restore_eFile(file, entry->current_line, entry->current_pos,
+                         entry->first_screen_line) == -1)
+            continue;
+
+        if(add_file_eBar(manager->bar, file) == -1)
+        {
+            close_eFile(file);
+            continue;
+        }
+
+        add_tab_eScreen(manager->screen, file->filename);
+        if(manager->watch != NULL)
+            add_eWatch(manager->watch, file->realpath);
+
+        if((int) i == session->current)
+            current = file;
+    }
+
+    if(count_eBar(manager->bar) > 0
+       &&
+       manager->screen->windows[WFILE_CNT] == NULL)
+        create_file_window_eScreen(manager->screen, 1);
+
+    /* Only the current file is read now */
+    if(current != NULL && manager->file != current)
+    {
+        set_eFile_eManager(manager, current);
+        if(manager->file == current)
+        {
+            set_current_tab_eScreen(manager->screen,
+                                    get_index_eBar(manager->bar, current));
+            resize_file_eScreen(manager->screen,
+                                digit_number(get_n_lines_eManager(manager)));
+            scroll_to_cursor_eManager(manager);
+        }
+    }
+
+    if(session->mode == WRITE && manager->file != NULL)
+        change_mode_eManager(manager, WRITE);
+    else if(session->mode == BAR && count_eBar(manager->bar) > 0)
+        change_mode_eManager(manager, BAR);
+    delete_eSession(&session);
+
+    send_help_msg_to_screen_eManager(manager);
+    update_help_eScreen(manager->screen);
+    update_bar_eScreen(manager->screen);
+
+    if(manager->mode == WRITE)
+    {
+        print_file_eManager(manager);
+        move_cursor_eScreen(manager->screen,
+                            gety_cursor_eManager(manager),
+                            getx_cursor_eManager(manager),
+                            WFILE_CNT);
+        update_file_eScreen(manager->screen, true);
+    }
+    else if(manager->mode == DIR)
+    {
+        move_current_item_menu_eScreen(manager->screen, MDIR);
+        update_directory_eScreen(manager->screen);
+    }
+}
+
+
+/**
+ * @brief The open_stream_eManager() function open a buffer filled with the
+ *        bytes written in a pipe, like the output of a command piped to
+ *        edito. The pipe is read between two inputs until its end.
+ *
+ * @param manager: eManager pointer
+ * @param file: eFile pointer of the buffer, not opened
+ * @param fd: Descriptor of the pipe
+ *
+ * @return 0 on success or -1 in failure.
+ */
+int open_stream_eManager(eManager * manager,
+                         eFile * file,
+                         int fd)
+{
+    if(file == NULL || file->n_elines > 0)
+        return -1;
+
+    /* The buffer has no file, it can be modified but not saved */
+    file->follow = create_eFollow(NULL, fd, 0);
+    if(file->follow == NULL)
+        return -1;
+
+    file->permissions = p_READONLY;
+    file->undo = create_eUndo(manager->undo_limit);
+    end_open_eFile(file);
+
+    if(open_file_eManager(manager, file) == -1)
+    {
+        close_eFile(file);
+        return -1;
+    }
+
+    add_help_msg_eManager(manager, "Reading the input...");
+
+    return 0;
+}
+
+
+/**
+ * @brief The recover_directory_eManager() function ask the user to replay
+ *        the journals of the files of a directory. A recovered file is
+ *        opened with the replayed modifications, it is not saved.
+ *
+ * @param manager: eManager pointer
+ * @param directory: eDirectory pointer
+ *
+ * @note This is a recursive function.
+ */
+static void recover_directory_eManager(eManager * manager,
+                                       eDirectory const * directory)
+{
+    char message[256];
+    char answer[2];
+    eFile *file = NULL;
+    long count = 0;
+
+    for(unsigned int i=0; i<directory->n_files; i++)
+    {
+        file = directory->files[i];
+        if(!exists_eJournal(file->realpath))
+            continue;
+
+        snprintf(message, sizeof(message),
+                 "Recover unsaved edits of %s? (y/n): ", file->filename);
+
+        /* Escape keeps the journal for the next start */
+        if(!prompt_eManager(manager, message, answer, sizeof(answer)))
+            continue;
+
+        if(answer[0] != 'y' && answer[0] != 'Y')
+        {
+            remove_eJournal(file->realpath);
+            continue;
+        }
+
+        if(open_file_eManager(manager, file) == -1)
+            continue;
+
+        /* The records apply to the whole file, a viewed file has no line */
+        process_loads_eManager(manager, true);
+        count = (file->view == NULL) ? replay_eJournal(file) : -1;
+        if(count == -1)
+        {
+            snprintf(message, sizeof(message),
+                     "The journal of %s does not match the file.",
+                     file->filename);
+        }
+        else
+        {
+            flush_eJournal(file->journal);
+            file->current_line = file->first_file_line;
+            file->current_pos = 0;
+            file->first_screen_line = file->first_file_line;
+            snprintf(message, sizeof(message),
+                     "%ld edits of %s recovered.", count, file->filename);
+        }
+        add_help_msg_eManager(manager, message);
+    }
+
+    for(unsigned int i=0; i<directory->n_dirs; i++)
+        recover_directory_eManager(manager, directory->dirs[i]);
+}
+
+
+/**
+ * @brief The save_session_eManager() function keep the open files and
+ *        directories in the directory for the next run. A file out of the
+ *        directory can not be found again, it is not kept.
+ *
+ * @param manager: eManager pointer
+ */
+static void save_session_eManager(eManager * manager)
+{
+    eSession *session = NULL;
+    eFile const *file = NULL;
+    char const *path = NULL;
+    int result = 0;
+
+    if(!manager->session)
+        return;
+
+    session = create_eSession(manager->directory->realpath);
+    if(session == NULL)
+        return;
+
+    session->mode = manager->mode;
+    save_directories_eManager(manager, session, manager->directory);
+
+    for(unsigned int i=0; i<count_eBar(manager->bar) && result == 0; i++)
+    {
+        file = (eFile const *) get_file_eBar(manager->bar, i);
+        if(file->realpath == NULL
+           ||
+           (path = get_session_path_eManager(manager, file->realpath)) == NULL)
+            continue;
+
+        if(file == manager->file)
+            session->current = (int) session->n_files;
+
+        /* The cursor of a packed file is kept in its pack */
+        if(file->pack != NULL)
+            result = add_file_eSession(session, path,
+                                       file->pack->current_line,
+                                       file->pack->current_pos,
+                                       file->pack->first_screen_line);
+        else if(file->current_line != NULL)
+            result = add_file_eSession(session, path,
+                                       file->current_line->line_number,
+                                       file->current_pos,
+                                       file->first_screen_line->line_number);
+        else
+            result = add_file_eSession(session, path,
+                                       1, 0, 1);
+    }
+
+    if(result == 0)
+        write_eSession(session);
+    delete_eSession(&session);
+}
+
+
+/**
+ * @brief The save_directories_eManager() function add the open directories
+ *        under a directory to the session.
+ *
+ * @param manager: eManager pointer
+ * @param session: eSession pointer
+ * @param directory: eDirectory pointer
+ *
+ * @note This is a recursive function.
+ */
+static void save_directories_eManager(eManager const * manager,
+                                      eSession * session,
+                                      eDirectory const * directory)
+{
+    char const *path = NULL;
+
+    for(unsigned int i=0; i<directory->n_dirs; i++)
+    {
+        if(directory->dirs[i] == NULL || !directory->dirs[i]->is_open)
+            continue;
+
+        path = get_session_path_eManager(manager, directory->dirs[i]->realpath);
+        if(path != NULL)
+            add_directory_eSession(session, path);
+        save_directories_eManager(manager, session, directory->dirs[i]);
+    }
+}
+
+
+/**
+ * @brief The get_session_path_eManager() function return the path of a
+ *        file from the directory of edito, as it is kept in the session.
+ *
+ * @param manager: eManager pointer
+ * @param realpath: Path of the file
+ *
+ * @return Path from the directory, in realpath, or NULL if the file is
+ *         not in the directory.
+ */
+static char const * get_session_path_eManager(eManager const * manager,
+                                              char const * realpath)
+{
+    char const *root = manager->directory->realpath;
+    size_t length = strlen(root);
+
+    if(strncmp(realpath, root, length) != 0)
+        return NULL;
+
+    /* The root "/" ends with the '/' of its files */
+    if(length > 0 && root[length-1] == '/')
+        return (realpath[length] != 0) ? realpath+length : NULL;
+
+    return (realpath[length] == '/') ? realpath+length+1 : NULL;
+}
+
+
+/**
+ * @brief The process_saves_eManager() function wait for the saves of a file
+ *        and report their result.
+ *
+ * @param manager: eManager pointer
+ * @param file: eFile pointer, NULL for every file
+ */
+static void process_saves_eManager(eManager * manager,
+                                   eFile const * file)
+{
+    eSave *save = NULL;
+    struct stat info;
+    char message[128];
+    unsigned int n = 0;
+
+    for(unsigned int i=0; i<manager->n_saves; i++)
+    {
+        save = manager->saves[i];
+        if(file != NULL && save->file != file)
+        {
+            manager->saves[n++] = save;
+            continue;
+        }
+
+        if(wait_eSave(save) == 0)
+        {
+            /* The saved file is not a change of another program, its hash
+               is not known */
+            if(stat(save->file->realpath, &info) == 0)
+            {
+                save->file->disk_stat = info;
+                save->file->disk_hash = 0;
+                if(save->file->journal != NULL)
+                    rebase_eJournal(save->file->journal, &info);
+            }
+
+            /* The file renamed over the previous one has a new inode */
+            update_file_eBar(manager->bar, save->file);
+
+            update_file_eIndex(manager->index, save->file);
+            snprintf(message, sizeof(message), "%s saved.",
+                     save->file->filename);
+        }
+        else
+        {
+            save->file->is_saved = false;
+            snprintf(message, sizeof(message), "Impossible to save %s.",
+                     save->file->filename);
+        }
+        add_help_msg_eManager(manager, message);
+
+        /* The ranges of the swap file read by the snapshot can be reused */
+        if(save->file->view != NULL)
+            release_swap_eView(save->file->view);
+
+        delete_eSave(&save);
+    }
+
+    manager->n_saves = n;
+}
+
+
+/**
+ * @brief The replace_project_eManager() function replace a string in every
+ *        file of the directory. Open files are modified in memory, the other
+ *        files are rewritten by the eReplace workers while the progress is
+ *        printed in the help window. Escape cancels the replacement.
+ *
+ * @param manager: eManager pointer
+ * @param pattern: String to replace
+ * @param replacement: String replacing pattern
+ */
+static void replace_project_eManager(eManager * manager,
+                                     char const * pattern,
+                                     char const * replacement)
+{
+    char const *string_array[2] = {NULL, NULL};
+    char message[256];
+    eReplace *replace = NULL;
+    eFile *file = NULL;
+    eFile const *last_file = NULL, *failed = NULL;
+    unsigned int n_done = 0;
+    unsigned int n_buffers = 0;
+    unsigned int n_errors = 0;
+    bool finished = false;
+
+    /* Open files are modified entirely, a prefetched file may change */
+    process_loads_eManager(manager, true);
+    drop_prefetch_eManager(manager);
+
+    /* Open files are not saved, the buffer is modified. A dropped file, or
+       a packed file which was not modified, is rewritten on disk by
+       eReplace instead, it is read again when it is shown */
+    for(unsigned int i=0; i<count_eBar(manager->bar); i++)
+    {
+        file = (eFile *) get_file_eBar(manager->bar, i);
+        if(file->pack != NULL
+           &&
+           (file->pack->dropped
+            ||
+            (!is_saving_eManager(manager, file) && drop_eFile(file) == 0)))
+            continue;
+
+        /* A viewed file rewritten on disk would be reverted by a save */
+        if(file->view != NULL || unpack_eFile(file) == -1)
+        {
+            if(failed == NULL)
+                failed = file;
+            n_errors++;
+            continue;
+        }
+
+        next_group_eUndo(file->undo);
+        if(replace_all_eFile(file, pattern, strlen(pattern),
+                             replacement, strlen(replacement)) > 0)
+            n_buffers++;
+    }
+
+    replace = create_eReplace(manager->directory,
+                              manager->bar,
+                              pattern,
+                              replacement,
+                              manager->fsync_policy);
+    if(replace == NULL || start_eReplace(replace) == -1)
+    {
+        delete_eReplace(&replace);
+        add_help_msg_eManager(manager, "Impossible to replace.");
+        return;
+    }
+
+    string_array[0] = message;
+    set_input_timeout_eScreen(manager->screen, WHELP, 100);
+
+    while(!finished)
+    {
+        finished = get_progress_eReplace(replace, &n_done, &last_file);
+
+        snprintf(message, sizeof(message), "Replacing %u/%u (Escape): %s",
+                 n_done, replace->n_files,
+                 (last_file != NULL) ? last_file->filename : "");
+        print_help_eScreen(manager->screen, string_array);
+        update_help_eScreen(manager->screen);
+
+        if(!finished && get_input_eScreen(manager->screen, WHELP) == 27)
+            cancel_eReplace(replace);
+    }
+
+    set_input_timeout_eScreen(manager->screen, WHELP, -1);
+
+    /* Rewritten sources must be parsed again */
+    for(unsigned int i=0; i<replace->n_files; i++)
+    {
+        if(replace->changed[i])
+            update_file_eIndex(manager->index, replace->files[i]);
+    }
+
+    snprintf(message, sizeof(message),
+             "%s%u files rewritten, %u open files modified, %u errors%s%s.",
+             (replace->cancel) ? "Canceled, " : "",
+             replace->n_changed, n_buffers, replace->n_errors+n_errors,
+             (failed != NULL) ? ", not replaced: " : "",
+             (failed != NULL) ? failed->filename : "");
+    add_help_msg_eManager(manager, message);
+
+    /* The file window is not printed by run_eManager() in DIR mode */
+    if(manager->file != NULL && n_buffers > 0)
+    {
+        print_file_eManager(manager);
+        update_file_eScreen(manager->screen, true);
+    }
+
+    delete_eReplace(&replace);
+}
+
+
 /**
  * @brief The change_mode_eManager() function change the mode of the manager
  *        and save current mode in last mode.
@@ -0,0 +1,668 @@
+/**
+ * @file ePack.c
+ * @brief Contain ePack structure and functions
+ * @author ALARY Dorian
+ * @version 1.0
+ * @date 21/07/2024
+ * @copyright GNU Public License.
+ *
+ * @details This file contains the functions used to keep the lines of an
+ *          unused file compressed in memory. The codec is a small LZ77: a
+ *          sequence is a run of literal bytes followed by a copy of the
+ *          bytes found up to 64 KiB before. It is not the best ratio, but
+ *          a block of source code or of logs inflates in a few hundred
+ *          microseconds.
+ */
+
+#include "ePack.h"
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+
+#define PACK_MIN_MATCH 4 /* Shortest copy, a hashed sequence of bytes */
+#define PACK_MAX_OFFSET 65535 /* Farthest copy, on 2 bytes */
+#define PACK_HASH_BITS 14 /* Size of the table of the sequences seen */
+
+
+/**
+ * @enum PACK_OFFSET kind of offset of a line, the offset of a line read as
+ *       is usually follows the previous one.
+ */
+typedef enum {
+    OFFSET_NONE = 0,
+    OFFSET_NEXT,
+    OFFSET_OTHER,
+    OFFSET_KINDS
+} PACK_OFFSET;
+
+
+static int reserve_ePack(ePack * pack,
+                         size_t length);
+static int compress_block_ePack(ePack * pack);
+static unsigned char * write_number_ePack(unsigned char * output,
+                                          uint64_t number);
+static int read_number_ePack(unsigned char const ** input,
+                             unsigned char const * end,
+                             uint64_t * number);
+static size_t compress_ePack(unsigned char const * source,
+                             size_t length,
+                             unsigned char * destination);
+static unsigned char * write_sequence_ePack(unsigned char * output,
+                                            unsigned char const * literals,
+                                            size_t n_literals,
+                                            size_t offset,
+                                            size_t match);
+static unsigned char * write_length_ePack(unsigned char * output,
+                                          size_t length);
+static int read_length_ePack(unsigned char const ** input,
+                             unsigned char const * end,
+                             size_t * length);
+static int decompress_ePack(unsigned char const * source,
+                            size_t size,
+                            unsigned char * destination,
+                            size_t length);
+static int read_lines_ePack(ePack const * pack,
+                            unsigned char const * data,
+                            size_t length,
+                            off_t * next_offset,
+                            eLine ** first_line,
+                            eLine ** last_line,
+                            unsigned int * n_lines);
+
+
+/**
+ * @brief The create_ePack() function allocate an empty ePack.
+ *
+ * @return ePack pointer or NULL if it was an error.
+ *
+ * @note delete_ePack() must be called before exiting.
+ */
+ePack * create_ePack(void)
+{
+    ePack *pack = (ePack *) malloc(sizeof(ePack));
+    if(pack == NULL)
+        return NULL;
+
+    pack->blocks = NULL;
+    pack->n_blocks = 0;
+    pack->alloc_blocks = 0;
+    pack->n_lines = 0;
+    pack->buffer = NULL;
+    pack->length = 0;
+    pack->alloc_length = 0;
+    pack->next_offset = 0;
+    pack->size = 0;
+    pack->current_line = 1;
+    pack->current_pos = 0;
+    pack->first_screen_line = 1;
+    pack->dropped = false;
+    pack->restored = false;
+
+    return pack;
+}
+
+
+/**
+ * @brief The delete_ePack() function deallocate ePack and set the pointer
+ *        to NULL.
+ *
+ * @param pack: ePack pointer pointer
+ */
+void delete_ePack(ePack ** pack)
+{
+    if(*pack == NULL)
+        return;
+
+    for(unsigned int i=0; i<(*pack)->n_blocks; i++)
+        free((*pack)->blocks[i].data);
+    free((*pack)->blocks);
+    free((*pack)->buffer);
+    free(*pack);
+    *pack = NULL;
+}
+
+
+/**
+ * @brief The add_line_ePack() function write a line after the previous
+ *        ones, the block is compressed when it is full.
+ *
+ * @param pack: ePack pointer
+ * @param line: Line written
+ *
+ * @return 0 on success or -1 in failure.
+ */
+int add_line_ePack(ePack * pack,
+                   eLine const * line)
+{
+    PACK_OFFSET kind = OFFSET_NONE;
+    unsigned char *output = NULL;
+
+    if(line->file_offset != -1)
+        kind = (line->file_offset == pack->next_offset) ? OFFSET_NEXT
+                                                        : OFFSET_OTHER;
+
+    /* A line is never cut between two blocks, a longer line makes a block
+       by itself */
+    if(pack->length > 0 && pack->length+line->length > PACK_BLOCK_LENGTH
+       &&
+       compress_block_ePack(pack) == -1)
+        return -1;
+
+    /* Two numbers of 10 bytes at most precede the line */
+    if(reserve_ePack(pack, pack->length+line->length+20) == -1)
+        return -1;
+
+    output = pack->buffer+pack->length;
+    output = write_number_ePack(output,
+                                (uint64_t) line->length*OFFSET_KINDS+kind);
+    if(kind == OFFSET_OTHER)
+        output = write_number_ePack(output, (uint64_t) line->file_offset);
+    memcpy(output, line->string, line->length);
+    pack->length = output+line->length-pack->buffer;
+
+    if(kind != OFFSET_NONE)
+        pack->next_offset = line->file_offset+line->length+1;
+    pack->n_lines++;
+
+    return 0;
+}
+
+
+/**
+ * @brief The end_ePack() function compress the last block, no line can be
+ *        added afterwards.
+ *
+ * @param pack: ePack pointer
+ *
+ * @return 0 on success or -1 in failure.
+ */
+int end_ePack(ePack * pack)
+{
+    if(pack->length > 0 && compress_block_ePack(pack) == -1)
+        return -1;
+
+    free(pack->buffer);
+    pack->buffer = NULL;
+    pack->alloc_length = 0;
+
+    return 0;
+}
+
+
+/**
+ * @brief The unpack_ePack() function inflate every block and create the
+ *        lines again, linked together.
+ *
+ * @param pack: ePack pointer
+ * @param first_line: First line or NULL
+ * @param last_line: Last line or NULL
+ *
+ * @return 0 on success or -1 in failure, no line is created then.
+ */
+int unpack_ePack(ePack const * pack,
+                 eLine ** first_line,
+                 eLine ** last_line)
+{
+    unsigned char *buffer = NULL;
+    size_t alloc_length = 0;
+    off_t next_offset = 0;
+    unsigned int n_lines = 0;
+    eLine *current = NULL, *next = NULL;
+    int result = 0;
+
+    *first_line = *last_line = NULL;
+
+    for(unsigned int i=0; i<pack->n_blocks; i++)
+        if(pack->blocks[i].length > alloc_length)
+            alloc_length = pack->blocks[i].length;
+
+    buffer = (unsigned char *) malloc(alloc_length+1);
+    if(buffer == NULL)
+        return -1;
+
+    for(unsigned int i=0; i<pack->n_blocks && result == 0; i++)
+    {
+        if(decompress_ePack(pack->blocks[i].data, pack->blocks[i].size,
+                            buffer, pack->blocks[i].length) == -1
+           ||
+           read_lines_ePack(pack, buffer, pack->blocks[i].length,
+                            &next_offset, first_line, last_line,
+                            &n_lines) == -1)
+            result = -1;
+    }
+
+    free(buffer);
+
+    if(result == 0 && n_lines == pack->n_lines)
+        return 0;
+
+    for(current = *first_line; current; current = next)
+    {
+        next = current->next;
+        delete_eLine(&current);
+    }
+    *first_line = *last_line = NULL;
+
+    return -1;
+}
+
+
+/**
+ * @brief The reserve_ePack() function grow the buffer of the block being
+ *        written.
+ *
+ * @param pack: ePack pointer
+ * @param length: Number of bytes needed
+ *
+ * @return 0 on success or -1 in failure.
+ */
+static int reserve_ePack(ePack * pack,
+                         size_t length)
+{
+    unsigned char *buffer = NULL;
+    size_t alloc_length = (pack->alloc_length != 0) ? pack->alloc_length
+                                                    : PACK_BLOCK_LENGTH;
+
+    if(length <= pack->alloc_length)
+        return 0;
+
+    while(alloc_length < length)
+        alloc_length *= 2;
+
+    buffer = (unsigned char *) realloc(pack->buffer, alloc_length);
+    if(buffer == NULL)
+        return -1;
+
+    pack->buffer = buffer;
+    pack->alloc_length = alloc_length;
+
+    return 0;
+}
+
+
+/**
+ * @brief The compress_block_ePack() function compress the block being
+ *        written and empty the buffer for the next one.
+ *
+ * @param pack: ePack pointer
+ *
+ * @return 0 on success or -1 in failure.
+ */
+static int compress_block_ePack(ePack * pack)
+{
+    pack_block *blocks = NULL;
+    unsigned char *output = NULL, *data = NULL;
+    unsigned int alloc_blocks = 0;
+    size_t size = 0;
+
+    if(pack->n_blocks+1 > pack->alloc_blocks)
+    {
+        alloc_blocks = (pack->alloc_blocks != 0) ? pack->alloc_blocks*2 : 16;
+        blocks = (pack_block *) realloc(pack->blocks,
+                                        alloc_blocks*sizeof(pack_block));
+        if(blocks == NULL)
+            return -1;
+
+        pack->blocks = blocks;
+        pack->alloc_blocks = alloc_blocks;
+    }
+
+    /* Bytes that do not repeat grow by one byte every 255 */
+    output = (unsigned char *) malloc(pack->length+pack->length/255+16);
+    if(output == NULL)
+        return -1;
+
+    size = compress_ePack(pack->buffer, pack->length, output);
+
+    /* Only the compressed bytes are kept */
+    data = (unsigned char *) realloc(output, size);
+    if(data == NULL)
+        data = output;
+
+    pack->blocks[pack->n_blocks].data = data;
+    pack->blocks[pack->n_blocks].size = size;
+    pack->blocks[pack->n_blocks].length = pack->length;
+    pack->n_blocks++;
+    pack->size += size;
+    pack->length = 0;
+
+    return 0;
+}
+
+
+/**
+ * @brief The write_number_ePack() function write a number by groups of 7
+ *        bits, the last group has its high bit clear.
+ *
+ * @param output: Destination, 10 bytes at most are written
+ * @param number: Number
+ *
+ * @return Byte following the number.
+ */
+static unsigned char * write_number_ePack(unsigned char * output,
+                                          uint64_t number)
+{
+    while(number >= 0x80)
+    {
+        *output++ = (unsigned char) (number | 0x80);
+        number >>= 7;
+    }
+    *output++ = (unsigned char) number;
+
+    return output;
+}
+
+
+/**
+ * @brief The read_number_ePack() function read a number written by
+ *        write_number_ePack().
+ *
+ * @param input: Source, moved after the number
+ * @param end: End of the source
+ * @param number: Number read
+ *
+ * @return 0 on success or -1 if the number is truncated.
+ */
+static int read_number_ePack(unsigned char const ** input,
+                             unsigned char const * end,
+                             uint64_t * number)
+{
+    unsigned int shift = 0;
+
+    *number = 0;
+    while(*input < end && shift < 64)
+    {
+        *number |= (uint64_t) (**input & 0x7f) << shift;
+        if((*(*input)++ & 0x80) == 0)
+            return 0;
+        shift += 7;
+    }
+
+    return -1;
+}
+
+
+/**
+ * @brief The compress_ePack() function compress a block. The sequences of
+ *        PACK_MIN_MATCH bytes are hashed, a sequence seen before is
+ *        extended as far as possible and written as a copy.
+ *
+ * @param source: Bytes of the block
+ * @param length: Number of bytes
+ * @param destination: Compressed bytes, length+length/255+16 bytes at most
+ *
+ * @return Number of compressed bytes.
+ */
+static size_t compress_ePack(unsigned char const * source,
+                             size_t length,
+                             unsigned char * destination)
+{
+    uint32_t table[1 << PACK_HASH_BITS];
+    unsigned char *output = destination;
+    size_t anchor = 0, position = 0, candidate = 0, match = 0;
+    uint32_t sequence = 0, hash = 0;
+
+    memset(table, 0, sizeof(table));
+
+    while(position+PACK_MIN_MATCH <= length)
+    {
+        memcpy(&sequence, source+position, PACK_MIN_MATCH);
+        hash = (sequence*2654435761U) >> (32-PACK_HASH_BITS);
+        candidate = table[hash];
+        table[hash] = (uint32_t) position;
+
+        if(candidate >= position
+           ||
+           position-candidate > PACK_MAX_OFFSET
+           ||
+           memcmp(source+candidate, source+position, PACK_MIN_MATCH) != 0)
+        {
+            position++;
+            continue;
+        }
+
+        match = PACK_MIN_MATCH;
+        while(position+match < length
+              &&
+              source[candidate+match] == source[position+match])
+            match++;
+
+        output = write_sequence_ePack(output, source+anchor,
+                                      position-anchor, position-candidate,
+                                      match);
+        position += match;
+        anchor = position;
+    }
+
+    /* The last bytes end the block, without copy */
+    output = write_sequence_ePack(output, source+anchor, length-anchor, 0, 0);
+
+    return output-destination;
+}
+
+
+/**
+ * @brief The write_sequence_ePack() function write a token, the literal
+ *        bytes and the copy. The token holds both lengths on 4 bits, a
+ *        length of 15 or more continues after it.
+ *
+ * @param output: Destination
+ * @param literals: Literal bytes
+ * @param n_literals: Number of literal bytes
+ * @param offset: Distance of the bytes copied
+ * @param match: Number of bytes copied, 0 for the last sequence
+ *
+ * @return Byte following the sequence.
+ */
+static unsigned char * write_sequence_ePack(unsigned char * output,
+                                            unsigned char const * literals,
+                                            size_t n_literals,
+                                            size_t offset,
+                                            size_t match)
+{
+    unsigned char *token = output++;
+
+    *token = (unsigned char) ((n_literals >= 15 ? 15 : n_literals) << 4);
+    if(n_literals >= 15)
+        output = write_length_ePack(output, n_literals-15);
+    memcpy(output, literals, n_literals);
+    output += n_literals;
+
+    if(match == 0)
+        return output;
+
+    *output++ = (unsigned char) (offset & 0xff);
+    *output++ = (unsigned char) (offset >> 8);
+
+    match -= PACK_MIN_MATCH;
+    *token |= (unsigned char) (match >= 15 ? 15 : match);
+    if(match >= 15)
+        output = write_length_ePack(output, match-15);
+
+    return output;
+}
+
+
+/**
+ * @brief The write_length_ePack() function write the rest of a length, by
+ *        bytes of 255 ended by a smaller byte.
+ *
+ * @param output: Destination
+ * @param length: Rest of the length
+ *
+ * @return Byte following the length.
+ */
+static unsigned char * write_length_ePack(unsigned char * output,
+                                          size_t length)
+{
+    while(length >= 255)
+    {
+        *output++ = 255;
+        length -= 255;
+    }
+    *output++ = (unsigned char) length;
+
+    return output;
+}
+
+
+/**
+ * @brief The read_length_ePack() function read the rest of a length
+ *        written by write_length_ePack().
+ *
+ * @param input: Source, moved after the length
+ * @param end: End of the source
+ * @param length: Length, increased by the rest
+ *
+ * @return 0 on success or -1 if the length is truncated.
+ */
+static int read_length_ePack(unsigned char const ** input,
+                             unsigned char const * end,
+                             size_t * length)
+{
+    unsigned char byte = 255;
+
+    while(byte == 255)
+    {
+        if(*input == end)
+            return -1;
+        byte = *(*input)++;
+        *length += byte;
+    }
+
+    return 0;
+}
+
+
+/**
+ * @brief The decompress_ePack() function inflate a block. Every length and
+ *        offset is checked, a damaged block is not read out of its bounds.
+ *
+ * @param source: Compressed bytes
+ * @param size: Number of compressed bytes
+ * @param destination: Bytes of the block
+ * @param length: Number of bytes of the block
+ *
+ * @return 0 on success or -1 if the block is damaged.
+ */
+static int decompress_ePack(unsigned char const * source,
+                            size_t size,
+                            unsigned char * destination,
+                            size_t length)
+{
+    unsigned char const *input = source, *end = source+size, *copy = NULL;
+    unsigned char *output = destination, *output_end = destination+length;
+    size_t n = 0, offset = 0;
+    unsigned char token = 0;
+
+    while(input < end)
+    {
+        token = *input++;
+
+        n = token >> 4;
+        if(n == 15 && read_length_ePack(&input, end, &n) == -1)
+            return -1;
+        if((size_t) (end-input) < n || (size_t) (output_end-output) < n)
+            return -1;
+        memcpy(output, input, n);
+        input += n;
+        output += n;
+
+        /* The last sequence has no copy */
+        if(input == end)
+            break;
+
+        if(end-input < 2)
+            return -1;
+        offset = input[0] | (size_t) input[1] << 8;
+        input += 2;
+        if(offset == 0 || offset > (size_t) (output-destination))
+            return -1;
+
+        n = token & 15;
+        if(n == 15 && read_length_ePack(&input, end, &n) == -1)
+            return -1;
+        n += PACK_MIN_MATCH;
+        if((size_t) (output_end-output) < n)
+            return -1;
+
+        /* A copy close to its source repeats the bytes it writes */
+        copy = output-offset;
+        if(offset >= n)
+            memcpy(output, copy, n);
+        else
+            for(size_t i=0; i<n; i++)
+                output[i] = copy[i];
+        output += n;
+    }
+
+    return (output == output_end) ? 0 : -1;
+}
+
+
+/**
+ * @brief The read_lines_ePack() function create the lines of an inflated
+ *        block after the previous ones.
+ *
+ * @param pack: ePack pointer
+ * @param data: Bytes of the block
+ * @param length: Number of bytes
+ * @param next_offset: Offset following the previous line in the file
+ * @param first_line: First line or NULL
+ * @param last_line: Last line or NULL
+ * @param n_lines: Number of lines created
+ *
+ * @return 0 on success or -1 in failure.
+ */
+static int read_lines_ePack(ePack const * pack,
+                            unsigned char const * data,
+                            size_t length,
+                            off_t * next_offset,
+                            eLine ** first_line,
+                            eLine ** last_line,
+                            unsigned int * n_lines)
+{
+    unsigned char const *input = data, *end = data+length;
+    uint64_t header = 0, offset = 0;
+    size_t line_length = 0;
+    PACK_OFFSET kind = OFFSET_NONE;
+    eLine *line = NULL;
+
+    while(input < end)
+    {
+        if(*n_lines == pack->n_lines
+           ||
+           read_number_ePack(&input, end, &header) == -1)
+            return -1;
+
+        kind = (PACK_OFFSET) (header%OFFSET_KINDS);
+        line_length = header/OFFSET_KINDS;
+
+        if(kind == OFFSET_OTHER && read_number_ePack(&input, end,
+                                                     &offset) == -1)
+            return -1;
+        if((size_t) (end-input) < line_length)
+            return -1;
+
+        line = create_eLine((char const *) input, line_length, 0, *last_line,
+                            NULL);
+        if(line == NULL)
+            return -1;
+        if(*first_line == NULL)
+            *first_line = line;
+        *last_line = line;
+        (*n_lines)++;
+        input += line_length;
+
+        if(kind == OFFSET_NEXT)
+            line->file_offset = *next_offset;
+        else if(kind == OFFSET_OTHER)
+            line->file_offset = (off_t) offset;
+        if(kind != OFFSET_NONE)
+            *next_offset = line->file_offset+line_length+1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,719 @@
+/**
+ * @file eReplace.c
+ * @brief Contain eReplace structure and functions
+ * @author ALARY Dorian
+ * @version 1.0
+ * @date 21/07/2024
+ * @copyright GNU Public License.
+ *
+ * @details This file contains all the structures, variables and functions
+ *          used to replace a string in every file of the directory. Worker
+ *          threads take the files one by one, stream them through the
+ *          replacement into a temporary file of the same directory and
+ *          rename it over the original, so a file is either fully replaced
+ *          or left unchanged.
+ */
+
+#define _GNU_SOURCE /* memmem */
+
+#include "eReplace.h"
+#include "eDirectory.h"
+#include "eBar.h"
+#include "eFile.h"
+#include "eSave.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h> /* PATH_MAX */
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+
+#define REPLACE_BUFFER_LENGTH (64*1024) /* Read and write buffers length */
+
+
+/**
+ * @struct replace_output structure to buffer the writes of a worker.
+ */
+typedef struct {
+
+    /** File descriptor */
+    int fd;
+
+    /** Buffer */
+    char * buffer;
+
+    /** Number of bytes in buffer */
+    size_t length;
+
+    /** A write failed */
+    bool error;
+
+} replace_output;
+
+
+/**
+ * @struct replace_target structure to find the files reached by several
+ *         symbolic links.
+ */
+typedef struct {
+
+    /** Canonical path of the file, the target of its links */
+    char * path;
+
+    /** Index of the file in the files to process */
+    unsigned int index;
+
+} replace_target;
+
+
+static void fill_files_eReplace(eReplace * replace,
+                                eDirectory const * directory,
+                                eBar const * bar);
+static bool is_open_eReplace(eBar const * bar,
+                             eFile const * file);
+static int remove_links_eReplace(eReplace * replace);
+static int compare_targets(void const * first,
+                           void const * second);
+static void * run_eReplace(void * arg);
+static int replace_file_eReplace(eReplace * replace,
+                                 eFile const * file);
+static int stream_file_eReplace(eReplace * replace,
+                                int fd,
+                                char * buffer,
+                                replace_output * output);
+static void write_output(replace_output * output,
+                         char const * data,
+                         size_t length);
+static void flush_output(replace_output * output);
+
+
+/**
+ * @brief The create_eReplace() function allocate an eReplace with every
+ *        file of directory which is not in the bar. A file reached by
+ *        several symbolic links is processed once.
+ *
+ * @param directory: Root eDirectory
+ * @param bar: eBar of the open files, processed in memory by the caller
+ * @param pattern: String to replace
+ * @param replacement: String replacing pattern
+ * @param policy: fsync policy, as for the saves
+ *
+ * @return eReplace pointer or NULL if it was an error.
+ *
+ * @note delete_eReplace() must be called before exiting.
+ */
+eReplace * create_eReplace(eDirectory const * directory,
+                           eBar const * bar,
+                           char const * pattern,
+                           char const * replacement,
+                           FSYNC_POLICY policy)
+{
+    eReplace *replace = NULL;
+
+    if(directory == NULL || pattern == NULL || pattern[0] == 0
+       || replacement == NULL)
+        return NULL;
+
+    replace = (eReplace *) malloc(sizeof(eReplace));
+    if(replace == NULL)
+        return NULL;
+
+    memset(replace, 0, sizeof(eReplace));
+    pthread_mutex_init(&replace->mutex, NULL);
+
+    replace->pattern = strdup(pattern);
+    replace->replacement = strdup(replacement);
+    if(replace->pattern == NULL || replace->replacement == NULL)
+    {
+        delete_eReplace(&replace);
+        return NULL;
+    }
+    replace->pattern_length = strlen(pattern);
+    replace->replacement_length = strlen(replacement);
+    replace->policy = policy;
+
+    fill_files_eReplace(replace, directory, bar);
+
+    /* A target rewritten through two links would replace the replacement
+       again */
+    if(remove_links_eReplace(replace) == -1)
+    {
+        delete_eReplace(&replace);
+        return NULL;
+    }
+
+    replace->changed = (bool *) calloc(replace->n_files+1, sizeof(bool));
+    if(replace->changed == NULL)
+    {
+        delete_eReplace(&replace);
+        return NULL;
+    }
+
+    return replace;
+}
+
+
+/**
+ * @brief The delete_eReplace() function wait for the workers, deallocate
+ *        eReplace and set the pointer to NULL.
+ *
+ * @param replace: eReplace pointer pointer
+ */
+void delete_eReplace(eReplace ** replace)
+{
+    if(*replace == NULL)
+        return;
+
+    for(unsigned int i=0; i<(*replace)->n_threads; i++)
+        pthread_join((*replace)->threads[i], NULL);
+
+    pthread_mutex_destroy(&(*replace)->mutex);
+    free((*replace)->files);
+    free((*replace)->changed);
+    free((*replace)->pattern);
+    free((*replace)->replacement);
+    free(*replace);
+    *replace = NULL;
+}
+
+
+/**
+ * @brief The start_eReplace() function start the worker threads.
+ *
+ * @param replace: eReplace pointer
+ *
+ * @return 0 on success or -1 in failure.
+ */
+int start_eReplace(eReplace * replace)
+{
+    long n_cpu = 0;
+    unsigned int n_threads = 0;
+
+    if(replace == NULL)
+        return -1;
+
+    n_cpu = sysconf(_SC_NPROCESSORS_ONLN);
+    n_threads = (n_cpu > 0) ? n_cpu : 1;
+    if(n_threads > REPLACE_MAX_THREADS)
+        n_threads = REPLACE_MAX_THREADS;
+    if(n_threads > replace->n_files)
+        n_threads = replace->n_files;
+
+    pthread_mutex_lock(&replace->mutex);
+    for(unsigned int i=0; i<n_threads; i++)
+    {
+        if(pthread_create(&replace->threads[replace->n_threads], NULL,
+                          run_eReplace, replace) == 0)
+        {
+            replace->n_threads++;
+            replace->n_running++;
+        }
+    }
+    pthread_mutex_unlock(&replace->mutex);
+
+    if(replace->n_threads == 0 && replace->n_files != 0)
+        return -1;
+
+    return 0;
+}
+
+
+/**
+ * @brief The cancel_eReplace() function ask the workers to stop. Files
+ *        being processed are left unchanged.
+ *
+ * @param replace: eReplace pointer
+ */
+void cancel_eReplace(eReplace * replace)
+{
+    if(replace == NULL)
+        return;
+
+    pthread_mutex_lock(&replace->mutex);
+    replace->cancel = true;
+    pthread_mutex_unlock(&replace->mutex);
+}
+
+
+/**
+ * @brief The get_progress_eReplace() function return the progress of the
+ *        replacement.
+ *
+ * @param replace: eReplace pointer
+ * @param n_done: Number of processed files returned
+ * @param last_file: Last processed file returned, may be NULL
+ *
+ * @return true if every worker has finished, false otherwise.
+ */
+bool get_progress_eReplace(eReplace * replace,
+                           unsigned int * n_done,
+                           eFile const ** last_file)
+{
+    bool finished = false;
+
+    pthread_mutex_lock(&replace->mutex);
+    *n_done = replace->n_done;
+    if(last_file != NULL)
+        *last_file = replace->last_file;
+    finished = (replace->n_running == 0);
+    pthread_mutex_unlock(&replace->mutex);
+
+    return finished;
+}
+
+
+/**
+ * @brief The fill_files_eReplace() function add every file of directory
+ *        and its children which is not open in the bar.
+ *
+ * @param replace: eReplace pointer
+ * @param directory: eDirectory pointer
+ * @param bar: eBar pointer
+ *
+ * @note This is a recursive function.
+ */
+static void fill_files_eReplace(eReplace * replace,
+                                eDirectory const * directory,
+                                eBar const * bar)
+{
+    eFile **files = NULL;
+
+    for(unsigned int i=0; i<directory->n_dirs; i++)
+    {
+        if(directory->dirs[i] != NULL)
+            fill_files_eReplace(replace, directory->dirs[i], bar);
+    }
+
+    for(unsigned int i=0; i<directory->n_files; i++)
+    {
+        if(directory->files[i] == NULL
+           ||
+           directory->files[i]->permissions != p_READWRITE
+           ||
+           is_open_eReplace(bar, directory->files[i]))
+            continue;
+
+        if((replace->n_files & (replace->n_files-1)) == 0)
+        {
+            files = (eFile **) realloc(replace->files,
+                     get_next_power_of_two(replace->n_files+1)*sizeof(eFile *));
+            if(files == NULL)
+                return;
+            replace->files = files;
+        }
+
+        replace->files[replace->n_files] = directory->files[i];
+        replace->n_files++;
+    }
+}
+
+
+/**
+ * @brief The is_open_eReplace() function return true if the lines of a
+ *        file are in memory in the bar.
+ *
+ * @param bar: eBar pointer
+ * @param file: eFile of the directory
+ *
+ * @return false if the file is not in the bar or if its lines were
+ *         dropped, true otherwise.
+ */
+static bool is_open_eReplace(eBar const * bar,
+                             eFile const * file)
+{
+    eFile const *open = find_file_eBar(bar, file);
+
+    /* A dropped file is read as it is on disk when it is shown */
+    return open != NULL && (open->pack == NULL || !open->pack->dropped);
+}
+
+
+/**
+ * @brief The remove_links_eReplace() function keep only the first of the
+ *        files which have the same canonical path, like a file and a
+ *        symbolic link to it. The order of the files is kept.
+ *
+ * @param replace: eReplace pointer
+ *
+ * @return 0 on success or -1 in failure.
+ *
+ * @note Hard links are different paths and are all kept: the rename of
+ *       the replaced file breaks the link, so each name is rewritten.
+ */
+static int remove_links_eReplace(eReplace * replace)
+{
+    replace_target *targets = NULL;
+    char path[PATH_MAX];
+    unsigned int n_targets = 0;
+    unsigned int n_files = 0;
+    int result = 0;
+
+    if(replace->n_files < 2)
+        return 0;
+
+    targets = (replace_target *) malloc(replace->n_files
+                                        * sizeof(replace_target));
+    if(targets == NULL)
+        return -1;
+
+    /* A file without target fails in the workers */
+    for(unsigned int i=0; i<replace->n_files && result == 0; i++)
+    {
+        if(realpath(replace->files[i]->realpath, path) == NULL)
+            continue;
+
+        targets[n_targets].path = strdup(path);
+        targets[n_targets].index = i;
+        if(targets[n_targets].path == NULL)
+            result = -1;
+        else
+            n_targets++;
+    }
+
+    if(result == 0)
+        qsort(targets, n_targets, sizeof(replace_target), compare_targets);
+
+    for(unsigned int i=1; i<n_targets && result == 0; i++)
+    {
+        if(strcmp(targets[i].path, targets[i-1].path) == 0)
+            replace->files[targets[i].index] = NULL;
+    }
+
+    for(unsigned int i=0; i<n_targets; i++)
+        free(targets[i].path);
+    free(targets);
+
+    if(result == -1)
+        return -1;
+
+    for(unsigned int i=0; i<replace->n_files; i++)
+    {
+        if(replace->files[i] != NULL)
+            replace->files[n_files++] = replace->files[i];
+    }
+    replace->n_files = n_files;
+
+    return 0;
+}
+
+
+/**
+ * @brief The compare_targets() function compare two replace_target by
+ *        path and index, for qsort().
+ *
+ * @param first: replace_target pointer
+ * @param second: replace_target pointer
+ *
+ * @return A negative number, 0 or a positive number if first is before,
+ *         equal to or after second.
+ */
+static int compare_targets(void const * first,
+                           void const * second)
+{
+    replace_target const *a = (replace_target const *) first;
+    replace_target const *b = (replace_target const *) second;
+    int order = strcmp(a->path, b->path);
+
+    if(order != 0)
+        return order;
+    if(a->index != b->index)
+        return (a->index < b->index) ? -1 : 1;
+
+    return 0;
+}
+
+
+/**
+ * @brief The run_eReplace() function process files until every file is
+ *        processed or the replacement is canceled. Thread routine.
+ *
+ * @param arg: eReplace pointer
+ *
+ * @return NULL.
+ */
+static void * run_eReplace(void * arg)
+{
+    eReplace *replace = (eReplace *) arg;
+    unsigned int index = 0;
+    int result = 0;
+
+    pthread_mutex_lock(&replace->mutex);
+
+    while(!replace->cancel && replace->next < replace->n_files)
+    {
+        index = replace->next;
+        replace->next++;
+        pthread_mutex_unlock(&replace->mutex);
+
+        result = replace_file_eReplace(replace, replace->files[index]);
+
+        pthread_mutex_lock(&replace->mutex);
+        replace->n_done++;
+        replace->last_file = replace->files[index];
+        if(result == 1)
+        {
+            replace->changed[index] = true;
+            replace->n_changed++;
+        }
+        else if(result == -1)
+        {
+            replace->n_errors++;
+        }
+    }
+
+    replace->n_running--;
+    pthread_mutex_unlock(&replace->mutex);
+
+    return NULL;
+}
+
+
+/**
+ * @brief The replace_file_eReplace() function stream a file through the
+ *        replacement into a temporary file and rename it over the
+ *        original. A file without occurrence, with a NUL byte in its first
+ *        block or processed when the replacement is canceled is left
+ *        unchanged.
+ *
+ * @param replace: eReplace pointer
+ * @param file: eFile pointer
+ *
+ * @return 1 if the file was rewritten, 0 if it was left unchanged or -1 in
+ *         failure.
+ */
+static int replace_file_eReplace(eReplace * replace,
+                                 eFile const * file)
+{
+    char path[PATH_MAX];
+    char tmp_path[PATH_MAX+32];
+    char *buffer = NULL;
+    char *directory_end = NULL;
+    struct stat info;
+    replace_output output = {-1, NULL, 0, false};
+    int fd = -1;
+    int result = -1;
+
+    /* Rewrite the target of a symbolic link, not the link */
+    if(realpath(file->realpath, path) == NULL)
+        return -1;
+
+    if((fd = open(path, O_RDONLY)) == -1)
+        return -1;
+
+    if(fstat(fd, &info) == -1 || !S_ISREG(info.st_mode))
+    {
+        close(fd);
+        return -1;
+    }
+
+    buffer = (char *) malloc(REPLACE_BUFFER_LENGTH+replace->pattern_length);
+    output.buffer = (char *) malloc(REPLACE_BUFFER_LENGTH);
+    if(buffer == NULL || output.buffer == NULL)
+        goto end;
+
+    /* Most files do not contain the pattern, they are only read */
+    result = stream_file_eReplace(replace, fd, buffer, NULL);
+    if(result != 1)
+        goto end;
+
+    /* Temporary file in the same directory, rename must not cross file
+       systems */
+    directory_end = strrchr(path, '/');
+    snprintf(tmp_path, sizeof(tmp_path), "%.*s/.%s.edito-XXXXXX",
+             (int) (directory_end-path), path, directory_end+1);
+
+    result = -1;
+    if((output.fd = mkstemp(tmp_path)) == -1)
+        goto end;
+
+    if(lseek(fd, 0, SEEK_SET) == -1)
+        goto remove;
+
+    /* Only a cancel or a pattern gone since the first pass leave the file
+       unchanged, a failed write is an error */
+    result = stream_file_eReplace(replace, fd, buffer, &output);
+    if(result != 1)
+        goto remove;
+
+    result = -1;
+    if(fchmod(output.fd, info.st_mode & 07777) == -1
+       ||
+       (replace->policy != f_NONE && fsync(output.fd) == -1))
+        goto remove;
+
+    /* Ownership can only be kept by root or the owner */
+    if(fchown(output.fd, info.st_uid, info.st_gid) == -1)
+    {
+        /* Ignored */
+    }
+
+    if(close(output.fd) == -1 || rename(tmp_path, path) == -1)
+    {
+        output.fd = -1;
+        goto remove;
+    }
+
+    output.fd = -1;
+
+    /* The rename is only durable once the directory is synced */
+    result = (replace->policy == f_FULL && sync_directory_eSave(path) == -1)
+             ? -1 : 1;
+    goto end;
+
+remove:
+    unlink(tmp_path);
+
+end:
+    if(output.fd != -1)
+        close(output.fd);
+    close(fd);
+    free(buffer);
+    free(output.buffer);
+
+    return result;
+}
+
+
+/**
+ * @brief The stream_file_eReplace() function read a file block by block.
+ *        Without output, it only searches an occurrence of the pattern.
+ *        With an output, it writes the file with every occurrence
+ *        replaced.
+ *
+ * @param replace: eReplace pointer
+ * @param fd: File descriptor to read
+ * @param buffer: Buffer of REPLACE_BUFFER_LENGTH+pattern_length bytes
+ * @param output: replace_output pointer or NULL
+ *
+ * @return 1 if the pattern was found (and the output written), 0 if it
+ *         was not found, if the file looks binary or if the replacement
+ *         was canceled, -1 in failure.
+ */
+static int stream_file_eReplace(eReplace * replace,
+                                int fd,
+                                char * buffer,
+                                replace_output * output)
+{
+    size_t keep = replace->pattern_length-1;
+    size_t length = 0, start = 0, safe = 0;
+    char const *match = NULL;
+    ssize_t n_read = 0;
+    bool first_block = true;
+    bool found = false;
+    bool cancel = false;
+
+    while((n_read = read(fd, buffer+length, REPLACE_BUFFER_LENGTH)) > 0)
+    {
+        if(first_block && memchr(buffer, 0, n_read) != NULL)
+            return 0;
+        first_block = false;
+        length += n_read;
+
+        pthread_mutex_lock(&replace->mutex);
+        cancel = replace->cancel;
+        pthread_mutex_unlock(&replace->mutex);
+        if(cancel)
+            return 0;
+
+        /* Bytes from safe may start an occurrence split with the next
+           block, they are kept for the next loop */
+        safe = (length > keep) ? length-keep : 0;
+        start = 0;
+
+        while((match = memmem(buffer+start, length-start,
+                              replace->pattern,
+                              replace->pattern_length)) != NULL
+              &&
+              (size_t) (match-buffer) < safe)
+        {
+            found = true;
+            if(output == NULL)
+                return 1;
+
+            write_output(output, buffer+start, match-(buffer+start));
+            write_output(output, replace->replacement,
+                         replace->replacement_length);
+            start = match-buffer + replace->pattern_length;
+        }
+
+        if(start < safe)
+        {
+            if(output != NULL)
+                write_output(output, buffer+start, safe-start);
+            start = safe;
+        }
+
+        memmove(buffer, buffer+start, length-start);
+        length -= start;
+    }
+
+    if(n_read == -1)
+        return -1;
+
+    if(output == NULL)
+        return 0;
+
+    /* Last bytes, too short to contain an occurrence */
+    write_output(output, buffer, length);
+    flush_output(output);
+
+    return (output->error) ? -1 : found;
+}
+
+
+/**
+ * @brief The write_output() function add bytes to the output buffer and
+ *        write it when it is full.
+ *
+ * @param output: replace_output pointer
+ * @param data: Bytes to write
+ * @param length: Number of bytes
+ */
+static void write_output(replace_output * output,
+                         char const * data,
+                         size_t length)
+{
+    size_t n = 0;
+
+    while(length > 0 && !output->error)
+    {
+        n = REPLACE_BUFFER_LENGTH - output->length;
+        if(n > length)
+            n = length;
+
+        memcpy(output->buffer+output->length, data, n);
+        output->length += n;
+        data += n;
+        length -= n;
+
+        if(output->length == REPLACE_BUFFER_LENGTH)
+            flush_output(output);
+    }
+}
+
+
+/**
+ * @brief The flush_output() function write the output buffer.
+ *
+ * @param output: replace_output pointer
+ */
+static void flush_output(replace_output * output)
+{
+    size_t written = 0;
+    ssize_t n = 0;
+
+    while(written < output->length && !output->error)
+    {
+        n = write(output->fd, output->buffer+written,
+                  output->length-written);
+        if(n == -1)
+            output->error = true;
+        else
+            written += n;
+    }
+
+    output->length = 0;
+}
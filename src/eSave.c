@@ -0,0 +1,728 @@
+/**
+ * @file eSave.c
+ * @brief Contain eSave structure and functions
+ * @author ALARY Dorian
+ * @version 1.0
+ * @date 21/07/2024
+ * @copyright GNU Public License.
+ *
+ * @details This file contains the functions used to save an eFile. The
+ *          lines are copied in a snapshot, then written in a temporary file
+ *          which is renamed over the original file. The snapshot can be
+ *          written by a background thread while the eFile is modified.
+ */
+
+#define _GNU_SOURCE /* copy_file_range */
+
+#include "eSave.h"
+#include "eFile.h"
+#include "eLine.h"
+#include "eView.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h> /* PATH_MAX */
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+
+#define CHUNK_LENGTH (1024*1024) /* Length of the snapshot chunks */
+#define CHUNK_ALIGNMENT 4096 /* Alignment of the snapshot chunks */
+#define COPY_BUFFER_LENGTH (64*1024) /* Buffer of copy_range_eSave() */
+
+
+static bool is_source_valid(eFile const * file);
+static int add_line_eSave(eSave * save,
+                          eLine const * line,
+                          bool from_source);
+static int add_view_eSave(eSave * save,
+                          eView const * view);
+static int add_range_eSave(eSave * save,
+                           bool swap,
+                           off_t offset,
+                           size_t length);
+static int add_data_eSave(eSave * save,
+                          char const * string,
+                          size_t length,
+                          bool newline);
+static int add_segment_eSave(eSave * save,
+                             char * data,
+                             bool swap,
+                             off_t offset,
+                             size_t length);
+static int add_chunk_eSave(eSave * save,
+                           size_t length);
+static int copy_range_eSave(int source_fd,
+                            int fd,
+                            off_t offset,
+                            size_t length);
+static void * run_eSave(void * arg);
+static int write_all_eSave(int fd,
+                           char const * data,
+                           size_t length);
+
+
+/**
+ * @brief The create_eSave() function allocate an eSave and take a
+ *        snapshot of the lines of file. The file can be modified as soon as
+ *        the function returns.
+ *
+ * @param file: eFile pointer
+ * @param policy: fsync policy
+ *
+ * @return eSave pointer or NULL if it was an error.
+ *
+ * @note delete_eSave() must be called before exiting.
+ */
+eSave * create_eSave(eFile * file,
+                     FSYNC_POLICY policy)
+{
+    eSave *save = NULL;
+    eLine *current = NULL;
+    bool from_source = false;
+    struct stat info;
+    mode_t mask = 0;
+
+    if(file == NULL)
+        return NULL;
+
+    save = (eSave *) malloc(sizeof(eSave));
+    if(save == NULL)
+        return NULL;
+
+    memset(save, 0, sizeof(eSave));
+    pthread_mutex_init(&save->mutex, NULL);
+    save->file = file;
+    save->policy = policy;
+    save->result = -1;
+    save->source_fd = -1;
+    save->swap_fd = -1;
+
+    save->realpath = strdup(file->realpath);
+    if(save->realpath == NULL)
+    {
+        delete_eSave(&save);
+        return NULL;
+    }
+
+    /* A new file gets the mode open(2) would give it */
+    if(stat(file->realpath, &info) == 0)
+        save->mode = info.st_mode & 07777;
+    else
+    {
+        mask = umask(0);
+        umask(mask);
+        save->mode = 0666 & ~mask;
+    }
+
+    /* Unchanged lines are only copied if the file was not modified since
+       it was opened, the descriptor is duplicated for the thread */
+    if(is_source_valid(file))
+        save->source_fd = dup(file->fd);
+    from_source = (save->source_fd != -1);
+
+    /* The pages of a view are copied from the file or its swap file */
+    if(file->view != NULL)
+    {
+        if(add_view_eSave(save, file->view) == -1)
+            delete_eSave(&save);
+        else
+            hold_swap_eView(file->view);
+        return save;
+    }
+
+    current = file->first_file_line;
+    while(current)
+    {
+        if(add_line_eSave(save, current, from_source) == -1)
+        {
+            delete_eSave(&save);
+            return NULL;
+        }
+        current = current->next;
+    }
+
+    return save;
+}
+
+
+/**
+ * @brief The delete_eSave() function wait for the thread, deallocate eSave
+ *        and set the pointer to NULL.
+ *
+ * @param save: eSave pointer pointer
+ */
+void delete_eSave(eSave ** save)
+{
+    if(*save == NULL)
+        return;
+
+    if((*save)->started)
+        pthread_join((*save)->thread, NULL);
+
+    for(unsigned int i=0; i<(*save)->n_chunks; i++)
+        free((*save)->chunks[i]);
+
+    if((*save)->source_fd != -1)
+        close((*save)->source_fd);
+
+    if((*save)->swap_fd != -1)
+        close((*save)->swap_fd);
+
+    pthread_mutex_destroy(&(*save)->mutex);
+    free((*save)->chunks);
+    free((*save)->segments);
+    free((*save)->realpath);
+    free(*save);
+    *save = NULL;
+}
+
+
+/**
+ * @brief The start_eSave() function start a thread writing the snapshot.
+ *
+ * @param save: eSave pointer
+ *
+ * @return 0 on success or -1 in failure.
+ */
+int start_eSave(eSave * save)
+{
+    if(save == NULL || save->started)
+        return -1;
+
+    if(pthread_create(&save->thread, NULL, run_eSave, save) != 0)
+        return -1;
+
+    save->started = true;
+
+    return 0;
+}
+
+
+/**
+ * @brief The write_eSave() function write the snapshot in a temporary file
+ *        of the same directory and rename it over the file, so that the
+ *        file is never half written.
+ *
+ * @param save: eSave pointer
+ *
+ * @return 0 on success or -1 in failure.
+ */
+int write_eSave(eSave * save)
+{
+    char path[PATH_MAX];
+    char tmp_path[PATH_MAX+32];
+    char *directory_end = NULL;
+    save_segment const *segment = NULL;
+    struct stat info;
+    bool exists = false;
+    int fd = -1;
+
+    /* Replace the target of a symbolic link, not the link */
+    if(realpath(save->realpath, path) == NULL)
+    {
+        if(errno != ENOENT || strlen(save->realpath) >= sizeof(path))
+            return -1;
+        strcpy(path, save->realpath);
+    }
+    exists = (stat(path, &info) == 0);
+
+    /* Temporary file in the same directory, rename must not cross file
+       systems */
+    directory_end = strrchr(path, '/');
+    if(directory_end != NULL)
+        snprintf(tmp_path, sizeof(tmp_path), "%.*s/.%s.edito-XXXXXX",
+                 (int) (directory_end-path), path, directory_end+1);
+    else
+        snprintf(tmp_path, sizeof(tmp_path), ".%s.edito-XXXXXX", path);
+
+    if((fd = mkstemp(tmp_path)) == -1)
+        return -1;
+
+    for(unsigned int i=0; i<save->n_segments; i++)
+    {
+        segment = &save->segments[i];
+
+        if(segment->data != NULL
+           &&
+           write_all_eSave(fd, segment->data, segment->length) == -1)
+            goto remove;
+
+        if(segment->data == NULL
+           &&
+           copy_range_eSave(segment->swap ? save->swap_fd : save->source_fd,
+                            fd, segment->offset, segment->length) == -1)
+            goto remove;
+    }
+
+    if(fchmod(fd, save->mode) == -1)
+        goto remove;
+
+    /* Ownership can only be kept by root or the owner */
+    if(exists && fchown(fd, info.st_uid, info.st_gid) == -1)
+    {
+        /* Ignored */
+    }
+
+    if(save->policy != f_NONE && fsync(fd) == -1)
+        goto remove;
+
+    if(close(fd) == -1)
+    {
+        fd = -1;
+        goto remove;
+    }
+    fd = -1;
+
+    if(rename(tmp_path, path) == -1)
+        goto remove;
+
+    /* The rename is only durable once the directory is synced */
+    if(save->policy == f_FULL && sync_directory_eSave(path) == -1)
+        return -1;
+
+    return 0;
+
+remove:
+    if(fd != -1)
+        close(fd);
+    unlink(tmp_path);
+
+    return -1;
+}
+
+
+/**
+ * @brief The is_finished_eSave() function return true if the snapshot was
+ *        written, the result is then in the result attribute.
+ *
+ * @param save: eSave pointer
+ *
+ * @return true if the save is finished, false otherwise.
+ */
+bool is_finished_eSave(eSave * save)
+{
+    bool finished = false;
+
+    pthread_mutex_lock(&save->mutex);
+    finished = save->finished;
+    pthread_mutex_unlock(&save->mutex);
+
+    return finished;
+}
+
+
+/**
+ * @brief The wait_eSave() function wait until the snapshot is written.
+ *
+ * @param save: eSave pointer
+ *
+ * @return 0 if the file was saved or -1 in failure.
+ */
+int wait_eSave(eSave * save)
+{
+    if(save->started)
+    {
+        pthread_join(save->thread, NULL);
+        save->started = false;
+    }
+
+    return save->result;
+}
+
+
+/**
+ * @brief The sync_directory_eSave() function sync the directory of a file,
+ *        so that a rename in it is durable.
+ *
+ * @param path: Path of the file
+ *
+ * @return 0 on success or -1 in failure.
+ */
+int sync_directory_eSave(char const * path)
+{
+    char directory[PATH_MAX];
+    char const *directory_end = strrchr(path, '/');
+    int fd = -1;
+    int result = 0;
+
+    if(directory_end == NULL)
+        strcpy(directory, ".");
+    else if(directory_end == path)
+        strcpy(directory, "/");
+    else
+        snprintf(directory, sizeof(directory), "%.*s",
+                 (int) (directory_end-path), path);
+
+    if((fd = open(directory, O_RDONLY | O_DIRECTORY)) == -1)
+        return -1;
+
+    result = fsync(fd);
+    close(fd);
+
+    return result;
+}
+
+
+/**
+ * @brief The is_source_valid() function return true if the opened file
+ *        still contains the bytes read by open_eFile().
+ *
+ * @param file: eFile pointer
+ *
+ * @return true if the unchanged lines can be copied from the file.
+ */
+static bool is_source_valid(eFile const * file)
+{
+    struct stat info;
+
+    if(file->fd == -1 || fstat(file->fd, &info) == -1)
+        return false;
+
+    return info.st_ino == file->file_stat.st_ino
+           &&
+           info.st_dev == file->file_stat.st_dev
+           &&
+           info.st_size == file->file_stat.st_size
+           &&
+           info.st_mtim.tv_sec == file->file_stat.st_mtim.tv_sec
+           &&
+           info.st_mtim.tv_nsec == file->file_stat.st_mtim.tv_nsec;
+}
+
+
+/**
+ * @brief The add_line_eSave() function add a line and its \n to the
+ *        snapshot.
+ *
+ * @param save: eSave pointer
+ * @param line: eLine pointer
+ * @param from_source: The line can be copied from the opened file
+ *
+ * @return 0 on success or -1 in failure.
+ */
+static int add_line_eSave(eSave * save,
+                          eLine const * line,
+                          bool from_source)
+{
+    /* Unchanged line */
+    if(from_source && line->file_offset != -1)
+        return add_range_eSave(save, false, line->file_offset,
+                               line->length+1);
+
+    return add_data_eSave(save, line->string, line->length, true);
+}
+
+
+/**
+ * @brief The add_view_eSave() function add the pages of a view to the
+ *        snapshot: unchanged pages and the lines not indexed yet are copied
+ *        from the opened file, spilled pages from the swap file.
+ *
+ * @param save: eSave pointer
+ * @param view: eView pointer
+ *
+ * @return 0 on success or -1 in failure.
+ */
+static int add_view_eSave(eSave * save,
+                          eView const * view)
+{
+    view_page const *page = NULL;
+    int result = 0;
+
+    if(save->source_fd == -1)
+        return -1;
+
+    /* The swap file is held by the caller, the spilled pages are not
+       overwritten while the snapshot is written */
+    if(view->swap_fd != -1 && (save->swap_fd = dup(view->swap_fd)) == -1)
+        return -1;
+
+    for(unsigned int i=0; i<view->n_pages && result == 0; i++)
+    {
+        page = &view->pages[i];
+
+        if(!page->dirty)
+            result = add_range_eSave(save, false, page->offset, page->length);
+        else if(page->data == NULL)
+            result = add_range_eSave(save, true, page->offset, page->length);
+        else
+            result = add_data_eSave(save, page->data, page->length, false);
+    }
+
+    if(result == 0 && view->indexed < view->size)
+        result = add_range_eSave(save, false, view->indexed,
+                                 view->size-view->indexed);
+
+    return result;
+}
+
+
+/**
+ * @brief The add_range_eSave() function add a range of the opened file or
+ *        of the swap file to the snapshot. It is merged with the previous
+ *        range when they are consecutive.
+ *
+ * @param save: eSave pointer
+ * @param swap: The range is in the swap file
+ * @param offset: Offset of the range
+ * @param length: Number of bytes
+ *
+ * @return 0 on success or -1 in failure.
+ */
+static int add_range_eSave(eSave * save,
+                           bool swap,
+                           off_t offset,
+                           size_t length)
+{
+    save_segment *last = NULL;
+
+    if(save->n_segments > 0)
+        last = &save->segments[save->n_segments-1];
+
+    if(last != NULL && last->data == NULL && last->swap == swap
+       &&
+       last->offset+(off_t) last->length == offset)
+    {
+        last->length += length;
+        return 0;
+    }
+
+    return add_segment_eSave(save, NULL, swap, offset, length);
+}
+
+
+/**
+ * @brief The add_data_eSave() function copy bytes in the snapshot. They
+ *        are merged with the previous segment when it is in memory too.
+ *
+ * @param save: eSave pointer
+ * @param string: Bytes to copy
+ * @param length: Number of bytes
+ * @param newline: A \n is added after the bytes
+ *
+ * @return 0 on success or -1 in failure.
+ */
+static int add_data_eSave(eSave * save,
+                          char const * string,
+                          size_t length,
+                          bool newline)
+{
+    save_segment *last = NULL;
+    char *data = NULL;
+    size_t total = length+(newline ? 1 : 0);
+
+    if(save->n_segments > 0)
+        last = &save->segments[save->n_segments-1];
+
+    if(save->n_chunks == 0
+       ||
+       save->chunk_length+total > save->chunk_size)
+    {
+        if(add_chunk_eSave(save, total) == -1)
+            return -1;
+    }
+
+    data = save->chunks[save->n_chunks-1]+save->chunk_length;
+    memcpy(data, string, length);
+    if(newline)
+        data[length] = '\n';
+    save->chunk_length += total;
+
+    /* Following the previous segment in memory */
+    if(last != NULL && last->data != NULL && last->data+last->length == data)
+    {
+        last->length += total;
+        return 0;
+    }
+
+    return add_segment_eSave(save, data, false, -1, total);
+}
+
+
+/**
+ * @brief The add_segment_eSave() function add a segment at the end of the
+ *        snapshot.
+ *
+ * @param save: eSave pointer
+ * @param data: Bytes in memory or NULL
+ * @param swap: The range is in the swap file
+ * @param offset: Offset of the range
+ * @param length: Number of bytes
+ *
+ * @return 0 on success or -1 in failure.
+ */
+static int add_segment_eSave(eSave * save,
+                             char * data,
+                             bool swap,
+                             off_t offset,
+                             size_t length)
+{
+    save_segment *segments = NULL;
+    unsigned int alloc_segments = 0;
+
+    if(save->n_segments == save->alloc_segments)
+    {
+        alloc_segments = (save->alloc_segments != 0)
+                         ? save->alloc_segments*2 : 64;
+        segments = (save_segment *) realloc(save->segments,
+                                          alloc_segments*sizeof(save_segment));
+        if(segments == NULL)
+            return -1;
+
+        save->segments = segments;
+        save->alloc_segments = alloc_segments;
+    }
+
+    save->segments[save->n_segments].data = data;
+    save->segments[save->n_segments].swap = swap;
+    save->segments[save->n_segments].offset = offset;
+    save->segments[save->n_segments].length = length;
+    save->n_segments++;
+
+    return 0;
+}
+
+
+/**
+ * @brief The add_chunk_eSave() function add an empty chunk to the snapshot.
+ *
+ * @param save: eSave pointer
+ * @param length: Minimum length of the chunk, for lines longer than a
+ *                chunk
+ *
+ * @return 0 on success or -1 in failure.
+ */
+static int add_chunk_eSave(eSave * save,
+                           size_t length)
+{
+    char **chunks = NULL;
+    char *chunk = NULL;
+
+    if(length < CHUNK_LENGTH)
+        length = CHUNK_LENGTH;
+
+    chunks = (char **) realloc(save->chunks,
+                               (save->n_chunks+1)*sizeof(char *));
+    if(chunks == NULL)
+        return -1;
+    save->chunks = chunks;
+
+    if(posix_memalign((void **) &chunk, CHUNK_ALIGNMENT, length) != 0)
+        return -1;
+
+    save->chunks[save->n_chunks] = chunk;
+    save->n_chunks++;
+    save->chunk_length = 0;
+    save->chunk_size = length;
+
+    return 0;
+}
+
+
+/**
+ * @brief The copy_range_eSave() function copy a range of a file at the
+ *        end of fd. copy_file_range(2) lets the kernel share the
+ *        blocks (reflink) or copy them without going through user space,
+ *        read(2) and write(2) are used when it is not supported.
+ *
+ * @param source_fd: File descriptor to read
+ * @param fd: File descriptor to write
+ * @param offset: Offset of the range in source_fd
+ * @param length: Number of bytes
+ *
+ * @return 0 on success or -1 in failure.
+ */
+static int copy_range_eSave(int source_fd,
+                            int fd,
+                            off_t offset,
+                            size_t length)
+{
+    char buffer[COPY_BUFFER_LENGTH];
+    ssize_t n = 0;
+
+    while(length > 0)
+    {
+        n = copy_file_range(source_fd, &offset, fd, NULL, length, 0);
+        if(n == -1 && errno == EINTR)
+            continue;
+        if(n <= 0)
+            break;
+        length -= n;
+    }
+
+    /* Not supported (other file system, old kernel) */
+    while(length > 0)
+    {
+        n = pread(source_fd, buffer,
+                  (length < sizeof(buffer)) ? length : sizeof(buffer),
+                  offset);
+        if(n == -1 && errno == EINTR)
+            continue;
+        if(n <= 0 || write_all_eSave(fd, buffer, n) == -1)
+            return -1;
+
+        offset += n;
+        length -= n;
+    }
+
+    return 0;
+}
+
+
+/**
+ * @brief The run_eSave() function is the writing thread.
+ *
+ * @param arg: eSave pointer
+ *
+ * @return NULL.
+ */
+static void * run_eSave(void * arg)
+{
+    eSave *save = (eSave *) arg;
+    int result = write_eSave(save);
+
+    pthread_mutex_lock(&save->mutex);
+    save->result = result;
+    save->finished = true;
+    pthread_mutex_unlock(&save->mutex);
+
+    return NULL;
+}
+
+
+/**
+ * @brief The write_all_eSave() function write length bytes on the file
+ *        descriptor, even if write(2) is interrupted or partial.
+ *
+ * @param fd: File descriptor
+ * @param data: Bytes to write
+ * @param length: Number of bytes
+ *
+ * @return 0 on success or -1 in failure.
+ */
+static int write_all_eSave(int fd,
+                           char const * data,
+                           size_t length)
+{
+    ssize_t n = 0;
+
+    while(length > 0)
+    {
+        n = write(fd, data, length);
+        if(n == -1)
+        {
+            if(errno == EINTR)
+                continue;
+            return -1;
+        }
+
+        data += n;
+        length -= n;
+    }
+
+    return 0;
+}
@@ -104,14 +104,12 @@ eScreen * create_eScreen(int lines,
                                             0);
 
     /* Create MENUs */
-    screen->menus[MBAR] = create_eMenu(screen->windows[WBAR_BOX]->window,
-                                       screen->windows[WBAR_ITEMS]->window,
-                                       1);
-
     screen->menus[MDIR] = create_eMenu(screen->windows[WDIR_BOX]->window,
                                        screen->windows[WDIR_ITEMS]->window,
                                        0);
 
+    screen->tabs = create_eTabs(screen->windows[WBAR_ITEMS]->window);
+
     return screen;
 }
 
@@ -139,6 +137,8 @@ void delete_eScreen(eScreen ** screen)
         delete_eMenu(&(*screen)->menus[i]);
     }
 
+    delete_eTabs(&(*screen)->tabs);
+
     free(*screen);
     *screen = NULL;
 }
@@ -158,12 +158,14 @@ void update_directory_eScreen(eScreen * screen)
 
 
 /*
- * @brief The update_bar_eScreen() function refresh the bar window.
+ * @brief The update_bar_eScreen() function print the tabs and refresh the
+ *        bar window.
  *
  * @param screen: eScreen pointer
  */
 void update_bar_eScreen(eScreen * screen)
 {
+    print_eTabs(screen->tabs);
     box(screen->windows[WBAR_BOX]->window, 0, 0);
     wrefresh(screen->windows[WBAR_BOX]->window);
     wrefresh(screen->windows[WBAR_ITEMS]->window);
@@ -293,6 +295,25 @@ int get_input_eScreen(eScreen * screen,
 }
 
 
+/**
+ * @brief The set_input_timeout_eScreen() function set how long
+ *        get_input_eScreen() waits for an input on the window designed by
+ *        type.
+ *
+ * @param screen: eScreen pointer
+ * @param type: Window type
+ * @param delay: Delay in milliseconds, negative to wait forever
+ *
+ * @note get_input_eScreen() returns ERR when the delay expires.
+ */
+void set_input_timeout_eScreen(eScreen * screen,
+                               WINDOW_TYPE type,
+                               int delay)
+{
+    wtimeout(screen->windows[type]->window, delay);
+}
+
+
 /**
  * @brief The create_file_window_eScreen() function allocate and initialize
  *        file windows.
@@ -358,6 +379,29 @@ void resize_file_eScreen(eScreen * screen,
             screen->windows[WFILE_LNUM]->x + width_file_linesnumber;
 
 
+        /* The content window must stay in the screen: it is shrunk
+           before moving right, and moved left before growing */
+        if((unsigned int) x_file_content > screen->windows[WFILE_CNT]->x)
+        {
+            wresize(screen->windows[WFILE_CNT]->window,
+                    screen->windows[WFILE_CNT]->height,
+                    width_file_content);
+
+            mvwin(screen->windows[WFILE_CNT]->window,
+                  screen->windows[WFILE_CNT]->y,
+                  x_file_content);
+        }
+        else
+        {
+            mvwin(screen->windows[WFILE_CNT]->window,
+                  screen->windows[WFILE_CNT]->y,
+                  x_file_content);
+
+            wresize(screen->windows[WFILE_CNT]->window,
+                    screen->windows[WFILE_CNT]->height,
+                    width_file_content);
+        }
+
         screen->windows[WFILE_LNUM]->width = width_file_linesnumber;
         screen->windows[WFILE_CNT]->width = width_file_content;
         screen->windows[WFILE_CNT]->x = x_file_content;
@@ -365,14 +409,6 @@ void resize_file_eScreen(eScreen * screen,
         wresize(screen->windows[WFILE_LNUM]->window,
                 screen->windows[WFILE_LNUM]->height,
                 width_file_linesnumber);
-
-        mvwin(screen->windows[WFILE_CNT]->window,
-              screen->windows[WFILE_CNT]->y,
-              x_file_content);
-
-        wresize(screen->windows[WFILE_CNT]->window,
-                screen->windows[WFILE_CNT]->height,
-                width_file_content);
     }
 }
 
@@ -396,6 +432,50 @@ void print_line_eScreen(eScreen *screen,
 }
 
 
+/**
+ * @brief The print_string_eScreen() print the first bytes of a string,
+ *        which may not be terminated by 0, on the screen.
+ *
+ * @param screen: eScreen pointer
+ * @param type: Window type
+ * @param y: y position of the string
+ * @param x: x position of the string
+ * @param string: string to print
+ * @param length: number of bytes to print
+ */
+void print_string_eScreen(eScreen *screen,
+                          WINDOW_TYPE type,
+                          int y,
+                          int x,
+                          char const * string,
+                          size_t length)
+{
+    mvwaddnstr(screen->windows[type]->window, y, x, string, (int) length);
+}
+
+
+/**
+ * @brief The print_selected_line_eScreen() print a highlighted line on the
+ *        screen.
+ *
+ * @param screen: eScreen pointer
+ * @param type: Window type
+ * @param y: y position of the line
+ * @param x: x position of the line
+ * @param line: line to print
+ */
+void print_selected_line_eScreen(eScreen *screen,
+                                 WINDOW_TYPE type,
+                                 int y,
+                                 int x,
+                                 char const * line)
+{
+    wattron(screen->windows[type]->window, A_REVERSE);
+    mvwaddstr(screen->windows[type]->window, y, x, line);
+    wattroff(screen->windows[type]->window, A_REVERSE);
+}
+
+
 /**
  * @brief The erase_window_eScreen() function erase the window designed by type.
  *
@@ -469,6 +549,75 @@ void print_help_eScreen(eScreen * screen,
 }
 
 
+/**
+ * @brief The create_popup_eScreen() function allocate the popup window in
+ *        the middle of the file box.
+ *
+ * @param screen: eScreen pointer
+ *
+ * @return 0 on success or -1 in failure.
+ *
+ * @note delete_popup_eScreen() must be called to close the popup.
+ */
+int create_popup_eScreen(eScreen * screen)
+{
+    eWindow const *file_box = screen->windows[WFILE_BOX];
+    int width = 0, height = 0;
+    int y = 0, x = 0;
+
+    if(screen->windows[WPOPUP] != NULL)
+        return 0;
+
+    width = file_box->width - file_box->width/6;
+    height = file_box->height - file_box->height/4;
+    if(height < 5)
+        height = 5;
+
+    y = file_box->y + (file_box->height-height)/2;
+    x = file_box->x + (file_box->width-width)/2;
+
+    screen->windows[WPOPUP] = create_eWindow(height, width, y, x);
+    if(screen->windows[WPOPUP] == NULL)
+        return -1;
+
+    return 0;
+}
+
+
+/**
+ * @brief The delete_popup_eScreen() function deallocate the popup window
+ *        and redraw the windows under it.
+ *
+ * @param screen: eScreen pointer
+ */
+void delete_popup_eScreen(eScreen * screen)
+{
+    if(screen->windows[WPOPUP] == NULL)
+        return;
+
+    delete_eWindow(&screen->windows[WPOPUP]);
+
+    for(int i=0 ; i<WINDOWS_NUMBER ; i++)
+    {
+        if(screen->windows[i] != NULL)
+            touchwin(screen->windows[i]->window);
+    }
+    update_all_eScreen(screen);
+}
+
+
+/**
+ * @brief The update_popup_eScreen() function refresh the popup window.
+ *
+ * @param screen: eScreen pointer
+ */
+void update_popup_eScreen(eScreen * screen)
+{
+    box(screen->windows[WPOPUP]->window, 0, 0);
+    wrefresh(screen->windows[WPOPUP]->window);
+}
+
+
 /* ==========================================================
  * eMenu functions
  * ========================================================== */
@@ -606,3 +755,87 @@ int get_current_item_index_menu_eScreen(eScreen const * screen,
 {
     return get_current_item_index_eMenu(screen->menus[type]);
 }
+
+
+/* ==========================================================
+ * eTabs functions
+ * ========================================================== */
+
+/**
+ * @brief The add_tab_eScreen() function add a tab after the last one.
+ *
+ * @param screen: eScreen pointer
+ * @param title: Tab title
+ *
+ * @return 0 in success or -1 in failure.
+ */
+int add_tab_eScreen(eScreen * screen,
+                    char const * title)
+{
+    return add_tab_eTabs(screen->tabs, title);
+}
+
+
+/**
+ * @brief The remove_tab_eScreen() function remove a tab.
+ *
+ * @param screen: eScreen pointer
+ * @param index: Index of the tab
+ *
+ * @return 0 in success or -1 in failure.
+ */
+int remove_tab_eScreen(eScreen * screen,
+                       int index)
+{
+    return remove_tab_eTabs(screen->tabs, index);
+}
+
+
+/**
+ * @brief The set_current_tab_eScreen() function set the current tab.
+ *
+ * @param screen: eScreen pointer
+ * @param index: Index of the tab
+ */
+void set_current_tab_eScreen(eScreen * screen,
+                             int index)
+{
+    set_current_tab_eTabs(screen->tabs, index);
+}
+
+
+/**
+ * @brief The get_current_tab_eScreen() function return the index of the
+ *        current tab.
+ *
+ * @param screen: eScreen pointer
+ *
+ * @return Index of the current tab or -1 if there is no tab.
+ */
+int get_current_tab_eScreen(eScreen const * screen)
+{
+    return get_current_tab_eTabs(screen->tabs);
+}
+
+
+/**
+ * @brief The move_next_tab_eScreen() function move to the next tab.
+ *
+ * @param screen: eScreen pointer
+ */
+void move_next_tab_eScreen(eScreen * screen)
+{
+    move_next_tab_eTabs(screen->tabs);
+}
+
+
+/**
+ * @brief The move_previous_tab_eScreen() function move to the previous
+ *        tab.
+ *
+ * @param screen: eScreen pointer
+ */
+void move_previous_tab_eScreen(eScreen * screen)
+{
+    move_previous_tab_eTabs(screen->tabs);
+}
@@ -0,0 +1,411 @@
+/**
+ * @file eSession.c
+ * @brief Contain eSession structure and functions
+ * @author ALARY Dorian
+ * @version 1.0
+ * @date 21/07/2024
+ * @copyright GNU Public License.
+ *
+ * @details This file contains the functions used to keep the state of
+ *          edito in a directory between two runs. The session is a small
+ *          text file, one line by open directory or open file, written
+ *          when edito exits and read when it starts. Only the paths and the
+ *          cursors are kept, the files are read again when they are shown.
+ *          The session is kept in the state directory of the user, so
+ *          that it is neither listed nor indexed with the directory.
+ */
+
+#include "eSession.h"
+#include "util.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h> /* PATH_MAX */
+#include <unistd.h>
+#include <sys/stat.h> /* mkdir */
+
+
+#define SESSION_MAGIC "EDSESSN2" /* First line of a session */
+#define SESSION_DIRECTORY "edito" /* Directory of the sessions in the state
+                                     directory */
+
+
+static bool is_valid_path_eSession(char const * path);
+static int get_state_eSession(char * path,
+                              size_t size);
+static int make_directories_eSession(char const * path);
+
+
+/**
+ * @brief The create_eSession() function allocate an empty eSession of a
+ *        directory. Its file is in $XDG_STATE_HOME/edito, or in
+ *        $HOME/.local/state/edito, named after the directory and the hash
+ *        of its absolute path.
+ *
+ * @param directory: Path of the directory, "" for the root
+ *
+ * @return eSession pointer or NULL if it was an error or if the user has
+ *         no state directory.
+ *
+ * @note delete_eSession() must be called before exiting.
+ */
+eSession * create_eSession(char const * directory)
+{
+    eSession *session = NULL;
+    char root[PATH_MAX];
+    char path[PATH_MAX];
+    char const *name = NULL;
+    size_t length = 0;
+    int n = 0;
+
+    /* The session of a directory is found whatever the path it is given */
+    if(realpath((directory[0] != 0) ? directory : "/", root) == NULL
+       ||
+       get_state_eSession(path, sizeof(path)) == -1)
+        return NULL;
+
+    name = strrchr(root, '/')+1;
+    length = strlen(path);
+    n = snprintf(path+length, sizeof(path)-length, "/%s/%s-%016llx",
+                 SESSION_DIRECTORY, (name[0] != 0) ? name : "root",
+                 (unsigned long long) hash_bytes(HASH_INIT, root,
+                                                 strlen(root)));
+    if(n < 0 || (size_t) n >= sizeof(path)-length)
+        return NULL;
+
+    session = (eSession *) malloc(sizeof(eSession));
+    if(session == NULL)
+        return NULL;
+
+    memset(session, 0, sizeof(eSession));
+    session->current = -1;
+
+    session->path = strdup(path);
+    session->root = strdup(root);
+    if(session->path == NULL || session->root == NULL)
+    {
+        delete_eSession(&session);
+        return NULL;
+    }
+
+    return session;
+}
+
+
+/**
+ * @brief The delete_eSession() function deallocate eSession and set the
+ *        pointer to NULL.
+ *
+ * @param session: eSession pointer pointer
+ */
+void delete_eSession(eSession ** session)
+{
+    if(*session == NULL)
+        return;
+
+    for(unsigned int i=0; i<(*session)->n_files; i++)
+        free((*session)->files[i].path);
+
+    for(unsigned int i=0; i<(*session)->n_directories; i++)
+        free((*session)->directories[i]);
+
+    free((*session)->files);
+    free((*session)->directories);
+    free((*session)->path);
+    free((*session)->root);
+    free(*session);
+    *session = NULL;
+}
+
+
+/**
+ * @brief The add_file_eSession() function add an open file after the
+ *        previous ones.
+ *
+ * @param session: eSession pointer
+ * @param path: Path of the file, from the directory of the session
+ * @param current_line: Line number of the current line
+ * @param current_pos: Current pos in current line
+ * @param first_screen_line: Line number of the first line of screen
+ *
+ * @return 0 on success or -1 in failure.
+ */
+int add_file_eSession(eSession * session,
+                      char const * path,
+                      unsigned int current_line,
+                      unsigned int current_pos,
+                      unsigned int first_screen_line)
+{
+    session_file *files = NULL;
+    session_file *file = NULL;
+    unsigned int alloc_files = 0;
+
+    /* A path is written on one line */
+    if(session == NULL || !is_valid_path_eSession(path))
+        return -1;
+
+    if(session->n_files >= session->alloc_files)
+    {
+        alloc_files = (session->alloc_files > 0) ? session->alloc_files*2
+                                                 : 16;
+        files = (session_file *) realloc(session->files,
+                                         alloc_files*sizeof(session_file));
+        if(files == NULL)
+            return -1;
+
+        session->files = files;
+        session->alloc_files = alloc_files;
+    }
+
+    file = &session->files[session->n_files];
+    file->path = strdup(path);
+    if(file->path == NULL)
+        return -1;
+    file->current_line = (current_line > 0) ? current_line : 1;
+    file->current_pos = current_pos;
+    file->first_screen_line = (first_screen_line > 0
+                               &&
+                               first_screen_line <= file->current_line)
+                              ? first_screen_line : file->current_line;
+    session->n_files++;
+
+    return 0;
+}
+
+
+/**
+ * @brief The add_directory_eSession() function add an open directory.
+ *
+ * @param session: eSession pointer
+ * @param path: Path of the directory, from the directory of the session
+ *
+ * @return 0 on success or -1 in failure.
+ */
+int add_directory_eSession(eSession * session,
+                           char const * path)
+{
+    char **directories = NULL;
+    unsigned int alloc_directories = 0;
+
+    if(session == NULL || !is_valid_path_eSession(path))
+        return -1;
+
+    if(session->n_directories >= session->alloc_directories)
+    {
+        alloc_directories = (session->alloc_directories > 0)
+                            ? session->alloc_directories*2 : 16;
+        directories = (char **) realloc(session->directories,
+                                        alloc_directories*sizeof(char *));
+        if(directories == NULL)
+            return -1;
+
+        session->directories = directories;
+        session->alloc_directories = alloc_directories;
+    }
+
+    session->directories[session->n_directories] = strdup(path);
+    if(session->directories[session->n_directories] == NULL)
+        return -1;
+    session->n_directories++;
+
+    return 0;
+}
+
+
+/**
+ * @brief The write_eSession() function write the session in its file. The
+ *        session is written in a temporary file renamed over it.
+ *
+ * @param session: eSession pointer
+ *
+ * @return 0 on success or -1 in failure.
+ */
+int write_eSession(eSession * session)
+{
+    char tmp_path[PATH_MAX+8];
+    session_file const *file = NULL;
+    FILE *fp = NULL;
+    bool failed = false;
+
+    if(make_directories_eSession(session->path) == -1)
+        return -1;
+
+    snprintf(tmp_path, sizeof(tmp_path), "%s.new", session->path);
+    if((fp = fopen(tmp_path, "w")) == NULL)
+        return -1;
+
+    /* The directory tells a session from another one of the same hash */
+    fprintf(fp, "%s\nroot %s\nmode %d\ncurrent %d\n", SESSION_MAGIC,
+            session->root, session->mode, session->current);
+
+    for(unsigned int i=0; i<session->n_directories; i++)
+        fprintf(fp, "directory %s\n", session->directories[i]);
+
+    /* The path is the end of the line, it may contain spaces */
+    for(unsigned int i=0; i<session->n_files; i++)
+    {
+        file = &session->files[i];
+        fprintf(fp, "file %u %u %u %s\n", file->current_line,
+                file->current_pos, file->first_screen_line, file->path);
+    }
+
+    failed = (ferror(fp) != 0);
+    if(fclose(fp) != 0 || failed || rename(tmp_path, session->path) == -1)
+    {
+        unlink(tmp_path);
+        return -1;
+    }
+
+    return 0;
+}
+
+
+/**
+ * @brief The read_eSession() function read the session written by the
+ *        last edito which exited in the directory.
+ *
+ * @param session: eSession pointer, empty
+ *
+ * @return 0 on success or -1 if there is no session or it can not be
+ *         read.
+ */
+int read_eSession(eSession * session)
+{
+    FILE *fp = NULL;
+    char *line = NULL;
+    size_t alloc_length = 0;
+    ssize_t length = 0;
+    unsigned int current_line = 0, current_pos = 0, first_screen_line = 0;
+    int path = 0;
+    int result = 0;
+
+    if((fp = fopen(session->path, "r")) == NULL)
+        return -1;
+
+    /* A session of another version is not read */
+    length = getline(&line, &alloc_length, fp);
+    if(length > 0 && line[length-1] == '\n')
+        line[length-1] = 0;
+    if(length <= 0 || strcmp(line, SESSION_MAGIC) != 0)
+    {
+        free(line);
+        fclose(fp);
+        return -1;
+    }
+
+    length = getline(&line, &alloc_length, fp);
+    if(length > 0 && line[length-1] == '\n')
+        line[length-1] = 0;
+    if(length <= 5
+       ||
+       strncmp(line, "root ", 5) != 0
+       ||
+       strcmp(line+5, session->root) != 0)
+    {
+        free(line);
+        fclose(fp);
+        return -1;
+    }
+
+    while(result == 0 && (length = getline(&line, &alloc_length, fp)) > 0)
+    {
+        if(line[length-1] == '\n')
+            line[length-1] = 0;
+
+        path = 0;
+        if(sscanf(line, "mode %d", &session->mode) == 1)
+            continue;
+        if(sscanf(line, "current %d", &session->current) == 1)
+            continue;
+
+        if(sscanf(line, "directory %n", &path) == 0 && path > 0)
+            result = add_directory_eSession(session, line+path);
+        else if(sscanf(line, "file %u %u %u %n", &current_line,
+                       &current_pos, &first_screen_line, &path) == 3
+                &&
+                path > 0)
+            result = add_file_eSession(session, line+path, current_line,
+                                       current_pos, first_screen_line);
+    }
+
+    free(line);
+    fclose(fp);
+
+    if(session->current >= (int) session->n_files)
+        session->current = -1;
+
+    return result;
+}
+
+
+/**
+ * @brief The is_valid_path_eSession() function return true if a path can
+ *        be written on a line of the session.
+ *
+ * @param path: Path, from the directory of the session
+ *
+ * @return true if the path is not empty and has no '\n', false otherwise.
+ */
+static bool is_valid_path_eSession(char const * path)
+{
+    return path != NULL && path[0] != 0 && strchr(path, '\n') == NULL;
+}
+
+
+/**
+ * @brief The get_state_eSession() function give the state directory of the
+ *        user: $XDG_STATE_HOME, or $HOME/.local/state when it is not set
+ *        or not absolute.
+ *
+ * @param path: Buffer of the path
+ * @param size: Size of the buffer
+ *
+ * @return 0 on success or -1 if the user has no state directory.
+ */
+static int get_state_eSession(char * path,
+                              size_t size)
+{
+    char const *state = getenv("XDG_STATE_HOME");
+    char const *home = getenv("HOME");
+    int n = 0;
+
+    if(state != NULL && state[0] == '/')
+        n = snprintf(path, size, "%s", state);
+    else if(home != NULL && home[0] == '/')
+        n = snprintf(path, size, "%s/.local/state", home);
+    else
+        return -1;
+
+    return (n < 0 || (size_t) n >= size) ? -1 : 0;
+}
+
+
+/**
+ * @brief The make_directories_eSession() function create the missing
+ *        directories of the path of a file, private to the user.
+ *
+ * @param path: Absolute path of the file
+ *
+ * @return 0 on success or -1 in failure.
+ */
+static int make_directories_eSession(char const * path)
+{
+    char directory[PATH_MAX];
+    char *slash = NULL;
+
+    if(snprintf(directory, sizeof(directory), "%s", path)
+       >= (int) sizeof(directory))
+        return -1;
+
+    for(slash = strchr(directory+1, '/'); slash; slash = strchr(slash+1, '/'))
+    {
+        *slash = 0;
+        if(mkdir(directory, 0700) == -1 && errno != EEXIST)
+            return -1;
+        *slash = '/';
+    }
+
+    return 0;
+}
@@ -0,0 +1,323 @@
+/**
+ * @file eTabs.c
+ * @brief eTabs is a View part of the MVC design
+ * @author ALARY Dorian
+ * @version 1.0
+ * @date 21/07/2024
+ * @copyright GNU Public License.
+ *
+ * @details This file contain every functions relative to the eTabs
+ *          structure. The tabs show the titles of the open files on one
+ *          row. A tab is added or removed by moving the pointers of the
+ *          titles, and a print only looks at the tabs which fit in the
+ *          window, so that hundreds of tabs cost no more than a few.
+ */
+
+#include "eTabs.h"
+#include "util.h"
+#include <stdlib.h>
+#include <string.h>
+
+static int get_width_eTabs(eTabs const * tabs);
+static int get_tab_width_eTabs(eTabs const * tabs,
+                               int index,
+                               int width);
+
+
+/**
+ * @brief The create_eTabs() function allocate and initialize an eTabs
+ *        structure.
+ *
+ * @param win: Tabs window
+ *
+ * @return eTabs pointer or NULL if it was an error.
+ *
+ * @note delete_eTabs() must be called before exiting.
+ */
+eTabs * create_eTabs(WINDOW * win)
+{
+    eTabs *tabs = NULL;
+
+    tabs = (eTabs *) malloc(sizeof(eTabs));
+    if(tabs == NULL)
+        return NULL;
+
+    tabs->win = win;
+    tabs->titles = NULL;
+    tabs->n_tabs = 0;
+    tabs->alloc_size = 0;
+    tabs->current = -1;
+    tabs->first = 0;
+
+    return tabs;
+}
+
+
+/**
+ * @brief The delete_eTabs() function deallocate the eTabs structure and
+ *        set the pointer to the structure to NULL.
+ *
+ * @param tabs: eTabs pointer pointer
+ */
+void delete_eTabs(eTabs ** tabs)
+{
+    if(*tabs == NULL)
+        return;
+
+    for(int i=0; i<(*tabs)->n_tabs; i++)
+    {
+        free((*tabs)->titles[i]);
+    }
+
+    free((*tabs)->titles);
+    free(*tabs);
+    *tabs = NULL;
+}
+
+
+/**
+ * @brief The add_tab_eTabs() function add a tab after the last one, the
+ *        other tabs are kept as they are.
+ *
+ * @param tabs: eTabs pointer
+ * @param title: Tab title
+ *
+ * @return 0 on success, -1 in failure.
+ */
+int add_tab_eTabs(eTabs * tabs,
+                  char const * title)
+{
+    char **titles = NULL;
+    char *copy = NULL;
+
+    if(tabs == NULL)
+        return -1;
+
+    if(tabs->n_tabs+1 > tabs->alloc_size)
+    {
+        titles = (char **) realloc(tabs->titles,
+                                   get_next_power_of_two(tabs->n_tabs+1)
+                                   * sizeof(char *));
+        if(titles == NULL)
+            return -1;
+
+        tabs->titles = titles;
+        tabs->alloc_size = get_next_power_of_two(tabs->n_tabs+1);
+    }
+
+    copy = strdup(title);
+    if(copy == NULL)
+        return -1;
+
+    tabs->titles[tabs->n_tabs] = copy;
+    tabs->n_tabs++;
+
+    if(tabs->current == -1)
+        tabs->current = 0;
+
+    return 0;
+}
+
+
+/**
+ * @brief The remove_tab_eTabs() function remove a tab, the current tab
+ *        stays the same or becomes the previous one if it is removed.
+ *
+ * @param tabs: eTabs pointer
+ * @param index: Index of the tab
+ *
+ * @return 0 on success, -1 in failure.
+ */
+int remove_tab_eTabs(eTabs * tabs,
+                     int index)
+{
+    if(tabs == NULL || index < 0 || index >= tabs->n_tabs)
+        return -1;
+
+    free(tabs->titles[index]);
+    memmove(&tabs->titles[index], &tabs->titles[index+1],
+            (tabs->n_tabs-index-1)*sizeof(char *));
+    tabs->n_tabs--;
+
+    if(index < tabs->current || (index == tabs->current && index > 0))
+        tabs->current--;
+    if(tabs->current >= tabs->n_tabs)
+        tabs->current = tabs->n_tabs-1;
+
+    if(index < tabs->first)
+        tabs->first--;
+
+    return 0;
+}
+
+
+/**
+ * @brief The set_current_tab_eTabs() function set the current tab.
+ *
+ * @param tabs: eTabs pointer
+ * @param index: Index of the tab
+ */
+void set_current_tab_eTabs(eTabs * tabs,
+                           int index)
+{
+    if(index < 0 || index >= tabs->n_tabs)
+        return;
+
+    tabs->current = index;
+}
+
+
+/**
+ * @brief The get_current_tab_eTabs() function return the current tab.
+ *
+ * @param tabs: eTabs pointer
+ *
+ * @return Index of the current tab or -1 if there is no tab.
+ */
+int get_current_tab_eTabs(eTabs const * tabs)
+{
+    return tabs->current;
+}
+
+
+/**
+ * @brief The move_next_tab_eTabs() function move to the next tab, the
+ *        first one after the last one.
+ *
+ * @param tabs: eTabs pointer
+ */
+void move_next_tab_eTabs(eTabs * tabs)
+{
+    if(tabs->n_tabs == 0)
+        return;
+
+    tabs->current = (tabs->current+1) % tabs->n_tabs;
+}
+
+
+/**
+ * @brief The move_previous_tab_eTabs() function move to the previous tab,
+ *        the last one before the first one.
+ *
+ * @param tabs: eTabs pointer
+ */
+void move_previous_tab_eTabs(eTabs * tabs)
+{
+    if(tabs->n_tabs == 0)
+        return;
+
+    tabs->current = (tabs->current > 0) ? tabs->current-1 : tabs->n_tabs-1;
+}
+
+
+/**
+ * @brief The print_eTabs() function print the tabs which fit in the
+ *        window around the current one, and move the cursor of the window
+ *        to the current tab.
+ *
+ * @param tabs: eTabs pointer
+ */
+void print_eTabs(eTabs * tabs)
+{
+    int width = get_width_eTabs(tabs);
+    int used = 0, last = 0, x = TABS_MARGIN, cursor = TABS_MARGIN;
+    int length = 0;
+
+    werase(tabs->win);
+    if(tabs->n_tabs == 0)
+        return;
+
+    /* The row scrolls to the left, then to the right until the current
+       tab fits, only the tabs between are measured */
+    if(tabs->current < tabs->first)
+        tabs->first = tabs->current;
+
+    last = tabs->current;
+    used = get_tab_width_eTabs(tabs, last, width);
+    while(last > tabs->first
+          &&
+          used+1+get_tab_width_eTabs(tabs, last-1, width) <= width)
+    {
+        last--;
+        used += 1+get_tab_width_eTabs(tabs, last, width);
+    }
+    tabs->first = last;
+
+    /* Tabs after the current one fill the row */
+    used = 0;
+    for(last=tabs->first; last<tabs->n_tabs; last++)
+    {
+        length = get_tab_width_eTabs(tabs, last, width);
+        if(used+(last > tabs->first)+length > width)
+            break;
+        used += (last > tabs->first)+length;
+    }
+
+    /* The space left by closed tabs is filled with the previous ones */
+    while(last == tabs->n_tabs
+          &&
+          tabs->first > 0
+          &&
+          used+1+get_tab_width_eTabs(tabs, tabs->first-1, width) <= width)
+    {
+        tabs->first--;
+        used += 1+get_tab_width_eTabs(tabs, tabs->first, width);
+    }
+
+    for(int i=tabs->first; i<last; i++)
+    {
+        length = get_tab_width_eTabs(tabs, i, width);
+        if(i == tabs->current)
+        {
+            cursor = x;
+            wattron(tabs->win, A_REVERSE);
+        }
+        mvwaddnstr(tabs->win, 0, x, tabs->titles[i], length);
+        wattroff(tabs->win, A_REVERSE);
+        x += length+1;
+    }
+
+    /* The hidden tabs are marked on each side */
+    if(tabs->first > 0)
+        mvwaddch(tabs->win, 0, 0, '<');
+    if(last < tabs->n_tabs)
+        mvwaddch(tabs->win, 0, getmaxx(tabs->win)-1, '>');
+
+    wmove(tabs->win, 0, cursor);
+}
+
+
+/**
+ * @brief The get_width_eTabs() function return the number of columns of
+ *        the tabs, without the scroll marks.
+ *
+ * @param tabs: eTabs pointer
+ *
+ * @return Number of columns, at least 1.
+ */
+static int get_width_eTabs(eTabs const * tabs)
+{
+    int width = getmaxx(tabs->win)-2*TABS_MARGIN;
+
+    return (width > 0) ? width : 1;
+}
+
+
+/**
+ * @brief The get_tab_width_eTabs() function return the number of columns
+ *        of a tab, a title longer than the row is cut.
+ *
+ * @param tabs: eTabs pointer
+ * @param index: Index of the tab
+ * @param width: Number of columns of the tabs
+ *
+ * @return Number of columns of the tab.
+ */
+static int get_tab_width_eTabs(eTabs const * tabs,
+                               int index,
+                               int width)
+{
+    size_t length = strlen(tabs->titles[index]);
+
+    return (length < (size_t) width) ? (int) length : width;
+}
@@ -0,0 +1,469 @@
+/**
+ * @file eUndo.c
+ * @brief Contain eUndo structure and functions
+ * @author ALARY Dorian
+ * @version 1.0
+ * @date 21/07/2024
+ * @copyright GNU Public License.
+ *
+ * @details This file contains the functions used to undo and redo the
+ *          modifications of an eFile. Every modification adds the operation
+ *          undoing it to a stack, its bytes are copied in an arena. The
+ *          operations of an input form a group, undone at once.
+ */
+
+#include "eUndo.h"
+#include "eFile.h"
+#include "util.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+
+static size_t get_size_eUndo(eUndo const * undo);
+static void clear_stack_eUndo(undo_stack * stack);
+static void drop_oldest_eUndo(eUndo * undo,
+                              undo_stack * stack,
+                              size_t needed);
+static void drop_group_eUndo(eUndo * undo,
+                             undo_stack * stack);
+static int apply_group_eUndo(eUndo * undo,
+                             undo_stack * stack,
+                             eFile * file,
+                             UNDO_STATE state);
+static int apply_record_eUndo(eFile * file,
+                              undo_record const * record,
+                              char const * arena);
+
+
+/**
+ * @brief The create_eUndo() function allocate an empty eUndo.
+ *
+ * @param limit: Memory cap of the records (bytes)
+ *
+ * @return eUndo pointer or NULL if it was an error.
+ *
+ * @note delete_eUndo() must be called before exiting.
+ */
+eUndo * create_eUndo(size_t limit)
+{
+    eUndo *undo = NULL;
+
+    undo = (eUndo *) malloc(sizeof(eUndo));
+    if(undo == NULL)
+        return NULL;
+
+    memset(undo, 0, sizeof(eUndo));
+    undo->limit = limit;
+    undo->state = u_DO;
+
+    return undo;
+}
+
+
+/**
+ * @brief The delete_eUndo() function deallocate eUndo and set the pointer
+ *        to NULL.
+ *
+ * @param undo: eUndo pointer pointer
+ */
+void delete_eUndo(eUndo ** undo)
+{
+    if(*undo == NULL)
+        return;
+
+    clear_stack_eUndo(&(*undo)->undo);
+    clear_stack_eUndo(&(*undo)->redo);
+    free(*undo);
+    *undo = NULL;
+}
+
+
+/**
+ * @brief The set_limit_eUndo() function set the memory cap of the records.
+ *        The oldest records are dropped to fit in it.
+ *
+ * @param undo: eUndo pointer
+ * @param limit: Memory cap (bytes)
+ */
+void set_limit_eUndo(eUndo * undo,
+                     size_t limit)
+{
+    if(undo == NULL)
+        return;
+
+    undo->limit = limit;
+
+    if(get_size_eUndo(undo) > limit)
+    {
+        clear_stack_eUndo(&undo->redo);
+        drop_oldest_eUndo(undo, &undo->undo, 0);
+    }
+}
+
+
+/**
+ * @brief The next_group_eUndo() function start a new group, the next
+ *        modifications are undone together.
+ *
+ * @param undo: eUndo pointer
+ */
+void next_group_eUndo(eUndo * undo)
+{
+    if(undo == NULL)
+        return;
+
+    undo->group++;
+    undo->overflow = false;
+}
+
+
+/**
+ * @brief The add_record_eUndo() function add the operation undoing a
+ *        modification to the current group.
+ *
+ * @param undo: eUndo pointer
+ * @param type: Operation type
+ * @param line_number: Line number of the operation
+ * @param pos: Position in the line
+ * @param data: Bytes of u_INSERT_STRING or NULL
+ * @param length: Number of bytes, or removed length of u_REMOVE_STRING
+ * @param typing: The modification is a typed character
+ *
+ * @return 0 on success or -1 in failure.
+ */
+int add_record_eUndo(eUndo * undo,
+                     UNDO_RECORD type,
+                     unsigned int line_number,
+                     unsigned int pos,
+                     char const * data,
+                     size_t length,
+                     bool typing)
+{
+    undo_stack *stack = NULL;
+    undo_record *record = NULL;
+    size_t data_length = (type == u_INSERT_STRING) ? length : 0;
+    size_t needed = sizeof(undo_record)+data_length;
+    size_t alloc_size = 0;
+    void *memory = NULL;
+
+    if(undo == NULL || undo->overflow)
+        return -1;
+
+    stack = (undo->state == u_UNDO) ? &undo->redo : &undo->undo;
+
+    /* A new modification can not be redone after the undone ones */
+    if(undo->state == u_DO)
+        clear_stack_eUndo(&undo->redo);
+
+    /* A character typed after the previous one grows its record */
+    if(typing && stack->n_records > 0)
+    {
+        record = &stack->records[stack->n_records-1];
+        if(record->typing
+           &&
+           record->group+1 == undo->group
+           &&
+           record->line_number == line_number
+           &&
+           record->pos+record->length == pos)
+        {
+            record->length += length;
+            record->group = undo->group;
+            return 0;
+        }
+    }
+
+    if(get_size_eUndo(undo)+needed > undo->limit)
+        drop_oldest_eUndo(undo, stack, needed);
+
+    /* The group does not fit, none of its records is kept */
+    if(get_size_eUndo(undo)+needed > undo->limit)
+    {
+        drop_group_eUndo(undo, stack);
+        undo->overflow = true;
+        return -1;
+    }
+
+    if(stack->n_records+1 > stack->alloc_records)
+    {
+        alloc_size = get_next_power_of_two(stack->n_records+1);
+        memory = realloc(stack->records, alloc_size*sizeof(undo_record));
+        if(memory == NULL)
+            return -1;
+
+        stack->records = (undo_record *) memory;
+        stack->alloc_records = alloc_size;
+    }
+
+    if(stack->arena_length+data_length > stack->arena_size)
+    {
+        alloc_size = get_next_power_of_two(stack->arena_length+data_length);
+        memory = realloc(stack->arena, alloc_size);
+        if(memory == NULL)
+            return -1;
+
+        stack->arena = (char *) memory;
+        stack->arena_size = alloc_size;
+    }
+
+    record = &stack->records[stack->n_records++];
+    record->group = undo->group;
+    record->line_number = line_number;
+    record->pos = pos;
+    record->type = type;
+    record->typing = typing;
+    record->offset = stack->arena_length;
+    record->length = length;
+
+    if(data_length > 0)
+        memcpy(stack->arena+stack->arena_length, data, data_length);
+    stack->arena_length += data_length;
+
+    return 0;
+}
+
+
+/**
+ * @brief The undo_eUndo() function undo the last group of modifications
+ *        of the file. The cursor is moved to the last modification.
+ *
+ * @param undo: eUndo pointer
+ * @param file: eFile pointer
+ *
+ * @return 0 on success or -1 if there is nothing to undo.
+ */
+int undo_eUndo(eUndo * undo,
+               eFile * file)
+{
+    if(undo == NULL)
+        return -1;
+
+    return apply_group_eUndo(undo, &undo->undo, file, u_UNDO);
+}
+
+
+/**
+ * @brief The redo_eUndo() function redo the last undone group of
+ *        modifications of the file. The cursor is moved to the last
+ *        modification.
+ *
+ * @param undo: eUndo pointer
+ * @param file: eFile pointer
+ *
+ * @return 0 on success or -1 if there is nothing to redo.
+ */
+int redo_eUndo(eUndo * undo,
+               eFile * file)
+{
+    if(undo == NULL)
+        return -1;
+
+    return apply_group_eUndo(undo, &undo->redo, file, u_REDO);
+}
+
+
+/**
+ * @brief The get_size_eUndo() function return the memory used by the
+ *        records of both stacks.
+ *
+ * @param undo: eUndo pointer
+ *
+ * @return Memory used (bytes).
+ */
+static size_t get_size_eUndo(eUndo const * undo)
+{
+    return undo->undo.arena_length
+           + undo->undo.n_records*sizeof(undo_record)
+           + undo->redo.arena_length
+           + undo->redo.n_records*sizeof(undo_record);
+}
+
+
+/**
+ * @brief The clear_stack_eUndo() function remove every record of a stack
+ *        and deallocate its memory.
+ *
+ * @param stack: undo_stack pointer
+ */
+static void clear_stack_eUndo(undo_stack * stack)
+{
+    free(stack->records);
+    free(stack->arena);
+    memset(stack, 0, sizeof(undo_stack));
+}
+
+
+/**
+ * @brief The drop_oldest_eUndo() function remove the oldest groups of a
+ *        stack, but not the current one, until needed bytes fit in 3/4 of
+ *        the memory cap, so that the stack is not moved for each record.
+ *
+ * @param undo: eUndo pointer
+ * @param stack: undo_stack pointer
+ * @param needed: Number of bytes to add
+ */
+static void drop_oldest_eUndo(eUndo * undo,
+                              undo_stack * stack,
+                              size_t needed)
+{
+    size_t target = undo->limit/4*3;
+    size_t size = get_size_eUndo(undo)+needed;
+    size_t offset = 0;
+    unsigned int n = 0;
+    unsigned int group = 0;
+
+    while(n < stack->n_records
+          &&
+          stack->records[n].group != undo->group
+          &&
+          size > target)
+    {
+        /* A group is dropped entirely */
+        group = stack->records[n].group;
+        while(n < stack->n_records && stack->records[n].group == group)
+        {
+            size -= sizeof(undo_record);
+            if(stack->records[n].type == u_INSERT_STRING)
+                size -= stack->records[n].length;
+            n++;
+        }
+    }
+
+    if(n == 0)
+        return;
+
+    offset = (n < stack->n_records) ? stack->records[n].offset
+                                    : stack->arena_length;
+
+    memmove(stack->records, stack->records+n,
+            (stack->n_records-n)*sizeof(undo_record));
+    stack->n_records -= n;
+
+    memmove(stack->arena, stack->arena+offset, stack->arena_length-offset);
+    stack->arena_length -= offset;
+
+    for(unsigned int i=0; i<stack->n_records; i++)
+        stack->records[i].offset -= offset;
+}
+
+
+/**
+ * @brief The drop_group_eUndo() function remove the records of the current
+ *        group from the top of a stack.
+ *
+ * @param undo: eUndo pointer
+ * @param stack: undo_stack pointer
+ */
+static void drop_group_eUndo(eUndo * undo,
+                             undo_stack * stack)
+{
+    while(stack->n_records > 0
+          &&
+          stack->records[stack->n_records-1].group == undo->group)
+    {
+        stack->n_records--;
+        stack->arena_length = stack->records[stack->n_records].offset;
+    }
+}
+
+
+/**
+ * @brief The apply_group_eUndo() function apply the last group of a stack
+ *        on the file and remove it from the stack. The applied operations
+ *        are recorded in the other stack depending on state.
+ *
+ * @param undo: eUndo pointer
+ * @param stack: undo_stack pointer
+ * @param file: eFile pointer
+ * @param state: u_UNDO or u_REDO
+ *
+ * @return 0 on success or -1 if the stack is empty.
+ */
+static int apply_group_eUndo(eUndo * undo,
+                             undo_stack * stack,
+                             eFile * file,
+                             UNDO_STATE state)
+{
+    undo_record *last = NULL;
+    unsigned int first = 0;
+    unsigned int line_number = 0;
+    unsigned int pos = 0;
+
+    if(file == NULL || stack->n_records == 0)
+        return -1;
+
+    first = stack->n_records-1;
+    while(first > 0
+          &&
+          stack->records[first-1].group == stack->records[first].group)
+        first--;
+
+    undo->state = state;
+    next_group_eUndo(undo);
+
+    /* The records are applied from the last one, the file is printed once
+       by the caller */
+    for(unsigned int i=stack->n_records; i>first; i--)
+        apply_record_eUndo(file, &stack->records[i-1], stack->arena);
+
+    last = &stack->records[first];
+    line_number = last->line_number;
+    pos = last->pos;
+
+    stack->n_records = first;
+    stack->arena_length = last->offset;
+
+    undo->state = u_DO;
+    next_group_eUndo(undo);
+
+    /* The cursor is put on the first modification of the group */
+    file->current_line = get_line_eFile(file, line_number);
+    file->current_pos = pos;
+    if(file->current_pos > file->current_line->length)
+        file->current_pos = file->current_line->length;
+
+    return 0;
+}
+
+
+/**
+ * @brief The apply_record_eUndo() function apply an operation on the file.
+ *
+ * @param file: eFile pointer
+ * @param record: undo_record pointer
+ * @param arena: Arena of the record
+ *
+ * @return 0 on success or -1 in failure.
+ */
+static int apply_record_eUndo(eFile * file,
+                              undo_record const * record,
+                              char const * arena)
+{
+    file->current_line = get_line_eFile(file, record->line_number);
+    if(file->current_line == NULL)
+        return -1;
+
+    file->current_pos = record->pos;
+    if(file->current_pos > file->current_line->length)
+        file->current_pos = file->current_line->length;
+
+    switch(record->type)
+    {
+        case u_INSERT_STRING:
+            return insert_string_eFile(file, arena+record->offset,
+                                       record->length);
+
+        case u_REMOVE_STRING:
+            return remove_string_eFile(file, record->length);
+
+        case u_ADD_LINE:
+            return add_empty_line_eFile(file, record->line_number);
+
+        case u_DELETE_LINE:
+            return delete_line_eFile(file, record->line_number);
+
+        default:
+            return -1;
+    }
+}
@@ -0,0 +1,1180 @@
+/**
+ * @file eView.c
+ * @brief Contain eView structure and functions
+ * @author ALARY Dorian
+ * @version 1.0
+ * @date 21/07/2024
+ * @copyright GNU Public License.
+ *
+ * @details This file contains the functions used to show and modify a huge
+ *          file without reading its lines. The file is mapped in memory and
+ *          divided in pages of VIEW_STEP lines as they are reached, so that
+ *          the memory used does not depend on the number of lines. A page
+ *          is copied in memory when it is modified, and spilled in a swap
+ *          file when the modified pages exceed their budget. The ranges of
+ *          the swap file left by pages modified again are reused. A file
+ *          truncated by another program, like a rotated log, would stop
+ *          edito with SIGBUS when a page past its end is read: the page
+ *          is replaced by zeros and the view is marked truncated.
+ */
+
+#include "eView.h"
+#include "util.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+
+#define VIEW_DROP_SIZE (16*1024*1024) /* Bytes indexed at once from which
+                                         their pages are released */
+#define VIEW_PAGE_MAX (1024*1024) /* Length (bytes) from which a modified
+                                     page is split */
+#define VIEW_EXTENT_STEP 4096 /* Ranges of the swap file are rounded up to
+                                 it, a quarter bigger than their page */
+
+
+static eView * first_view = NULL; /* Views read by the SIGBUS handler */
+static size_t guard_page_size = 0; /* Size of the pages replaced by it */
+
+
+static void guard_eView(eView * view);
+static void unguard_eView(eView const * view);
+static void handle_sigbus(int sig,
+                          siginfo_t * info,
+                          void * context);
+static int add_page_eView(eView * view,
+                          unsigned int index);
+static unsigned int find_page_eView(eView const * view,
+                                    unsigned int line_number);
+static char const * get_data_eView(eView * view,
+                                   unsigned int index);
+static int load_page_eView(eView * view,
+                           unsigned int index);
+static int reserve_page_eView(eView * view,
+                              unsigned int index,
+                              size_t length);
+static void spill_eView(eView * view,
+                        unsigned int keep);
+static int spill_page_eView(eView * view,
+                            unsigned int index);
+static off_t take_extent_eView(eView * view,
+                               size_t length);
+static void free_extent_eView(eView * view,
+                              off_t offset,
+                              size_t length);
+static void trim_swap_eView(eView * view);
+static int split_page_eView(eView * view,
+                            unsigned int index);
+static int merge_page_eView(eView * view,
+                            unsigned int index);
+static void shift_lines_eView(eView * view,
+                              unsigned int index,
+                              int delta);
+static size_t find_line_eView(char const * data,
+                              size_t length,
+                              unsigned int count);
+
+
+/**
+ * @brief The create_eView() function map a file and allocate an eView with
+ *        an empty index.
+ *
+ * @param fd: Descriptor of the file, it can be closed afterwards
+ * @param size: Size of the file
+ * @param realpath: Path of the file, the swap file is created next to it
+ *
+ * @return eView pointer or NULL if it was an error.
+ *
+ * @note delete_eView() must be called before exiting.
+ */
+eView * create_eView(int fd,
+                     size_t size,
+                     char const * realpath)
+{
+    eView *view = NULL;
+    void *data = NULL;
+    char const *filename = NULL;
+    size_t length = 0;
+
+    /* An empty file can not be mapped */
+    if(fd == -1 || size == 0 || realpath == NULL)
+        return NULL;
+
+    data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if(data == MAP_FAILED)
+        return NULL;
+
+    view = (eView *) malloc(sizeof(eView));
+    if(view == NULL)
+    {
+        munmap(data, size);
+        return NULL;
+    }
+
+    memset(view, 0, sizeof(eView));
+    view->data = (char const *) data;
+    view->size = size;
+    view->swap_fd = -1;
+    view->budget = VIEW_DEFAULT_BUDGET;
+    view->first_screen_line = 1;
+    view->current_line = 1;
+
+    /* The swap file is hidden next to the file, like its journal */
+    length = strlen(realpath)+32;
+    view->swap_path = (char *) malloc(length);
+    if(view->swap_path == NULL)
+    {
+        delete_eView(&view);
+        return NULL;
+    }
+
+    filename = strrchr(realpath, '/');
+    if(filename != NULL)
+        snprintf(view->swap_path, length, "%.*s/.%s.edito-swap-XXXXXX",
+                 (int) (filename-realpath), realpath, filename+1);
+    else
+        snprintf(view->swap_path, length, ".%s.edito-swap-XXXXXX",
+                 realpath);
+
+    guard_eView(view);
+
+    return view;
+}
+
+
+/**
+ * @brief The delete_eView() function unmap the file, remove the swap file,
+ *        deallocate eView and set the pointer to NULL.
+ *
+ * @param view: eView pointer pointer
+ */
+void delete_eView(eView ** view)
+{
+    if(*view == NULL)
+        return;
+
+    for(unsigned int i=0; i<(*view)->n_pages; i++)
+        free((*view)->pages[i].data);
+
+    /* The swap file was removed once opened */
+    if((*view)->swap_fd != -1)
+        close((*view)->swap_fd);
+
+    unguard_eView(*view);
+    munmap((void *) (*view)->data, (*view)->size);
+    free((*view)->pages);
+    free((*view)->extents);
+    free((*view)->swap_path);
+    free(*view);
+    *view = NULL;
+}
+
+
+/**
+ * @brief The set_budget_eView() function set the memory cap of the
+ *        modified pages. The least recently used ones are spilled to fit
+ *        in it.
+ *
+ * @param view: eView pointer
+ * @param budget: Memory cap (bytes)
+ */
+void set_budget_eView(eView * view,
+                      size_t budget)
+{
+    if(view == NULL)
+        return;
+
+    view->budget = budget;
+    spill_eView(view, UINT_MAX);
+}
+
+
+/**
+ * @brief The extend_eView() function index the lines of the file until a
+ *        line number, or until the end of the file.
+ *
+ * @param view: eView pointer
+ * @param line_number: Line number to reach
+ *
+ * @return Number of lines indexed.
+ */
+unsigned int extend_eView(eView * view,
+                          unsigned int line_number)
+{
+    view_page *page = NULL;
+    char const *newline = NULL;
+    size_t page_size = sysconf(_SC_PAGESIZE);
+    size_t from = view->indexed;
+    size_t begin = 0, end = 0, next = 0;
+
+    while(view->n_lines < line_number && view->indexed < view->size)
+    {
+        /* Lines are added to the last page until it is full or modified */
+        page = (view->n_pages > 0) ? &view->pages[view->n_pages-1] : NULL;
+        if(page == NULL || page->dirty || page->n_lines >= VIEW_STEP)
+        {
+            if(add_page_eView(view, view->n_pages) == -1)
+                break;
+
+            page = &view->pages[view->n_pages-1];
+            page->first_line = view->n_lines+1;
+            page->offset = view->indexed;
+        }
+
+        newline = memchr(view->data+view->indexed, '\n',
+                         view->size-view->indexed);
+        next = (newline != NULL) ? (size_t) (newline-view->data)+1
+                                 : view->size;
+
+        page->length += next-view->indexed;
+        page->n_lines++;
+        view->n_lines++;
+        view->indexed = next;
+    }
+
+    /* The pages read to count the lines are not kept in memory, the
+       mapping is read again when they are shown */
+    if(view->indexed-from >= VIEW_DROP_SIZE)
+    {
+        begin = (from+page_size-1)/page_size*page_size;
+        end = view->indexed/page_size*page_size;
+        madvise((void *) (view->data+begin), end-begin, MADV_DONTNEED);
+    }
+
+    return view->n_lines;
+}
+
+
+/**
+ * @brief The get_line_eView() function find a line. The line is not
+ *        terminated by 0, and is valid until the next call on the eView.
+ *
+ * @param view: eView pointer
+ * @param line_number: Line number
+ * @param length: Length of the line, without '\n'
+ *
+ * @return Beginning of the line or NULL if the line does not exist.
+ */
+char const * get_line_eView(eView * view,
+                            unsigned int line_number,
+                            size_t * length)
+{
+    view_page const *page = NULL;
+    char const *data = NULL;
+    char const *newline = NULL;
+    unsigned int index = 0;
+    unsigned int current = 0;
+    size_t offset = 0;
+
+    if(line_number == 0 || extend_eView(view, line_number) < line_number)
+        return NULL;
+
+    /* The lines are found from the last one when it is in the same page,
+       so that the lines of a screen are found one after the other */
+    page = (view->last_line != 0) ? &view->pages[view->last_page] : NULL;
+    if(page != NULL
+       &&
+       view->last_line <= line_number
+       &&
+       line_number < page->first_line+page->n_lines)
+    {
+        index = view->last_page;
+        current = view->last_line;
+        offset = view->last_offset;
+    }
+    else
+    {
+        index = find_page_eView(view, line_number);
+        current = view->pages[index].first_line;
+        offset = 0;
+    }
+
+    data = get_data_eView(view, index);
+    if(data == NULL)
+        return NULL;
+
+    page = &view->pages[index];
+    offset += find_line_eView(data+offset, page->length-offset,
+                              line_number-current);
+
+    view->last_line = line_number;
+    view->last_page = index;
+    view->last_offset = offset;
+
+    newline = memchr(data+offset, '\n', page->length-offset);
+    *length = (newline != NULL) ? (size_t) (newline-data)-offset
+                                : page->length-offset;
+
+    return data+offset;
+}
+
+
+/**
+ * @brief The insert_eView() function insert a string in a line. Each '\n'
+ *        of the string splits the line.
+ *
+ * @param view: eView pointer
+ * @param line_number: Line number
+ * @param pos: Position in the line
+ * @param string: String to insert
+ * @param length: Length of the string
+ *
+ * @return 0 on success or -1 in failure.
+ */
+int insert_eView(eView * view,
+                 unsigned int line_number,
+                 unsigned int pos,
+                 char const * string,
+                 size_t length)
+{
+    view_page *page = NULL;
+    char const *newline = NULL;
+    unsigned int index = 0;
+    unsigned int n_lines = 0;
+    size_t offset = 0, line_length = 0;
+
+    if(line_number == 0 || extend_eView(view, line_number) < line_number)
+        return -1;
+
+    index = find_page_eView(view, line_number);
+    if(load_page_eView(view, index) == -1
+       ||
+       reserve_page_eView(view, index, view->pages[index].length+length) == -1)
+        return -1;
+
+    page = &view->pages[index];
+    offset = find_line_eView(page->data, page->length,
+                             line_number-page->first_line);
+    newline = memchr(page->data+offset, '\n', page->length-offset);
+    line_length = (size_t) (newline-page->data)-offset;
+    if(pos > line_length)
+        pos = line_length;
+    offset += pos;
+
+    memmove(page->data+offset+length, page->data+offset,
+            page->length-offset);
+    memcpy(page->data+offset, string, length);
+    page->length += length;
+    page->swapped = false;
+
+    for(size_t i=0; i<length; i++)
+    {
+        if(string[i] == '\n')
+            n_lines++;
+    }
+    page->n_lines += n_lines;
+    shift_lines_eView(view, index, n_lines);
+    view->last_line = 0;
+
+    if(page->length > VIEW_PAGE_MAX)
+        split_page_eView(view, index);
+
+    spill_eView(view, index);
+
+    return 0;
+}
+
+
+/**
+ * @brief The remove_eView() function remove bytes of a line. Removing the
+ *        '\n' at the end of the line joins the next line.
+ *
+ * @param view: eView pointer
+ * @param line_number: Line number
+ * @param pos: Position in the line
+ * @param length: Number of bytes, up to the end of the line and its '\n'
+ *
+ * @return 0 on success or -1 in failure.
+ */
+int remove_eView(eView * view,
+                 unsigned int line_number,
+                 unsigned int pos,
+                 size_t length)
+{
+    view_page *page = NULL;
+    char const *newline = NULL;
+    unsigned int index = 0;
+    size_t offset = 0, line_length = 0;
+    bool join = false;
+
+    /* The next line is indexed, it may be joined */
+    if(line_number == 0 || extend_eView(view, line_number+1) < line_number)
+        return -1;
+
+    index = find_page_eView(view, line_number);
+    if(load_page_eView(view, index) == -1)
+        return -1;
+
+    page = &view->pages[index];
+    offset = find_line_eView(page->data, page->length,
+                             line_number-page->first_line);
+    newline = memchr(page->data+offset, '\n', page->length-offset);
+    line_length = (size_t) (newline-page->data)-offset;
+    if(pos > line_length)
+        return -1;
+
+    if(length > line_length-pos+1)
+        length = line_length-pos+1;
+
+    join = (pos+length == line_length+1);
+
+    /* The last line of the file keeps its '\n' */
+    if(join && line_number == view->n_lines)
+    {
+        length--;
+        join = false;
+    }
+
+    /* The first line of the next page is joined with the whole page */
+    if(join && line_number == page->first_line+page->n_lines-1)
+    {
+        if(merge_page_eView(view, index) == -1)
+            return -1;
+        page = &view->pages[index];
+    }
+
+    offset += pos;
+    memmove(page->data+offset, page->data+offset+length,
+            page->length-offset-length);
+    page->length -= length;
+    page->swapped = false;
+
+    if(join)
+    {
+        page->n_lines--;
+        shift_lines_eView(view, index, -1);
+    }
+    view->last_line = 0;
+
+    spill_eView(view, index);
+
+    return 0;
+}
+
+
+/**
+ * @brief The check_truncated_eView() function return true the first time
+ *        a page was read past the end of the file, truncated by another
+ *        program. The lines are not right anymore.
+ *
+ * @param view: eView pointer
+ *
+ * @return true if the truncation was not reported yet, false otherwise.
+ */
+bool check_truncated_eView(eView * view)
+{
+    if(view == NULL || !view->truncated || view->reported)
+        return false;
+
+    view->reported = true;
+
+    return true;
+}
+
+
+/**
+ * @brief The hold_swap_eView() function keep the spilled pages where they
+ *        are while a snapshot reads the swap file: spilled pages are then
+ *        appended and no free range is reused.
+ *
+ * @param view: eView pointer
+ *
+ * @note release_swap_eView() must be called once the snapshot is written.
+ */
+void hold_swap_eView(eView * view)
+{
+    view->n_holds++;
+}
+
+
+/**
+ * @brief The release_swap_eView() function let the free ranges of the swap
+ *        file be reused once a snapshot was written.
+ *
+ * @param view: eView pointer
+ */
+void release_swap_eView(eView * view)
+{
+    if(view->n_holds > 0)
+        view->n_holds--;
+
+    trim_swap_eView(view);
+}
+
+
+/**
+ * @brief The guard_eView() function add a view to the views read by the
+ *        SIGBUS handler, installed with the first view.
+ *
+ * @param view: eView pointer
+ *
+ * @note The views are only read by the main thread, the handler runs in
+ *       it when a page faults.
+ */
+static void guard_eView(eView * view)
+{
+    struct sigaction action;
+
+    if(guard_page_size == 0)
+    {
+        guard_page_size = sysconf(_SC_PAGESIZE);
+
+        memset(&action, 0, sizeof(action));
+        action.sa_sigaction = handle_sigbus;
+        action.sa_flags = SA_SIGINFO;
+        sigemptyset(&action.sa_mask);
+        sigaction(SIGBUS, &action, NULL);
+    }
+
+    view->next = first_view;
+    first_view = view;
+}
+
+
+/**
+ * @brief The unguard_eView() function remove a view from the views read by
+ *        the SIGBUS handler.
+ *
+ * @param view: eView pointer
+ */
+static void unguard_eView(eView const * view)
+{
+    eView **current = &first_view;
+
+    while(*current != NULL && *current != view)
+        current = &(*current)->next;
+
+    if(*current != NULL)
+        *current = view->next;
+}
+
+
+/**
+ * @brief The handle_sigbus() function replace the page of a view read past
+ *        the end of its file by a page of zeros, the read is then done
+ *        again. A fault out of the views stops edito as it would have.
+ *
+ * @param sig: SIGBUS
+ * @param info: Address of the fault
+ * @param context: Not used
+ */
+static void handle_sigbus(int sig,
+                          siginfo_t * info,
+                          void * context)
+{
+    uintptr_t address = (uintptr_t) info->si_addr;
+    uintptr_t page = address & ~((uintptr_t) guard_page_size-1);
+
+    (void) context;
+
+    for(eView *view = first_view; view != NULL; view = view->next)
+    {
+        if(address < (uintptr_t) view->data
+           ||
+           address >= (uintptr_t) view->data+view->size)
+            continue;
+
+        if(mmap((void *) page, guard_page_size, PROT_READ,
+                MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0) != MAP_FAILED)
+        {
+            view->truncated = 1;
+            return;
+        }
+        break;
+    }
+
+    signal(sig, SIG_DFL);
+}
+
+
+/**
+ * @brief The add_page_eView() function insert an empty page.
+ *
+ * @param view: eView pointer
+ * @param index: Index of the new page
+ *
+ * @return 0 on success or -1 in failure.
+ */
+static int add_page_eView(eView * view,
+                          unsigned int index)
+{
+    view_page *pages = NULL;
+    unsigned int alloc_size = 0;
+
+    if(view->n_pages+1 > view->alloc_pages)
+    {
+        alloc_size = get_next_power_of_two(view->n_pages+1);
+        pages = (view_page *) realloc(view->pages,
+                                      alloc_size*sizeof(view_page));
+        if(pages == NULL)
+            return -1;
+
+        view->pages = pages;
+        view->alloc_pages = alloc_size;
+    }
+
+    memmove(view->pages+index+1, view->pages+index,
+            (view->n_pages-index)*sizeof(view_page));
+    memset(&view->pages[index], 0, sizeof(view_page));
+    view->n_pages++;
+    view->last_line = 0;
+
+    return 0;
+}
+
+
+/**
+ * @brief The find_page_eView() function return the page of an indexed
+ *        line, by binary search.
+ *
+ * @param view: eView pointer
+ * @param line_number: Line number
+ *
+ * @return Index of the page.
+ */
+static unsigned int find_page_eView(eView const * view,
+                                    unsigned int line_number)
+{
+    unsigned int low = 0, high = view->n_pages-1, middle = 0;
+
+    while(low < high)
+    {
+        middle = low+(high-low+1)/2;
+        if(view->pages[middle].first_line <= line_number)
+            low = middle;
+        else
+            high = middle-1;
+    }
+
+    return low;
+}
+
+
+/**
+ * @brief The get_data_eView() function return the bytes of a page, a
+ *        spilled page is read again.
+ *
+ * @param view: eView pointer
+ * @param index: Index of the page
+ *
+ * @return Bytes of the page or NULL if it was an error.
+ */
+static char const * get_data_eView(eView * view,
+                                   unsigned int index)
+{
+    view_page *page = &view->pages[index];
+
+    page->use = ++view->use;
+
+    if(!page->dirty)
+        return view->data+page->offset;
+
+    if(page->data == NULL)
+    {
+        if(load_page_eView(view, index) == -1)
+            return NULL;
+        spill_eView(view, index);
+    }
+
+    return view->pages[index].data;
+}
+
+
+/**
+ * @brief The load_page_eView() function copy a page in memory to modify
+ *        it, from the mapping or from the swap file. Every line then ends
+ *        with '\n'.
+ *
+ * @param view: eView pointer
+ * @param index: Index of the page
+ *
+ * @return 0 on success or -1 in failure.
+ */
+static int load_page_eView(eView * view,
+                           unsigned int index)
+{
+    view_page *page = &view->pages[index];
+    char *data = NULL;
+    size_t length = 0, size = 0;
+    ssize_t n = 0;
+
+    page->use = ++view->use;
+
+    if(page->data != NULL)
+        return 0;
+
+    /* One more byte for the '\n' of the last line of the file */
+    size = page->length+1;
+    data = (char *) malloc(size);
+    if(data == NULL)
+        return -1;
+
+    if(!page->dirty)
+        memcpy(data, view->data+page->offset, page->length);
+
+    while(page->dirty && length < page->length)
+    {
+        n = pread(view->swap_fd, data+length, page->length-length,
+                  page->offset+length);
+        if(n == -1 && errno == EINTR)
+            continue;
+        if(n <= 0)
+        {
+            free(data);
+            return -1;
+        }
+        length += n;
+    }
+
+    if(page->length == 0 || data[page->length-1] != '\n')
+        data[page->length++] = '\n';
+
+    page->data = data;
+    page->size = size;
+    page->dirty = true;
+    view->resident += page->size;
+
+    return 0;
+}
+
+
+/**
+ * @brief The reserve_page_eView() function grow the memory of a modified
+ *        page.
+ *
+ * @param view: eView pointer
+ * @param index: Index of the page
+ * @param length: Number of bytes needed
+ *
+ * @return 0 on success or -1 in failure.
+ */
+static int reserve_page_eView(eView * view,
+                              unsigned int index,
+                              size_t length)
+{
+    view_page *page = &view->pages[index];
+    char *data = NULL;
+    size_t size = 0;
+
+    if(length <= page->size)
+        return 0;
+
+    size = (length < page->size*2) ? page->size*2 : length;
+    data = (char *) realloc(page->data, size);
+    if(data == NULL)
+        return -1;
+
+    view->resident += size-page->size;
+    page->data = data;
+    page->size = size;
+
+    return 0;
+}
+
+
+/**
+ * @brief The spill_eView() function spill the least recently used
+ *        modified pages until they fit in the budget.
+ *
+ * @param view: eView pointer
+ * @param keep: Index of a page which stays in memory
+ */
+static void spill_eView(eView * view,
+                        unsigned int keep)
+{
+    unsigned int victim = 0;
+    bool found = false;
+
+    while(view->resident > view->budget)
+    {
+        found = false;
+        for(unsigned int i=0; i<view->n_pages; i++)
+        {
+            if(i == keep || view->pages[i].data == NULL)
+                continue;
+
+            if(!found || view->pages[i].use < view->pages[victim].use)
+                victim = i;
+            found = true;
+        }
+
+        if(!found || spill_page_eView(view, victim) == -1)
+            return;
+    }
+}
+
+
+/**
+ * @brief The spill_page_eView() function write a modified page in the swap
+ *        file and release its memory. The page is written over its
+ *        previous range when it fits, otherwise in the smallest free range
+ *        where it fits or at the end. A page read again and not modified
+ *        is not written.
+ *
+ * @param view: eView pointer
+ * @param index: Index of the page
+ *
+ * @return 0 on success or -1 in failure.
+ */
+static int spill_page_eView(eView * view,
+                            unsigned int index)
+{
+    view_page *page = &view->pages[index];
+    size_t length = 0, size = 0;
+    ssize_t n = 0;
+
+    if(page->swapped)
+        goto release;
+
+    /* Removed once opened, the swap file disappears with edito */
+    if(view->swap_fd == -1)
+    {
+        view->swap_fd = mkstemp(view->swap_path);
+        if(view->swap_fd == -1)
+            return -1;
+        unlink(view->swap_path);
+    }
+
+    /* A snapshot may read the previous range, it is then kept. A page
+       modified again grows, its range has room for it */
+    if(view->n_holds > 0 || page->extent < page->length)
+    {
+        if(page->extent > 0)
+            free_extent_eView(view, page->offset, page->extent);
+        size = page->length+page->length/4;
+        size = (size+VIEW_EXTENT_STEP-1)/VIEW_EXTENT_STEP*VIEW_EXTENT_STEP;
+        page->offset = take_extent_eView(view, size);
+        page->extent = size;
+    }
+
+    while(length < page->length)
+    {
+        n = pwrite(view->swap_fd, page->data+length, page->length-length,
+                   page->offset+length);
+        if(n == -1 && errno == EINTR)
+            continue;
+        if(n <= 0)
+            return -1;
+        length += n;
+    }
+
+    page->swapped = true;
+
+release:
+    free(page->data);
+    view->resident -= page->size;
+    page->data = NULL;
+    page->size = 0;
+
+    return 0;
+}
+
+
+/**
+ * @brief The take_extent_eView() function return the offset of a range of
+ *        the swap file for a page: the smallest free range where it fits,
+ *        the rest of which stays free, or the end of the file.
+ *
+ * @param view: eView pointer
+ * @param length: Number of bytes
+ *
+ * @return Offset of the range.
+ */
+static off_t take_extent_eView(eView * view,
+                               size_t length)
+{
+    swap_extent extent;
+    unsigned int low = 0, high = view->n_extents, middle = 0;
+
+    /* A snapshot may read the free ranges */
+    if(view->n_holds > 0)
+        low = view->n_extents;
+
+    while(low < high)
+    {
+        middle = low+(high-low)/2;
+        if(view->extents[middle].length < length)
+            low = middle+1;
+        else
+            high = middle;
+    }
+
+    if(low == view->n_extents)
+    {
+        view->swap_size += length;
+        return view->swap_size-length;
+    }
+
+    extent = view->extents[low];
+    memmove(view->extents+low, view->extents+low+1,
+            (view->n_extents-low-1)*sizeof(swap_extent));
+    view->n_extents--;
+
+    if(extent.length > length)
+        free_extent_eView(view, extent.offset+length, extent.length-length);
+
+    return extent.offset;
+}
+
+
+/**
+ * @brief The free_extent_eView() function add a range of the swap file to
+ *        the free ranges, sorted by length, merged with the free ranges
+ *        next to it. A range at the end of the file shrinks it instead.
+ *
+ * @param view: eView pointer
+ * @param offset: Offset of the range
+ * @param length: Number of bytes
+ *
+ * @note A range which can not be added is lost until edito exits.
+ */
+static void free_extent_eView(eView * view,
+                              off_t offset,
+                              size_t length)
+{
+    swap_extent *extents = NULL;
+    unsigned int alloc_size = 0, index = 0;
+
+    while(index < view->n_extents)
+    {
+        if(view->extents[index].offset+(off_t) view->extents[index].length
+           != offset
+           &&
+           offset+(off_t) length != view->extents[index].offset)
+        {
+            index++;
+            continue;
+        }
+
+        if(view->extents[index].offset < offset)
+            offset = view->extents[index].offset;
+        length += view->extents[index].length;
+        memmove(view->extents+index, view->extents+index+1,
+                (view->n_extents-index-1)*sizeof(swap_extent));
+        view->n_extents--;
+        index = 0;
+    }
+    index = 0;
+
+    if(view->n_extents+1 > view->alloc_extents)
+    {
+        alloc_size = get_next_power_of_two(view->n_extents+1);
+        extents = (swap_extent *) realloc(view->extents,
+                                          alloc_size*sizeof(swap_extent));
+        if(extents == NULL)
+            return;
+
+        view->extents = extents;
+        view->alloc_extents = alloc_size;
+    }
+
+    while(index < view->n_extents && view->extents[index].length < length)
+        index++;
+
+    memmove(view->extents+index+1, view->extents+index,
+            (view->n_extents-index)*sizeof(swap_extent));
+    view->extents[index].offset = offset;
+    view->extents[index].length = length;
+    view->n_extents++;
+
+    trim_swap_eView(view);
+}
+
+
+/**
+ * @brief The trim_swap_eView() function remove the free ranges at the end
+ *        of the swap file and truncate it.
+ *
+ * @param view: eView pointer
+ */
+static void trim_swap_eView(eView * view)
+{
+    off_t size = view->swap_size;
+    unsigned int i = 0;
+
+    if(view->n_holds > 0)
+        return;
+
+    while(i < view->n_extents)
+    {
+        if(view->extents[i].offset+(off_t) view->extents[i].length
+           != view->swap_size)
+        {
+            i++;
+            continue;
+        }
+
+        view->swap_size = view->extents[i].offset;
+        memmove(view->extents+i, view->extents+i+1,
+                (view->n_extents-i-1)*sizeof(swap_extent));
+        view->n_extents--;
+        i = 0;
+    }
+
+    if(view->swap_size < size && view->swap_fd != -1)
+        ftruncate(view->swap_fd, view->swap_size);
+}
+
+
+/**
+ * @brief The split_page_eView() function split a modified page longer than
+ *        VIEW_PAGE_MAX in two pages, at a line near its middle.
+ *
+ * @param view: eView pointer
+ * @param index: Index of the page
+ *
+ * @return 0 on success or -1 in failure, the page is then kept whole.
+ */
+static int split_page_eView(eView * view,
+                            unsigned int index)
+{
+    view_page *page = &view->pages[index], *next = NULL;
+    char const *newline = NULL;
+    char *data = NULL;
+    size_t split = 0;
+    unsigned int n_lines = 0;
+
+    newline = memchr(page->data+page->length/2, '\n',
+                     page->length-page->length/2);
+    split = (size_t) (newline-page->data)+1;
+
+    /* A single long line is not split */
+    if(split >= page->length)
+        return -1;
+
+    for(char const *c=page->data; c<page->data+split; c++)
+    {
+        if(*c == '\n')
+            n_lines++;
+    }
+
+    data = (char *) malloc(page->length-split);
+    if(data == NULL || add_page_eView(view, index+1) == -1)
+    {
+        free(data);
+        return -1;
+    }
+
+    page = &view->pages[index];
+    next = &view->pages[index+1];
+    memcpy(data, page->data+split, page->length-split);
+
+    next->first_line = page->first_line+n_lines;
+    next->n_lines = page->n_lines-n_lines;
+    next->length = page->length-split;
+    next->data = data;
+    next->size = next->length;
+    next->dirty = true;
+    next->use = page->use;
+    view->resident += next->size;
+
+    page->n_lines = n_lines;
+    page->length = split;
+    page->swapped = false;
+
+    return 0;
+}
+
+
+/**
+ * @brief The merge_page_eView() function append the next page to a
+ *        modified page.
+ *
+ * @param view: eView pointer
+ * @param index: Index of the page
+ *
+ * @return 0 on success or -1 in failure.
+ */
+static int merge_page_eView(eView * view,
+                            unsigned int index)
+{
+    view_page *page = NULL, *next = NULL;
+
+    if(index+1 >= view->n_pages
+       ||
+       load_page_eView(view, index+1) == -1
+       ||
+       reserve_page_eView(view, index,
+                          view->pages[index].length
+                          + view->pages[index+1].length) == -1)
+        return -1;
+
+    page = &view->pages[index];
+    next = &view->pages[index+1];
+
+    memcpy(page->data+page->length, next->data, next->length);
+    page->length += next->length;
+    page->n_lines += next->n_lines;
+    page->swapped = false;
+
+    free(next->data);
+    view->resident -= next->size;
+    if(next->extent > 0)
+        free_extent_eView(view, next->offset, next->extent);
+
+    memmove(view->pages+index+1, view->pages+index+2,
+            (view->n_pages-index-2)*sizeof(view_page));
+    view->n_pages--;
+    view->last_line = 0;
+
+    return 0;
+}
+
+
+/**
+ * @brief The shift_lines_eView() function shift the line numbers of the
+ *        pages after a page whose number of lines changed.
+ *
+ * @param view: eView pointer
+ * @param index: Index of the page
+ * @param delta: Number of lines added, negative if removed
+ */
+static void shift_lines_eView(eView * view,
+                              unsigned int index,
+                              int delta)
+{
+    if(delta == 0)
+        return;
+
+    for(unsigned int i=index+1; i<view->n_pages; i++)
+        view->pages[i].first_line += delta;
+
+    view->n_lines += delta;
+}
+
+
+/**
+ * @brief The find_line_eView() function return the offset of a line from
+ *        the beginning of a line.
+ *
+ * @param data: Beginning of a line
+ * @param length: Number of bytes after data
+ * @param count: Number of lines to skip
+ *
+ * @return Offset of the line.
+ */
+static size_t find_line_eView(char const * data,
+                              size_t length,
+                              unsigned int count)
+{
+    char const *newline = NULL;
+    size_t offset = 0;
+
+    while(count > 0)
+    {
+        newline = memchr(data+offset, '\n', length-offset);
+        if(newline == NULL)
+            break;
+
+        offset = (size_t) (newline-data)+1;
+        count--;
+    }
+
+    return offset;
+}
@@ -0,0 +1,151 @@
+/**
+ * @file eWatch.c
+ * @brief Contain eWatch structure and functions
+ * @author ALARY Dorian
+ * @version 1.0
+ * @date 21/07/2024
+ * @copyright GNU Public License.
+ *
+ * @details This file contains the functions used to tell when the open
+ *          files may have been changed by another program, like git or a
+ *          formatter. inotify only tells that something happened in a
+ *          directory, the status of each file is then compared by eManager.
+ */
+
+#include "eWatch.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+
+
+/* A file written in place, replaced or removed */
+#define WATCH_EVENTS (IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE \
+                      | IN_ATTRIB)
+
+
+/**
+ * @brief The create_eWatch() function allocate an eWatch without watched
+ *        directory.
+ *
+ * @return eWatch pointer or NULL if it was an error.
+ *
+ * @note delete_eWatch() must be called before exiting.
+ */
+eWatch * create_eWatch(void)
+{
+    eWatch *watch = NULL;
+
+    watch = (eWatch *) malloc(sizeof(eWatch));
+    if(watch == NULL)
+        return NULL;
+
+    /* Without inotify, the files are checked every WATCH_DELAY */
+    watch->inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    watch->pending = false;
+    clock_gettime(CLOCK_MONOTONIC, &watch->last_check);
+
+    return watch;
+}
+
+
+/**
+ * @brief The delete_eWatch() function stop watching the directories,
+ *        deallocate eWatch and set the pointer to NULL.
+ *
+ * @param watch: eWatch pointer pointer
+ */
+void delete_eWatch(eWatch ** watch)
+{
+    if(*watch == NULL)
+        return;
+
+    if((*watch)->inotify_fd != -1)
+        close((*watch)->inotify_fd);
+
+    free(*watch);
+    *watch = NULL;
+}
+
+
+/**
+ * @brief The add_eWatch() function watch the directory of a file. A
+ *        directory is watched once, until the eWatch is deleted.
+ *
+ * @param watch: eWatch pointer
+ * @param realpath: Path of the file
+ *
+ * @return 0 on success or -1 in failure.
+ */
+int add_eWatch(eWatch * watch,
+               char const * realpath)
+{
+    char directory[PATH_MAX];
+    char *slash = NULL;
+
+    if(watch->inotify_fd == -1)
+        return -1;
+
+    if(strlen(realpath) >= sizeof(directory))
+        return -1;
+    strcpy(directory, realpath);
+
+    /* The watch of a directory already watched is only updated */
+    slash = strrchr(directory, '/');
+    if(slash == NULL)
+        strcpy(directory, ".");
+    else if(slash == directory)
+        directory[1] = 0;
+    else
+        *slash = 0;
+
+    return (inotify_add_watch(watch->inotify_fd, directory,
+                              WATCH_EVENTS) == -1) ? -1 : 0;
+}
+
+
+/**
+ * @brief The is_changed_eWatch() function return true if a file of the
+ *        watched directories was written, renamed or deleted since the last
+ *        call, without waiting.
+ *
+ * @param watch: eWatch pointer
+ *
+ * @return true if the files must be checked, false otherwise.
+ */
+bool is_changed_eWatch(eWatch * watch)
+{
+    char events[4096];
+    struct timespec now;
+    bool changed = watch->pending;
+    long elapsed = 0;
+    ssize_t n = 0;
+
+    watch->pending = false;
+
+    if(watch->inotify_fd == -1)
+    {
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        elapsed = (now.tv_sec-watch->last_check.tv_sec)*1000
+                  + (now.tv_nsec-watch->last_check.tv_nsec)/1000000;
+        if(elapsed < WATCH_DELAY)
+            return changed;
+
+        watch->last_check = now;
+        return true;
+    }
+
+    /* Every pending event is read, one check covers them all */
+    while((n = read(watch->inotify_fd, events, sizeof(events))) > 0
+          ||
+          (n == -1 && errno == EINTR))
+    {
+        if(n > 0)
+            changed = true;
+    }
+
+    return changed;
+}
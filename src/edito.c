@@ -11,14 +11,23 @@
 #include "eFile.h"
 #include "eManager.h"
 
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <stdbool.h>
 #include <locale.h>
+#include <unistd.h>
+#include <limits.h>
 
 
-void init_terminal(void);
+int init_terminal(void);
 void reset_terminal(void);
 void usage(void);
+FSYNC_POLICY get_fsync_policy(void);
+unsigned long get_env_number(char const * name,
+                             unsigned long default_value,
+                             unsigned long unit);
+bool get_session(void);
 
 int main(int argc, char * argv[])
 {
@@ -28,7 +37,18 @@ int main(int argc, char * argv[])
     eScreen *screen = NULL;
     eBar *bar = NULL;
     eDirectory *project_repo = NULL;
+    eIndex *index = NULL;
+    eFile *input = NULL;
     char *reponame = 0;
+    bool read_input = false;
+
+    /* "-" reads the output of a command piped to edito */
+    if(argc > 1 && strcmp(argv[1], "-") == 0)
+    {
+        read_input = true;
+        argc--;
+        argv++;
+    }
 
     if(argc == 1)
     {
@@ -44,9 +64,21 @@ int main(int argc, char * argv[])
         exit(EXIT_FAILURE);
     }
 
+    /* The standard input of a terminal is the keyboard of ncurses, it is
+       not read as a file */
+    if(read_input && isatty(STDIN_FILENO))
+    {
+        fprintf(stderr, "edito: no input piped\n");
+        exit(EXIT_FAILURE);
+    }
+
 
     /* Terminal initialization */
-    init_terminal();
+    if(init_terminal() == -1)
+    {
+        fprintf(stderr, "edito: no terminal\n");
+        exit(EXIT_FAILURE);
+    }
 
     /* Screen structure initialization */
     if((screen = create_eScreen(LINES, COLS)) == NULL)
@@ -69,6 +101,9 @@ int main(int argc, char * argv[])
         exit(EXIT_FAILURE);
     }
 
+    /* Symbol index creation, files are parsed in background */
+    index = create_eIndex(project_repo);
+
     /* Manager structure initialization */
     if((manager = create_eManager()) == NULL)
     {
@@ -79,6 +114,27 @@ int main(int argc, char * argv[])
     set_eScreen_eManager(manager, screen);
     set_eBar_eManager(manager, bar);
     set_eDirectory_eManager(manager, project_repo);
+    set_eIndex_eManager(manager, index);
+    set_fsync_policy_eManager(manager, get_fsync_policy());
+
+    /* Sizes are read in MiB, the delay in seconds */
+    set_undo_limit_eManager(manager,
+                            get_env_number("EDITO_UNDO_LIMIT",
+                                           UNDO_DEFAULT_LIMIT, 1024*1024));
+    set_view_threshold_eManager(manager,
+                                get_env_number("EDITO_VIEW_THRESHOLD",
+                                               VIEW_DEFAULT_THRESHOLD,
+                                               1024*1024));
+    set_view_budget_eManager(manager,
+                             get_env_number("EDITO_VIEW_MEMORY",
+                                            VIEW_DEFAULT_BUDGET, 1024*1024));
+    set_pack_delay_eManager(manager,
+                            get_env_number("EDITO_PACK_DELAY",
+                                           PACK_DEFAULT_DELAY, 1));
+    set_pack_budget_eManager(manager,
+                             get_env_number("EDITO_PACK_MEMORY",
+                                            PACK_DEFAULT_BUDGET, 1024*1024));
+    set_session_eManager(manager, get_session());
 
     manager->directory->is_open = true;
 
@@ -93,6 +149,22 @@ int main(int argc, char * argv[])
     /* Set cursor on the current menu item */
     move_current_item_menu_eScreen(manager->screen, MDIR);
 
+    /* Journals left by an edito which did not exit */
+    recover_journals_eManager(manager);
+
+    /* Files and directories left open by the last run */
+    restore_session_eManager(manager);
+
+    /* The piped input is read while the buffer is shown */
+    if(read_input)
+    {
+        input = create_eFile("[stdin]");
+        if(input == NULL
+           ||
+           open_stream_eManager(manager, input, STDIN_FILENO) == -1)
+            delete_eFile(&input);
+    }
+
     /* Main loop */
     while(run)
     {
@@ -101,8 +173,10 @@ int main(int argc, char * argv[])
 
     delete_eScreen(&screen);
     delete_eBar(&bar);
+    delete_eIndex(&index);
     delete_eDirectory(&project_repo);
     delete_eManager(&manager);
+    delete_eFile(&input);
 
     reset_terminal();
 
@@ -111,14 +185,24 @@ int main(int argc, char * argv[])
 
 
 /*
- * @brief Initialize the terminal for the applciation
+ * @brief Initialize the terminal for the applciation. When the standard
+ *        input is a pipe, the inputs are read from /dev/tty.
+ *
+ * @return 0 on success or -1 in failure.
  */
-void init_terminal(void)
+int init_terminal(void)
 {
+    FILE *tty = NULL;
+
     setlocale(LC_ALL, "");
 
     /* Init window structure */
-    initscr();
+    if(isatty(STDIN_FILENO))
+        initscr();
+    else if((tty = fopen("/dev/tty", "r")) == NULL
+            ||
+            newterm(NULL, stdout, tty) == NULL)
+        return -1;
 
     /* Deactivate echo from getch */
     noecho();
@@ -126,6 +210,8 @@ void init_terminal(void)
     /* Deactivate buffering and disallow signals like Ctrl+C, Ctrl+S */
     raw();
     set_escdelay(50);
+
+    return 0;
 }
 
 
@@ -140,5 +226,64 @@ void reset_terminal(void)
 
 void usage(void)
 {
-    printf("edito [directory]");
+    printf("edito [-] [directory]");
+}
+
+
+/*
+ * @brief Return the fsync policy of the saves, read in the EDITO_FSYNC
+ *        environment variable: "none", "file" or "full" (default).
+ */
+FSYNC_POLICY get_fsync_policy(void)
+{
+    char const *policy = getenv("EDITO_FSYNC");
+
+    if(policy != NULL && strcmp(policy, "none") == 0)
+        return f_NONE;
+
+    if(policy != NULL && strcmp(policy, "file") == 0)
+        return f_FILE;
+
+    return f_FULL;
+}
+
+
+/*
+ * @brief Return a number read in an environment variable and multiplied
+ *        by its unit, or the default value if the variable is not set, is
+ *        not a number or is too big.
+ *
+ * @param name: Name of the environment variable
+ * @param default_value: Value returned by default, already in bytes or
+ *                       seconds
+ * @param unit: Unit of the variable, like 1024*1024 for MiB
+ */
+unsigned long get_env_number(char const * name,
+                             unsigned long default_value,
+                             unsigned long unit)
+{
+    char const *string = getenv(name);
+    char *end = NULL;
+    unsigned long value = 0;
+
+    if(string == NULL)
+        return default_value;
+
+    value = strtoul(string, &end, 10);
+    if(end == string || *end != 0 || value > ULONG_MAX/unit)
+        return default_value;
+
+    return value*unit;
+}
+
+
+/*
+ * @brief Return false if the open files are not kept for the next run, when
+ *        the EDITO_SESSION environment variable is "none".
+ */
+bool get_session(void)
+{
+    char const *session = getenv("EDITO_SESSION");
+
+    return session == NULL || strcmp(session, "none") != 0;
 }
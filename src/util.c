@@ -1,3 +1,8 @@
+#include "util.h"
+
+#include <string.h>
+
+
 /*
  * @brief The get_next_power_of_two() function is an intern function to
  *        calculate the next power of two after a number n.
@@ -40,3 +45,34 @@ int digit_number(unsigned int n)
 
     return 10;
 }
+
+
+/*
+ * @brief The hash_bytes() function continue the hash of a content with
+ *        the following bytes. The bytes are hashed by words of 8, a
+ *        content hashed in blocks of a multiple of 8 bytes gets the same
+ *        hash as in one block.
+ *
+ * @example hash_bytes(HASH_INIT, "abc", 3)
+ */
+uint64_t hash_bytes(uint64_t hash,
+                    void const * data,
+                    size_t length)
+{
+    unsigned char const *bytes = (unsigned char const *) data;
+    uint64_t word = 0;
+    size_t i = 0;
+
+    /* FNV-1a on words, the multiplication mixes the 8 bytes at once */
+    for(; i+8 <= length; i+=8)
+    {
+        memcpy(&word, bytes+i, 8);
+        hash = (hash ^ word)*0x100000001b3ULL;
+        hash ^= hash >> 32;
+    }
+
+    for(; i<length; i++)
+        hash = (hash ^ bytes[i])*0x100000001b3ULL;
+
+    return hash;
+}